@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) NVIDIA CORPORATION & AFFILIATES, 2024. ALL RIGHTS RESERVED.
+#
+# See file LICENSE for terms.
+#
+#
+# Message rate and latency regression suite for UCP over transports which do
+# not require special hardware (self, shared memory, CMA and TCP loopback).
+#
+# The suite runs ucx_perftest in loopback mode for every combination of
+# message size (sizes batch file), test type (types batch file) and transport,
+# and writes the results to a JSON file. If a baseline file is given, every result
+# is compared with the baseline and the script fails if any of the results is
+# worse than the baseline by more than the allowed tolerance.
+#
+# Usage example:
+#   ucx_perftest_regress.py --perftest ./src/tools/perf/ucx_perftest \
+#       --output results.json
+#   ucx_perftest_regress.py --perftest ./src/tools/perf/ucx_perftest \
+#       --baseline results.json --tolerance 10
+#
+
+import argparse
+import csv
+import json
+import os
+import subprocess
+import sys
+
+
+# Batch files are looked up in the source tree, or next to the installed script
+SCRIPT_DIR  = os.path.dirname(os.path.abspath(__file__))
+CONFIG_DIRS = [os.path.join(SCRIPT_DIR, "ucx_perftest_config"), SCRIPT_DIR]
+
+# Default pairs of (message sizes, test types) batch files
+SUITES = [
+    ("msg_regress",     "test_types_ucp_regress"),
+    ("msg_regress_amo", "test_types_ucp_regress_amo"),
+]
+
+# Transports which are available without special hardware: name -> UCX_TLS
+TRANSPORTS = {
+    "self"  : "self",
+    "posix" : "posix",
+    "sysv"  : "sysv",
+    "cma"   : "tcp,cma",
+    "tcp"   : "tcp",
+}
+
+# CSV columns printed by "ucx_perftest -v", after the batch test names
+CSV_FIELDS = ["iterations", "percentile_lat", "avg_lat", "overall_lat",
+              "avg_bw", "overall_bw", "avg_mr", "overall_mr"]
+
+# Metrics which are compared with the baseline: name -> higher is better
+METRICS = {
+    "overall_lat" : False,
+    "overall_bw"  : True,
+    "overall_mr"  : True,
+}
+
+
+def config_path(name):
+    for path in [name] + [os.path.join(d, name) for d in CONFIG_DIRS]:
+        if os.path.exists(path):
+            return path
+    sys.exit("batch file '%s' was not found" % name)
+
+
+def run_perftest(args, tls_name, msg_sizes, test_types):
+    env = dict(os.environ)
+    env["UCX_TLS"] = TRANSPORTS[tls_name]
+    env.setdefault("UCX_WARN_UNUSED_ENV_VARS", "n")
+
+    cmd = [args.perftest, "-l", "-v", "-f",
+           "-b", config_path(test_types), "-b", config_path(msg_sizes)]
+    if args.cpu is not None:
+        cmd += ["-c", args.cpu]
+
+    if args.verbose:
+        print("running: UCX_TLS=%s %s" % (env["UCX_TLS"], " ".join(cmd)))
+
+    proc = subprocess.run(cmd, env=env, stdout=subprocess.PIPE,
+                          stderr=subprocess.PIPE, universal_newlines=True)
+    if proc.returncode != 0:
+        sys.stderr.write("transport %s: ucx_perftest failed (%d):\n%s" %
+                         (tls_name, proc.returncode, proc.stderr))
+        return None
+
+    results = {}
+    for row in csv.reader(proc.stdout.splitlines()):
+        # Results rows have two test names (type, size) followed by numbers
+        if len(row) != (2 + len(CSV_FIELDS)):
+            continue
+        try:
+            values = [float(value) for value in row[2:]]
+        except ValueError:
+            continue  # CSV header
+
+        key = "%s/%s/%s" % (tls_name, row[0].strip(), row[1].strip())
+        results[key] = dict(zip(CSV_FIELDS, values))
+
+    return results
+
+
+def compare(results, baseline, tolerance, verbose):
+    regressions = []
+    num_compared = 0
+    for key, base in sorted(baseline.items()):
+        if key not in results:
+            if verbose:
+                print("%-50s missing in results" % key)
+            continue
+
+        num_compared += 1
+
+        for metric, higher_is_better in sorted(METRICS.items()):
+            if not base.get(metric):
+                continue
+
+            value = results[key][metric]
+            ratio = (value / base[metric]) if higher_is_better else \
+                    (base[metric] / value if value else float("inf"))
+            degradation = (1.0 - ratio) * 100.0
+            status = "FAIL" if degradation > tolerance else "ok"
+            if (status != "ok") or verbose:
+                print("%-50s %-12s base %14.3f current %14.3f (%+.1f%%) %s" %
+                      (key, metric, base[metric], value, -degradation,
+                       status))
+            if status != "ok":
+                regressions.append((key, metric))
+
+    return num_compared, regressions
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+            description="UCP performance regression suite over loopback")
+    parser.add_argument("--perftest", default="ucx_perftest",
+                        help="path to ucx_perftest executable")
+    parser.add_argument("--transports", default=",".join(TRANSPORTS),
+                        help="comma-separated transports to test, out of: " +
+                             ", ".join(TRANSPORTS))
+    parser.add_argument("--suite", action="append",
+                        metavar="SIZES_FILE,TYPES_FILE",
+                        help="pair of ucx_perftest batch files with message "
+                             "sizes and test types, may be given several "
+                             "times (default: %s)" %
+                             " ".join("%s,%s" % suite for suite in SUITES))
+    parser.add_argument("--output", help="write results to this JSON file")
+    parser.add_argument("--baseline", help="compare results to this JSON file")
+    parser.add_argument("--tolerance", type=float, default=10.0,
+                        help="allowed degradation from baseline, in percent")
+    parser.add_argument("--cpu", help="CPU list to bind ucx_perftest to")
+    parser.add_argument("-v", "--verbose", action="store_true",
+                        help="print every command and comparison")
+    args = parser.parse_args()
+
+    suites = SUITES
+    if args.suite:
+        suites = [tuple(suite.split(",")) for suite in args.suite]
+        if any(len(suite) != 2 for suite in suites):
+            parser.error("--suite expects SIZES_FILE,TYPES_FILE")
+
+    results = {}
+    failed  = False
+    for tls_name in args.transports.split(","):
+        if tls_name not in TRANSPORTS:
+            parser.error("unknown transport '%s'" % tls_name)
+
+        for msg_sizes, test_types in suites:
+            tls_results = run_perftest(args, tls_name, msg_sizes, test_types)
+            if tls_results is None:
+                failed = True
+                continue
+
+            results.update(tls_results)
+
+    if args.output:
+        with open(args.output, "w") as output_file:
+            json.dump(results, output_file, indent=2, sort_keys=True)
+    elif not args.baseline:
+        json.dump(results, sys.stdout, indent=2, sort_keys=True)
+        print()
+
+    if args.baseline:
+        with open(args.baseline) as baseline_file:
+            baseline = json.load(baseline_file)
+
+        num_compared, regressions = compare(results, baseline,
+                                            args.tolerance, args.verbose)
+        print("%d results compared to baseline, %d regressions" %
+              (num_compared, len(regressions)))
+        failed = failed or bool(regressions)
+
+    sys.exit(1 if failed else 0)
@@ -24,6 +24,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <errno.h>
+#include <inttypes.h>
 
 
 #define INDENT             4
@@ -64,6 +65,7 @@ typedef enum {
 
 typedef struct options {
     const char                   *filename;
+    const char                   *trace_filename;
     int                          raw;
     time_units_t                 time_units;
     int                          thread_list[MAX_THREADS + 1];
@@ -74,9 +76,23 @@ typedef struct {
     const ucs_profile_thread_header_t   *header;
     const ucs_profile_thread_location_t *locations;
     const ucs_profile_record_t          *records;
+    uint64_t                            num_dropped;
 } profile_thread_data_t;
 
 
+/* Thread data collected from the chunks of a streamed profile */
+typedef struct {
+    ucs_profile_thread_header_t         header;
+    ucs_profile_thread_location_t       *locations;
+    ucs_profile_record_t                *records;
+    size_t                              max_records;
+    const ucs_profile_thread_location_t *end_locations;
+    unsigned                            num_end_locations;
+    uint64_t                            num_dropped;
+    int                                 is_ended;
+} profile_stream_thread_t;
+
+
 typedef struct {
     void                         *mem;
     size_t                       length;
@@ -86,6 +102,8 @@ typedef struct {
     char                         *env_variables;
     uint32_t                     num_locations;
     unsigned                     num_threads;
+    ucs_profile_location_t       *stream_locations;
+    profile_stream_thread_t      *stream_threads;
 } profile_data_t;
 
 
@@ -108,6 +126,233 @@ static const char* time_units_str[] = {
     [TIME_UNITS_LAST] = NULL
 };
 
+static profile_stream_thread_t *
+read_profile_stream_find_thread(profile_data_t *data, uint32_t tid)
+{
+    profile_stream_thread_t *thread;
+
+    /* Thread ids may be reused, so look for the latest thread which did not
+     * end yet */
+    for (thread = data->stream_threads + data->num_threads - 1;
+         thread >= data->stream_threads; --thread) {
+        if ((thread->header.tid == tid) && !thread->is_ended) {
+            return thread;
+        }
+    }
+
+    return NULL;
+}
+
+static int read_profile_stream_records(profile_stream_thread_t *thread,
+                                       const ucs_profile_record_t *records,
+                                       size_t num_records)
+{
+    size_t max_records = thread->max_records;
+    ucs_profile_record_t *new_records;
+
+    while ((thread->header.num_records + num_records) > max_records) {
+        max_records = (max_records * 2) + 1024;
+    }
+
+    if (max_records != thread->max_records) {
+        new_records = realloc(thread->records,
+                              max_records * sizeof(*new_records));
+        if (new_records == NULL) {
+            print_error("failed to allocate thread records");
+            return -ENOMEM;
+        }
+
+        thread->records     = new_records;
+        thread->max_records = max_records;
+    }
+
+    memcpy(thread->records + thread->header.num_records, records,
+           num_records * sizeof(*records));
+    thread->header.num_records += num_records;
+    return 0;
+}
+
+static int read_profile_stream_chunk(profile_data_t *data,
+                                     const ucs_profile_stream_chunk_t *chunk)
+{
+    const void *payload = chunk + 1;
+    const ucs_profile_thread_header_t *thread_hdr;
+    ucs_profile_location_t *new_locations;
+    profile_stream_thread_t *new_threads;
+    profile_stream_thread_t *thread;
+    size_t num_locations;
+
+    switch (chunk->type) {
+    case UCS_PROFILE_STREAM_CHUNK_LOCATIONS:
+        num_locations = chunk->size / sizeof(ucs_profile_location_t);
+        new_locations = realloc(data->stream_locations,
+                                (data->num_locations + num_locations) *
+                                sizeof(*new_locations));
+        if (new_locations == NULL) {
+            print_error("failed to allocate locations array");
+            return -ENOMEM;
+        }
+
+        memcpy(new_locations + data->num_locations, payload,
+               num_locations * sizeof(*new_locations));
+        data->stream_locations = new_locations;
+        data->num_locations   += num_locations;
+        return 0;
+    case UCS_PROFILE_STREAM_CHUNK_THREAD_START:
+        if (chunk->size < sizeof(*thread_hdr)) {
+            break;
+        }
+
+        new_threads = realloc(data->stream_threads,
+                              (data->num_threads + 1) * sizeof(*new_threads));
+        if (new_threads == NULL) {
+            print_error("failed to allocate threads array");
+            return -ENOMEM;
+        }
+
+        data->stream_threads = new_threads;
+        thread               = &new_threads[data->num_threads++];
+        memset(thread, 0, sizeof(*thread));
+        thread->header             = *(const ucs_profile_thread_header_t*)payload;
+        thread->header.end_time    = thread->header.start_time;
+        thread->header.num_records = 0;
+        return 0;
+    case UCS_PROFILE_STREAM_CHUNK_RECORDS:
+        thread = read_profile_stream_find_thread(data, chunk->tid);
+        if (thread == NULL) {
+            break;
+        }
+
+        return read_profile_stream_records(thread, payload,
+                                           chunk->size /
+                                           sizeof(ucs_profile_record_t));
+    case UCS_PROFILE_STREAM_CHUNK_DROPPED:
+        thread = read_profile_stream_find_thread(data, chunk->tid);
+        if ((thread == NULL) || (chunk->size < sizeof(uint64_t))) {
+            break;
+        }
+
+        thread->num_dropped += *(const uint64_t*)payload;
+        return 0;
+    case UCS_PROFILE_STREAM_CHUNK_THREAD_END:
+        thread = read_profile_stream_find_thread(data, chunk->tid);
+        if ((thread == NULL) || (chunk->size < sizeof(*thread_hdr))) {
+            break;
+        }
+
+        thread_hdr                = payload;
+        thread->header.end_time   = thread_hdr->end_time;
+        thread->end_locations     = (const void*)(thread_hdr + 1);
+        thread->num_end_locations = (chunk->size - sizeof(*thread_hdr)) /
+                                    sizeof(ucs_profile_thread_location_t);
+        thread->is_ended          = 1;
+        return 0;
+    default:
+        break;
+    }
+
+    print_error("ignoring invalid chunk type %u size %zu of thread %u",
+                chunk->type, (size_t)chunk->size, chunk->tid);
+    return 0;
+}
+
+static int read_profile_stream(profile_data_t *data)
+{
+    const void *end  = UCS_PTR_BYTE_OFFSET(data->mem, data->length);
+    int is_completed = 0;
+    const ucs_profile_stream_chunk_t *chunk;
+    profile_stream_thread_t *thread;
+    unsigned num_locations;
+    const void *ptr;
+    int ret;
+
+    data->num_locations = 0;
+    data->num_threads   = 0;
+
+    /* Chunks follow the environment variables */
+    ptr = UCS_PTR_BYTE_OFFSET(data->mem, data->header->env_vars.offset +
+                                         data->header->env_vars.size);
+    while (UCS_PTR_BYTE_DIFF(ptr, end) >= sizeof(*chunk)) {
+        chunk = ptr;
+        ptr   = chunk + 1;
+        /* coverity[tainted_data] */
+        if (chunk->size > UCS_PTR_BYTE_DIFF(ptr, end)) {
+            break;
+        }
+
+        if (chunk->type == UCS_PROFILE_STREAM_CHUNK_END) {
+            is_completed = 1;
+            break;
+        }
+
+        ret = read_profile_stream_chunk(data, chunk);
+        if (ret < 0) {
+            return ret;
+        }
+
+        ptr = UCS_PTR_BYTE_OFFSET(ptr, chunk->size);
+    }
+
+    if (!is_completed) {
+        fprintf(stderr, "Warning: profile was not completed, showing partial "
+                        "data\n");
+    }
+
+    /* coverity[tainted_data] */
+    data->threads = calloc(data->num_threads, sizeof(*data->threads));
+    if (data->threads == NULL) {
+        print_error("failed to allocate threads array");
+        return -ENOMEM;
+    }
+
+    for (thread = data->stream_threads;
+         thread < data->stream_threads + data->num_threads; ++thread) {
+        thread->locations = calloc(data->num_locations,
+                                   sizeof(*thread->locations));
+        if (thread->locations == NULL) {
+            print_error("failed to allocate thread locations");
+            return -ENOMEM;
+        }
+
+        num_locations = ucs_min(thread->num_end_locations,
+                                data->num_locations);
+        memcpy(thread->locations, thread->end_locations,
+               num_locations * sizeof(*thread->locations));
+
+        if (!thread->is_ended && (thread->header.num_records > 0)) {
+            thread->header.end_time =
+                    thread->records[thread->header.num_records - 1].timestamp;
+        }
+
+        data->threads[thread - data->stream_threads] =
+                (profile_thread_data_t){
+                    .header      = &thread->header,
+                    .locations   = thread->locations,
+                    .records     = thread->records,
+                    .num_dropped = thread->num_dropped
+                };
+    }
+
+    data->locations = data->stream_locations;
+    return 0;
+}
+
+static void release_profile_stream(profile_data_t *data)
+{
+    profile_stream_thread_t *thread;
+
+    if (data->stream_threads != NULL) {
+        for (thread = data->stream_threads;
+             thread < data->stream_threads + data->num_threads; ++thread) {
+            free(thread->records);
+            free(thread->locations);
+        }
+    }
+
+    free(data->stream_threads);
+    free(data->stream_locations);
+}
+
 static int read_profile_data(const char *file_name, profile_data_t *data)
 {
     size_t total_num_records = 0;
@@ -167,6 +412,15 @@ static int read_profile_data(const char *file_name, profile_data_t *data)
            env_vars_size);
     data->env_variables[env_vars_size] = '\0';
 
+    if (data->header->feature_flags & UCS_PROFILE_FEATURE_STREAM) {
+        ret = read_profile_stream(data);
+        if (ret < 0) {
+            goto err_stream;
+        }
+
+        goto out_close;
+    }
+
     data->num_locations = data->header->locations.size /
                           sizeof(ucs_profile_location_t);
     data->locations     = UCS_PTR_BYTE_OFFSET(data->mem,
@@ -205,6 +459,9 @@ out_close:
 out:
     return ret;
 
+err_stream:
+    free(data->threads);
+    release_profile_stream(data);
 err_env_variables:
     free(data->env_variables);
 err_munmap:
@@ -214,6 +471,7 @@ err_munmap:
 
 static void release_profile_data(profile_data_t *data)
 {
+    release_profile_stream(data);
     free(data->threads);
     free(data->env_variables);
     munmap(data->mem, data->length);
@@ -309,6 +567,33 @@ static const char* thread_list_str(const int *thread_list, char *buf, size_t max
     return buf;
 }
 
+static int profile_has_log(const profile_data_t *data)
+{
+    return data->header->mode & (UCS_BIT(UCS_PROFILE_MODE_LOG) |
+                                 UCS_BIT(UCS_PROFILE_MODE_STREAM));
+}
+
+/* Return the location of a record, or NULL if the record is corrupted */
+static const ucs_profile_location_t *
+record_location(const profile_data_t *data, const ucs_profile_record_t *rec)
+{
+    if (rec->location >= data->num_locations) {
+        return NULL;
+    }
+
+    return &data->locations[rec->location];
+}
+
+static void show_invalid_records(const profile_data_t *data, int thread_idx,
+                                 size_t num_invalid)
+{
+    if (num_invalid > 0) {
+        fprintf(stderr, "Warning: thread %d: skipped %zu records with invalid "
+                        "location (max: %u)\n", thread_idx + 1, num_invalid,
+                data->num_locations);
+    }
+}
+
 static double time_to_units(profile_data_t *data, options_t *opts, uint64_t time)
 {
     static const double time_units_val[] = {
@@ -483,6 +768,7 @@ static void show_profile_data_log(profile_data_t *data, options_t *opts,
     khash_t(request_ids) reqids;
     int hash_extra_status;
     khiter_t hash_it;
+    size_t num_invalid;
     size_t reqid;
 
 #define RECORD_FMT       "%s%10.3f%s%*s"
@@ -504,10 +790,14 @@ static void show_profile_data_log(profile_data_t *data, options_t *opts,
     }
 
     printf("\n");
-    printf("%sThread %d (tid %d%s)%s\n", HEAD_COLOR, thread_idx + 1,
+    printf("%sThread %d (tid %d%s)%s", HEAD_COLOR, thread_idx + 1,
            thread->header->tid,
            (thread->header->tid == data->header->pid) ? ", main" : "",
            CLEAR_COLOR);
+    if (thread->num_dropped > 0) {
+        printf(" %" PRIu64 " records were dropped", thread->num_dropped);
+    }
+    printf("\n");
     printf("\n");
 
     memset(stack, 0, sizeof(stack));
@@ -515,8 +805,14 @@ static void show_profile_data_log(profile_data_t *data, options_t *opts,
     /* Find the first record with minimal nesting level, which is the base of call stack */
     nesting         = 0;
     min_nesting     = 0;
+    num_invalid     = 0;
     for (rec = thread->records; rec < thread->records + num_records; ++rec) {
-        loc = &data->locations[rec->location];
+        loc = record_location(data, rec);
+        if (loc == NULL) {
+            ++num_invalid;
+            continue;
+        }
+
         switch (loc->type) {
         case UCS_PROFILE_TYPE_SCOPE_BEGIN:
             stack[nesting + UCS_PROFILE_STACK_MAX] = &scope_ends[rec - thread->records];
@@ -545,10 +841,16 @@ static void show_profile_data_log(profile_data_t *data, options_t *opts,
 
     kh_init_inplace(request_ids, &reqids);
 
+    show_invalid_records(data, thread_idx, num_invalid);
+
     /* Display records */
     nesting = -min_nesting;
     for (rec = thread->records; rec < thread->records + num_records; ++rec) {
-        loc = &data->locations[rec->location];
+        loc = record_location(data, rec);
+        if (loc == NULL) {
+            continue;
+        }
+
         switch (loc->type) {
         case UCS_PROFILE_TYPE_SCOPE_BEGIN:
             se = scope_ends[rec - thread->records];
@@ -660,7 +962,7 @@ static int redirect_output(const profile_data_t *data, options_t *opts)
                      1; /* locations footer */
     }
 
-    if (data->header->mode & UCS_BIT(UCS_PROFILE_MODE_LOG)) {
+    if (profile_has_log(data)) {
         for (t = opts->thread_list; *t != -1; ++t) {
             num_lines += 3; /* thread header */
             /* Suppressing a false positive for null value dereference */
@@ -756,10 +1058,9 @@ static int compare_int(const void *a, const void *b)
     return *(const int*)a - *(const int*)b;
 }
 
-static int show_profile_data(profile_data_t *data, options_t *opts)
+static int check_thread_list(profile_data_t *data, options_t *opts)
 {
     unsigned i, thread_list_len;
-    int ret;
     int *t;
 
     if (data->num_threads > MAX_THREADS) {
@@ -798,6 +1099,19 @@ static int show_profile_data(profile_data_t *data, options_t *opts)
         }
     }
 
+    return 0;
+}
+
+static int show_profile_data(profile_data_t *data, options_t *opts)
+{
+    int ret;
+    int *t;
+
+    ret = check_thread_list(data, opts);
+    if (ret < 0) {
+        return ret;
+    }
+
     /* redirect output if needed */
     if (!opts->raw) {
         ret = redirect_output(data, opts);
@@ -813,7 +1127,7 @@ static int show_profile_data(profile_data_t *data, options_t *opts)
         printf("\n");
     }
 
-    if (data->header->mode & UCS_BIT(UCS_PROFILE_MODE_LOG)) {
+    if (profile_has_log(data)) {
         for (t = opts->thread_list; *t != -1; ++t) {
             show_profile_data_log(data, opts, *t - 1);
         }
@@ -823,11 +1137,187 @@ static int show_profile_data(profile_data_t *data, options_t *opts)
     return 0;
 }
 
+static void trace_print_string(FILE *stream, const char *str)
+{
+    fputc('"', stream);
+    for (; *str != '\0'; ++str) {
+        if ((*str == '"') || (*str == '\\')) {
+            fprintf(stream, "\\%c", *str);
+        } else if ((unsigned char)*str < 0x20) {
+            fprintf(stream, "\\u%04x", *str);
+        } else {
+            fputc(*str, stream);
+        }
+    }
+    fputc('"', stream);
+}
+
+static void trace_print_event(FILE *stream, profile_data_t *data,
+                              const profile_thread_data_t *thread,
+                              const char *name, const char *phase,
+                              double ts, int *is_first)
+{
+    fprintf(stream, "%s\n{\"pid\":%u,\"tid\":%u,\"ph\":\"%s\",\"ts\":%.3f,"
+            "\"name\":", *is_first ? "" : ",", data->header->pid,
+            thread->header->tid, phase, ts);
+    trace_print_string(stream, name);
+    *is_first = 0;
+}
+
+static void trace_print_location(FILE *stream,
+                                 const ucs_profile_location_t *loc)
+{
+    fprintf(stream, ",\"args\":{\"file\":");
+    trace_print_string(stream, ucs_basename(loc->file));
+    fprintf(stream, ",\"line\":%d,\"function\":", loc->line);
+    trace_print_string(stream, loc->function);
+    fprintf(stream, "}}");
+}
+
+static void export_thread_trace(FILE *stream, profile_data_t *data,
+                                int thread_idx, uint64_t base_time,
+                                int *is_first)
+{
+    const profile_thread_data_t *thread = &data->threads[thread_idx];
+    size_t num_records                  = thread->header->num_records;
+    const ucs_profile_record_t *stack[UCS_PROFILE_STACK_MAX];
+    const ucs_profile_record_t *rec, *begin;
+    const ucs_profile_location_t *loc;
+    size_t num_invalid;
+    const char *phase;
+    char name[64];
+    int nesting;
+
+#define TRACE_TIME(_ts) \
+    (((double)(_ts) - (double)base_time) * 1e6 / data->header->one_second)
+
+    snprintf(name, sizeof(name), "thread_name");
+    trace_print_event(stream, data, thread, name, "M", 0, is_first);
+    snprintf(name, sizeof(name), "Thread %d%s", thread_idx + 1,
+             (thread->header->tid == data->header->pid) ? " (main)" : "");
+    fprintf(stream, ",\"args\":{\"name\":");
+    trace_print_string(stream, name);
+    fprintf(stream, "}}");
+
+    nesting     = 0;
+    num_invalid = 0;
+    for (rec = thread->records; rec < thread->records + num_records; ++rec) {
+        loc = record_location(data, rec);
+        if (loc == NULL) {
+            ++num_invalid;
+            continue;
+        }
+
+        switch (loc->type) {
+        case UCS_PROFILE_TYPE_SCOPE_BEGIN:
+            if (nesting < UCS_PROFILE_STACK_MAX) {
+                stack[nesting] = rec;
+            }
+            ++nesting;
+            break;
+        case UCS_PROFILE_TYPE_SCOPE_END:
+            /* The scope name is defined by its end location */
+            if (nesting == 0) {
+                break; /* Scope began before the first record */
+            }
+
+            --nesting;
+            if (nesting >= UCS_PROFILE_STACK_MAX) {
+                break;
+            }
+
+            begin = stack[nesting];
+            trace_print_event(stream, data, thread, loc->name, "X",
+                              TRACE_TIME(begin->timestamp), is_first);
+            fprintf(stream, ",\"dur\":%.3f",
+                    TRACE_TIME(rec->timestamp) - TRACE_TIME(begin->timestamp));
+            trace_print_location(stream, loc);
+            break;
+        case UCS_PROFILE_TYPE_SAMPLE:
+            trace_print_event(stream, data, thread, loc->name, "i",
+                              TRACE_TIME(rec->timestamp), is_first);
+            fprintf(stream, ",\"s\":\"t\"");
+            trace_print_location(stream, loc);
+            break;
+        case UCS_PROFILE_TYPE_REQUEST_NEW:
+        case UCS_PROFILE_TYPE_REQUEST_EVENT:
+        case UCS_PROFILE_TYPE_REQUEST_FREE:
+            /* Request lifetime is shown as an asynchronous event */
+            phase = (loc->type == UCS_PROFILE_TYPE_REQUEST_NEW)  ? "b" :
+                    (loc->type == UCS_PROFILE_TYPE_REQUEST_FREE) ? "e" :
+                    "n";
+            trace_print_event(stream, data, thread,
+                              (loc->type == UCS_PROFILE_TYPE_REQUEST_EVENT) ?
+                              loc->name : "request",
+                              phase, TRACE_TIME(rec->timestamp), is_first);
+            fprintf(stream, ",\"cat\":\"request\",\"id\":\"0x%" PRIx64 "\"",
+                    rec->param64);
+            trace_print_location(stream, loc);
+            break;
+        default:
+            break;
+        }
+    }
+
+    show_invalid_records(data, thread_idx, num_invalid);
+
+#undef TRACE_TIME
+}
+
+/*
+ * Export the records in Chrome trace event format, which can be loaded by
+ * chrome://tracing or https://ui.perfetto.dev
+ */
+static int export_profile_trace(profile_data_t *data, options_t *opts)
+{
+    uint64_t base_time = UINT64_MAX;
+    int is_first       = 1;
+    FILE *stream;
+    int ret;
+    int *t;
+
+    if (!profile_has_log(data)) {
+        print_error("the profile does not contain records");
+        return -EINVAL;
+    }
+
+    ret = check_thread_list(data, opts);
+    if (ret < 0) {
+        return ret;
+    }
+
+    stream = fopen(opts->trace_filename, "w");
+    if (stream == NULL) {
+        print_error("failed to open %s: %m", opts->trace_filename);
+        return -errno;
+    }
+
+    for (t = opts->thread_list; *t != -1; ++t) {
+        base_time = ucs_min(base_time, data->threads[*t - 1].header->start_time);
+    }
+
+    fprintf(stream, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for (t = opts->thread_list; *t != -1; ++t) {
+        export_thread_trace(stream, data, *t - 1, base_time, &is_first);
+    }
+    fprintf(stream, "\n]}\n");
+
+    if (fclose(stream) != 0) {
+        print_error("failed to write %s: %m", opts->trace_filename);
+        return -errno;
+    }
+
+    return 0;
+}
+
 static void usage()
 {
     printf("Usage: ucx_read_profile [options] [profile-file]\n");
     printf("Options are:\n");
     printf("  -r              Show raw output\n");
+    printf("  -j <file>       Export the records to a JSON file in Chrome "
+           "trace format,\n"
+           "                  which can be loaded by Perfetto UI\n");
     printf("  -T <threads>    Comma-separated list of threads to show, "
            "e.g. \"1,2,3\", or \"all\" to show all threads\n");
     printf("  -t <units>      Select time units to use:\n");
@@ -842,18 +1332,22 @@ static int parse_args(int argc, char **argv, options_t *opts)
 {
     int ret, c;
 
-    opts->raw         = !isatty(fileno(stdout));
-    opts->time_units  = TIME_UNITS_USEC;
+    opts->raw            = !isatty(fileno(stdout));
+    opts->time_units     = TIME_UNITS_USEC;
+    opts->trace_filename = NULL;
     ret = parse_thread_list(opts->thread_list, "all");
     if (ret < 0) {
         return ret;
     }
 
-    while ( (c = getopt(argc, argv, "rT:t:h")) != -1 ) {
+    while ( (c = getopt(argc, argv, "rj:T:t:h")) != -1 ) {
         switch (c) {
         case 'r':
             opts->raw = 1;
             break;
+        case 'j':
+            opts->trace_filename = optarg;
+            break;
         case 'T':
             ret = parse_thread_list(opts->thread_list, optarg);
             if (ret < 0) {
@@ -911,7 +1405,11 @@ int main(int argc, char **argv)
         return ret;
     }
 
-    ret = show_profile_data(&data, &opts);
+    if (opts.trace_filename != NULL) {
+        ret = export_profile_trace(&data, &opts);
+    } else {
+        ret = show_profile_data(&data, &opts);
+    }
     release_profile_data(&data);
     return ret;
 }
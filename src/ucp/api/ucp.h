@@ -223,10 +223,35 @@ enum ucp_listener_params_field {
 
     /**< User's callback and argument for handling the incoming connection
      *   request. */
-    UCP_LISTENER_PARAM_FIELD_CONN_HANDLER        = UCS_BIT(2)
+    UCP_LISTENER_PARAM_FIELD_CONN_HANDLER        = UCS_BIT(2),
+
+    /**
+     * Listener flags.
+     */
+    UCP_LISTENER_PARAM_FIELD_FLAGS               = UCS_BIT(3)
 };
 
 
+/**
+ * @ingroup UCP_WORKER
+ * @brief UCP listener flags.
+ *
+ * The enumeration list describes the flags passed in
+ * @ref ucp_listener_params_t::flags.
+ */
+typedef enum {
+    /**
+     * Allow several listeners to listen on the same address, if all of them
+     * are created with this flag. Typically each listener is created on a
+     * different worker, and the operating system distributes the incoming
+     * connection requests between them, so each endpoint is accepted and
+     * progressed by the worker whose listener received the request. Only
+     * the transports which support it, such as TCP, are used by the listener.
+     */
+    UCP_LISTENER_FLAG_REUSE_PORT = UCS_BIT(0)
+} ucp_listener_flags_t;
+
+
 /**
  * @ingroup UCP_WORKER
  * @brief UCP worker address flags.
@@ -610,7 +635,18 @@ enum ucp_am_cb_flags {
      * so the data will be accessible outside the callback, until
      * @ref ucp_am_data_release is called.
      */
-    UCP_AM_FLAG_PERSISTENT_DATA = UCS_BIT(1)
+    UCP_AM_FLAG_PERSISTENT_DATA = UCS_BIT(1),
+
+    /**
+     * Receive rendezvous messages into buffers taken from the worker receive
+     * pool, which is created by @ref ucp_worker_am_recv_pool_create. The
+     * callback is invoked once the whole message has arrived, with
+     * @ref UCP_AM_RECV_ATTR_FLAG_DATA flag set, so the data buffer can be kept
+     * by returning UCS_INPROGRESS and released by @ref ucp_am_data_release.
+     * If no pool buffer can hold the message, the callback is invoked with
+     * @ref UCP_AM_RECV_ATTR_FLAG_RNDV flag as usual.
+     */
+    UCP_AM_FLAG_RECV_POOL       = UCS_BIT(2)
 };
 
 
@@ -719,6 +755,7 @@ typedef enum {
     UCP_OP_ATTR_FIELD_MEMORY_TYPE   = UCS_BIT(6),  /**< memory type field */
     UCP_OP_ATTR_FIELD_RECV_INFO     = UCS_BIT(7),  /**< recv_info field */
     UCP_OP_ATTR_FIELD_MEMH          = UCS_BIT(8),  /**< memory handle field */
+    UCP_OP_ATTR_FIELD_COUNTER       = UCS_BIT(9),  /**< counter field */
 
     UCP_OP_ATTR_FLAG_NO_IMM_CMPL    = UCS_BIT(16), /**< Deny immediate completion,
                                                         i.e NULL cannot be returned.
@@ -1565,6 +1602,14 @@ typedef struct ucp_listener_params {
      *       communications.
      */
     ucp_listener_conn_handler_t         conn_handler;
+
+    /**
+     * Listener flags, using bits from @ref ucp_listener_flags_t.
+     * This value is optional. If it's not set (along with its corresponding
+     * bit in the field_mask - @ref UCP_LISTENER_PARAM_FIELD_FLAGS), no flags
+     * are used.
+     */
+    uint64_t                            flags;
 } ucp_listener_params_t;
 
 
@@ -1825,9 +1870,36 @@ typedef struct {
      */
     ucp_mem_h memh;
 
+    /**
+     * Completion counter, which is incremented when the operation completes,
+     * instead of returning a request handle. It is supported only by
+     * @ref ucp_put_nbx and @ref ucp_get_nbx, and can't be combined with
+     * @ref UCP_OP_ATTR_FIELD_REQUEST, @ref UCP_OP_ATTR_FIELD_CALLBACK and
+     * @ref UCP_OP_ATTR_FLAG_NO_IMM_CMPL. See @ref ucp_counter_create.
+     */
+    ucp_counter_h counter;
+
 } ucp_request_param_t;
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Element of a put batch.
+ *
+ * This structure describes a single put operation posted by
+ * @ref ucp_put_batch_nbx.
+ */
+typedef struct ucp_put_batch_elem {
+    ucp_ep_h         ep;          /**< Destination endpoint handle */
+    const void       *buffer;     /**< Pointer to the local source buffer */
+    size_t           length;      /**< Length of the data in bytes */
+    uint64_t         remote_addr; /**< Pointer to the destination remote
+                                       memory address */
+    ucp_rkey_h       rkey;        /**< Remote memory key associated with the
+                                       remote memory address */
+} ucp_put_batch_elem_t;
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Attributes of a particular request.
@@ -1904,6 +1976,65 @@ typedef struct ucp_am_handler_param {
 } ucp_am_handler_param_t;
 
 
+/**
+ * @ingroup UCP_WORKER
+ * @brief UCP Active Message receive pool parameters field mask.
+ *
+ * The enumeration allows specifying which fields in
+ * @ref ucp_am_recv_pool_params_t are present. It is used to enable backward
+ * compatibility support.
+ */
+enum ucp_am_recv_pool_params_field {
+    /**
+     * Indicates that @ref ucp_am_recv_pool_params_t.sizes and
+     * @ref ucp_am_recv_pool_params_t.num_sizes fields are valid.
+     */
+    UCP_AM_RECV_POOL_PARAM_FIELD_SIZES       = UCS_BIT(0),
+
+    /**
+     * Indicates that @ref ucp_am_recv_pool_params_t.max_buffers field is
+     * valid.
+     */
+    UCP_AM_RECV_POOL_PARAM_FIELD_MAX_BUFFERS = UCS_BIT(1)
+};
+
+
+/**
+ * @ingroup UCP_WORKER
+ * @brief Active Message receive pool parameters passed to
+ *        @ref ucp_worker_am_recv_pool_create routine.
+ */
+typedef struct ucp_am_recv_pool_params {
+    /**
+     * Mask of valid fields in this structure, using bits from
+     * @ref ucp_am_recv_pool_params_field. Fields not specified in this mask
+     * will be ignored. Provides ABI compatibility with respect to adding new
+     * fields.
+     */
+    uint64_t                 field_mask;
+
+    /**
+     * Array of buffer sizes, one for each size class of the pool. A message
+     * is received into the smallest buffer which can hold its data and user
+     * header. This field is mandatory.
+     */
+    const size_t             *sizes;
+
+    /**
+     * Number of elements in @ref sizes array.
+     */
+    unsigned                 num_sizes;
+
+    /**
+     * Maximal number of buffers in each size class. When all buffers of the
+     * matching size classes are in use, messages are reported to the callback
+     * as rendezvous messages. If not specified, the number of buffers is not
+     * limited.
+     */
+    unsigned                 max_buffers;
+} ucp_am_recv_pool_params_t;
+
+
 /**
  * @ingroup UCP_WORKER
  * @brief Operation parameters provided in @ref ucp_am_recv_callback_t callback.
@@ -3213,6 +3344,28 @@ ucs_status_t ucp_worker_set_am_recv_handler(ucp_worker_h worker,
                                             const ucp_am_handler_param_t *param);
 
 
+/**
+ * @ingroup UCP_WORKER
+ * @brief Create a pool of receive buffers for Active Messages.
+ *
+ * This routine creates a pool of receive buffers, which are allocated and
+ * registered with all memory domains of the worker in advance. Rendezvous
+ * Active Messages for handlers set with @ref UCP_AM_FLAG_RECV_POOL flag are
+ * received into these buffers, so the receive path does not allocate or
+ * register memory.
+ *
+ * @param [in]  worker      UCP worker to create the pool on.
+ * @param [in]  params      Pool parameters, as defined by
+ *                          @ref ucp_am_recv_pool_params_t.
+ *
+ * @return UCS_ERR_ALREADY_EXISTS - The pool was already created on the worker.
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t
+ucp_worker_am_recv_pool_create(ucp_worker_h worker,
+                               const ucp_am_recv_pool_params_t *params);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Send Active Message.
@@ -3442,6 +3595,46 @@ ucs_status_ptr_t ucp_tag_send_sync_nbx(ucp_ep_h ep, const void *buffer,
                                        const ucp_request_param_t *param);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Create a persistent tagged-send request.
+ *
+ * This routine creates a request which describes a tagged-send operation with
+ * the same arguments as @ref ucp_tag_send_nbx, without starting it. The
+ * operation is started by @ref ucp_request_start, and can be started again
+ * every time the previous start has completed. The protocol selection,
+ * memory type detection and parameter validation are performed once, when the
+ * request is created, and are reused by all subsequent starts, as long as the
+ * endpoint configuration does not change. A buffer registration done by the
+ * selected protocol is also kept by the request until it is released.
+ *
+ * The request is created in completed state. If a completion callback is
+ * passed in @a param, it is called for every start which did not complete
+ * immediately. The request must be released by @ref ucp_request_free.
+ *
+ * @note Only contiguous datatypes are supported, and the request must be
+ *       allocated by UCP, so @ref UCP_OP_ATTR_FIELD_REQUEST is not allowed.
+ * @note The user should not modify the @a buffer while an operation started
+ *       on this request is in progress, and should not release it before the
+ *       request is released.
+ *
+ * @param [in]  ep          Destination endpoint handle.
+ * @param [in]  buffer      Pointer to the message buffer (payload).
+ * @param [in]  count       Number of elements to send.
+ * @param [in]  tag         Message tag.
+ * @param [in]  param       Operation parameters, see @ref ucp_request_param_t.
+ *
+ * @return UCS_PTR_IS_ERR(_ptr) - The request could not be created.
+ *                                @ref UCS_ERR_UNSUPPORTED is returned if the
+ *                                datatype is not contiguous, or the protocols
+ *                                v2 are disabled.
+ * @return otherwise            - Persistent request handle.
+ */
+ucs_status_ptr_t ucp_tag_send_init_nbx(ucp_ep_h ep, const void *buffer,
+                                       size_t count, ucp_tag_t tag,
+                                       const ucp_request_param_t *param);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Non-blocking stream receive operation of structured data into a
@@ -3517,6 +3710,92 @@ ucs_status_ptr_t ucp_stream_recv_nbx(ucp_ep_h ep, void *buffer, size_t count,
 ucs_status_ptr_t ucp_stream_recv_data_nb(ucp_ep_h ep, size_t *length);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Attach a user-provided receive ring to a stream endpoint.
+ *
+ * This routine registers the buffer described by @a buffer and @a length as a
+ * receive ring of the endpoint @a ep. Incoming stream data is written directly
+ * to the ring in arrival order, without creating receive descriptors or
+ * matching receive requests. The application consumes the data with
+ * @ref ucp_stream_recv_ring_peek and @ref ucp_stream_recv_ring_consume.
+ * Data which does not fit into the ring is held by UCP and is moved to the
+ * ring when the application consumes data from it. Stream data which was
+ * received before the ring was attached is moved to the ring as well.
+ *
+ * While the ring is attached, @ref ucp_stream_recv_nbx and
+ * @ref ucp_stream_recv_data_nb can not be used on @a ep. The endpoint is
+ * reported by @ref ucp_stream_worker_poll when new data arrives to the ring.
+ *
+ * @param [in]  ep        Endpoint to attach the receive ring to.
+ * @param [in]  buffer    Ring buffer, which must remain valid until the ring
+ *                        is detached or the endpoint is closed.
+ * @param [in]  length    Size of the ring buffer in bytes.
+ *
+ * @return UCS_OK             - The ring is attached.
+ * @return UCS_ERR_BUSY       - A ring is already attached, or stream receive
+ *                              requests are outstanding on @a ep.
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t ucp_stream_recv_ring_attach(ucp_ep_h ep, void *buffer,
+                                         size_t length);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Detach the receive ring from a stream endpoint.
+ *
+ * This routine detaches the receive ring which was attached by
+ * @ref ucp_stream_recv_ring_attach. After the ring is detached, stream data is
+ * received by @ref ucp_stream_recv_nbx and @ref ucp_stream_recv_data_nb.
+ *
+ * @param [in]  ep        Endpoint to detach the receive ring from.
+ *
+ * @return UCS_OK             - The ring is detached.
+ * @return UCS_ERR_BUSY       - The ring still holds data which was not
+ *                              consumed by the application.
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t ucp_stream_recv_ring_detach(ucp_ep_h ep);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Get the received data at the read cursor of the receive ring.
+ *
+ * This routine returns the longest contiguous block of received data that
+ * starts at the read cursor of the ring. The data remains in the ring until it
+ * is consumed by @ref ucp_stream_recv_ring_consume. When the received data
+ * wraps around the end of the ring, the rest of it is returned by the next call
+ * after the returned block is consumed.
+ *
+ * @param [in]  ep        Endpoint with an attached receive ring.
+ * @param [out] data_p    Filled with the address of the data in the ring.
+ * @param [out] length_p  Filled with the length of the data, or 0 if no data
+ *                        is available.
+ *
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t ucp_stream_recv_ring_peek(ucp_ep_h ep, void **data_p,
+                                       size_t *length_p);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Advance the read cursor of the receive ring.
+ *
+ * This routine releases @a length bytes at the read cursor of the ring, so
+ * the space can be reused for incoming data.
+ *
+ * @param [in]  ep        Endpoint with an attached receive ring.
+ * @param [in]  length    Number of bytes to consume, which may not exceed the
+ *                        amount of received data in the ring.
+ *
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t ucp_stream_recv_ring_consume(ucp_ep_h ep, size_t length);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Non-blocking tagged-receive operation.
@@ -3559,6 +3838,42 @@ ucs_status_ptr_t ucp_tag_recv_nbx(ucp_worker_h worker, void *buffer, size_t coun
                                   const ucp_request_param_t *param);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Create a persistent tagged-receive request.
+ *
+ * This routine creates a request which describes a tagged-receive operation
+ * with the same arguments as @ref ucp_tag_recv_nbx, without posting it. The
+ * receive is posted by @ref ucp_request_start, and can be posted again every
+ * time the previous one has completed. The buffer memory type is detected
+ * once, when the request is created. The information about the last received
+ * message can be obtained by @ref ucp_tag_recv_request_test.
+ *
+ * The request is created in completed state. If a completion callback is
+ * passed in @a param, it is called for every start which did not complete
+ * immediately. The request must be released by @ref ucp_request_free.
+ *
+ * @note Only contiguous datatypes are supported, and the request must be
+ *       allocated by UCP, so @ref UCP_OP_ATTR_FIELD_REQUEST is not allowed.
+ *
+ * @param [in]  worker      UCP worker that is used for the receive operation.
+ * @param [in]  buffer      Pointer to the buffer to receive the data.
+ * @param [in]  count       Number of elements to receive.
+ * @param [in]  tag         Message tag to expect.
+ * @param [in]  tag_mask    Bit mask that indicates the bits that are used for
+ *                          the matching of the incoming tag against the
+ *                          expected tag.
+ * @param [in]  param       Operation parameters, see @ref ucp_request_param_t.
+ *
+ * @return UCS_PTR_IS_ERR(_ptr) - The request could not be created.
+ * @return otherwise            - Persistent request handle.
+ */
+ucs_status_ptr_t ucp_tag_recv_init_nbx(ucp_worker_h worker, void *buffer,
+                                       size_t count, ucp_tag_t tag,
+                                       ucp_tag_t tag_mask,
+                                       const ucp_request_param_t *param);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Non-blocking probe and return a message.
@@ -3697,6 +4012,41 @@ ucs_status_ptr_t ucp_put_nbx(ucp_ep_h ep, const void *buffer, size_t count,
                              const ucp_request_param_t *param);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Non-blocking batch of remote memory put operations.
+ *
+ * This routine posts a batch of put operations, which may target different
+ * endpoints of the same @a worker, and tracks them with a single request.
+ * It is equivalent to calling @ref ucp_put_nbx for every element, but the
+ * worker lock is taken and the operation parameters are parsed only once
+ * for the whole batch. The completion callback in @a param is called once,
+ * after all the elements are completed locally.
+ *
+ * The elements are posted in order. If posting an element fails, the
+ * remaining elements are not posted, and the batch completes with the
+ * error status once the elements which were already posted are completed.
+ *
+ * @param [in]  worker  Worker of all the endpoints in the batch.
+ * @param [in]  elems   Array of operations to post.
+ * @param [in]  count   Number of elements in @a elems.
+ * @param [in]  param   Operation parameters, see @ref ucp_request_param_t.
+ *
+ * @return NULL                 - All operations were completed immediately.
+ * @return UCS_PTR_IS_ERR(_ptr) - The batch failed, and no operations are
+ *                                in progress.
+ * @return otherwise            - Operation handle of the whole batch.
+ *
+ * @note Only contiguous buffers are supported, so @a param->datatype and
+ *       @a param->memh must not be set. @ref UCP_OP_ATTR_FLAG_FORCE_IMM_CMPL
+ *       is not supported.
+ */
+ucs_status_ptr_t ucp_put_batch_nbx(ucp_worker_h worker,
+                                   const ucp_put_batch_elem_t *elems,
+                                   size_t count,
+                                   const ucp_request_param_t *param);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Non-blocking remote memory get operation.
@@ -3754,6 +4104,68 @@ ucs_status_ptr_t ucp_get_nbx(ucp_ep_h ep, void *buffer, size_t count,
                              const ucp_request_param_t *param);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Create a completion counter.
+ *
+ * This routine creates a completion counter, which can be passed to RMA
+ * operations with @ref UCP_OP_ATTR_FIELD_COUNTER. Such an operation does not
+ * return a request handle: it returns UCS_OK when it was posted successfully,
+ * and the counter is incremented when it completes, either immediately or
+ * later during @ref ucp_worker_progress. An operation which returns an error
+ * is not counted. The counter value starts at 0.
+ *
+ * @param [in]  worker      Worker which progresses the counted operations.
+ * @param [out] counter_p   Filled with the new counter handle.
+ *
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t ucp_counter_create(ucp_worker_h worker, ucp_counter_h *counter_p);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Destroy a completion counter.
+ *
+ * @param [in]  counter     Counter to destroy. There must be no outstanding
+ *                          operations which use it.
+ */
+void ucp_counter_destroy(ucp_counter_h counter);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Read the value of a completion counter.
+ *
+ * This routine returns the number of operations which were completed since
+ * the counter was created. It does not progress the worker.
+ *
+ * @param [in]  counter     Counter to read.
+ * @param [out] status_p    If not NULL, filled with the status of the first
+ *                          counted operation which completed with an error,
+ *                          or UCS_OK if all of them completed successfully.
+ *
+ * @return Number of completed operations.
+ */
+uint64_t ucp_counter_read(ucp_counter_h counter, ucs_status_t *status_p);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Wait until a completion counter reaches a value.
+ *
+ * This routine progresses the counter worker until at least @a value
+ * operations are completed.
+ *
+ * @param [in]  counter     Counter to wait on.
+ * @param [in]  value       Number of completed operations to wait for.
+ *
+ * @return UCS_OK if all the counted operations completed successfully,
+ *         otherwise the status of the first operation which failed.
+ */
+ucs_status_t ucp_counter_wait(ucp_counter_h counter, uint64_t value);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Post an atomic memory operation.
@@ -3902,6 +4314,40 @@ ucs_status_t ucp_stream_recv_request_test(void *request, size_t *length_p);
 void ucp_request_cancel(ucp_worker_h worker, void *request);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Start a persistent communications request.
+ *
+ * @param [in]  request      Persistent request created by
+ *                           @ref ucp_tag_send_init_nbx or
+ *                           @ref ucp_tag_recv_init_nbx.
+ *
+ * This routine starts the operation described by a persistent request. The
+ * request must be completed, either because it was just created or because
+ * the operation started by the previous call has completed. The progress of
+ * the operation can be checked by @ref ucp_request_check_status, and it can be
+ * canceled by @ref ucp_request_cancel.
+ *
+ * The @ref UCP_OP_ATTR_FLAG_NO_IMM_CMPL and @ref UCP_OP_ATTR_FLAG_FORCE_IMM_CMPL
+ * flags which were passed when the request was created apply to every start.
+ *
+ * @return UCS_OK              - The operation was completed immediately, and
+ *                               the completion callback will not be called.
+ * @return UCS_INPROGRESS      - The operation was started and will be
+ *                               completed later, or it was completed
+ *                               immediately and its completion callback was
+ *                               already called, because
+ *                               @ref UCP_OP_ATTR_FLAG_NO_IMM_CMPL was set.
+ * @return UCS_ERR_NO_RESOURCE - @ref UCP_OP_ATTR_FLAG_FORCE_IMM_CMPL was set,
+ *                               and the operation could not be completed
+ *                               immediately.
+ * @return UCS_ERR_BUSY        - The operation started by the previous call is
+ *                               still in progress.
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t ucp_request_start(void *request);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Release UCP data buffer returned by @ref ucp_stream_recv_data_nb.
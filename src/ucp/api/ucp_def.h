@@ -167,6 +167,18 @@ typedef struct ucp_rkey                  *ucp_rkey_h;
 typedef struct ucp_mem                   *ucp_mem_h;
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief UCP completion counter
+ *
+ * Completion counter is an opaque object which counts the completed
+ * operations that were posted with it, see @ref UCP_OP_ATTR_FIELD_COUNTER.
+ * It allows tracking many operations without allocating or releasing a
+ * request handle for each one of them.
+ */
+typedef struct ucp_counter               *ucp_counter_h;
+
+
 /**
  * @ingroup UCP_WORKER
  * @brief UCP listen handle.
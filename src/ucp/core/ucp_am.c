@@ -21,8 +21,41 @@
 #include <ucp/proto/proto_common.inl>
 #include <ucp/dt/dt.h>
 #include <ucp/dt/dt.inl>
+#include <ucs/datastruct/mpool.inl>
 
 
+/**
+ * AM receive pool buffer. The message data follows the structure, and the user
+ * header is stored after the data.
+ */
+typedef struct {
+    ucp_mem_desc_t           super;       /* Registration of the buffer */
+    uint64_t                 ep_id;       /* ep which can be used for reply */
+    ucp_am_hdr_t             am;          /* AM id, flags and header length */
+    ucp_recv_desc_t          rdesc;       /* Descriptor passed to the user */
+} ucp_am_recv_pool_elem_t;
+
+
+static ucs_status_t
+ucp_am_recv_pool_chunk_alloc(ucs_mpool_t *mp, size_t *size_p, void **chunk_p)
+{
+    return ucp_mpool_malloc(*(ucp_worker_h*)ucs_mpool_priv(mp), mp, size_p,
+                            chunk_p);
+}
+
+static void ucp_am_recv_pool_chunk_release(ucs_mpool_t *mp, void *chunk)
+{
+    ucp_mpool_free(*(ucp_worker_h*)ucs_mpool_priv(mp), mp, chunk);
+}
+
+static ucs_mpool_ops_t ucp_am_recv_pool_mpool_ops = {
+    .chunk_alloc   = ucp_am_recv_pool_chunk_alloc,
+    .chunk_release = ucp_am_recv_pool_chunk_release,
+    .obj_init      = ucp_mpool_obj_init,
+    .obj_cleanup   = ucs_empty_function,
+    .obj_str       = NULL
+};
+
 ucs_status_t ucp_am_init(ucp_worker_h worker)
 {
     if (!(worker->context->config.features & UCP_FEATURE_AM)) {
@@ -30,18 +63,122 @@ ucs_status_t ucp_am_init(ucp_worker_h worker)
     }
 
     ucs_array_init_dynamic(&worker->am.cbs);
+    worker->am.recv_pools     = NULL;
+    worker->am.num_recv_pools = 0;
     return UCS_OK;
 }
 
+static void ucp_am_recv_pools_cleanup(ucp_worker_h worker, unsigned count)
+{
+    unsigned i;
+
+    for (i = 0; i < count; ++i) {
+        ucs_mpool_cleanup(&worker->am.recv_pools[i].mp, 1);
+    }
+
+    ucs_free(worker->am.recv_pools);
+    worker->am.recv_pools     = NULL;
+    worker->am.num_recv_pools = 0;
+}
+
 void ucp_am_cleanup(ucp_worker_h worker)
 {
     if (!(worker->context->config.features & UCP_FEATURE_AM)) {
         return;
     }
 
+    ucp_am_recv_pools_cleanup(worker, worker->am.num_recv_pools);
     ucs_array_cleanup_dynamic(&worker->am.cbs);
 }
 
+static int ucp_am_recv_pool_size_cmp(const void *elem1, const void *elem2)
+{
+    const ucp_am_recv_pool_t *pool1 = elem1;
+    const ucp_am_recv_pool_t *pool2 = elem2;
+
+    return (pool1->size > pool2->size) - (pool1->size < pool2->size);
+}
+
+ucs_status_t
+ucp_worker_am_recv_pool_create(ucp_worker_h worker,
+                               const ucp_am_recv_pool_params_t *params)
+{
+    ucs_mpool_params_t mp_params;
+    ucp_am_recv_pool_t *pool;
+    ucs_status_t status;
+    unsigned i, max_buffers;
+
+    /* The received data immediately follows the descriptor */
+    UCS_STATIC_ASSERT(sizeof(ucp_am_recv_pool_elem_t) ==
+                      ucs_offsetof(ucp_am_recv_pool_elem_t, rdesc) +
+                      sizeof(ucp_recv_desc_t));
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_AM,
+                                    return UCS_ERR_INVALID_PARAM);
+
+    if (!(params->field_mask & UCP_AM_RECV_POOL_PARAM_FIELD_SIZES) ||
+        (params->num_sizes == 0)) {
+        ucs_error("AM receive pool size classes are not specified");
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    max_buffers = UCP_PARAM_VALUE(AM_RECV_POOL, params, max_buffers,
+                                  MAX_BUFFERS, UINT_MAX);
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    if (worker->am.recv_pools != NULL) {
+        status = UCS_ERR_ALREADY_EXISTS;
+        goto out;
+    }
+
+    worker->am.recv_pools = ucs_calloc(params->num_sizes,
+                                       sizeof(*worker->am.recv_pools),
+                                       "ucp_am_recv_pools");
+    if (worker->am.recv_pools == NULL) {
+        status = UCS_ERR_NO_MEMORY;
+        goto out;
+    }
+
+    for (i = 0; i < params->num_sizes; ++i) {
+        worker->am.recv_pools[i].size = params->sizes[i];
+    }
+
+    qsort(worker->am.recv_pools, params->num_sizes,
+          sizeof(*worker->am.recv_pools), ucp_am_recv_pool_size_cmp);
+
+    for (i = 0; i < params->num_sizes; ++i) {
+        pool = &worker->am.recv_pools[i];
+
+        ucs_mpool_params_reset(&mp_params);
+        mp_params.priv_size       = sizeof(ucp_worker_h);
+        mp_params.elem_size       = sizeof(ucp_am_recv_pool_elem_t) +
+                                    pool->size;
+        mp_params.align_offset    = sizeof(ucp_am_recv_pool_elem_t);
+        mp_params.alignment       = UCS_SYS_CACHE_LINE_SIZE;
+        mp_params.elems_per_chunk = ucs_min(max_buffers,
+                                            ucs_max(UCS_MBYTE /
+                                                    mp_params.elem_size, 1));
+        mp_params.max_elems       = max_buffers;
+        mp_params.ops             = &ucp_am_recv_pool_mpool_ops;
+        mp_params.name            = "ucp_am_recv_pool";
+        status = ucs_mpool_init(&mp_params, &pool->mp);
+        if (status != UCS_OK) {
+            ucp_am_recv_pools_cleanup(worker, i);
+            goto out;
+        }
+
+        *(ucp_worker_h*)ucs_mpool_priv(&pool->mp) = worker;
+    }
+
+    worker->am.num_recv_pools = params->num_sizes;
+    status                    = UCS_OK;
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return status;
+}
+
 void ucp_am_ep_init(ucp_ep_h ep)
 {
     ucp_ep_ext_t *ep_ext = ep->ext;
@@ -145,6 +282,14 @@ UCS_PROFILE_FUNC_VOID(ucp_am_data_release, (worker, data),
         return;
     }
 
+    if (rdesc->flags & UCP_RECV_DESC_FLAG_AM_RECV_POOL) {
+        UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+        ucs_mpool_put_inline(ucs_container_of(rdesc, ucp_am_recv_pool_elem_t,
+                                              rdesc));
+        UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+        return;
+    }
+
     if (rdesc->flags & UCP_RECV_DESC_FLAG_RNDV) {
         if (rdesc->flags & UCP_RECV_DESC_FLAG_RECV_STARTED) {
             ucs_error("rndv receive is initiated on desc %p and cannot be "
@@ -1033,9 +1178,9 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_am_send_nbx,
         goto out;
     }
 
-    req = ucp_request_get_param(worker, param,
-                                {ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
-                                 goto out;});
+    req = ucp_request_get_send_param(worker, param,
+                                     {ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+                                      goto out;});
 
     if (worker->context->config.ext.proto_enable) {
         req->send.msg_proto.am.am_id           = id;
@@ -1626,6 +1771,115 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_am_long_middle_handler,
     return status;
 }
 
+static void ucp_am_recv_pool_completed(void *request, ucs_status_t status,
+                                       size_t length, void *user_data)
+{
+    ucp_am_recv_pool_elem_t *elem = user_data;
+    ucp_worker_h worker           = ((ucp_request_t*)request - 1)->recv.worker;
+    uint16_t am_id                = elem->am.am_id;
+    void *data                    = &elem->rdesc + 1;
+    ucp_am_entry_t *am_cb;
+    ucp_am_recv_param_t param;
+    ucp_ep_h ep;
+    void *hdr;
+
+    if (ucs_unlikely(status != UCS_OK)) {
+        ucs_debug("worker %p: failed to receive AM id %u to pool buffer %p: %s",
+                  worker, am_id, data, ucs_status_string(status));
+        goto out_put;
+    }
+
+    if (ucs_unlikely(!ucp_am_recv_check_id(worker, am_id))) {
+        goto out_put;
+    }
+
+    UCP_WORKER_GET_VALID_EP_BY_ID(&ep, worker, elem->ep_id, goto out_put,
+                                  "AM pool data");
+
+    hdr   = (elem->am.header_length != 0) ?
+            UCS_PTR_BYTE_OFFSET(data, length) : NULL;
+    am_cb = &ucs_array_elem(&worker->am.cbs, am_id);
+
+    elem->rdesc.length              = length;
+    elem->rdesc.payload_offset      = sizeof(elem->rdesc);
+    elem->rdesc.flags               = UCP_RECV_DESC_FLAG_AM_RECV_POOL;
+    elem->rdesc.release_desc_offset = 0;
+    ucp_recv_desc_set_name(&elem->rdesc, "am_recv_pool");
+
+    param.recv_attr = UCP_AM_RECV_ATTR_FLAG_DATA |
+                      ucp_am_hdr_reply_ep(worker, elem->am.flags, ep,
+                                          &param.reply_ep);
+    status          = am_cb->cb(am_cb->context, hdr, elem->am.header_length,
+                                data, length, &param);
+    if (status == UCS_INPROGRESS) {
+        /* The user keeps the buffer until ucp_am_data_release() */
+        return;
+    }
+
+out_put:
+    ucs_mpool_put_inline(elem);
+}
+
+/*
+ * Start receiving rendezvous data to a buffer from the AM receive pool.
+ * Returns nonzero if the receive was started.
+ */
+static int ucp_am_recv_pool_start(ucp_worker_h worker, ucp_recv_desc_t *desc,
+                                  const void *hdr)
+{
+    ucp_rndv_rts_hdr_t *rts = (ucp_rndv_rts_hdr_t*)(desc + 1);
+    ucp_am_hdr_t *am        = ucp_am_hdr_from_rts(rts);
+    size_t total_size       = rts->size + am->header_length;
+    ucp_request_param_t param;
+    ucp_am_recv_pool_elem_t *elem;
+    ucp_am_recv_pool_t *pool;
+    ucs_status_ptr_t sptr;
+    void *data;
+
+    ucs_carray_for_each(pool, worker->am.recv_pools,
+                        worker->am.num_recv_pools) {
+        if (pool->size < total_size) {
+            continue;
+        }
+
+        elem = ucs_mpool_get_inline(&pool->mp);
+        if (elem != NULL) {
+            goto found;
+        }
+    }
+
+    return 0;
+
+found:
+    elem->ep_id = rts->sreq.ep_id;
+    elem->am    = *am;
+    data        = &elem->rdesc + 1;
+    if (am->header_length != 0) {
+        /* The RTS descriptor is released before the data arrives */
+        memcpy(UCS_PTR_BYTE_OFFSET(data, rts->size), hdr, am->header_length);
+    }
+
+    param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                         UCP_OP_ATTR_FIELD_USER_DATA |
+                         UCP_OP_ATTR_FIELD_MEMH;
+    param.cb.recv_am   = ucp_am_recv_pool_completed;
+    param.user_data    = elem;
+    param.memh         = elem->super.memh;
+
+    sptr = ucp_am_recv_data_nbx(worker, rts, data, rts->size, &param);
+    if (ucs_unlikely(UCS_PTR_IS_ERR(sptr))) {
+        ucs_debug("worker %p: failed to start AM receive to pool buffer: %s",
+                  worker, ucs_status_string(UCS_PTR_STATUS(sptr)));
+        desc->flags &= ~UCP_RECV_DESC_FLAG_RECV_STARTED;
+        ucs_mpool_put_inline(elem);
+        return 0;
+    }
+
+    ucs_assert(UCS_PTR_IS_PTR(sptr));
+    ucp_request_release(sptr);
+    return 1;
+}
+
 ucs_status_t ucp_am_rndv_process_rts(void *arg, void *data, size_t length,
                                      unsigned tl_flags)
 {
@@ -1676,11 +1930,18 @@ ucs_status_t ucp_am_rndv_process_rts(void *arg, void *data, size_t length,
         goto out_send_ats;
     }
 
-    param.recv_attr = UCP_AM_RECV_ATTR_FLAG_RNDV |
-                      ucp_am_hdr_reply_ep(worker, am->flags, ep,
-                                          &param.reply_ep);
-    status          = am_cb->cb(am_cb->context, hdr, am->header_length,
-                                desc + 1, rts->size, &param);
+    if ((am_cb->flags & UCP_AM_FLAG_RECV_POOL) && (rts->size > 0) &&
+        ucp_am_recv_pool_start(worker, desc, hdr)) {
+        /* The callback is invoked when the data arrives to the pool buffer */
+        status = UCS_OK;
+    } else {
+        param.recv_attr = UCP_AM_RECV_ATTR_FLAG_RNDV |
+                          ucp_am_hdr_reply_ep(worker, am->flags, ep,
+                                              &param.reply_ep);
+        status          = am_cb->cb(am_cb->context, hdr, am->header_length,
+                                    desc + 1, rts->size, &param);
+    }
+
     if (ucp_am_rdesc_in_progress(desc, status)) {
         /* User either wants to save descriptor for later use or initiated
          * rendezvous receive (by ucp_am_recv_data_nbx) in the callback. */
@@ -10,6 +10,7 @@
 
 
 #include <ucs/datastruct/array.h>
+#include <ucs/datastruct/mpool.h>
 #include <ucp/rndv/rndv.h>
 
 
@@ -42,9 +43,20 @@ typedef struct ucp_am_entry {
 } ucp_am_entry_t;
 
 
+/**
+ * Size class of the AM receive pool
+ */
+typedef struct ucp_am_recv_pool {
+    ucs_mpool_t                           mp;     /* Registered buffers */
+    size_t                                size;   /* Buffer size */
+} ucp_am_recv_pool_t;
+
+
 typedef struct ucp_am_info {
     size_t                                alignment;
     ucs_array_s(unsigned, ucp_am_entry_t) cbs;
+    ucp_am_recv_pool_t                    *recv_pools;     /* Sorted by size */
+    unsigned                              num_recv_pools;
 } ucp_am_info_t;
 
 
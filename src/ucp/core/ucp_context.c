@@ -55,7 +55,9 @@
     _macro(UCP_AM_ID_AM_SINGLE) \
     _macro(UCP_AM_ID_AM_FIRST) \
     _macro(UCP_AM_ID_AM_MIDDLE) \
-    _macro(UCP_AM_ID_AM_SINGLE_REPLY)
+    _macro(UCP_AM_ID_AM_SINGLE_REPLY) \
+    _macro(UCP_AM_ID_ATOMIC_BATCH_REQ) \
+    _macro(UCP_AM_ID_ATOMIC_BATCH_REP)
 
 #define UCP_AM_HANDLER_DECL(_id) extern ucp_am_handler_t ucp_am_handler_##_id;
 
@@ -140,6 +142,13 @@ const char *ucp_object_versions[] = {
     [UCP_OBJECT_VERSION_LAST] = NULL
 };
 
+const char *ucp_numa_policy_names[] = {
+    [UCP_NUMA_POLICY_NONE]   = "none",
+    [UCP_NUMA_POLICY_LOCAL]  = "local",
+    [UCP_NUMA_POLICY_DEVICE] = "device",
+    [UCP_NUMA_POLICY_LAST]   = NULL
+};
+
 const char *ucp_extra_op_attr_flags_names[] = {
     [UCP_OP_ATTR_INDEX(UCP_OP_ATTR_FLAG_NO_IMM_CMPL)]    = "no_imm_cmpl",
     [UCP_OP_ATTR_INDEX(UCP_OP_ATTR_FLAG_FAST_CMPL)]      = "fast_cmpl",
@@ -273,6 +282,16 @@ static ucs_config_field_t ucp_context_config_table[] = {
    "          Otherwise the CPU mode is selected.",
    ucs_offsetof(ucp_context_config_t, atomic_mode), UCS_CONFIG_TYPE_ENUM(ucp_atomic_modes)},
 
+  {"SW_AMO_BATCH", "1",
+   "Maximal number of software-emulated atomic operations to the same endpoint\n"
+   "which are sent in one active message. Operations are batched only while\n"
+   "the endpoint is out of send resources, so the latency of a single\n"
+   "operation is not affected. The peer applies the batched operations in\n"
+   "order and acknowledges them with one reply. The maximal value is "
+   UCS_PP_MAKE_STRING(UCP_AMO_SW_BATCH_MAX) ", and\n"
+   "1 disables batching.",
+   ucs_offsetof(ucp_context_config_t, sw_amo_batch), UCS_CONFIG_TYPE_UINT},
+
   {"ADDRESS_DEBUG_INFO",
 #if ENABLE_DEBUG_DATA
    "y",
@@ -384,6 +403,16 @@ static ucs_config_field_t ucp_context_config_table[] = {
    ucs_offsetof(ucp_context_config_t, fence_mode),
    UCS_CONFIG_TYPE_ENUM(ucp_fence_modes)},
 
+  {"NUMA_POLICY", "none",
+   "NUMA node to allocate the memory pools of a worker and its transport\n"
+   "interfaces on.\n"
+   " none   - use the memory policy of the thread which grows the pool.\n"
+   " local  - use the node of the thread which creates the worker.\n"
+   " device - use the node closest to the network devices used by the context,\n"
+   "          or the node of the thread which creates the worker if it's unknown.",
+   ucs_offsetof(ucp_context_config_t, numa_policy),
+   UCS_CONFIG_TYPE_ENUM(ucp_numa_policy_names)},
+
   {"UNIFIED_MODE", "n",
    "Enable various optimizations intended for homogeneous environment.\n"
    "Enabling this mode implies that the local transport resources/devices\n"
@@ -421,6 +450,14 @@ static ucs_config_field_t ucp_context_config_table[] = {
    "(inf - check all endpoints on every round, must be greater than 0)",
    ucs_offsetof(ucp_context_config_t, keepalive_num_eps), UCS_CONFIG_TYPE_UINT},
 
+  {"IFACE_OPEN_THREADS", "1",
+   "Number of threads which open the transport interfaces when a worker is\n"
+   "created. Opening an interface may block for a few milliseconds, so using\n"
+   "several threads reduces worker creation time when many transports are\n"
+   "available. Interfaces of the same memory domain are always opened by the\n"
+   "same thread. 1 - open the interfaces serially on the calling thread.",
+   ucs_offsetof(ucp_context_config_t, iface_open_threads), UCS_CONFIG_TYPE_UINT},
+
   {"DYNAMIC_TL_SWITCH_INTERVAL", "inf",
    "Time interval between dynamic transport switching rounds. Must be\n"
    "non-zero value. use 'inf' to disable this feature.",
@@ -431,7 +468,17 @@ static ucs_config_field_t ucp_context_config_table[] = {
    "Number of usage tracker rounds performed for each progress operation. Must be\n"
    "non-zero value.",
    ucs_offsetof(ucp_context_config_t, dynamic_tl_progress_factor),
-   UCS_CONFIG_TYPE_TIME_UNITS},
+   UCS_CONFIG_TYPE_UINT},
+
+  {"EP_RELEASE_IDLE_LANES", "n",
+   "Release the shared memory and loopback transport endpoints of an endpoint\n"
+   "which the usage tracker considers idle, and recreate them on the next\n"
+   "operation. Network transport endpoints are not released. Each releasable\n"
+   "lane keeps a copy of its remote address also while the endpoint is in use,\n"
+   "so busy endpoints use slightly more memory. Requires\n"
+   "DYNAMIC_TL_SWITCH_INTERVAL to be set.",
+   ucs_offsetof(ucp_context_config_t, ep_release_idle_lanes),
+   UCS_CONFIG_TYPE_BOOL},
 
   {"RESOLVE_REMOTE_EP_ID", "n",
    "Defines whether resolving remote endpoint ID is required or not when\n"
@@ -1998,6 +2045,13 @@ ucp_dynamic_tl_switch_config_valid(const ucp_context_config_t *config)
         return 0;
     }
 
+    if (config->ep_release_idle_lanes &&
+        (config->dynamic_tl_switch_interval == UCS_TIME_INFINITY)) {
+        ucs_error("UCX_EP_RELEASE_IDLE_LANES requires a finite "
+                  "UCX_DYNAMIC_TL_SWITCH_INTERVAL");
+        return 0;
+    }
+
     return 1;
 }
 
@@ -2172,6 +2226,14 @@ static ucs_status_t ucp_fill_config(ucp_context_h context,
         goto err_free_alloc_methods;
     }
 
+    if ((context->config.ext.sw_amo_batch == 0) ||
+        (context->config.ext.sw_amo_batch > UCP_AMO_SW_BATCH_MAX)) {
+        ucs_error("UCX_SW_AMO_BATCH value must be between 1 and %d",
+                  UCP_AMO_SW_BATCH_MAX);
+        status = UCS_ERR_INVALID_PARAM;
+        goto err_free_alloc_methods;
+    }
+
     if (!ucp_dynamic_tl_switch_config_valid(&context->config.ext)) {
         status = UCS_ERR_INVALID_PARAM;
         goto err_free_alloc_methods;
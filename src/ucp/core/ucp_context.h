@@ -112,6 +112,8 @@ typedef struct ucp_context_config {
     unsigned                               max_worker_address_name;
     /** Atomic mode */
     ucp_atomic_mode_t                      atomic_mode;
+    /** Maximal number of software atomic operations in one message */
+    unsigned                               sw_amo_batch;
     /** If use mutex for MT support or not */
     int                                    use_mt_mutex;
     /** On-demand progress */
@@ -133,6 +135,8 @@ typedef struct ucp_context_config {
     int                                    flush_worker_eps;
     /** Fence mode */
     ucp_fence_mode_t                       fence_mode;
+    /** NUMA placement policy of worker memory pools */
+    ucp_numa_policy_t                      numa_policy;
     /** Enable optimizations suitable for homogeneous systems */
     int                                    unified_mode;
     /** Enable cm wireup message exchange to select the best transports
@@ -149,10 +153,14 @@ typedef struct ucp_context_config {
     /** Maximal number of endpoints to check on every keepalive round
      * (0 - disabled, inf - check all endpoints on every round) */
     unsigned                               keepalive_num_eps;
+    /** Number of threads which open transport interfaces of a new worker */
+    unsigned                               iface_open_threads;
     /** Time period between dynamic transport switching rounds */
     ucs_time_t                             dynamic_tl_switch_interval;
     /** Number of usage tracker rounds performed for each progress operation */
     unsigned                               dynamic_tl_progress_factor;
+    /** Release the lanes of endpoints demoted by the usage tracker */
+    int                                    ep_release_idle_lanes;
     /** Defines whether resolving remote endpoint ID is required or not when
      *  creating a local endpoint */
     ucs_on_off_auto_value_t                resolve_remote_ep_id;
@@ -580,6 +588,7 @@ typedef struct ucp_tl_iface_atomic_flags {
 
 extern ucp_am_handler_t *ucp_am_handlers[];
 extern const char       *ucp_feature_str[];
+extern const char       *ucp_numa_policy_names[];
 
 
 void ucp_dump_payload(ucp_context_h context, char *buffer, size_t max,
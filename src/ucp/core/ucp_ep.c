@@ -43,6 +43,11 @@ __KHASH_IMPL(ucp_ep_peer_mem_hash, kh_inline, uint64_t,
              ucp_ep_peer_mem_data_t, 1,
              kh_int64_hash_func, kh_int64_hash_equal);
 
+#define ucp_ep_cold_lanes_hash_key(_ep) kh_int64_hash_func((uintptr_t)(_ep))
+
+__KHASH_IMPL(ucp_ep_cold_lanes_hash, kh_inline, ucp_ep_h, ucp_ep_cold_lane_t*,
+             1, ucp_ep_cold_lanes_hash_key, kh_int64_hash_equal);
+
 typedef struct {
     double reg_growth;
     double reg_overhead;
@@ -134,6 +139,46 @@ static uct_iface_t ucp_failed_tl_iface = {
     }
 };
 
+static ucs_status_t ucp_ep_cold_lane_op(uct_ep_h ep);
+static ssize_t ucp_ep_cold_lane_bc_op(uct_ep_h ep);
+static ucs_status_t ucp_ep_cold_lane_pending_add(uct_ep_h ep);
+static void ucp_ep_cold_lanes_free(ucp_ep_h ep);
+
+static uct_iface_t ucp_cold_tl_iface = {
+    .ops = {
+        .ep_put_short        = (uct_ep_put_short_func_t)ucp_ep_cold_lane_op,
+        .ep_put_bcopy        = (uct_ep_put_bcopy_func_t)ucp_ep_cold_lane_bc_op,
+        .ep_put_zcopy        = (uct_ep_put_zcopy_func_t)ucp_ep_cold_lane_op,
+        .ep_get_short        = (uct_ep_get_short_func_t)ucp_ep_cold_lane_op,
+        .ep_get_bcopy        = (uct_ep_get_bcopy_func_t)ucp_ep_cold_lane_op,
+        .ep_get_zcopy        = (uct_ep_get_zcopy_func_t)ucp_ep_cold_lane_op,
+        .ep_am_short         = (uct_ep_am_short_func_t)ucp_ep_cold_lane_op,
+        .ep_am_short_iov     = (uct_ep_am_short_iov_func_t)ucp_ep_cold_lane_op,
+        .ep_am_bcopy         = (uct_ep_am_bcopy_func_t)ucp_ep_cold_lane_bc_op,
+        .ep_am_zcopy         = (uct_ep_am_zcopy_func_t)ucp_ep_cold_lane_op,
+        .ep_atomic_cswap64   = (uct_ep_atomic_cswap64_func_t)ucp_ep_cold_lane_op,
+        .ep_atomic_cswap32   = (uct_ep_atomic_cswap32_func_t)ucp_ep_cold_lane_op,
+        .ep_atomic64_post    = (uct_ep_atomic64_post_func_t)ucp_ep_cold_lane_op,
+        .ep_atomic32_post    = (uct_ep_atomic32_post_func_t)ucp_ep_cold_lane_op,
+        .ep_atomic64_fetch   = (uct_ep_atomic64_fetch_func_t)ucp_ep_cold_lane_op,
+        .ep_atomic32_fetch   = (uct_ep_atomic32_fetch_func_t)ucp_ep_cold_lane_op,
+        .ep_tag_eager_short  = (uct_ep_tag_eager_short_func_t)ucp_ep_cold_lane_op,
+        .ep_tag_eager_bcopy  = (uct_ep_tag_eager_bcopy_func_t)ucp_ep_cold_lane_bc_op,
+        .ep_tag_eager_zcopy  = (uct_ep_tag_eager_zcopy_func_t)ucp_ep_cold_lane_op,
+        .ep_tag_rndv_zcopy   = (uct_ep_tag_rndv_zcopy_func_t)ucp_ep_cold_lane_op,
+        .ep_tag_rndv_cancel  = (uct_ep_tag_rndv_cancel_func_t)ucs_empty_function_return_unsupported,
+        .ep_tag_rndv_request = (uct_ep_tag_rndv_request_func_t)ucp_ep_cold_lane_op,
+        .ep_pending_add      = (uct_ep_pending_add_func_t)ucp_ep_cold_lane_pending_add,
+        .ep_pending_purge    = (uct_ep_pending_purge_func_t)ucs_empty_function_return_success,
+        .ep_flush            = (uct_ep_flush_func_t)ucs_empty_function_return_success,
+        .ep_fence            = (uct_ep_fence_func_t)ucs_empty_function_return_success,
+        .ep_check            = (uct_ep_check_func_t)ucs_empty_function_return_success,
+        .ep_connect_to_ep    = (uct_ep_connect_to_ep_func_t)ucs_empty_function_return_unsupported,
+        .ep_destroy          = (uct_ep_destroy_func_t)ucs_empty_function,
+        .ep_get_address      = (uct_ep_get_address_func_t)ucs_empty_function_return_unsupported
+    }
+};
+
 static ucp_ep_discard_lanes_arg_t ucp_failed_tl_ep_discard_arg = {
     .failed_ep = {.iface = &ucp_failed_tl_iface},
     .status    = UCS_ERR_CANCELED
@@ -222,6 +267,8 @@ static ucp_ep_h ucp_ep_allocate(ucp_worker_h worker, const char *peer_name)
     ep->ext->remote_ep_id                 = UCS_PTR_MAP_KEY_INVALID;
     ep->ext->err_cb                       = NULL;
     ep->ext->close_req                    = NULL;
+    ep->ext->amo_batch                    = NULL;
+    ucs_queue_head_init(&ep->ext->amo_batch_q);
 #if UCS_ENABLE_ASSERT
     ep->ext->ka_last_round                = 0;
 #endif
@@ -505,6 +552,10 @@ void ucp_ep_destroy_base(ucp_ep_h ep)
     ucp_ep_release_id(ep);
     ucs_list_del(&ep->ext->ep_list);
 
+    if (worker->usage_tracker.handle != NULL) {
+        ucs_usage_tracker_remove(worker->usage_tracker.handle, ep);
+    }
+
     ucs_vfs_obj_remove(ep);
     ucs_callbackq_remove_oneshot(&worker->uct->progress_q, ep,
                                  ucp_ep_remove_filter, ep);
@@ -516,6 +567,7 @@ void ucp_ep_destroy_base(ucp_ep_h ep)
 
         kh_destroy(ucp_ep_peer_mem_hash, ep->ext->peer_mem);
     }
+    ucp_ep_cold_lanes_free(ep);
     ucp_ep_deallocate(ep);
 }
 
@@ -1248,6 +1300,11 @@ void ucp_ep_err_pending_purge(uct_pending_req_t *self, void *arg)
     ucp_request_t *req   = ucs_container_of(self, ucp_request_t, send.uct);
     ucs_status_t  status = UCS_PTR_STATUS(arg);
 
+    if (ucs_unlikely(req == req->send.ep->ext->amo_batch)) {
+        /* Complete software atomics queued on the pending request */
+        ucp_amo_sw_batch_purge(req, status);
+    }
+
     /* TODO: check for context->config.ext.proto_enable when all protocols are
      *       implemented, such as flush, AM/RNDV, etc */
     if (req->flags & UCP_REQUEST_FLAG_PROTO_SEND) {
@@ -1621,6 +1678,269 @@ void ucp_ep_cleanup_lanes(ucp_ep_h ep)
     ucp_ep_config_deactivate_worker_ifaces(ep->worker, ep->cfg_index);
 }
 
+static ucp_ep_cold_lane_t *ucp_ep_cold_lanes(ucp_ep_h ep)
+{
+    ucp_worker_h worker = ep->worker;
+    khiter_t iter;
+
+    if (!worker->context->config.ext.ep_release_idle_lanes) {
+        return NULL;
+    }
+
+    iter = kh_get(ucp_ep_cold_lanes_hash, &worker->cold_lanes_hash, ep);
+    if (iter == kh_end(&worker->cold_lanes_hash)) {
+        return NULL;
+    }
+
+    return kh_val(&worker->cold_lanes_hash, iter);
+}
+
+static void ucp_ep_cold_lanes_free(ucp_ep_h ep)
+{
+    ucp_worker_h worker = ep->worker;
+    ucp_ep_cold_lane_t *cold_lane, *next;
+    khiter_t iter;
+
+    if (!worker->context->config.ext.ep_release_idle_lanes) {
+        return;
+    }
+
+    iter = kh_get(ucp_ep_cold_lanes_hash, &worker->cold_lanes_hash, ep);
+    if (iter == kh_end(&worker->cold_lanes_hash)) {
+        return;
+    }
+
+    for (cold_lane = kh_val(&worker->cold_lanes_hash, iter); cold_lane != NULL;
+         cold_lane = next) {
+        next = cold_lane->next;
+        ucs_assert(ucp_ep_get_lane(ep, cold_lane->lane) != &cold_lane->super);
+        ucs_free(cold_lane);
+    }
+
+    kh_del(ucp_ep_cold_lanes_hash, &worker->cold_lanes_hash, iter);
+}
+
+int ucp_ep_is_lane_released(uct_ep_h uct_ep)
+{
+    return uct_ep->iface == &ucp_cold_tl_iface;
+}
+
+void ucp_ep_cold_lane_add(ucp_ep_h ep, ucp_lane_index_t lane,
+                          unsigned path_index, const uct_iface_attr_t *iface_attr,
+                          const uct_device_addr_t *dev_addr,
+                          const uct_iface_addr_t *iface_addr)
+{
+    size_t dev_addr_len   = (dev_addr != NULL) ? iface_attr->device_addr_len : 0;
+    size_t iface_addr_len = (iface_addr != NULL) ? iface_attr->iface_addr_len :
+                                                   0;
+    ucp_worker_h worker   = ep->worker;
+    ucp_ep_cold_lane_t *cold_lane;
+    khiter_t iter;
+    int ret;
+
+    if ((dev_addr_len > UINT8_MAX) || (iface_addr_len > UINT8_MAX) ||
+        (path_index > UINT8_MAX)) {
+        return;
+    }
+
+    cold_lane = ucs_malloc(sizeof(*cold_lane) + dev_addr_len + iface_addr_len,
+                           "ucp_ep_cold_lane");
+    if (cold_lane == NULL) {
+        /* The lane just stays connected while the endpoint is idle */
+        ucs_debug("ep %p: failed to allocate cold lane[%d]", ep, lane);
+        return;
+    }
+
+    cold_lane->super.iface    = &ucp_cold_tl_iface;
+    cold_lane->ucp_ep         = ep;
+    cold_lane->lane           = lane;
+    cold_lane->path_index     = path_index;
+    cold_lane->dev_addr_len   = dev_addr_len;
+    cold_lane->iface_addr_len = iface_addr_len;
+    if (dev_addr != NULL) {
+        memcpy(cold_lane->addr, dev_addr, dev_addr_len);
+    }
+    if (iface_addr != NULL) {
+        memcpy(UCS_PTR_BYTE_OFFSET(cold_lane->addr, dev_addr_len), iface_addr,
+               iface_addr_len);
+    }
+
+    iter = kh_put(ucp_ep_cold_lanes_hash, &worker->cold_lanes_hash, ep, &ret);
+    if (ret == UCS_KH_PUT_FAILED) {
+        ucs_free(cold_lane);
+        return;
+    }
+
+    cold_lane->next = (ret == UCS_KH_PUT_KEY_PRESENT) ?
+                      kh_val(&worker->cold_lanes_hash, iter) : NULL;
+    kh_val(&worker->cold_lanes_hash, iter) = cold_lane;
+}
+
+ucs_status_t ucp_ep_cold_lanes_restore(ucp_ep_h ep)
+{
+    ucp_ep_cold_lane_t *cold_lanes  = ucp_ep_cold_lanes(ep);
+    uct_ep_h uct_eps[UCP_MAX_LANES] = { NULL };
+    ucp_ep_cold_lane_t *cold_lane;
+    uct_ep_params_t uct_ep_params;
+    ucp_worker_iface_t *wiface;
+    ucs_status_t status;
+
+    for (cold_lane = cold_lanes; cold_lane != NULL;
+         cold_lane = cold_lane->next) {
+        if (ucp_ep_get_lane(ep, cold_lane->lane) != &cold_lane->super) {
+            continue;
+        }
+
+        wiface = ucp_worker_iface(ep->worker,
+                                  ucp_ep_get_rsc_index(ep, cold_lane->lane));
+        uct_ep_params.field_mask = UCT_EP_PARAM_FIELD_IFACE |
+                                   UCT_EP_PARAM_FIELD_PATH_INDEX;
+        uct_ep_params.iface      = wiface->iface;
+        uct_ep_params.path_index = cold_lane->path_index;
+        if (cold_lane->dev_addr_len > 0) {
+            uct_ep_params.field_mask |= UCT_EP_PARAM_FIELD_DEV_ADDR;
+            uct_ep_params.dev_addr    = (uct_device_addr_t*)cold_lane->addr;
+        }
+        if (cold_lane->iface_addr_len > 0) {
+            uct_ep_params.field_mask |= UCT_EP_PARAM_FIELD_IFACE_ADDR;
+            uct_ep_params.iface_addr  = (uct_iface_addr_t*)
+                    UCS_PTR_BYTE_OFFSET(cold_lane->addr,
+                                        cold_lane->dev_addr_len);
+        }
+
+        status = uct_ep_create(&uct_ep_params, &uct_eps[cold_lane->lane]);
+        if (status != UCS_OK) {
+            ucs_error("ep %p: failed to restore lane[%d]: %s", ep,
+                      cold_lane->lane, ucs_status_string(status));
+            goto err_destroy;
+        }
+    }
+
+    for (cold_lane = cold_lanes; cold_lane != NULL;
+         cold_lane = cold_lane->next) {
+        if (uct_eps[cold_lane->lane] != NULL) {
+            ucs_trace("ep %p: restore uct_ep[%d]=%p", ep, cold_lane->lane,
+                      uct_eps[cold_lane->lane]);
+            ucp_ep_set_lane(ep, cold_lane->lane, uct_eps[cold_lane->lane]);
+        }
+    }
+
+    return UCS_OK;
+
+err_destroy:
+    for (cold_lane = cold_lanes; cold_lane != NULL;
+         cold_lane = cold_lane->next) {
+        if (uct_eps[cold_lane->lane] != NULL) {
+            uct_ep_destroy(uct_eps[cold_lane->lane]);
+        }
+    }
+    return status;
+}
+
+static ucs_status_t ucp_ep_cold_lane_op(uct_ep_h ep)
+{
+    ucp_ep_cold_lane_t *cold_lane = ucs_derived_of(ep, ucp_ep_cold_lane_t);
+    ucs_status_t status;
+
+    /* Restore all released lanes of the endpoint, and let the caller retry
+     * the operation on the new transport endpoint */
+    status = ucp_ep_cold_lanes_restore(cold_lane->ucp_ep);
+    return (status == UCS_OK) ? UCS_ERR_NO_RESOURCE : status;
+}
+
+static ssize_t ucp_ep_cold_lane_bc_op(uct_ep_h ep)
+{
+    return ucp_ep_cold_lane_op(ep);
+}
+
+static ucs_status_t ucp_ep_cold_lane_pending_add(uct_ep_h ep)
+{
+    ucs_status_t status = ucp_ep_cold_lane_op(ep);
+
+    return (status == UCS_ERR_NO_RESOURCE) ? UCS_ERR_BUSY : status;
+}
+
+ucs_status_t ucp_ep_cold_lanes_reset(ucp_ep_h ep)
+{
+    ucs_status_t status;
+
+    if (ucp_ep_cold_lanes(ep) == NULL) {
+        return UCS_OK;
+    }
+
+    status = ucp_ep_cold_lanes_restore(ep);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    ucp_ep_cold_lanes_free(ep);
+    return UCS_OK;
+}
+
+static void ucp_ep_cold_lane_pending_purge(uct_pending_req_t *self, void *arg)
+{
+    ucs_queue_push((ucs_queue_head_t*)arg, (ucs_queue_elem_t*)self->priv);
+}
+
+ucs_status_t ucp_ep_release_idle_lanes(ucp_ep_h ep)
+{
+    ucp_ep_cold_lane_t *cold_lanes = ucp_ep_cold_lanes(ep);
+    ucs_queue_head_t pending_queue;
+    ucp_ep_cold_lane_t *cold_lane;
+    uct_ep_h uct_ep;
+
+    UCP_WORKER_THREAD_CS_CHECK_IS_BLOCKED(ep->worker);
+
+    if ((cold_lanes == NULL) ||
+        (ep->flags & (UCP_EP_FLAG_FAILED | UCP_EP_FLAG_CLOSED)) ||
+        !(ep->flags & UCP_EP_FLAG_LOCAL_CONNECTED) ||
+        !ucs_hlist_is_empty(&ep->ext->proto_reqs)) {
+        return UCS_ERR_BUSY;
+    }
+
+    /* All lanes must be idle, to avoid reordering with operations which are
+     * still in progress on the released transport endpoints */
+    for (cold_lane = cold_lanes; cold_lane != NULL;
+         cold_lane = cold_lane->next) {
+        uct_ep = ucp_ep_get_lane(ep, cold_lane->lane);
+        if (!ucp_ep_is_lane_released(uct_ep) &&
+            (ucp_wireup_ep_test(uct_ep) ||
+             (uct_ep_flush(uct_ep, UCT_FLUSH_FLAG_LOCAL, NULL) != UCS_OK))) {
+            return UCS_ERR_BUSY;
+        }
+    }
+
+    ucs_queue_head_init(&pending_queue);
+    for (cold_lane = cold_lanes; cold_lane != NULL;
+         cold_lane = cold_lane->next) {
+        uct_ep = ucp_ep_get_lane(ep, cold_lane->lane);
+        if (!ucp_ep_is_lane_released(uct_ep)) {
+            uct_ep_pending_purge(uct_ep, ucp_ep_cold_lane_pending_purge,
+                                 &pending_queue);
+        }
+    }
+
+    if (!ucs_queue_is_empty(&pending_queue)) {
+        ucp_wireup_replay_pending_requests(ep, &pending_queue);
+        return UCS_ERR_BUSY;
+    }
+
+    for (cold_lane = cold_lanes; cold_lane != NULL;
+         cold_lane = cold_lane->next) {
+        uct_ep = ucp_ep_get_lane(ep, cold_lane->lane);
+        if (ucp_ep_is_lane_released(uct_ep)) {
+            continue;
+        }
+
+        ucs_trace("ep %p: release idle uct_ep[%d]=%p", ep, cold_lane->lane,
+                  uct_ep);
+        ucp_ep_set_lane(ep, cold_lane->lane, &cold_lane->super);
+        uct_ep_destroy(uct_ep);
+    }
+
+    return UCS_OK;
+}
+
 void ucp_ep_disconnected(ucp_ep_h ep, int force)
 {
     ucp_worker_h worker = ep->worker;
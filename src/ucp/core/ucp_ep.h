@@ -504,6 +504,28 @@ typedef struct {
 } ucp_ep_flush_state_t;
 
 
+/**
+ * Lane connected to a remote interface, which can be released while the
+ * endpoint is idle and recreated on the next operation
+ */
+typedef struct ucp_ep_cold_lane {
+    uct_ep_t                 super;          /* Installed on the lane while it
+                                                is released */
+    struct ucp_ep_cold_lane  *next;          /* Next lane of the same endpoint */
+    ucp_ep_h                 ucp_ep;         /* Endpoint which owns the lane */
+    ucp_lane_index_t         lane;           /* Lane index */
+    uint8_t                  path_index;     /* Path index on the interface */
+    uint8_t                  dev_addr_len;   /* Remote device address length */
+    uint8_t                  iface_addr_len; /* Remote iface address length */
+    uint8_t                  addr[0];        /* Remote device and iface addresses */
+} ucp_ep_cold_lane_t;
+
+
+/* Hash map of releasable lanes by endpoint, kept on the worker so that
+ * endpoints which do not use this feature do not pay for it */
+KHASH_DECLARE(ucp_ep_cold_lanes_hash, ucp_ep_h, ucp_ep_cold_lane_t*);
+
+
 /**
  * Endpoint extension
  */
@@ -516,6 +538,10 @@ typedef struct ucp_ep_ext {
     ucs_ptr_map_key_t             remote_ep_id;  /* Remote EP ID */
     ucp_err_handler_cb_t          err_cb;        /* Error handler */
     ucp_request_t                 *close_req;    /* Close protocol request */
+    ucp_request_t                 *amo_batch;    /* Pending software atomic which
+                                                    carries a batch of atomics */
+    ucs_queue_head_t              amo_batch_q;   /* Software atomics queued on
+                                                    amo_batch */
     khash_t(ucp_ep_peer_mem_hash) *peer_mem;     /* Hash of remote memory segments
                                                     used by 2-stage ppln rndv proto */
     /* List of requests which are waiting for remote completion */
@@ -537,6 +563,7 @@ typedef struct ucp_ep_ext {
         ucs_list_link_t           ready_list;     /* List entry in worker's EP list */
         ucs_queue_head_t          match_q;        /* Queue of receive data or requests,
                                                      depends on UCP_EP_FLAG_STREAM_HAS_DATA */
+        struct ucp_stream_ring    *ring;          /* User receive ring, if attached */
     } stream;
 
     struct {
@@ -739,6 +766,19 @@ void ucp_ep_unprogress_uct_ep(ucp_ep_h ep, uct_ep_h uct_ep,
 
 void ucp_ep_cleanup_lanes(ucp_ep_h ep);
 
+void ucp_ep_cold_lane_add(ucp_ep_h ep, ucp_lane_index_t lane,
+                          unsigned path_index, const uct_iface_attr_t *iface_attr,
+                          const uct_device_addr_t *dev_addr,
+                          const uct_iface_addr_t *iface_addr);
+
+ucs_status_t ucp_ep_cold_lanes_restore(ucp_ep_h ep);
+
+ucs_status_t ucp_ep_cold_lanes_reset(ucp_ep_h ep);
+
+ucs_status_t ucp_ep_release_idle_lanes(ucp_ep_h ep);
+
+int ucp_ep_is_lane_released(uct_ep_h uct_ep);
+
 ucs_status_t ucp_ep_config_init(ucp_worker_h worker, ucp_ep_config_t *config,
                                 const ucp_ep_config_key_t *key);
 
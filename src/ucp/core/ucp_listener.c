@@ -143,6 +143,7 @@ ucp_listen(ucp_listener_h listener, const ucp_listener_params_t *params)
     ucp_worker_cm_t       *ucp_cm;
     ucs_status_t          status;
     int                   use_any_port;
+    int                   skip_cm;
     ucs_log_level_t       log_level;
 
     addr = (struct sockaddr *)&addr_storage;
@@ -170,6 +171,12 @@ ucp_listen(ucp_listener_h listener, const ucp_listener_params_t *params)
         uct_params.backlog     = worker->context->config.ext.listener_backlog;
     }
 
+    if (UCP_PARAM_VALUE(LISTENER, params, flags, FLAGS, 0) &
+        UCP_LISTENER_FLAG_REUSE_PORT) {
+        uct_params.field_mask |= UCT_LISTENER_PARAM_FIELD_FLAGS;
+        uct_params.flags       = UCT_LISTENER_FLAG_REUSE_PORT;
+    }
+
     listener->num_rscs          = 0;
     uct_listeners               = ucs_calloc(num_cms, sizeof(*uct_listeners),
                                              "uct_listeners_arr");
@@ -230,9 +237,13 @@ ucp_listen(ucp_listener_h listener, const ucp_listener_params_t *params)
              *       TCP listener first */
             cm_index = 0;
         } else {
-            log_level = ((status == UCS_ERR_BUSY) ||
-                         (status == UCS_ERR_NO_DEVICE)) ? UCS_LOG_LEVEL_DIAG :
-                        UCS_LOG_LEVEL_ERROR;
+            /* A CM may not support some of the requested listener flags */
+            skip_cm   = (status == UCS_ERR_NO_DEVICE) ||
+                        ((status == UCS_ERR_UNSUPPORTED) &&
+                         (uct_params.field_mask &
+                          UCT_LISTENER_PARAM_FIELD_FLAGS));
+            log_level = ((status == UCS_ERR_BUSY) || skip_cm) ?
+                        UCS_LOG_LEVEL_DIAG : UCS_LOG_LEVEL_ERROR;
             ucs_log(log_level,
                     "failed to create UCT listener on CM %p (component %s) "
                     "with address %s status %s", ucp_cm->cm,
@@ -240,7 +251,7 @@ ucp_listen(ucp_listener_h listener, const ucp_listener_params_t *params)
                     ucs_sockaddr_str(params->sockaddr.addr, addr_str,
                                      UCS_SOCKADDR_STRING_LEN),
                     ucs_status_string(status));
-            if (status != UCS_ERR_NO_DEVICE) {
+            if (!skip_cm) {
                 goto err_free_listeners;
             }
         }
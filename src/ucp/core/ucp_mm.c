@@ -1341,7 +1341,7 @@ ucp_mem_advise(ucp_context_h context, ucp_mem_h memh,
     return status;
 }
 
-static ucs_status_t
+ucs_status_t
 ucp_mpool_malloc(ucp_worker_h worker, ucs_mpool_t *mp, size_t *size_p, void **chunk_p)
 {
     ucp_mem_desc_t *chunk_hdr;
@@ -1363,8 +1363,7 @@ out:
     return status;
 }
 
-static void
-ucp_mpool_free(ucp_worker_h worker, ucs_mpool_t *mp, void *chunk)
+void ucp_mpool_free(ucp_worker_h worker, ucs_mpool_t *mp, void *chunk)
 {
     ucp_mem_desc_t *chunk_hdr;
 
@@ -117,6 +117,11 @@ extern ucp_mem_dummy_handle_t ucp_mem_dummy_handle;
 extern const ucp_memory_info_t ucp_mem_info_unknown;
 
 
+ucs_status_t ucp_mpool_malloc(ucp_worker_h worker, ucs_mpool_t *mp,
+                              size_t *size_p, void **chunk_p);
+
+void ucp_mpool_free(ucp_worker_h worker, ucs_mpool_t *mp, void *chunk);
+
 ucs_status_t ucp_reg_mpool_malloc(ucs_mpool_t *mp, size_t *size_p, void **chunk_p);
 
 void ucp_reg_mpool_free(ucs_mpool_t *mp, void *chunk);
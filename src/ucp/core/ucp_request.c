@@ -15,6 +15,7 @@
 
 #include <ucp/proto/proto_am.h>
 #include <ucp/proto/proto_debug.h>
+#include <ucp/rma/rma.h>
 #include <ucp/tag/tag_rndv.h>
 #include <uct/api/v2/uct_v2.h>
 #include <ucs/datastruct/mpool.inl>
@@ -28,6 +29,7 @@ static const char *ucp_request_flag_names[] = {
     [ucs_ilog2(UCP_REQUEST_FLAG_COMPLETED)]             = "cpml",
     [ucs_ilog2(UCP_REQUEST_FLAG_RELEASED)]              = "rls",
     [ucs_ilog2(UCP_REQUEST_FLAG_PROTO_SEND)]            = "proto",
+    [ucs_ilog2(UCP_REQUEST_FLAG_PERSISTENT)]            = "prst",
     [ucs_ilog2(UCP_REQUEST_FLAG_SYNC_LOCAL_COMPLETED)]  = "loc_cmpl",
     [ucs_ilog2(UCP_REQUEST_FLAG_SYNC_REMOTE_COMPLETED)] = "rm_cmpl",
     [ucs_ilog2(UCP_REQUEST_FLAG_CALLBACK)]              = "cb",
@@ -54,7 +56,9 @@ static const char *ucp_request_flag_names[] = {
 
 static ucs_memory_type_t ucp_request_get_mem_type(ucp_request_t *req)
 {
-    if (req->flags & UCP_REQUEST_FLAG_PROTO_SEND) {
+    if (req->flags & UCP_REQUEST_FLAG_PERSISTENT) {
+        return ((ucp_request_persistent_t*)req->user_data)->mem_type;
+    } else if (req->flags & UCP_REQUEST_FLAG_PROTO_SEND) {
         return req->send.state.dt_iter.mem_info.type;
     } else if (req->flags & (UCP_REQUEST_FLAG_SEND_AM | UCP_REQUEST_FLAG_SEND_TAG)) {
         return req->send.mem_type;
@@ -180,11 +184,12 @@ ucs_status_t ucp_tag_recv_request_test(void *request, ucp_tag_recv_info_t *info)
     ucp_request_t *req   = (ucp_request_t*)request - 1;
     ucs_status_t  status = ucp_request_check_status(request);
 
-    if (status != UCS_INPROGRESS) {
-        ucs_assert(req->flags & UCP_REQUEST_FLAG_RECV_TAG);
-        *info = req->recv.tag.info;
+    if (status == UCS_INPROGRESS) {
+        return status;
     }
 
+    ucs_assert(req->flags & UCP_REQUEST_FLAG_RECV_TAG);
+    *info = req->recv.tag.info;
     return status;
 }
 
@@ -219,7 +224,15 @@ ucp_request_release_common(void *request, uint8_t cb_flag, const char *debug_nam
     ucs_assert(!(flags & UCP_REQUEST_FLAG_RELEASED));
 
     if (ucs_likely(flags & UCP_REQUEST_FLAG_COMPLETED)) {
+        if (ucs_unlikely(flags & UCP_REQUEST_FLAG_PERSISTENT)) {
+            ucp_request_persistent_free(req->user_data);
+        }
         ucp_request_put(req);
+    } else if (flags & UCP_REQUEST_FLAG_PERSISTENT) {
+        /* The callback of a running persistent operation releases the
+         * persistent parameters, and skips the user callback once the
+         * request is released */
+        req->flags = flags | UCP_REQUEST_FLAG_RELEASED;
     } else {
         req->flags = (flags | UCP_REQUEST_FLAG_RELEASED) & ~cb_flag;
     }
@@ -269,6 +282,45 @@ UCS_PROFILE_FUNC_VOID(ucp_request_cancel, (worker, request),
     }
 }
 
+UCS_PROFILE_FUNC(ucs_status_t, ucp_request_start, (request), void *request)
+{
+    ucp_request_t *req  = (ucp_request_t*)request - 1;
+    ucp_worker_h worker = ucs_container_of(ucs_mpool_obj_owner(req),
+                                           ucp_worker_t, req_mp);
+    ucp_request_persistent_t *prst;
+    ucs_status_t status;
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    if (ENABLE_PARAMS_CHECK && !(req->flags & UCP_REQUEST_FLAG_PERSISTENT)) {
+        ucs_error("request %p is not persistent", request);
+        status = UCS_ERR_INVALID_PARAM;
+        goto out;
+    }
+
+    if (!(req->flags & UCP_REQUEST_FLAG_COMPLETED)) {
+        ucs_trace_req("request %p: previous operation is in progress", req);
+        status = UCS_ERR_BUSY;
+        goto out;
+    }
+
+    ucs_assert(!(req->flags & UCP_REQUEST_FLAG_RELEASED));
+
+    /* The callback is not called if the operation completes immediately */
+    req->flags &= ~(UCP_REQUEST_FLAG_COMPLETED | UCP_REQUEST_FLAG_CALLBACK);
+
+    prst   = req->user_data;
+    status = prst->start(req);
+    if (status != UCS_INPROGRESS) {
+        req->flags  |= UCP_REQUEST_FLAG_COMPLETED;
+        req->status  = status;
+    }
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return status;
+}
+
 static void
 ucp_worker_request_init_proxy(ucs_mpool_t *mp, void *obj, void *chunk)
 {
@@ -328,6 +380,7 @@ int ucp_request_pending_add(ucp_request_t *req)
 
     uct_ep = ucp_ep_get_lane(req->send.ep, req->send.lane);
     status = uct_ep_pending_add(uct_ep, &req->send.uct, 0);
+    UCS_PROBE(uct_pending_add, req, req->send.lane, (int)status);
     if (status == UCS_OK) {
         ucs_trace_data("ep %p: added pending uct request %p to lane[%d]=%p",
                        req->send.ep, req, req->send.lane, uct_ep);
@@ -677,6 +730,9 @@ void ucp_request_send_state_ff(ucp_request_t *req, ucs_status_t status)
     } else if (req->send.uct.func == ucp_wireup_msg_progress) {
         ucs_free(req->send.buffer);
         ucp_request_mem_free(req);
+    } else if (req->send.uct.func == ucp_progress_atomic_batch_reply) {
+        ucs_free(req->send.buffer);
+        ucp_request_put(req);
     } else if (req->send.state.uct_comp.func == ucp_ep_flush_completion) {
         ucp_ep_flush_request_ff(req, status);
     } else if (req->send.uct.func == ucp_worker_discard_uct_ep_pending_cb) {
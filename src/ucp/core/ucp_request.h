@@ -37,6 +37,7 @@ enum {
     UCP_REQUEST_FLAG_COMPLETED             = UCS_BIT(0),
     UCP_REQUEST_FLAG_RELEASED              = UCS_BIT(1),
     UCP_REQUEST_FLAG_PROTO_SEND            = UCS_BIT(2),
+    UCP_REQUEST_FLAG_PERSISTENT            = UCS_BIT(3),
     UCP_REQUEST_FLAG_SYNC_LOCAL_COMPLETED  = UCS_BIT(4),
     UCP_REQUEST_FLAG_SYNC_REMOTE_COMPLETED = UCS_BIT(5),
     UCP_REQUEST_FLAG_CALLBACK              = UCS_BIT(6),
@@ -106,8 +107,11 @@ enum {
                                                          because UCT AM callback is still in
                                                          the call stack and descriptor is not
                                                          initialized yet. */
-    UCP_RECV_DESC_FLAG_RELEASED         = UCS_BIT(10) /* Indicates that the descriptor was
-                                                         released and cannot be used. */
+    UCP_RECV_DESC_FLAG_RELEASED         = UCS_BIT(10), /* Indicates that the descriptor was
+                                                          released and cannot be used. */
+    UCP_RECV_DESC_FLAG_AM_RECV_POOL     = UCS_BIT(11)  /* Descriptor is a part of AM receive
+                                                          pool buffer and must be returned
+                                                          to the pool */
 };
 
 
@@ -352,6 +356,11 @@ struct ucp_request {
                     uint64_t              result;      /* Atomic result */
                     void                  *reply_buffer;
                     uct_atomic_op_t       uct_op;      /* Requested UCT AMO */
+                    /* Software atomic queued on a batch */
+                    struct {
+                        uint8_t           size;
+                        uint8_t           fetch;
+                    } batched;
                 } amo;
 
                 struct {
@@ -464,6 +473,43 @@ struct ucp_request {
 };
 
 
+/**
+ * Persistent operation, which is launched by ucp_request_start(). Every start
+ * runs the operation on the persistent request itself, which points to this
+ * descriptor by its user_data field.
+ */
+typedef struct ucp_request_persistent {
+    /* Launch a new operation with the cached parameters */
+    ucs_status_t            (*start)(ucp_request_t *req);
+    void                    *user_data;    /* User completion data */
+    uint32_t                op_attr_mask;  /* Operation attributes */
+    uint8_t                 mem_type;      /* Buffer memory type */
+    ucp_tag_t               tag;           /* Message tag */
+    /* Buffer registration kept between the starts, or NULL */
+    ucp_mem_h               memh;
+
+    union {
+        struct {
+            ucp_ep_h                 ep;
+            ucp_send_nbx_callback_t  cb; /* Completion callback */
+            /* Protocol selected by the last start, or NULL */
+            const ucp_proto_config_t *proto_config;
+            uint8_t                  sg_count;
+            ucp_datatype_iter_t      dt_iter; /* Initial buffer state */
+        } send;
+
+        struct {
+            ucp_worker_h                worker;
+            ucp_tag_recv_nbx_callback_t cb; /* Completion callback */
+            ucp_tag_t                   tag_mask;
+            void                        *buffer;
+            size_t                      count;
+            ucp_request_param_t         param; /* Receive parameters */
+        } recv;
+    };
+} ucp_request_persistent_t;
+
+
 /**
  * Unexpected receive descriptor. If it is initialized in the headroom of UCT
  * descriptor, the layout looks like the following:
@@ -13,6 +13,7 @@
 #include "ucp_mm.inl"
 
 #include <ucp/dt/dt.h>
+#include <ucs/profile/probe.h>
 #include <ucs/profile/profile.h>
 #include <ucs/datastruct/mpool.inl>
 #include <ucs/datastruct/mpool_set.inl>
@@ -61,6 +62,7 @@ UCS_PTR_MAP_IMPL(request, 0);
             ucs_trace_req("allocated request %p", _req); \
             ucp_request_reset_internal(_req, _worker); \
             UCS_PROFILE_REQUEST_NEW(_req, "ucp_request", 0); \
+            UCS_PROBE(request_new, _req); \
         } \
         _req; \
     })
@@ -78,6 +80,7 @@ UCS_PTR_MAP_IMPL(request, 0);
         (_req)->status = (_status); \
         \
         ucp_request_id_check(_req, ==, UCS_PTR_MAP_KEY_INVALID); \
+        UCS_PROBE(request_complete, _req, (int)(_status)); \
         \
         if (ucs_likely((_req)->flags & UCP_REQUEST_FLAG_CALLBACK)) { \
             (_req)->_cb((_req) + 1, (_status), ## __VA_ARGS__); \
@@ -120,6 +123,25 @@ UCS_PTR_MAP_IMPL(request, 0);
     })
 
 
+/* Same as ucp_request_get_param(), but take the request kept in the worker
+ * slot by a previous send which completed immediately, if there is one */
+#define ucp_request_get_send_param(_worker, _param, _failed) \
+    ({ \
+        ucp_request_t *___req = (_worker)->req_slot; \
+        if (ucs_likely((___req != NULL) && \
+                       !((_param)->op_attr_mask & UCP_OP_ATTR_FIELD_REQUEST))) { \
+            (_worker)->req_slot = NULL; \
+            ucs_trace_req("reused request %p", ___req); \
+            ucp_request_reset_internal(___req, _worker); \
+            UCS_PROFILE_REQUEST_NEW(___req, "ucp_request", 0); \
+            UCS_PROBE(request_new, ___req); \
+        } else { \
+            ___req = ucp_request_get_param(_worker, _param, _failed); \
+        } \
+        ___req; \
+    })
+
+
 #define ucp_request_id_check(_req, _cmp, _id) \
     ucs_assertv((_req)->id _cmp (_id), "req=%p req->id=0x%" PRIx64 " id=0x%" \
                 PRIx64, \
@@ -134,6 +156,14 @@ UCS_PTR_MAP_IMPL(request, 0);
     }
 
 
+#define ucp_request_put_send_param(_worker, _param, _req) \
+    if (!((_param)->op_attr_mask & UCP_OP_ATTR_FIELD_REQUEST)) { \
+        ucp_request_put_send(_worker, _req); \
+    } else { \
+        ucp_request_id_check(_req, ==, UCS_PTR_MAP_KEY_INVALID); \
+    }
+
+
 #define ucp_request_cb_param(_param, _req, _cb, ...) \
     if ((_param)->op_attr_mask & UCP_OP_ATTR_FIELD_CALLBACK) { \
         (_param)->cb._cb((_req) + 1, (_req)->status, ##__VA_ARGS__, \
@@ -162,6 +192,19 @@ UCS_PTR_MAP_IMPL(request, 0);
     }
 
 
+/* Same as ucp_request_imm_cmpl_param() for a send request, which is kept in
+ * the worker slot instead of being returned to the memory pool */
+#define ucp_request_send_imm_cmpl_param(_worker, _param, _req) \
+    if ((_param)->op_attr_mask & UCP_OP_ATTR_FLAG_NO_IMM_CMPL) { \
+        return ucp_request_prevent_imm_cmpl(_param, _req, send); \
+    } \
+    { \
+        ucs_status_t _status = (_req)->status; \
+        ucp_request_put_send_param(_worker, _param, _req); \
+        return UCS_STATUS_PTR(_status); \
+    }
+
+
 #define UCP_REQUEST_PARAM_FIELD(_param, _flag, _field, _default_value) \
     ((_param)->op_attr_mask & UCP_OP_ATTR_FIELD_##_flag) ? \
             (_param)->_field : (_default_value)
@@ -186,7 +229,9 @@ UCS_PTR_MAP_IMPL(request, 0);
     }
 
 
-#define UCP_REQUEST_CHECK_PARAM(_param) \
+/* Check the request parameters, and fail if any of the _invalid_fields, which
+ * are not supported by the operation, is set */
+#define UCP_REQUEST_CHECK_PARAM_FIELDS(_param, _invalid_fields) \
     if (ENABLE_PARAMS_CHECK) { \
         if (((_param)->op_attr_mask & UCP_OP_ATTR_FIELD_MEMORY_TYPE) && \
             ((_param)->memory_type > UCS_MEMORY_TYPE_LAST)) { \
@@ -202,9 +247,22 @@ UCS_PTR_MAP_IMPL(request, 0);
                       "UCP_OP_ATTR_FLAG_MULTI_SEND are mutually exclusive"); \
             return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM); \
         } \
+        \
+        if ((_param)->op_attr_mask & (_invalid_fields) & \
+            UCP_OP_ATTR_FIELD_COUNTER) { \
+            ucs_error("completion counter is supported only by put and get" \
+                      " operations"); \
+            return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM); \
+        } \
     }
 
 
+/* Completion counters are supported only by the operations which check the
+ * parameters with UCP_REQUEST_CHECK_PARAM_FIELDS */
+#define UCP_REQUEST_CHECK_PARAM(_param) \
+    UCP_REQUEST_CHECK_PARAM_FIELDS(_param, UCP_OP_ATTR_FIELD_COUNTER)
+
+
 #if UCS_ENABLE_ASSERT
 #  define UCP_REQUEST_RESET(_req) \
     (_req)->send.uct.func = \
@@ -240,6 +298,22 @@ ucp_request_put(ucp_request_t *req)
     ucs_mpool_put_inline(req);
 }
 
+static UCS_F_ALWAYS_INLINE void
+ucp_request_put_send(ucp_worker_h worker, ucp_request_t *req)
+{
+    if (worker->req_slot != NULL) {
+        ucp_request_put(req);
+        return;
+    }
+
+    ucs_trace_req("put request %p to worker slot", req);
+    ucs_assert(ucs_mpool_obj_owner(req) == &worker->req_mp);
+    ucp_request_id_check(req, ==, UCS_PTR_MAP_KEY_INVALID);
+    UCS_PROFILE_REQUEST_FREE(req);
+    UCP_REQUEST_RESET(req);
+    worker->req_slot = req;
+}
+
 static UCS_F_ALWAYS_INLINE void
 ucp_request_complete_send(ucp_request_t *req, ucs_status_t status)
 {
@@ -305,6 +379,7 @@ static int UCS_F_ALWAYS_INLINE ucp_request_try_send(ucp_request_t *req)
     /* coverity wrongly resolves (*req).send.uct.func to test_uct_pending::pending_send_op_ok */
     /* coverity[address_free] */
     status = req->send.uct.func(&req->send.uct);
+    UCS_PROBE(uct_send, req, req->send.lane, (int)status);
     if (status == UCS_OK) {
         /* Completed the operation, error also goes here */
         return 1;
@@ -799,6 +874,64 @@ ucp_request_param_user_data(const ucp_request_param_t *param)
     return UCP_REQUEST_PARAM_FIELD(param, USER_DATA, user_data, NULL);
 }
 
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_request_persistent_check_param(const ucp_request_param_t *param)
+{
+    if (param->op_attr_mask & UCP_OP_ATTR_FIELD_REQUEST) {
+        ucs_error("persistent request must be allocated by UCP");
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    if (!UCP_DT_IS_CONTIG(ucp_request_param_datatype(param))) {
+        /* The datatype state can't be shared by subsequent operations */
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    return UCS_OK;
+}
+
+/* Initialize a persistent request, which stays completed until started */
+static UCS_F_ALWAYS_INLINE ucp_request_persistent_t *
+ucp_request_persistent_init(ucp_request_t *req, const ucp_request_param_t *param,
+                            ucs_status_t (*start)(ucp_request_t*),
+                            ucp_tag_t tag, uint32_t flags)
+{
+    ucp_request_persistent_t *prst;
+
+    prst = (ucp_request_persistent_t*)ucs_malloc(sizeof(*prst),
+                                                 "ucp_request_persistent");
+    if (prst == NULL) {
+        return NULL;
+    }
+
+    prst->start        = start;
+    prst->user_data    = ucp_request_param_user_data(param);
+    prst->op_attr_mask = param->op_attr_mask;
+    prst->tag          = tag;
+    prst->memh         = NULL;
+    req->flags         = UCP_REQUEST_FLAG_PERSISTENT |
+                         UCP_REQUEST_FLAG_COMPLETED | flags;
+    req->status        = UCS_OK;
+    req->user_data     = prst;
+    return prst;
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_request_persistent_memh_put(ucp_request_persistent_t *prst)
+{
+    if (prst->memh != NULL) {
+        ucp_memh_put(prst->memh);
+        prst->memh = NULL;
+    }
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_request_persistent_free(ucp_request_persistent_t *prst)
+{
+    ucp_request_persistent_memh_put(prst);
+    ucs_free(prst);
+}
+
 static UCS_F_ALWAYS_INLINE ucs_memory_type_t
 ucp_request_get_memory_type(ucp_context_h context, const void *address,
                             size_t count, ucp_datatype_t datatype,
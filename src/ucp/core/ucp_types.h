@@ -23,6 +23,7 @@
 #define UCP_WORKER_ADDRESS_NAME_MAX  32 /* Worker address name for debugging */
 #define UCP_MIN_BCOPY                64 /* Minimal size for bcopy */
 #define UCP_FEATURE_AMO              (UCP_FEATURE_AMO32|UCP_FEATURE_AMO64)
+#define UCP_AMO_SW_BATCH_MAX         64 /* Maximal software atomics in one AM */
 
 
 /* Resources */
@@ -201,6 +202,10 @@ typedef enum {
                                           defined AM */
     UCP_AM_ID_AM_SINGLE_REPLY   =  26, /* Single fragment user defined AM
                                           carrying remote ep for reply */
+    UCP_AM_ID_ATOMIC_BATCH_REQ  =  27, /* Batch of remote memory atomic
+                                          requests */
+    UCP_AM_ID_ATOMIC_BATCH_REP  =  28, /* Aggregated reply to a batch of
+                                          atomic requests */
     UCP_AM_ID_LAST
 } ucp_am_id_t;
 
@@ -228,6 +233,17 @@ typedef enum {
 } ucp_fence_mode_t;
 
 
+/**
+ * NUMA placement policy of worker memory pools.
+ */
+typedef enum {
+    UCP_NUMA_POLICY_NONE,   /* Use the memory policy of the calling thread */
+    UCP_NUMA_POLICY_LOCAL,  /* Use the node of the thread creating the worker */
+    UCP_NUMA_POLICY_DEVICE, /* Use the node closest to the network devices */
+    UCP_NUMA_POLICY_LAST
+} ucp_numa_policy_t;
+
+
 /**
  * Communication scheme in RNDV protocol.
  */
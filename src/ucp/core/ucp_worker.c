@@ -47,6 +47,9 @@
 #define UCP_WORKER_USAGE_TRACKER_REMOVE_THRESHOLD     0.2
 #define UCP_WORKER_USAGE_TRACKER_EXP_DECAY_MULTIPLIER 0.8
 #define UCP_WORKER_USAGE_TRACKER_EXP_DECAY_ADDER      0.2
+/* Score below which an endpoint is considered idle, reached after about 15
+ * rounds without usage */
+#define UCP_WORKER_USAGE_TRACKER_IDLE_SCORE           0.01
 
 
 #define UCP_WIFACE_FMT "iface %p (" UCT_TL_RESOURCE_DESC_FMT ")"
@@ -1071,6 +1074,195 @@ ucp_worker_select_best_ifaces(ucp_worker_h worker, ucp_tl_bitmap_t *tl_bitmap_p)
     }
 }
 
+typedef struct {
+    ucp_worker_h       worker;
+    unsigned           num_ifaces;
+    ucp_rsc_index_t    *tl_ids;     /* Resource index of every iface */
+    ucs_status_t       *statuses;   /* Open status of every iface */
+    ucp_md_index_t     md_indices[UCP_MAX_MDS]; /* MDs which have ifaces */
+    unsigned           num_mds;
+    volatile uint32_t  next_md;     /* Next MD to open ifaces on */
+} ucp_worker_iface_open_ctx_t;
+
+
+static void *ucp_worker_iface_open_thread(void *arg)
+{
+    ucp_worker_iface_open_ctx_t *ctx = arg;
+    ucp_context_h context            = ctx->worker->context;
+    ucp_rsc_index_t tl_id;
+    ucp_md_index_t md_index;
+    unsigned iface_id;
+    uint32_t md_id;
+
+    /* Ifaces of the same MD share its state, so the MDs are the work items */
+    while ((md_id = ucs_atomic_fadd32(&ctx->next_md, 1)) < ctx->num_mds) {
+        md_index = ctx->md_indices[md_id];
+        for (iface_id = 0; iface_id < ctx->num_ifaces; ++iface_id) {
+            tl_id = ctx->tl_ids[iface_id];
+            if (context->tl_rscs[tl_id].md_index != md_index) {
+                continue;
+            }
+
+            ctx->statuses[iface_id] = ucp_worker_iface_open(
+                    ctx->worker, tl_id, &ctx->worker->ifaces[iface_id]);
+            if (ctx->statuses[iface_id] != UCS_OK) {
+                break;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Open the ifaces of all resources in @a tl_bitmap, in the order of the
+ * bitmap, using up to IFACE_OPEN_THREADS threads (including the calling one).
+ * On failure, some of the ifaces may remain open.
+ */
+static ucs_status_t
+ucp_worker_open_ifaces(ucp_worker_h worker, const ucp_tl_bitmap_t *tl_bitmap)
+{
+    ucp_context_h context = worker->context;
+    ucp_worker_iface_open_ctx_t ctx;
+    ucp_md_map_t md_map;
+    ucp_md_index_t md_index;
+    unsigned i, num_threads, num_started;
+    ucp_rsc_index_t tl_id;
+    ucs_time_t start_time;
+    pthread_t *threads;
+    ucs_status_t status;
+
+    start_time     = ucs_get_time();
+    ctx.worker     = worker;
+    ctx.num_ifaces = 0;
+    ctx.tl_ids     = ucs_alloca(worker->num_ifaces * sizeof(*ctx.tl_ids));
+    ctx.statuses   = ucs_alloca(worker->num_ifaces * sizeof(*ctx.statuses));
+    ctx.num_mds    = 0;
+    ctx.next_md    = 0;
+    md_map         = 0;
+    UCS_STATIC_BITMAP_FOR_EACH_BIT(tl_id, tl_bitmap) {
+        md_index                     = context->tl_rscs[tl_id].md_index;
+        ctx.statuses[ctx.num_ifaces] = UCS_OK;
+        ctx.tl_ids[ctx.num_ifaces++] = tl_id;
+        if (!(md_map & UCS_BIT(md_index))) {
+            md_map                       |= UCS_BIT(md_index);
+            ctx.md_indices[ctx.num_mds++] = md_index;
+        }
+    }
+
+    num_threads = ucs_min(context->config.ext.iface_open_threads, ctx.num_mds);
+    num_started = 0;
+    threads     = NULL;
+    if (num_threads > 1) {
+        threads = ucs_alloca((num_threads - 1) * sizeof(*threads));
+        for (i = 0; i < num_threads - 1; ++i) {
+            status = ucs_pthread_create(&threads[i],
+                                        ucp_worker_iface_open_thread, &ctx,
+                                        "ucp_iface_open");
+            if (status != UCS_OK) {
+                /* Proceed with the threads which were started */
+                break;
+            }
+
+            ++num_started;
+        }
+    }
+
+    ucp_worker_iface_open_thread(&ctx);
+
+    for (i = 0; i < num_started; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    ucs_debug("worker %p: opened %u ifaces on %u mds using %u threads in "
+              "%.3f ms", worker, ctx.num_ifaces, ctx.num_mds, num_started + 1,
+              ucs_time_to_msec(ucs_get_time() - start_time));
+
+    for (i = 0; i < ctx.num_ifaces; ++i) {
+        if (ctx.statuses[i] != UCS_OK) {
+            return ctx.statuses[i];
+        }
+    }
+
+    return UCS_OK;
+}
+
+/* Returns the NUMA node shared by most of the network devices of the context */
+static ucs_numa_node_t ucp_worker_numa_node_of_devices(ucp_context_h context)
+{
+    ucs_numa_node_t node, best_node = UCS_NUMA_NODE_UNDEFINED;
+    unsigned count, best_count      = 0;
+    ucs_sys_device_t devices[UCP_MAX_RESOURCES];
+    ucs_sys_device_t sys_dev;
+    unsigned num_devices = 0;
+    ucp_rsc_index_t tl_id;
+    unsigned i, j;
+
+    /* A device may have several transport resources, count it only once */
+    for (tl_id = 0; tl_id < context->num_tls; ++tl_id) {
+        sys_dev = context->tl_rscs[tl_id].tl_rsc.sys_device;
+        if ((context->tl_rscs[tl_id].tl_rsc.dev_type != UCT_DEVICE_TYPE_NET) ||
+            (sys_dev == UCS_SYS_DEVICE_ID_UNKNOWN)) {
+            continue;
+        }
+
+        for (i = 0; i < num_devices; ++i) {
+            if (devices[i] == sys_dev) {
+                break;
+            }
+        }
+
+        if (i == num_devices) {
+            devices[num_devices++] = sys_dev;
+        }
+    }
+
+    for (i = 0; i < num_devices; ++i) {
+        node = ucs_topo_sys_device_get_numa_node(devices[i]);
+        if (node == UCS_NUMA_NODE_UNDEFINED) {
+            continue;
+        }
+
+        count = 0;
+        for (j = 0; j < num_devices; ++j) {
+            if (ucs_topo_sys_device_get_numa_node(devices[j]) == node) {
+                ++count;
+            }
+        }
+
+        if (count > best_count) {
+            best_count = count;
+            best_node  = node;
+        }
+    }
+
+    return best_node;
+}
+
+static void ucp_worker_numa_node_init(ucp_worker_h worker)
+{
+    ucp_context_h context = worker->context;
+
+    switch (context->config.ext.numa_policy) {
+    case UCP_NUMA_POLICY_DEVICE:
+        worker->numa_node = ucp_worker_numa_node_of_devices(context);
+        if (worker->numa_node != UCS_NUMA_NODE_UNDEFINED) {
+            break;
+        }
+        /* Fall through */
+    case UCP_NUMA_POLICY_LOCAL:
+        worker->numa_node = ucs_numa_node_of_current_cpu();
+        break;
+    default:
+        worker->numa_node = UCS_NUMA_NODE_UNDEFINED;
+        break;
+    }
+
+    ucs_debug("worker %p: numa policy %s, node %d", worker,
+              ucp_numa_policy_names[context->config.ext.numa_policy],
+              worker->numa_node);
+}
+
 /**
  * @brief  Open all resources as interfaces on this worker
  *
@@ -1113,14 +1305,10 @@ static ucs_status_t ucp_worker_add_resource_ifaces(ucp_worker_h worker)
     }
 
     worker->num_ifaces = num_ifaces;
-    iface_id           = 0;
 
-    UCS_STATIC_BITMAP_FOR_EACH_BIT(tl_id, &tl_bitmap) {
-        status = ucp_worker_iface_open(worker, tl_id,
-                                       &worker->ifaces[iface_id++]);
-        if (status != UCS_OK) {
-            goto err_close_ifaces;
-        }
+    status = ucp_worker_open_ifaces(worker, &tl_bitmap);
+    if (status != UCS_OK) {
+        goto err_close_ifaces;
     }
 
     if (UCS_STATIC_BITMAP_IS_ZERO(ctx_tl_bitmap)) {
@@ -1320,9 +1508,11 @@ ucs_status_t ucp_worker_iface_open(ucp_worker_h worker, ucp_rsc_index_t tl_id,
     uct_iface_config_t *iface_config;
     ucp_worker_iface_t *wiface;
     ucs_sys_dev_distance_t distance;
+    ucs_time_t start_time;
     ucs_status_t status;
 
-    wiface = ucs_calloc(1, sizeof(*wiface), "ucp_iface");
+    start_time = ucs_get_time();
+    wiface     = ucs_calloc(1, sizeof(*wiface), "ucp_iface");
     if (wiface == NULL) {
         return UCS_ERR_NO_MEMORY;
     }
@@ -1372,6 +1562,11 @@ ucs_status_t ucp_worker_iface_open(ucp_worker_h worker, ucp_rsc_index_t tl_id,
     iface_params.mode.device.tl_name  = resource->tl_rsc.tl_name;
     iface_params.mode.device.dev_name = resource->tl_rsc.dev_name;
 
+    if (worker->numa_node != UCS_NUMA_NODE_UNDEFINED) {
+        iface_params.field_mask |= UCT_IFACE_PARAM_FIELD_NUMA_NODE;
+        iface_params.numa_node   = worker->numa_node;
+    }
+
 
     if (context->config.features & UCP_FEATURE_TAG) {
         iface_params.eager_arg     = iface_params.rndv_arg = wiface;
@@ -1435,7 +1630,8 @@ ucs_status_t ucp_worker_iface_open(ucp_worker_h worker, ucp_rsc_index_t tl_id,
               tl_id, wiface->iface, UCT_TL_RESOURCE_DESC_ARG(&resource->tl_rsc),
               worker);
 
-    *wiface_p = wiface;
+    wiface->open_time = ucs_get_time() - start_time;
+    *wiface_p         = wiface;
 
     return UCS_OK;
 
@@ -1931,12 +2127,15 @@ static ucs_status_t ucp_worker_init_mpools(ucp_worker_h worker)
     mp_params.elems_per_chunk = 128;
     mp_params.ops             = &ucp_request_mpool_ops;
     mp_params.name            = "ucp_requests";
+    mp_params.numa_node       = worker->numa_node;
     /* Create memory pool for requests */
     status = ucs_mpool_init(&mp_params, &worker->req_mp);
     if (status != UCS_OK) {
         goto err;
     }
 
+    worker->req_slot = NULL;
+
     if (worker->context->config.ext.rkey_mpool_max_md >= 0) {
         /* Create memory pool for small rkeys.
          *
@@ -1973,6 +2172,7 @@ static ucs_status_t ucp_worker_init_mpools(ucp_worker_h worker)
         mp_params.elems_per_chunk = 128;
         mp_params.ops             = &ucp_rkey_mpool_ops;
         mp_params.name            = "ucp_rkeys";
+        mp_params.numa_node       = worker->numa_node;
         status = ucs_mpool_init(&mp_params, &worker->rkey_mp);
         if (status != UCS_OK) {
             goto err_req_mp_cleanup;
@@ -1985,6 +2185,7 @@ static ucs_status_t ucp_worker_init_mpools(ucp_worker_h worker)
     mp_params.elems_per_chunk = 128;
     mp_params.ops             = &ucp_reg_mpool_ops;
     mp_params.name            = "ucp_reg_bufs";
+    mp_params.numa_node       = worker->numa_node;
     /* Create memory pool of bounce buffers */
     status = ucs_mpool_init(&mp_params, &worker->reg_mp);
     if (status != UCS_OK) {
@@ -2003,6 +2204,8 @@ static ucs_status_t ucp_worker_init_mpools(ucp_worker_h worker)
         if (status != UCS_OK) {
             goto err_reg_mp_cleanup;
         }
+
+        ucs_mpool_set_numa_node(&worker->am_mps, worker->numa_node);
         worker->flags |= UCP_WORKER_FLAG_AM_MPOOL_INITIALIZED;
     }
 
@@ -2041,6 +2244,9 @@ static void ucp_worker_destroy_mpools(ucp_worker_h worker)
     if (worker->context->config.ext.rkey_mpool_max_md >= 0) {
         ucs_mpool_cleanup(&worker->rkey_mp, 1);
     }
+    if (worker->req_slot != NULL) {
+        ucs_mpool_put(worker->req_slot);
+    }
     ucs_mpool_cleanup(&worker->req_mp,
                       !(worker->flags & UCP_WORKER_FLAG_IGNORE_REQUEST_LEAK));
 }
@@ -2308,6 +2514,14 @@ void ucp_worker_create_vfs(ucp_context_h context, ucp_worker_h worker)
                             (void*)ucs_thread_mode_names[thread_mode],
                             UCS_VFS_TYPE_STRING, "thread_mode");
 
+    ucs_vfs_obj_add_ro_file(worker, ucp_worker_vfs_show_primitive,
+                            (void*)ucp_numa_policy_names[
+                                    context->config.ext.numa_policy],
+                            UCS_VFS_TYPE_STRING, "numa/policy");
+    ucs_vfs_obj_add_ro_file(worker, ucp_worker_vfs_show_primitive,
+                            &worker->numa_node, UCS_VFS_TYPE_I16,
+                            "numa/node");
+
     ucs_vfs_obj_add_ro_file(worker, ucp_worker_vfs_show_primitive,
                             &worker->num_all_eps, UCS_VFS_TYPE_U32,
                             "num_all_eps");
@@ -2378,6 +2592,37 @@ static void ucp_worker_set_max_am_header(ucp_worker_h worker)
                             ucs_min(max_am_header, UINT32_MAX) : 0ul;
 }
 
+static unsigned ucp_worker_release_idle_lanes_progress(void *arg)
+{
+    ucp_worker_h worker = arg;
+    ucs_status_t status;
+    double score;
+    ucp_ep_h ep;
+
+    UCS_ASYNC_BLOCK(&worker->async);
+    kh_foreach_key(&worker->cold_lanes_hash, ep, {
+        /* The tracker drops endpoints which were not used recently, whether
+         * they were promoted or not, and the score of an idle endpoint which
+         * is still tracked decays on every round */
+        status = ucs_usage_tracker_get_score(worker->usage_tracker.handle, ep,
+                                             &score);
+        if ((status != UCS_OK) ||
+            (score < UCP_WORKER_USAGE_TRACKER_IDLE_SCORE)) {
+            ucp_ep_release_idle_lanes(ep);
+        }
+    })
+    UCS_ASYNC_UNBLOCK(&worker->async);
+
+    return 1;
+}
+
+static int
+ucp_worker_release_idle_lanes_filter(const ucs_callbackq_elem_t *elem,
+                                     void *arg)
+{
+    return elem->cb == ucp_worker_release_idle_lanes_progress;
+}
+
 void ucp_worker_track_ep_usage_always(ucp_request_t *req)
 {
     ucp_worker_h worker          = req->send.ep->worker;
@@ -2402,6 +2647,14 @@ void ucp_worker_track_ep_usage_always(ucp_request_t *req)
     if ((worker->usage_tracker.rounds_count %
          config->dynamic_tl_progress_factor) == 0) {
         ucs_usage_tracker_progress(worker->usage_tracker.handle);
+
+        if (config->ep_release_idle_lanes &&
+            (kh_size(&worker->cold_lanes_hash) > 0)) {
+            /* Transport endpoints cannot be destroyed from the send path */
+            ucs_callbackq_add_oneshot(&worker->uct->progress_q, worker,
+                                      ucp_worker_release_idle_lanes_progress,
+                                      worker);
+        }
     }
 }
 
@@ -2443,7 +2696,10 @@ static void ucp_worker_usage_tracker_destroy(ucp_worker_h worker)
         return;
     }
 
+    ucs_callbackq_remove_oneshot(&worker->uct->progress_q, worker,
+                                 ucp_worker_release_idle_lanes_filter, NULL);
     ucs_usage_tracker_destroy(worker->usage_tracker.handle);
+    worker->usage_tracker.handle = NULL;
 }
 
 ucs_status_t ucp_worker_create(ucp_context_h context,
@@ -2478,6 +2734,7 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
     ucs_list_head_init(&worker->internal_eps);
     kh_init_inplace(ucp_worker_rkey_config, &worker->rkey_config_hash);
     kh_init_inplace(ucp_worker_discard_uct_ep_hash, &worker->discard_uct_ep_hash);
+    kh_init_inplace(ucp_ep_cold_lanes_hash, &worker->cold_lanes_hash);
     worker->counters.ep_creations         = 0;
     worker->counters.ep_creation_failures = 0;
     worker->counters.ep_closures          = 0;
@@ -2597,6 +2854,8 @@ ucs_status_t ucp_worker_create(ucp_context_h context,
     ucs_conn_match_init(&worker->conn_match_ctx, sizeof(uint64_t),
                         UCP_EP_MATCH_CONN_SN_MAX, &ucp_ep_match_ops);
 
+    ucp_worker_numa_node_init(worker);
+
     /* Open all resources as interfaces on this worker */
     status = ucp_worker_add_resource_ifaces(worker);
     if (status != UCS_OK) {
@@ -2687,6 +2946,7 @@ err_free:
     ucs_strided_alloc_cleanup(&worker->ep_alloc);
     kh_destroy_inplace(ucp_worker_discard_uct_ep_hash,
                        &worker->discard_uct_ep_hash);
+    kh_destroy_inplace(ucp_ep_cold_lanes_hash, &worker->cold_lanes_hash);
     kh_destroy_inplace(ucp_worker_rkey_config, &worker->rkey_config_hash);
     ucp_worker_destroy_configs(worker);
     ucs_free(worker);
@@ -2937,6 +3197,7 @@ void ucp_worker_destroy(ucp_worker_h worker)
     ucs_strided_alloc_cleanup(&worker->ep_alloc);
     kh_destroy_inplace(ucp_worker_discard_uct_ep_hash,
                        &worker->discard_uct_ep_hash);
+    kh_destroy_inplace(ucp_ep_cold_lanes_hash, &worker->cold_lanes_hash);
     kh_destroy_inplace(ucp_worker_rkey_config, &worker->rkey_config_hash);
     ucp_worker_destroy_configs(worker);
     ucs_free(worker);
@@ -3282,7 +3543,8 @@ void ucp_worker_print_info(ucp_worker_h worker, FILE *stream)
 {
     ucp_context_h context = worker->context;
     ucp_worker_cfg_index_t rkey_cfg_index;
-    ucp_rsc_index_t rsc_index;
+    ucp_rsc_index_t rsc_index, iface_id;
+    ucp_worker_iface_t *wiface;
     ucs_string_buffer_t strb;
     ucp_address_t *address;
     size_t address_length;
@@ -3303,6 +3565,19 @@ void ucp_worker_print_info(ucp_worker_h worker, FILE *stream)
         fprintf(stream, "# <failed to get address>\n");
     }
 
+    fprintf(stream, "#             numa policy: %s node %d\n",
+            ucp_numa_policy_names[context->config.ext.numa_policy],
+            worker->numa_node);
+
+    for (iface_id = 0; iface_id < worker->num_ifaces; ++iface_id) {
+        wiface    = worker->ifaces[iface_id];
+        rsc_index = wiface->rsc_index;
+        fprintf(stream, "#         iface open time: %.3f ms %d:"
+                UCT_TL_RESOURCE_DESC_FMT "\n",
+                ucs_time_to_msec(wiface->open_time), rsc_index,
+                UCT_TL_RESOURCE_DESC_ARG(&context->tl_rscs[rsc_index].tl_rsc));
+    }
+
     if (context->config.features & UCP_FEATURE_AMO) {
         fprintf(stream, "#                 atomics: ");
         first = 1;
@@ -3678,6 +3953,12 @@ ucs_status_t ucp_worker_discard_uct_ep(ucp_ep_h ucp_ep, uct_ep_h uct_ep,
 
     uct_ep_pending_purge(uct_ep, purge_cb, purge_arg);
 
+    if (ucp_ep_is_lane_released(uct_ep)) {
+        /* Released lane has no outstanding operations */
+        uct_ep_destroy(uct_ep);
+        return UCS_OK;
+    }
+
     if (ucp_wireup_ep_test(uct_ep)) {
         uct_ep = ucp_worker_discard_wireup_ep(ucp_ep, ucp_wireup_ep(uct_ep),
                                               ep_flush_flags);
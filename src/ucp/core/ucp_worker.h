@@ -253,6 +253,7 @@ struct ucp_worker_iface {
     unsigned                      post_count;    /* Counts uncompleted requests which are
                                                     offloaded to the transport */
     uint8_t                       flags;         /* Interface flags */
+    ucs_time_t                    open_time;     /* Time it took to open */
 };
 
 
@@ -282,6 +283,10 @@ typedef struct ucp_worker {
     uint64_t                         client_id;           /* Worker client id for wireup */
     uct_worker_h                     uct;                 /* UCT worker handle */
     ucs_mpool_t                      req_mp;              /* Memory pool for requests */
+    ucp_request_t                    *req_slot;           /* Request from req_mp kept by the
+                                                             last send which completed
+                                                             immediately, reused by the next
+                                                             send */
     ucs_mpool_t                      rkey_mp;             /* Pool for small memory keys */
     ucp_tl_bitmap_t                  atomic_tls;          /* Which resources can be used for atomics */
 
@@ -333,9 +338,13 @@ typedef struct ucp_worker {
 
     ucs_cpu_set_t                    cpu_mask;            /* Save CPU mask for subsequent calls to
                                                              ucp_worker_listen */
+    ucs_numa_node_t                  numa_node;           /* Node of the memory pools,
+                                                             or UCS_NUMA_NODE_UNDEFINED */
 
     ucp_worker_rkey_config_hash_t    rkey_config_hash;    /* RKEY config key -> index */
     ucp_worker_discard_uct_ep_hash_t discard_uct_ep_hash; /* Hash of discarded UCT EPs */
+    khash_t(ucp_ep_cold_lanes_hash)  cold_lanes_hash;     /* Lanes which can be released
+                                                             while their EP is idle */
     UCS_PTR_MAP_T(ep)                ep_map;              /* UCP ep key to ptr
                                                              mapping */
     UCS_PTR_MAP_T(request)           request_map;         /* UCP requests key to
@@ -22,6 +22,7 @@
     _macro(ucp_reconfig_proto) \
     _macro(ucp_get_amo_post_proto) \
     _macro(ucp_get_amo_fetch_proto) \
+    _macro(ucp_amo_rkey_ptr_proto) \
     _macro(ucp_get_am_bcopy_proto) \
     _macro(ucp_get_offload_bcopy_proto) \
     _macro(ucp_get_offload_zcopy_proto) \
@@ -29,6 +30,7 @@
     _macro(ucp_put_offload_short_proto) \
     _macro(ucp_put_offload_bcopy_proto) \
     _macro(ucp_put_offload_zcopy_proto) \
+    _macro(ucp_rma_rkey_ptr_proto) \
     _macro(ucp_eager_bcopy_multi_proto) \
     _macro(ucp_eager_sync_bcopy_multi_proto) \
     _macro(ucp_eager_zcopy_multi_proto) \
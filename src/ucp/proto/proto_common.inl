@@ -250,7 +250,7 @@ static UCS_F_ALWAYS_INLINE ucs_status_ptr_t ucp_proto_request_send_op_common(
     UCS_PROFILE_CALL_VOID(ucp_request_send, req);
     if (req->flags & UCP_REQUEST_FLAG_COMPLETED) {
         /* coverity[offset_free] */
-        ucp_request_imm_cmpl_param(param, req, send);
+        ucp_request_send_imm_cmpl_param(worker, param, req);
     }
 
     ucp_request_set_send_callback_param(param, req, send);
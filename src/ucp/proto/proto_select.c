@@ -16,6 +16,7 @@
 #include <ucp/core/ucp_context.h>
 #include <ucp/dt/dt.h>
 #include <ucs/datastruct/dynamic_bitmap.h>
+#include <ucs/profile/probe.h>
 
 #include <ucp/core/ucp_worker.inl>
 
@@ -537,6 +538,9 @@ ucp_proto_select_lookup_slow(ucp_worker_h worker,
         goto out;
     }
 
+    UCS_PROBE(proto_select, worker, ep_cfg_index, rkey_cfg_index,
+              ucp_proto_select_op_id(select_param), key.u64);
+
     status = ucp_proto_select_elem_init(worker, internal, ep_cfg_index,
                                         rkey_cfg_index, select_param,
                                         &tmp_select_elem);
@@ -70,14 +70,208 @@ static size_t ucp_amo_sw_fetch_pack_cb(void *dest, void *arg)
     return ucp_amo_sw_pack(dest, req, 1, req->send.length);
 }
 
+static UCS_F_ALWAYS_INLINE size_t
+ucp_amo_sw_packed_size(const ucp_request_t *req, size_t size)
+{
+    return sizeof(ucp_atomic_req_hdr_t) +
+           ((req->send.amo.uct_op == UCT_ATOMIC_OP_CSWAP) ? (2 * size) : size);
+}
+
+static UCS_F_ALWAYS_INLINE size_t
+ucp_amo_sw_req_length(const ucp_atomic_req_hdr_t *atomicreqh)
+{
+    return sizeof(*atomicreqh) +
+           ((atomicreqh->opcode == UCT_ATOMIC_OP_CSWAP) ?
+            (2 * atomicreqh->length) : atomicreqh->length);
+}
+
+/*
+ * Batching of software atomics: when an atomic request cannot be sent because
+ * the endpoint is out of resources, it becomes the carrier of a batch. Atomics
+ * issued on the same endpoint while the carrier is pending are queued on it,
+ * instead of being added to the pending queue one by one. When resources are
+ * available, the carrier sends the queued atomics in ATOMIC_BATCH_REQ messages,
+ * and finally itself.
+ */
+typedef struct {
+    ucp_request_t *reqs[UCP_AMO_SW_BATCH_MAX];
+    uint8_t       sizes[UCP_AMO_SW_BATCH_MAX];
+    uint8_t       fetch[UCP_AMO_SW_BATCH_MAX];
+    unsigned      count;
+    unsigned      num_fetch;
+} ucp_amo_sw_batch_t;
+
+static void ucp_amo_sw_batch_push(ucp_amo_sw_batch_t *batch,
+                                  ucp_request_t *req, int fetch, size_t size)
+{
+    batch->reqs[batch->count]  = req;
+    batch->sizes[batch->count] = size;
+    batch->fetch[batch->count] = fetch;
+    batch->num_fetch          += fetch;
+    ++batch->count;
+}
+
+static size_t ucp_amo_sw_batch_pack_cb(void *dest, void *arg)
+{
+    ucp_amo_sw_batch_t *batch          = arg;
+    ucp_atomic_batch_req_hdr_t *batchh = dest;
+    void *atomich                      = batchh + 1;
+    unsigned i;
+
+    batchh->count     = batch->count;
+    batchh->num_fetch = batch->num_fetch;
+    for (i = 0; i < batch->count; ++i) {
+        atomich = UCS_PTR_BYTE_OFFSET(atomich,
+                                      ucp_amo_sw_pack(atomich, batch->reqs[i],
+                                                      batch->fetch[i],
+                                                      batch->sizes[i]));
+    }
+
+    return UCS_PTR_BYTE_DIFF(dest, atomich);
+}
+
+static ucs_status_t
+ucp_amo_sw_batch_send(ucp_request_t *req, int fetch, size_t size)
+{
+    ucp_ep_h ep             = req->send.ep;
+    ucs_queue_head_t *queue = &ep->ext->amo_batch_q;
+    unsigned max_count      = ep->worker->context->config.ext.sw_amo_batch;
+    size_t max_length       = ucp_ep_get_max_bcopy(ep, req->send.lane);
+    size_t length           = sizeof(ucp_atomic_batch_req_hdr_t);
+    ucp_amo_sw_batch_t batch;
+    ucp_request_t *freq;
+    ssize_t packed_len;
+    ucs_status_t status;
+    int last;
+    unsigned i;
+
+    ucs_assert(ep->ext->amo_batch == req);
+
+    /* Pack the queued requests first, and the carrier itself only if all of
+     * them fit in one message. Otherwise the carrier stays pending and sends
+     * the rest of the queue in the next message. */
+    batch.count     = 0;
+    batch.num_fetch = 0;
+    while (!ucs_queue_is_empty(queue) && (batch.count < max_count)) {
+        freq = ucs_queue_head_elem_non_empty(queue, ucp_request_t,
+                                             send.uct.priv);
+        if ((length + ucp_amo_sw_packed_size(freq,
+                                             freq->send.amo.batched.size)) >
+            max_length) {
+            break;
+        }
+
+        ucs_queue_pull_non_empty(queue);
+        length += ucp_amo_sw_packed_size(freq, freq->send.amo.batched.size);
+        ucp_amo_sw_batch_push(&batch, freq, freq->send.amo.batched.fetch,
+                              freq->send.amo.batched.size);
+    }
+
+    last = ucs_queue_is_empty(queue) && (batch.count < max_count) &&
+           ((length + ucp_amo_sw_packed_size(req, size)) <= max_length);
+    if (last) {
+        length += ucp_amo_sw_packed_size(req, size);
+        ucp_amo_sw_batch_push(&batch, req, fetch, size);
+        /* Atomics issued from completion callbacks during the send must not
+         * be queued on the carrier, since it may be already completed */
+        ep->ext->amo_batch = NULL;
+    }
+
+    ucs_assert(batch.count > 0);
+    for (i = 0; i < batch.count; ++i) {
+        if (batch.fetch[i]) {
+            ucp_send_request_id_alloc(batch.reqs[i]);
+        }
+    }
+
+    /* See the comment in ucp_rma_sw_do_am_bcopy() */
+    ucp_worker_flush_ops_count_add(ep->worker, +(int)batch.count);
+    packed_len = uct_ep_am_bcopy(ucp_ep_get_fast_lane(ep, req->send.lane),
+                                 UCP_AM_ID_ATOMIC_BATCH_REQ,
+                                 ucp_amo_sw_batch_pack_cb, &batch, 0);
+    if (ucs_unlikely(packed_len < 0)) {
+        ucp_worker_flush_ops_count_add(ep->worker, -(int)batch.count);
+        for (i = 0; i < batch.count; ++i) {
+            if (batch.fetch[i]) {
+                ucp_send_request_id_release(batch.reqs[i]);
+            }
+        }
+
+        status             = (ucs_status_t)packed_len;
+        ep->ext->amo_batch = req;
+        if (status == UCS_ERR_NO_RESOURCE) {
+            /* Return the requests to the queue in the original order */
+            for (i = batch.count - last; i > 0; --i) {
+                freq = batch.reqs[i - 1];
+                ucs_queue_push_head(queue,
+                                    (ucs_queue_elem_t*)&freq->send.uct.priv);
+            }
+            return UCS_ERR_NO_RESOURCE;
+        }
+
+        for (i = 0; i < (batch.count - last); ++i) {
+            ucp_request_complete_send(batch.reqs[i], status);
+        }
+        ucp_amo_sw_batch_purge(req, status);
+        ucp_request_complete_send(req, status);
+        return UCS_OK;
+    }
+
+    ucs_assert(packed_len == length);
+    for (i = 0; i < batch.count; ++i) {
+        ucp_ep_rma_remote_request_sent(ep);
+    }
+
+    /* Requests with a result are completed by the reply */
+    for (i = 0; i < batch.count; ++i) {
+        if (!batch.fetch[i]) {
+            ucp_request_complete_send(batch.reqs[i], UCS_OK);
+        }
+    }
+
+    return last ? UCS_OK : UCS_INPROGRESS;
+}
+
+void ucp_amo_sw_batch_purge(ucp_request_t *req, ucs_status_t status)
+{
+    ucp_ep_h ep = req->send.ep;
+    ucp_request_t *freq;
+
+    ucs_assert(ep->ext->amo_batch == req);
+
+    ep->ext->amo_batch = NULL;
+    ucs_queue_for_each_extract(freq, &ep->ext->amo_batch_q, send.uct.priv,
+                               1) {
+        ucp_request_complete_send(freq, status);
+    }
+}
+
 static UCS_F_ALWAYS_INLINE ucs_status_t
 ucp_amo_sw_progress(uct_pending_req_t *self, uct_pack_callback_t pack_cb,
-                    int fetch)
+                    int fetch, size_t size)
 {
     ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_ep_h ep        = req->send.ep;
     ucs_status_t status;
 
-    req->send.lane = ucp_ep_get_am_lane(req->send.ep);
+    req->send.lane = ucp_ep_get_am_lane(ep);
+
+    if (ucs_unlikely(ep->ext->amo_batch != NULL)) {
+        if (ep->ext->amo_batch != req) {
+            /* The carrier is waiting for resources, queue the request on it */
+            req->send.amo.batched.size  = size;
+            req->send.amo.batched.fetch = fetch;
+            ucs_queue_push(&ep->ext->amo_batch_q,
+                           (ucs_queue_elem_t*)&req->send.uct.priv);
+            return UCS_OK;
+        } else if (!ucs_queue_is_empty(&ep->ext->amo_batch_q)) {
+            return ucp_amo_sw_batch_send(req, fetch, size);
+        } else {
+            /* Nothing was queued, send a regular atomic request */
+            ep->ext->amo_batch = NULL;
+        }
+    }
+
     if (fetch) {
         ucp_send_request_id_alloc(req);
     }
@@ -96,6 +290,11 @@ ucp_amo_sw_progress(uct_pending_req_t *self, uct_pack_callback_t pack_cb,
             ucp_request_complete_send(req, status);
             return UCS_OK;
         }
+
+        if (ep->worker->context->config.ext.sw_amo_batch > 1) {
+            ucs_assert(ucs_queue_is_empty(&ep->ext->amo_batch_q));
+            ep->ext->amo_batch = req;
+        }
     }
 
     return status;
@@ -103,12 +302,18 @@ ucp_amo_sw_progress(uct_pending_req_t *self, uct_pack_callback_t pack_cb,
 
 static ucs_status_t ucp_amo_sw_progress_post(uct_pending_req_t *self)
 {
-    return ucp_amo_sw_progress(self, ucp_amo_sw_post_pack_cb, 0);
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+
+    return ucp_amo_sw_progress(self, ucp_amo_sw_post_pack_cb, 0,
+                               req->send.length);
 }
 
 static ucs_status_t ucp_amo_sw_progress_fetch(uct_pending_req_t *self)
 {
-    return ucp_amo_sw_progress(self, ucp_amo_sw_fetch_pack_cb, 1);
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+
+    return ucp_amo_sw_progress(self, ucp_amo_sw_fetch_pack_cb, 1,
+                               req->send.length);
 }
 
 ucp_amo_proto_t ucp_amo_sw_proto = {
@@ -218,20 +423,39 @@ DEFINE_AMO_SW_OP(64)
 DEFINE_AMO_SW_FOP(32)
 DEFINE_AMO_SW_FOP(64)
 
-UCS_PROFILE_FUNC(ucs_status_t, ucp_atomic_req_handler, (arg, data, length, am_flags),
-                 void *arg, void *data, size_t length, unsigned am_flags)
+static void ucp_amo_sw_do_post(const ucp_atomic_req_hdr_t *atomicreqh)
 {
-    ucp_atomic_req_hdr_t *atomicreqh = data;
-    ucp_worker_h worker              = arg;
-    ucp_rsc_index_t amo_rsc_idx      = UCS_STATIC_BITMAP_FFS(worker->atomic_tls);
-    ucp_request_t *req;
-    ucp_ep_h ep;
+    switch (atomicreqh->length) {
+    case sizeof(uint32_t):
+        ucp_amo_sw_do_op32(atomicreqh);
+        break;
+    case sizeof(uint64_t):
+        ucp_amo_sw_do_op64(atomicreqh);
+        break;
+    default:
+        ucs_fatal("invalid atomic length: %u", atomicreqh->length);
+    }
+}
+
+static void ucp_amo_sw_do_fetch(const ucp_atomic_req_hdr_t *atomicreqh,
+                                ucp_atomic_reply_t *result)
+{
+    switch (atomicreqh->length) {
+    case sizeof(uint32_t):
+        ucp_amo_sw_do_fop32(atomicreqh, result);
+        break;
+    case sizeof(uint64_t):
+        ucp_amo_sw_do_fop64(atomicreqh, result);
+        break;
+    default:
+        ucs_fatal("invalid atomic length: %u", atomicreqh->length);
+    }
+}
+
+static void ucp_amo_sw_check_device_atomics(ucp_worker_h worker)
+{
+    ucp_rsc_index_t amo_rsc_idx = UCS_STATIC_BITMAP_FFS(worker->atomic_tls);
 
-    /* allow getting closed EP to be used for sending a completion or AMO data to
-     * enable flush on a peer
-     */
-    UCP_WORKER_GET_EP_BY_ID(&ep, worker, atomicreqh->req.ep_id, return UCS_OK,
-                            "SW AMO request");
     if (ucs_unlikely((amo_rsc_idx != UCP_MAX_RESOURCES) &&
                      (ucp_worker_iface_get_attr(worker,
                                                 amo_rsc_idx)->cap.flags &
@@ -243,39 +467,26 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_atomic_req_handler, (arg, data, length, am_fl
          *       AMO on fastest resource from worker->atomic_tls using loopback
          *       EP and continue SW AMO protocol */
     }
+}
+
+static void ucp_amo_sw_handle_req(ucp_worker_h worker, ucp_ep_h ep,
+                                  const ucp_atomic_req_hdr_t *atomicreqh)
+{
+    ucp_request_t *req;
 
     if (atomicreqh->req.req_id == UCS_PTR_MAP_KEY_INVALID) {
         /* atomic operation without result */
-        switch (atomicreqh->length) {
-        case sizeof(uint32_t):
-            ucp_amo_sw_do_op32(atomicreqh);
-            break;
-        case sizeof(uint64_t):
-            ucp_amo_sw_do_op64(atomicreqh);
-            break;
-        default:
-            ucs_fatal("invalid atomic length: %u", atomicreqh->length);
-        }
+        ucp_amo_sw_do_post(atomicreqh);
         ucp_rma_sw_send_cmpl(ep);
     } else {
         /* atomic operation with result */
         req = ucp_request_get(worker);
         if (req == NULL) {
             ucs_error("failed to allocate atomic reply");
-            return UCS_OK;
-        }
-
-        switch (atomicreqh->length) {
-        case sizeof(uint32_t):
-            ucp_amo_sw_do_fop32(atomicreqh, &req->send.atomic_reply.data);
-            break;
-        case sizeof(uint64_t):
-            ucp_amo_sw_do_fop64(atomicreqh, &req->send.atomic_reply.data);
-            break;
-        default:
-            ucs_fatal("invalid atomic length: %u", atomicreqh->length);
+            return;
         }
 
+        ucp_amo_sw_do_fetch(atomicreqh, &req->send.atomic_reply.data);
         ucp_request_send_state_init(req, ucp_dt_make_contig(1),
                                     atomicreqh->length);
 
@@ -286,33 +497,200 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_atomic_req_handler, (arg, data, length, am_fl
         req->send.uct.func                   = ucp_progress_atomic_reply;
         ucp_request_send(req);
     }
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_atomic_req_handler, (arg, data, length, am_flags),
+                 void *arg, void *data, size_t length, unsigned am_flags)
+{
+    ucp_atomic_req_hdr_t *atomicreqh = data;
+    ucp_worker_h worker              = arg;
+    ucp_ep_h ep;
+
+    /* allow getting closed EP to be used for sending a completion or AMO data to
+     * enable flush on a peer
+     */
+    UCP_WORKER_GET_EP_BY_ID(&ep, worker, atomicreqh->req.ep_id, return UCS_OK,
+                            "SW AMO request");
+    ucp_amo_sw_check_device_atomics(worker);
+    ucp_amo_sw_handle_req(worker, ep, atomicreqh);
+    return UCS_OK;
+}
+
+static size_t ucp_amo_sw_pack_atomic_batch_reply(void *dest, void *arg)
+{
+    ucp_atomic_batch_rep_hdr_t *reph = dest;
+    ucp_request_t *req               = arg;
+
+    memcpy(reph, req->send.buffer, req->send.length);
+    reph->ep_id = ucp_send_request_get_ep_remote_id(req);
+    return req->send.length;
+}
+
+ucs_status_t ucp_progress_atomic_batch_reply(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_ep_t *ep       = req->send.ep;
+    ssize_t packed_len;
+
+    req->send.lane = ucp_ep_get_am_lane(ep);
+    packed_len     = uct_ep_am_bcopy(ucp_ep_get_fast_lane(ep, req->send.lane),
+                                     UCP_AM_ID_ATOMIC_BATCH_REP,
+                                     ucp_amo_sw_pack_atomic_batch_reply, req,
+                                     0);
+    if (packed_len < 0) {
+        return (ucs_status_t)packed_len;
+    }
 
+    ucs_assert(packed_len == req->send.length);
+    ucs_free(req->send.buffer);
+    ucp_request_put(req);
     return UCS_OK;
 }
 
-UCS_PROFILE_FUNC(ucs_status_t, ucp_atomic_rep_handler, (arg, data, length, am_flags),
-                 void *arg, void *data, size_t length, unsigned am_flags)
+UCS_PROFILE_FUNC(ucs_status_t, ucp_atomic_batch_req_handler,
+                 (arg, data, length, am_flags), void *arg, void *data,
+                 size_t length, unsigned am_flags)
+{
+    ucp_atomic_batch_req_hdr_t *batchh = data;
+    ucp_atomic_req_hdr_t *atomicreqh   = (ucp_atomic_req_hdr_t*)(batchh + 1);
+    ucp_worker_h worker                = arg;
+    ucp_atomic_batch_rep_hdr_t *reph;
+    ucp_atomic_batch_result_t *result;
+    ucp_atomic_reply_t reply;
+    ucp_request_t *req;
+    size_t max_length;
+    unsigned i;
+    ucp_ep_h ep;
+
+    UCP_WORKER_GET_EP_BY_ID(&ep, worker, atomicreqh->req.ep_id, return UCS_OK,
+                            "SW AMO batch request");
+    ucp_amo_sw_check_device_atomics(worker);
+
+    max_length = sizeof(*reph) + (batchh->num_fetch *
+                                  (sizeof(*result) + sizeof(uint64_t)));
+    if (ucs_unlikely(max_length >
+                     ucp_ep_get_max_bcopy(ep, ucp_ep_get_am_lane(ep)))) {
+        /* The aggregated reply does not fit in one message, acknowledge every
+         * request separately */
+        for (i = 0; i < batchh->count; ++i) {
+            ucp_amo_sw_handle_req(worker, ep, atomicreqh);
+            atomicreqh = UCS_PTR_BYTE_OFFSET(atomicreqh,
+                                             ucp_amo_sw_req_length(atomicreqh));
+        }
+        return UCS_OK;
+    }
+
+    req = ucp_request_get(worker);
+    if (req == NULL) {
+        ucs_error("failed to allocate atomic batch reply");
+        return UCS_OK;
+    }
+
+    reph = ucs_malloc(max_length, "atomic_batch_reply");
+    if (reph == NULL) {
+        ucs_error("failed to allocate atomic batch reply buffer");
+        ucp_request_put(req);
+        return UCS_OK;
+    }
+
+    /* Apply the atomics in the order they were issued */
+    reph->num_post  = 0;
+    reph->num_fetch = 0;
+    result          = (ucp_atomic_batch_result_t*)(reph + 1);
+    for (i = 0; i < batchh->count; ++i) {
+        if (atomicreqh->req.req_id == UCS_PTR_MAP_KEY_INVALID) {
+            ucp_amo_sw_do_post(atomicreqh);
+            ++reph->num_post;
+        } else {
+            ucp_amo_sw_do_fetch(atomicreqh, &reply);
+            result->req_id = atomicreqh->req.req_id;
+            result->length = atomicreqh->length;
+            memcpy(result + 1, &reply, atomicreqh->length);
+            result = UCS_PTR_BYTE_OFFSET(result + 1, atomicreqh->length);
+            ++reph->num_fetch;
+        }
+
+        atomicreqh = UCS_PTR_BYTE_OFFSET(atomicreqh,
+                                         ucp_amo_sw_req_length(atomicreqh));
+    }
+
+    ucs_assertv(UCS_PTR_BYTE_DIFF(batchh, atomicreqh) == length,
+                "batch length %zu, expected %zu",
+                UCS_PTR_BYTE_DIFF(batchh, atomicreqh), length);
+    ucs_assert(reph->num_fetch == batchh->num_fetch);
+
+    ucp_request_send_state_init(req, ucp_dt_make_contig(1), 0);
+
+    req->flags         = 0;
+    req->send.ep       = ep;
+    req->send.buffer   = reph;
+    req->send.length   = UCS_PTR_BYTE_DIFF(reph, result);
+    req->send.uct.func = ucp_progress_atomic_batch_reply;
+    ucp_request_send(req);
+    return UCS_OK;
+}
+
+static void ucp_amo_sw_fetch_completed(ucp_worker_h worker,
+                                       ucs_ptr_map_key_t req_id,
+                                       const void *data, size_t length)
 {
-    ucp_worker_h worker    = arg;
-    ucp_rma_rep_hdr_t *hdr = data;
-    size_t frag_length     = length - sizeof(*hdr);
     ucp_request_t *req;
     ucp_ep_h ep;
 
-    UCP_SEND_REQUEST_GET_BY_ID(&req, worker, hdr->req_id, 1, return UCS_OK,
-                               "ATOMIC_REP %p", hdr);
+    UCP_SEND_REQUEST_GET_BY_ID(&req, worker, req_id, 1, return,
+                               "ATOMIC_REP %p", data);
 
     if (worker->context->config.ext.proto_enable) {
-        ucp_dt_contig_unpack(worker, req->send.amo.reply_buffer, hdr + 1,
-                             frag_length, ucp_amo_request_reply_mem_type(req),
-                             frag_length);
+        ucp_dt_contig_unpack(worker, req->send.amo.reply_buffer, data, length,
+                             ucp_amo_request_reply_mem_type(req), length);
     } else {
-        memcpy(req->send.buffer, hdr + 1, frag_length);
+        memcpy(req->send.buffer, data, length);
     }
 
     ep = req->send.ep;
     ucp_request_complete_send(req, UCS_OK);
     ucp_ep_rma_remote_request_completed(ep);
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_atomic_rep_handler, (arg, data, length, am_flags),
+                 void *arg, void *data, size_t length, unsigned am_flags)
+{
+    ucp_worker_h worker    = arg;
+    ucp_rma_rep_hdr_t *hdr = data;
+
+    ucp_amo_sw_fetch_completed(worker, hdr->req_id, hdr + 1,
+                               length - sizeof(*hdr));
+    return UCS_OK;
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_atomic_batch_rep_handler,
+                 (arg, data, length, am_flags), void *arg, void *data,
+                 size_t length, unsigned am_flags)
+{
+    ucp_worker_h worker               = arg;
+    ucp_atomic_batch_rep_hdr_t *reph  = data;
+    ucp_atomic_batch_result_t *result = (ucp_atomic_batch_result_t*)(reph + 1);
+    unsigned i;
+    ucp_ep_h ep;
+
+    for (i = 0; i < reph->num_fetch; ++i) {
+        ucp_amo_sw_fetch_completed(worker, result->req_id, result + 1,
+                                   result->length);
+        result = UCS_PTR_BYTE_OFFSET(result + 1, result->length);
+    }
+
+    if (reph->num_post == 0) {
+        return UCS_OK;
+    }
+
+    /* allow getting closed EP to be used for handling a completion to enable
+     * flush on a peer
+     */
+    UCP_WORKER_GET_EP_BY_ID(&ep, worker, reph->ep_id, return UCS_OK,
+                            "SW AMO batch completion");
+    for (i = 0; i < reph->num_post; ++i) {
+        ucp_ep_rma_remote_request_completed(ep);
+    }
 
     return UCS_OK;
 }
@@ -321,6 +699,8 @@ static void ucp_amo_sw_dump_packet(ucp_worker_h worker, uct_am_trace_type_t type
                                    uint8_t id, const void *data, size_t length,
                                    char *buffer, size_t max)
 {
+    const ucp_atomic_batch_req_hdr_t *batchh;
+    const ucp_atomic_batch_rep_hdr_t *batch_reph;
     const ucp_atomic_req_hdr_t *atomich;
     const ucp_rma_rep_hdr_t *reph;
     size_t header_len;
@@ -341,6 +721,20 @@ static void ucp_amo_sw_dump_packet(ucp_worker_h worker, uct_am_trace_type_t type
         snprintf(buffer, max, "ATOMIC_REP [req_id 0x%"PRIu64"]", reph->req_id);
         header_len = sizeof(*reph);
         break;
+    case UCP_AM_ID_ATOMIC_BATCH_REQ:
+        batchh  = data;
+        atomich = (const ucp_atomic_req_hdr_t*)(batchh + 1);
+        snprintf(buffer, max,
+                 "ATOMIC_BATCH_REQ [count %u fetch %u ep_id 0x%"PRIx64"]",
+                 batchh->count, batchh->num_fetch, atomich->req.ep_id);
+        return;
+    case UCP_AM_ID_ATOMIC_BATCH_REP:
+        batch_reph = data;
+        snprintf(buffer, max,
+                 "ATOMIC_BATCH_REP [ep_id 0x%"PRIx64" post %u fetch %u]",
+                 batch_reph->ep_id, batch_reph->num_post,
+                 batch_reph->num_fetch);
+        return;
     default:
         return;
     }
@@ -355,6 +749,12 @@ UCP_DEFINE_AM_WITH_PROXY(UCP_FEATURE_AMO, UCP_AM_ID_ATOMIC_REQ,
                          ucp_atomic_req_handler, ucp_amo_sw_dump_packet, 0);
 UCP_DEFINE_AM_WITH_PROXY(UCP_FEATURE_AMO, UCP_AM_ID_ATOMIC_REP,
                          ucp_atomic_rep_handler, ucp_amo_sw_dump_packet, 0);
+UCP_DEFINE_AM_WITH_PROXY(UCP_FEATURE_AMO, UCP_AM_ID_ATOMIC_BATCH_REQ,
+                         ucp_atomic_batch_req_handler, ucp_amo_sw_dump_packet,
+                         0);
+UCP_DEFINE_AM_WITH_PROXY(UCP_FEATURE_AMO, UCP_AM_ID_ATOMIC_BATCH_REP,
+                         ucp_atomic_batch_rep_handler, ucp_amo_sw_dump_packet,
+                         0);
 
 static size_t ucp_proto_amo_sw_post_pack_cb(void *dest, void *arg)
 {
@@ -398,15 +798,36 @@ ucp_proto_amo_sw_progress(uct_pending_req_t *self, uct_pack_callback_t pack_cb,
 
     ucs_assert(req->flags & UCP_REQUEST_FLAG_PROTO_AMO_PACKED);
 
-    return ucp_amo_sw_progress(self, pack_cb, fetch);
+    return ucp_amo_sw_progress(self, pack_cb, fetch,
+                               req->send.state.dt_iter.length);
+}
+
+int ucp_proto_amo_is_device_selected(const ucp_proto_init_params_t *init_params)
+{
+    const ucp_ep_config_key_t *ep_config_key = init_params->ep_config_key;
+    const ucp_ep_config_key_lane_t *lane_config;
+    const uct_iface_attr_t *iface_attr;
+
+    /* If the endpoint has device atomic lanes, it means the target worker
+       expects only device atomics */
+    ucs_carray_for_each(lane_config, ep_config_key->lanes,
+                        ep_config_key->num_lanes) {
+        iface_attr = ucp_worker_iface_get_attr(init_params->worker,
+                                               lane_config->rsc_index);
+        if ((lane_config->lane_types & UCS_BIT(UCP_LANE_TYPE_AMO)) &&
+            (iface_attr->cap.flags & UCT_IFACE_FLAG_ATOMIC_DEVICE)) {
+            return 1;
+        }
+    }
+
+    return 0;
 }
 
 static void ucp_proto_amo_sw_probe(const ucp_proto_init_params_t *init_params,
                                    unsigned flags)
 {
-    const ucp_ep_config_key_t *ep_config_key = init_params->ep_config_key;
-    ucp_worker_h worker                      = init_params->worker;
-    ucp_proto_single_init_params_t params    = {
+    ucp_worker_h worker                   = init_params->worker;
+    ucp_proto_single_init_params_t params = {
         .super.super         = *init_params,
         .super.latency       = 1.2e-6,
         .super.overhead      = worker->context->config.ext.proto_overhead_sw,
@@ -428,20 +849,12 @@ static void ucp_proto_amo_sw_probe(const ucp_proto_init_params_t *init_params,
         .lane_type           = UCP_LANE_TYPE_AM,
         .tl_cap_flags        = 0
     };
-    const ucp_ep_config_key_lane_t *lane_config;
-    const uct_iface_attr_t *iface_attr;
 
-    /* If the endpoint has device atomic lanes, it means the target worker
-       expects only device atomics, so we cannot use SW atomics. */
-    ucs_carray_for_each(lane_config, ep_config_key->lanes,
-                        ep_config_key->num_lanes) {
-        iface_attr = ucp_worker_iface_get_attr(worker, lane_config->rsc_index);
-        if ((lane_config->lane_types & UCS_BIT(UCP_LANE_TYPE_AMO)) &&
-            (iface_attr->cap.flags & UCT_IFACE_FLAG_ATOMIC_DEVICE)) {
-            ucs_trace("software atomics not supported because device atomics "
-                      "are selected");
-            return;
-        }
+    /* Cannot use SW atomics if the target worker expects device atomics */
+    if (ucp_proto_amo_is_device_selected(init_params)) {
+        ucs_trace("software atomics not supported because device atomics "
+                  "are selected");
+        return;
     }
 
     ucp_proto_single_probe(&params);
@@ -463,6 +876,32 @@ ucp_proto_amo_sw_post_probe(const ucp_proto_init_params_t *init_params)
     ucp_proto_amo_sw_probe(init_params, 0);
 }
 
+/* The protocol of the carrier may be reselected, so send the queued requests
+ * separately */
+static void ucp_proto_amo_sw_batch_reset(ucp_request_t *req)
+{
+    ucp_ep_h ep = req->send.ep;
+    ucs_queue_head_t queue;
+    ucp_request_t *freq;
+
+    if (ucs_likely(ep->ext->amo_batch != req)) {
+        return;
+    }
+
+    ep->ext->amo_batch = NULL;
+    ucs_queue_head_init(&queue);
+    ucs_queue_splice(&queue, &ep->ext->amo_batch_q);
+    ucs_queue_for_each_extract(freq, &queue, send.uct.priv, 1) {
+        ucp_proto_request_restart(freq);
+    }
+}
+
+static ucs_status_t ucp_proto_amo_sw_post_reset(ucp_request_t *req)
+{
+    ucp_proto_amo_sw_batch_reset(req);
+    return ucp_proto_request_bcopy_reset(req);
+}
+
 ucp_proto_t ucp_get_amo_post_proto = {
     .name     = "amo/post/sw",
     .desc     = UCP_PROTO_RMA_EMULATION_DESC,
@@ -471,7 +910,7 @@ ucp_proto_t ucp_get_amo_post_proto = {
     .query    = ucp_proto_single_query,
     .progress = {ucp_proto_amo_sw_progress_post},
     .abort    = ucp_proto_abort_fatal_not_implemented,
-    .reset    = ucp_proto_request_bcopy_reset
+    .reset    = ucp_proto_amo_sw_post_reset
 };
 
 static ucs_status_t ucp_proto_amo_sw_progress_fetch(uct_pending_req_t *self)
@@ -492,6 +931,12 @@ ucp_proto_amo_sw_fetch_probe(const ucp_proto_init_params_t *init_params)
     ucp_proto_amo_sw_probe(init_params, UCP_PROTO_COMMON_INIT_FLAG_RESPONSE);
 }
 
+static ucs_status_t ucp_proto_amo_sw_fetch_reset(ucp_request_t *req)
+{
+    ucp_proto_amo_sw_batch_reset(req);
+    return ucp_proto_request_bcopy_id_reset(req);
+}
+
 ucp_proto_t ucp_get_amo_fetch_proto = {
     .name     = "amo/fetch/sw",
     .desc     = UCP_PROTO_RMA_EMULATION_DESC,
@@ -500,5 +945,5 @@ ucp_proto_t ucp_get_amo_fetch_proto = {
     .query    = ucp_proto_single_query,
     .progress = {ucp_proto_amo_sw_progress_fetch},
     .abort    = ucp_proto_abort_fatal_not_implemented,
-    .reset    = ucp_proto_request_bcopy_id_reset
+    .reset    = ucp_proto_amo_sw_fetch_reset
 };
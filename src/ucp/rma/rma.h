@@ -49,6 +49,17 @@ struct ucp_amo_proto {
 };
 
 
+/**
+ * Completion counter of RMA operations
+ */
+struct ucp_counter {
+    ucp_worker_h               worker;
+    volatile uint64_t          value;  /* Number of completed operations */
+    volatile int32_t           status; /* Status of the first failed operation,
+                                          wide enough for atomic update */
+};
+
+
 /**
  * Atomic reply data
  */
@@ -91,6 +102,28 @@ typedef struct {
 } UCS_S_PACKED ucp_atomic_req_hdr_t;
 
 
+/* Followed by 'count' atomic requests, each one with its arguments */
+typedef struct {
+    uint16_t                  count;
+    uint16_t                  num_fetch; /* Requests which return a result */
+} UCS_S_PACKED ucp_atomic_batch_req_hdr_t;
+
+
+/* Followed by 'num_fetch' results */
+typedef struct {
+    uint64_t                  ep_id;
+    uint16_t                  num_post;  /* Completed requests without result */
+    uint16_t                  num_fetch;
+} UCS_S_PACKED ucp_atomic_batch_rep_hdr_t;
+
+
+/* Followed by 'length' bytes of the result */
+typedef struct {
+    uint64_t                  req_id;
+    uint8_t                   length;
+} UCS_S_PACKED ucp_atomic_batch_result_t;
+
+
 extern ucp_rma_proto_t ucp_rma_basic_proto;
 extern ucp_rma_proto_t ucp_rma_sw_proto;
 extern ucp_amo_proto_t ucp_amo_basic_proto;
@@ -109,4 +142,10 @@ void ucp_ep_flush_remote_completed(ucp_request_t *req);
 
 void ucp_rma_sw_send_cmpl(ucp_ep_h ep);
 
+int ucp_proto_amo_is_device_selected(const ucp_proto_init_params_t *init_params);
+
+void ucp_amo_sw_batch_purge(ucp_request_t *req, ucs_status_t status);
+
+ucs_status_t ucp_progress_atomic_batch_reply(uct_pending_req_t *self);
+
 #endif
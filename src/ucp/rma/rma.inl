@@ -11,6 +11,7 @@
 
 #include <ucp/api/ucp.h>
 #include <ucp/core/ucp_request.inl>
+#include <ucs/arch/atomic.h>
 #include <ucs/debug/log.h>
 
 
@@ -79,6 +80,19 @@ static inline ucs_status_t ucp_rma_wait(ucp_worker_h worker, void *user_req,
     }
 }
 
+static UCS_F_ALWAYS_INLINE void
+ucp_rma_counter_complete(ucp_counter_h counter, ucs_status_t status)
+{
+    if (ucs_unlikely(status != UCS_OK)) {
+        /* Keep the first error if operations fail concurrently */
+        ucs_atomic_cswap32((volatile uint32_t*)&counter->status, UCS_OK,
+                           (int32_t)status);
+    }
+
+    /* Zero-length operations are counted without taking the worker lock */
+    ucs_atomic_add64(&counter->value, 1);
+}
+
 static inline void ucp_ep_rma_remote_request_sent(ucp_ep_h ep)
 {
     ++ucp_ep_flush_state(ep)->send_sn;
@@ -0,0 +1,251 @@
+/**
+ * Copyright (c) NVIDIA CORPORATION & AFFILIATES, 2025. ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "rma.h"
+#include "rma.inl"
+
+#include <ucp/core/ucp_request.inl>
+#include <ucp/dt/datatype_iter.inl>
+#include <ucp/proto/proto_init.h>
+#include <ucp/proto/proto_single.inl>
+#include <ucs/arch/atomic.h>
+
+
+#define UCP_PROTO_RMA_RKEY_PTR_DESC "access mapped remote memory"
+
+
+/*
+ * Protocols which access remote memory directly by CPU, when it is mapped to
+ * the local process by an rkey_ptr capable memory domain, e.g. host memory
+ * allocated from shared memory by ucp_mem_map(). The operation is complete
+ * when the progress function returns, so the target does not participate.
+ */
+static void
+ucp_proto_rma_rkey_ptr_probe(const ucp_proto_init_params_t *init_params,
+                             uint64_t op_id_mask, size_t min_length,
+                             size_t max_length, unsigned flags)
+{
+    ucp_context_t *context                = init_params->worker->context;
+    ucp_proto_single_init_params_t params = {
+        .super.super         = *init_params,
+        .super.latency       = 0,
+        .super.overhead      = context->config.ext.proto_overhead_rkey_ptr,
+        .super.cfg_thresh    = UCS_MEMUNITS_AUTO,
+        .super.cfg_priority  = 0,
+        .super.min_length    = min_length,
+        .super.max_length    = max_length,
+        .super.min_iov       = 0,
+        .super.min_frag_offs = UCP_PROTO_COMMON_OFFSET_INVALID,
+        .super.max_frag_offs = UCP_PROTO_COMMON_OFFSET_INVALID,
+        .super.max_iov_offs  = UCP_PROTO_COMMON_OFFSET_INVALID,
+        .super.hdr_size      = 0,
+        .super.send_op       = UCT_EP_OP_LAST,
+        .super.memtype_op    = UCT_EP_OP_LAST,
+        .super.flags         = flags | UCP_PROTO_COMMON_INIT_FLAG_RKEY_PTR |
+                               UCP_PROTO_COMMON_INIT_FLAG_RECV_ZCOPY |
+                               UCP_PROTO_COMMON_INIT_FLAG_REMOTE_ACCESS |
+                               UCP_PROTO_COMMON_INIT_FLAG_SINGLE_FRAG,
+        .super.exclude_map   = 0,
+        .super.reg_mem_info  = ucp_mem_info_unknown,
+        .lane_type           = UCP_LANE_TYPE_RKEY_PTR,
+        .tl_cap_flags        = 0
+    };
+
+    if (!ucp_proto_init_check_op(init_params, op_id_mask) ||
+        !UCP_MEM_IS_HOST(init_params->select_param->mem_type) ||
+        (init_params->rkey_config_key == NULL) ||
+        !UCP_MEM_IS_HOST(init_params->rkey_config_key->mem_type) ||
+        (init_params->ep_config_key->rkey_ptr_lane == UCP_NULL_LANE)) {
+        return;
+    }
+
+    ucp_proto_single_probe(&params);
+}
+
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_proto_rma_rkey_ptr_get(ucp_request_t *req, ucp_rkey_h rkey,
+                           uint64_t remote_addr, void **ptr_p)
+{
+    const ucp_proto_single_priv_t *spriv = req->send.proto_config->priv;
+    ucp_md_index_t rkey_index            = spriv->super.rkey_index;
+
+    ucs_assert(rkey_index != UCP_NULL_RESOURCE);
+    return uct_rkey_ptr(rkey->tl_rkey[rkey_index].cmpt,
+                        &rkey->tl_rkey[rkey_index].rkey, remote_addr, ptr_p);
+}
+
+static ucs_status_t ucp_proto_rma_rkey_ptr_progress(uct_pending_req_t *self)
+{
+    ucp_request_t *req  = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_worker_h worker = req->send.ep->worker;
+    ucp_datatype_iter_t next_iter;
+    ucs_status_t status;
+    void *ptr;
+
+    status = ucp_proto_rma_rkey_ptr_get(req, req->send.rma.rkey,
+                                        req->send.rma.remote_addr, &ptr);
+    if (ucs_unlikely(status != UCS_OK)) {
+        ucp_proto_request_bcopy_abort(req, status);
+        return UCS_OK;
+    }
+
+    if (ucp_proto_select_op_id(&req->send.proto_config->select_param) ==
+        UCP_OP_ID_PUT) {
+        ucp_datatype_iter_next_pack(&req->send.state.dt_iter, worker, SIZE_MAX,
+                                    &next_iter, ptr);
+        /* Make the data visible to the peer before reporting completion */
+        ucs_memory_cpu_store_fence();
+    } else {
+        status = ucp_datatype_iter_unpack(&req->send.state.dt_iter, worker,
+                                          req->send.state.dt_iter.length, 0,
+                                          ptr);
+        if (ucs_unlikely(status != UCS_OK)) {
+            ucp_proto_request_bcopy_abort(req, status);
+            return UCS_OK;
+        }
+    }
+
+    ucp_datatype_iter_cleanup(&req->send.state.dt_iter, 0, UCP_DT_MASK_ALL);
+    ucp_request_complete_send(req, UCS_OK);
+    return UCS_OK;
+}
+
+static void
+ucp_proto_rma_rkey_ptr_rma_probe(const ucp_proto_init_params_t *init_params)
+{
+    unsigned flags = ucp_proto_init_check_op(init_params,
+                                             UCS_BIT(UCP_OP_ID_GET)) ?
+                     UCP_PROTO_COMMON_INIT_FLAG_RESPONSE : 0;
+
+    ucp_proto_rma_rkey_ptr_probe(init_params,
+                                 UCS_BIT(UCP_OP_ID_PUT) |
+                                 UCS_BIT(UCP_OP_ID_GET), 0, SIZE_MAX, flags);
+}
+
+ucp_proto_t ucp_rma_rkey_ptr_proto = {
+    .name     = "rma/rkey_ptr",
+    .desc     = UCP_PROTO_RMA_RKEY_PTR_DESC,
+    .flags    = 0,
+    .probe    = ucp_proto_rma_rkey_ptr_rma_probe,
+    .query    = ucp_proto_single_query,
+    .progress = {ucp_proto_rma_rkey_ptr_progress},
+    .abort    = ucp_proto_request_bcopy_abort,
+    .reset    = ucp_proto_request_bcopy_reset
+};
+
+#define UCP_PROTO_AMO_RKEY_PTR_OP(_bits) \
+    static uint##_bits##_t ucp_proto_amo_rkey_ptr_op##_bits( \
+            uct_atomic_op_t op, uint##_bits##_t *ptr, uint##_bits##_t value, \
+            uint##_bits##_t swap) \
+    { \
+        switch (op) { \
+        case UCT_ATOMIC_OP_ADD: \
+            return ucs_atomic_fadd##_bits(ptr, value); \
+        case UCT_ATOMIC_OP_AND: \
+            return ucs_atomic_fand##_bits(ptr, value); \
+        case UCT_ATOMIC_OP_OR: \
+            return ucs_atomic_for##_bits(ptr, value); \
+        case UCT_ATOMIC_OP_XOR: \
+            return ucs_atomic_fxor##_bits(ptr, value); \
+        case UCT_ATOMIC_OP_SWAP: \
+            return ucs_atomic_swap##_bits(ptr, value); \
+        case UCT_ATOMIC_OP_CSWAP: \
+            return ucs_atomic_cswap##_bits(ptr, value, swap); \
+        default: \
+            ucs_fatal("invalid opcode: %d", op); \
+        } \
+    }
+
+UCP_PROTO_AMO_RKEY_PTR_OP(32)
+UCP_PROTO_AMO_RKEY_PTR_OP(64)
+
+static ucs_status_t ucp_proto_amo_rkey_ptr_progress(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    size_t length      = req->send.state.dt_iter.length;
+    uct_atomic_op_t op = req->send.amo.uct_op;
+    void *reply_buffer = req->send.amo.reply_buffer;
+    int fetch          = ucp_proto_select_op_id(
+                                 &req->send.proto_config->select_param) !=
+                         UCP_OP_ID_AMO_POST;
+    ucp_datatype_iter_t next_iter;
+    ucs_status_t status;
+    uint32_t result32;
+    uint64_t result64;
+    void *ptr;
+
+    status = ucp_proto_rma_rkey_ptr_get(req, req->send.amo.rkey,
+                                        req->send.amo.remote_addr, &ptr);
+    if (ucs_unlikely(status != UCS_OK)) {
+        ucp_request_complete_send(req, status);
+        return UCS_OK;
+    }
+
+    ucp_datatype_iter_next_pack(&req->send.state.dt_iter, req->send.ep->worker,
+                                SIZE_MAX, &next_iter, &req->send.amo.value);
+    if (length == sizeof(uint64_t)) {
+        result64 = ucp_proto_amo_rkey_ptr_op64(
+                op, ptr, req->send.amo.value,
+                (op == UCT_ATOMIC_OP_CSWAP) ? *(uint64_t*)reply_buffer : 0);
+        if (fetch) {
+            *(uint64_t*)reply_buffer = result64;
+        }
+    } else {
+        ucs_assert(length == sizeof(uint32_t));
+        result32 = ucp_proto_amo_rkey_ptr_op32(
+                op, ptr, req->send.amo.value,
+                (op == UCT_ATOMIC_OP_CSWAP) ? *(uint32_t*)reply_buffer : 0);
+        if (fetch) {
+            *(uint32_t*)reply_buffer = result32;
+        }
+    }
+
+    ucp_request_complete_send(req, UCS_OK);
+    return UCS_OK;
+}
+
+static void
+ucp_proto_amo_rkey_ptr_probe(const ucp_proto_init_params_t *init_params)
+{
+    unsigned flags = 0;
+
+    /* Atomics on mapped memory are CPU atomics, which are not atomic with
+     * respect to device atomics the target may use on the same memory */
+    if ((init_params->select_param->dt_class != UCP_DATATYPE_CONTIG) ||
+        ucp_proto_amo_is_device_selected(init_params)) {
+        return;
+    }
+
+    if (!ucp_proto_init_check_op(init_params, UCS_BIT(UCP_OP_ID_AMO_POST))) {
+        /* The result is written directly to the reply buffer */
+        if (!UCP_MEM_IS_HOST(init_params->select_param->op.reply.mem_type)) {
+            return;
+        }
+
+        flags = UCP_PROTO_COMMON_INIT_FLAG_RESPONSE;
+    }
+
+    ucp_proto_rma_rkey_ptr_probe(init_params,
+                                 UCS_BIT(UCP_OP_ID_AMO_POST) |
+                                 UCS_BIT(UCP_OP_ID_AMO_FETCH) |
+                                 UCS_BIT(UCP_OP_ID_AMO_CSWAP),
+                                 sizeof(uint32_t), sizeof(uint64_t), flags);
+}
+
+ucp_proto_t ucp_amo_rkey_ptr_proto = {
+    .name     = "amo/rkey_ptr",
+    .desc     = UCP_PROTO_RMA_RKEY_PTR_DESC,
+    .flags    = 0,
+    .probe    = ucp_proto_amo_rkey_ptr_probe,
+    .query    = ucp_proto_single_query,
+    .progress = {ucp_proto_amo_rkey_ptr_progress},
+    .abort    = ucp_proto_abort_fatal_not_implemented,
+    .reset    = ucp_proto_request_bcopy_reset
+};
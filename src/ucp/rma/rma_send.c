@@ -44,16 +44,32 @@
     } while (0)
 
 
-#define UCP_RMA_CHECK_PTR(_context, _buffer, _length) \
+#define UCP_RMA_CHECK_PTR(_context, _buffer, _length, _param) \
     do { \
         UCP_CONTEXT_CHECK_FEATURE_FLAGS(_context, UCP_FEATURE_RMA, \
                                         return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM)); \
-        UCP_RMA_CHECK_ZERO_LENGTH(_length, return NULL); \
+        UCP_RMA_CHECK_COUNTER_PARAM(_param); \
+        UCP_RMA_CHECK_ZERO_LENGTH(_length, \
+                                  return ucp_rma_counter_update(_param, NULL)); \
         UCP_RMA_CHECK_BUFFER(_buffer, \
                              return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM)); \
     } while (0)
 
 
+#define UCP_RMA_CHECK_COUNTER_PARAM(_param) \
+    do { \
+        if (ENABLE_PARAMS_CHECK && \
+            ((_param)->op_attr_mask & UCP_OP_ATTR_FIELD_COUNTER) && \
+            ((_param)->op_attr_mask & (UCP_OP_ATTR_FIELD_REQUEST | \
+                                       UCP_OP_ATTR_FIELD_CALLBACK | \
+                                       UCP_OP_ATTR_FLAG_NO_IMM_CMPL))) { \
+            ucs_error("completion counter can't be used with a request or" \
+                      " a callback"); \
+            return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM); \
+        } \
+    } while (0)
+
+
 /* request can be released if
  *  - all fragments were sent (length == 0) (bcopy & zcopy mix)
  *  - all zcopy fragments are done (uct_comp.count == 0)
@@ -185,6 +201,52 @@ ucp_rma_nonblocking(ucp_ep_h ep, const void *buffer, size_t length,
     return ucp_rma_send_request(req, param);
 }
 
+static void
+ucp_rma_counter_completed(void *request, ucs_status_t status, void *user_data)
+{
+    ucp_rma_counter_complete(user_data, status);
+}
+
+/* Replace the counter by a callback which updates it on completion */
+static UCS_F_ALWAYS_INLINE const ucp_request_param_t *
+ucp_rma_counter_param(const ucp_request_param_t *param,
+                      ucp_request_param_t *counter_param)
+{
+    if (ucs_likely(!(param->op_attr_mask & UCP_OP_ATTR_FIELD_COUNTER))) {
+        return param;
+    }
+
+    *counter_param              = *param;
+    counter_param->op_attr_mask = (param->op_attr_mask &
+                                   ~UCP_OP_ATTR_FIELD_COUNTER) |
+                                  UCP_OP_ATTR_FIELD_CALLBACK |
+                                  UCP_OP_ATTR_FIELD_USER_DATA;
+    counter_param->cb.send      = ucp_rma_counter_completed;
+    counter_param->user_data    = param->counter;
+    return counter_param;
+}
+
+static UCS_F_ALWAYS_INLINE ucs_status_ptr_t
+ucp_rma_counter_update(const ucp_request_param_t *param, ucs_status_ptr_t ret)
+{
+    if (ucs_likely(!(param->op_attr_mask & UCP_OP_ATTR_FIELD_COUNTER))) {
+        return ret;
+    }
+
+    if (UCS_PTR_IS_PTR(ret)) {
+        /* The request is released by its completion, which updates the
+         * counter, so it is never returned to the user */
+        ((ucp_request_t*)ret - 1)->flags |= UCP_REQUEST_FLAG_RELEASED;
+        return NULL;
+    }
+
+    if (!UCS_PTR_IS_ERR(ret)) {
+        ucp_rma_counter_complete(param->counter, UCS_OK);
+    }
+
+    return ret;
+}
+
 ucs_status_t ucp_put_nbi(ucp_ep_h ep, const void *buffer, size_t length,
                          uint64_t remote_addr, ucp_rkey_h rkey)
 {
@@ -239,38 +301,28 @@ ucp_put_send_short(ucp_ep_h ep, const void *buffer, size_t length,
                             buffer, length, remote_addr, tl_rkey);
 }
 
-ucs_status_ptr_t ucp_put_nbx(ucp_ep_h ep, const void *buffer, size_t count,
-                             uint64_t remote_addr, ucp_rkey_h rkey,
-                             const ucp_request_param_t *param)
+/* Must be called with the worker lock held */
+static UCS_F_ALWAYS_INLINE ucs_status_ptr_t
+ucp_put_send(ucp_ep_h ep, const void *buffer, size_t count,
+             uint64_t remote_addr, ucp_rkey_h rkey,
+             const ucp_request_param_t *param)
 {
     ucp_worker_h worker     = ep->worker;
     size_t contig_length    = 0;
     ucp_datatype_t datatype = ucp_dt_make_contig(1);
     ucp_ep_rma_config_t *rma_config;
-    ucs_status_ptr_t ret;
     ucs_status_t status;
     ucp_request_t *req;
 
-    UCP_REQUEST_CHECK_PARAM(param);
-    UCP_RMA_CHECK_PTR(worker->context, buffer, count);
-    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
-
-    ucs_trace_req("put_nbx buffer %p count %zu remote_addr %" PRIx64
-                  " rkey %p to %s cb %p",
-                  buffer, count, remote_addr, rkey, ucp_ep_peer_name(ep),
-                  ucp_request_param_send_callback(param));
-
     if (worker->context->config.ext.proto_enable) {
         status = ucp_put_send_short(ep, buffer, count, remote_addr, rkey, param);
         if (ucs_likely(status != UCS_ERR_NO_RESOURCE) ||
             ucs_unlikely(param->op_attr_mask & UCP_OP_ATTR_FLAG_FORCE_IMM_CMPL)) {
-            ret = UCS_STATUS_PTR(status);
-            goto out_unlock;
+            return UCS_STATUS_PTR(status);
         }
 
         req = ucp_request_get_param(worker, param,
-                                    {ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
-                                    goto out_unlock;});
+                                    {return UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);});
         req->send.rma.rkey        = rkey;
         req->send.rma.remote_addr = remote_addr;
 
@@ -283,42 +335,179 @@ ucs_status_ptr_t ucp_put_nbx(ucp_ep_h ep, const void *buffer, size_t count,
             contig_length = count;
         }
 
-        ret = ucp_proto_request_send_op(
+        return ucp_proto_request_send_op(
                 ep, &ucp_rkey_config(worker, rkey)->proto_select,
                 rkey->cfg_index, req, UCP_OP_ID_PUT, buffer, count, datatype,
                 contig_length, param, 0, 0);
-    } else {
-        status = UCP_RKEY_RESOLVE(rkey, ep, rma);
-        if (status != UCS_OK) {
-            ret = UCS_STATUS_PTR(status);
-            goto out_unlock;
+    }
+
+    status = UCP_RKEY_RESOLVE(rkey, ep, rma);
+    if (status != UCS_OK) {
+        return UCS_STATUS_PTR(status);
+    }
+
+    /* Fast path for a single short message */
+    if (ucs_likely(!(param->op_attr_mask & UCP_OP_ATTR_FLAG_NO_IMM_CMPL) &&
+                   ((ssize_t)count <= rkey->cache.max_put_short))) {
+        status = UCS_PROFILE_CALL(uct_ep_put_short,
+                                  ucp_ep_get_fast_lane(ep,
+                                                       rkey->cache.rma_lane),
+                                  buffer, count, remote_addr,
+                                  rkey->cache.rma_rkey);
+        if (ucs_likely(status != UCS_ERR_NO_RESOURCE)) {
+            return UCS_STATUS_PTR(status);
         }
+    }
 
-        /* Fast path for a single short message */
-        if (ucs_likely(!(param->op_attr_mask & UCP_OP_ATTR_FLAG_NO_IMM_CMPL) &&
-                       ((ssize_t)count <= rkey->cache.max_put_short))) {
-            status = UCS_PROFILE_CALL(
-                    uct_ep_put_short,
-                    ucp_ep_get_fast_lane(ep, rkey->cache.rma_lane), buffer,
-                    count, remote_addr, rkey->cache.rma_rkey);
-            if (ucs_likely(status != UCS_ERR_NO_RESOURCE)) {
-                ret = UCS_STATUS_PTR(status);
-                goto out_unlock;
-            }
+    if (ucs_unlikely(param->op_attr_mask & UCP_OP_ATTR_FLAG_FORCE_IMM_CMPL)) {
+        return UCS_STATUS_PTR(UCS_ERR_NO_RESOURCE);
+    }
+
+    rma_config = &ucp_ep_config(ep)->rma[rkey->cache.rma_lane];
+    return ucp_rma_nonblocking(ep, buffer, count, remote_addr, rkey,
+                               UCP_RKEY_RMA_PROTO(rkey->cache.rma_proto_index)->progress_put,
+                               rma_config->put_zcopy_thresh, param);
+}
+
+ucs_status_ptr_t ucp_put_nbx(ucp_ep_h ep, const void *buffer, size_t count,
+                             uint64_t remote_addr, ucp_rkey_h rkey,
+                             const ucp_request_param_t *param)
+{
+    ucp_worker_h worker = ep->worker;
+    ucp_request_param_t counter_param;
+    ucs_status_ptr_t ret;
+
+    UCP_REQUEST_CHECK_PARAM_FIELDS(param, 0);
+    UCP_RMA_CHECK_PTR(worker->context, buffer, count, param);
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    ucs_trace_req("put_nbx buffer %p count %zu remote_addr %" PRIx64
+                  " rkey %p to %s cb %p",
+                  buffer, count, remote_addr, rkey, ucp_ep_peer_name(ep),
+                  ucp_request_param_send_callback(param));
+
+    ret = ucp_put_send(ep, buffer, count, remote_addr, rkey,
+                       ucp_rma_counter_param(param, &counter_param));
+    ret = ucp_rma_counter_update(param, ret);
+
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return ret;
+}
+
+static void
+ucp_put_batch_completed(void *request, ucs_status_t status, void *user_data)
+{
+    ucp_request_t *req = user_data;
+
+    if (ucs_unlikely(status != UCS_OK)) {
+        req->status = status;
+    }
+
+    if (--req->send.state.uct_comp.count == 0) {
+        ucp_request_complete_send(req, req->status);
+    }
+}
+
+static UCS_F_ALWAYS_INLINE ucs_status_ptr_t
+ucp_put_batch_send(ucp_worker_h worker, const ucp_put_batch_elem_t *elems,
+                   size_t count, const ucp_request_param_t *param)
+{
+    const ucp_put_batch_elem_t *elem;
+    ucp_request_param_t elem_param;
+    ucs_status_ptr_t elem_ret;
+    ucp_request_t *req;
+
+    req = ucp_request_get_param(worker, param,
+                                {return UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);});
+    req->flags                    = 0;
+    req->status                   = UCS_OK;
+    req->send.state.uct_comp.func = NULL;
+    /* Hold a reference while posting, so the request is not completed by an
+     * element which completes during the loop */
+    req->send.state.uct_comp.count = 1;
+
+    /* All elements share the same parameters, which complete the batch */
+    elem_param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                              UCP_OP_ATTR_FIELD_USER_DATA |
+                              (param->op_attr_mask &
+                               UCP_OP_ATTR_FIELD_MEMORY_TYPE);
+    elem_param.cb.send      = ucp_put_batch_completed;
+    elem_param.user_data    = req;
+    elem_param.memory_type  = param->memory_type;
+
+    ucs_carray_for_each(elem, elems, count) {
+        if (elem->length == 0) {
+            continue;
         }
 
-        if (ucs_unlikely(param->op_attr_mask & UCP_OP_ATTR_FLAG_FORCE_IMM_CMPL)) {
-            ret = UCS_STATUS_PTR(UCS_ERR_NO_RESOURCE);
-            goto out_unlock;
+        elem_ret = ucp_put_send(elem->ep, elem->buffer, elem->length,
+                                elem->remote_addr, elem->rkey, &elem_param);
+        if (UCS_PTR_IS_PTR(elem_ret)) {
+            /* Completion releases the element request */
+            ((ucp_request_t*)elem_ret - 1)->flags |= UCP_REQUEST_FLAG_RELEASED;
+            ++req->send.state.uct_comp.count;
+        } else if (ucs_unlikely(UCS_PTR_IS_ERR(elem_ret))) {
+            ucs_debug("put batch %p: failed to post element %zu: %s", req,
+                      (size_t)(elem - elems),
+                      ucs_status_string(UCS_PTR_STATUS(elem_ret)));
+            req->status = UCS_PTR_STATUS(elem_ret);
+            break;
         }
+    }
 
-        rma_config = &ucp_ep_config(ep)->rma[rkey->cache.rma_lane];
-        ret = ucp_rma_nonblocking(ep, buffer, count, remote_addr, rkey,
-                                  UCP_RKEY_RMA_PROTO(rkey->cache.rma_proto_index)->progress_put,
-                                  rma_config->put_zcopy_thresh, param);
+    if (--req->send.state.uct_comp.count == 0) {
+        req->flags |= UCP_REQUEST_FLAG_COMPLETED;
+        /* coverity[offset_free] */
+        ucp_request_imm_cmpl_param(param, req, send);
     }
 
-out_unlock:
+    ucp_request_set_send_callback_param(param, req, send);
+    return req + 1;
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_put_batch_nbx,
+                 (worker, elems, count, param), ucp_worker_h worker,
+                 const ucp_put_batch_elem_t *elems, size_t count,
+                 const ucp_request_param_t *param)
+{
+    const ucp_put_batch_elem_t *elem;
+    ucs_status_ptr_t ret;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_RMA,
+                                    return UCS_STATUS_PTR(
+                                            UCS_ERR_INVALID_PARAM));
+    UCP_REQUEST_CHECK_PARAM(param);
+
+    if (ENABLE_PARAMS_CHECK) {
+        if (param->op_attr_mask &
+            (UCP_OP_ATTR_FIELD_DATATYPE | UCP_OP_ATTR_FIELD_MEMH |
+             UCP_OP_ATTR_FIELD_COUNTER | UCP_OP_ATTR_FLAG_FORCE_IMM_CMPL)) {
+            ucs_error("put batch supports only contiguous unregistered buffers"
+                      " without forced immediate completion");
+            return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+        }
+
+        ucs_carray_for_each(elem, elems, count) {
+            if ((elem->ep->worker != worker) ||
+                ((elem->buffer == NULL) && (elem->length != 0))) {
+                ucs_error("put batch element %zu is invalid",
+                          (size_t)(elem - elems));
+                return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+            }
+        }
+    }
+
+    if (count == 0) {
+        return UCS_STATUS_PTR(UCS_OK);
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    ucs_trace_req("put_batch_nbx elems %p count %zu cb %p", elems, count,
+                  ucp_request_param_send_callback(param));
+
+    ret = ucp_put_batch_send(worker, elems, count, param);
+
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
     return ret;
 }
@@ -351,36 +540,22 @@ ucs_status_ptr_t ucp_get_nb(ucp_ep_h ep, void *buffer, size_t length,
     return ucp_get_nbx(ep, buffer, length, remote_addr, rkey, &param);
 }
 
-ucs_status_ptr_t ucp_get_nbx(ucp_ep_h ep, void *buffer, size_t count,
-                             uint64_t remote_addr, ucp_rkey_h rkey,
-                             const ucp_request_param_t *param)
+/* Must be called with the worker lock held */
+static UCS_F_ALWAYS_INLINE ucs_status_ptr_t
+ucp_get_send(ucp_ep_h ep, void *buffer, size_t count, uint64_t remote_addr,
+             ucp_rkey_h rkey, const ucp_request_param_t *param)
 {
     ucp_worker_h worker  = ep->worker;
     size_t contig_length = 0;
     ucp_ep_rma_config_t *rma_config;
-    ucs_status_ptr_t ret;
     ucs_status_t status;
     ucp_request_t *req;
     uintptr_t datatype;
 
-    if (ucs_unlikely(param->op_attr_mask & UCP_OP_ATTR_FLAG_FORCE_IMM_CMPL)) {
-        return UCS_STATUS_PTR(UCS_ERR_NO_RESOURCE);
-    }
-
-    UCP_REQUEST_CHECK_PARAM(param);
-    UCP_RMA_CHECK_PTR(worker->context, buffer, count);
-    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
-
-    ucs_trace_req("get_nbx buffer %p count %zu remote_addr %" PRIx64
-                  " rkey %p from %s cb %p",
-                  buffer, count, remote_addr, rkey, ucp_ep_peer_name(ep),
-                  ucp_request_param_send_callback(param));
-
     if (worker->context->config.ext.proto_enable) {
         datatype = ucp_request_param_datatype(param);
         req = ucp_request_get_param(worker, param,
-                                    {ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
-                                    goto out_unlock;});
+                                    {return UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);});
 
         req->send.rma.rkey             = rkey;
         req->send.rma.remote_addr      = remote_addr;
@@ -389,24 +564,48 @@ ucs_status_ptr_t ucp_get_nbx(ucp_ep_h ep, void *buffer, size_t count,
             contig_length = ucp_contig_dt_length(datatype, count);
         }
 
-        ret = ucp_proto_request_send_op(
+        return ucp_proto_request_send_op(
                 ep, &ucp_rkey_config(worker, rkey)->proto_select,
                 rkey->cfg_index, req, UCP_OP_ID_GET, buffer, count, datatype,
                 contig_length, param, 0, 0);
-    } else {
-        status = UCP_RKEY_RESOLVE(rkey, ep, rma);
-        if (status != UCS_OK) {
-            ret = UCS_STATUS_PTR(status);
-            goto out_unlock;
-        }
+    }
+
+    status = UCP_RKEY_RESOLVE(rkey, ep, rma);
+    if (status != UCS_OK) {
+        return UCS_STATUS_PTR(status);
+    }
+
+    rma_config = &ucp_ep_config(ep)->rma[rkey->cache.rma_lane];
+    return ucp_rma_nonblocking(ep, buffer, count, remote_addr, rkey,
+                               UCP_RKEY_RMA_PROTO(rkey->cache.rma_proto_index)->progress_get,
+                               rma_config->get_zcopy_thresh, param);
+}
+
+ucs_status_ptr_t ucp_get_nbx(ucp_ep_h ep, void *buffer, size_t count,
+                             uint64_t remote_addr, ucp_rkey_h rkey,
+                             const ucp_request_param_t *param)
+{
+    ucp_worker_h worker = ep->worker;
+    ucp_request_param_t counter_param;
+    ucs_status_ptr_t ret;
 
-        rma_config = &ucp_ep_config(ep)->rma[rkey->cache.rma_lane];
-        ret        = ucp_rma_nonblocking(ep, buffer, count, remote_addr, rkey,
-                                         UCP_RKEY_RMA_PROTO(rkey->cache.rma_proto_index)->progress_get,
-                                         rma_config->get_zcopy_thresh, param);
+    if (ucs_unlikely(param->op_attr_mask & UCP_OP_ATTR_FLAG_FORCE_IMM_CMPL)) {
+        return UCS_STATUS_PTR(UCS_ERR_NO_RESOURCE);
     }
 
-out_unlock:
+    UCP_REQUEST_CHECK_PARAM_FIELDS(param, 0);
+    UCP_RMA_CHECK_PTR(worker->context, buffer, count, param);
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    ucs_trace_req("get_nbx buffer %p count %zu remote_addr %" PRIx64
+                  " rkey %p from %s cb %p",
+                  buffer, count, remote_addr, rkey, ucp_ep_peer_name(ep),
+                  ucp_request_param_send_callback(param));
+
+    ret = ucp_get_send(ep, buffer, count, remote_addr, rkey,
+                       ucp_rma_counter_param(param, &counter_param));
+    ret = ucp_rma_counter_update(param, ret);
+
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
     return ret;
 }
@@ -430,3 +629,46 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_get, (ep, buffer, length, remote_addr, rkey),
                                    (ucp_send_callback_t)ucs_empty_function),
                         "get");
 }
+
+ucs_status_t ucp_counter_create(ucp_worker_h worker, ucp_counter_h *counter_p)
+{
+    ucp_counter_h counter;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_RMA,
+                                    return UCS_ERR_INVALID_PARAM);
+
+    counter = ucs_malloc(sizeof(*counter), "ucp_counter");
+    if (counter == NULL) {
+        ucs_error("failed to allocate completion counter");
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    counter->worker = worker;
+    counter->value  = 0;
+    counter->status = UCS_OK;
+    *counter_p      = counter;
+    return UCS_OK;
+}
+
+void ucp_counter_destroy(ucp_counter_h counter)
+{
+    ucs_free(counter);
+}
+
+uint64_t ucp_counter_read(ucp_counter_h counter, ucs_status_t *status_p)
+{
+    if (status_p != NULL) {
+        *status_p = (ucs_status_t)counter->status;
+    }
+
+    return counter->value;
+}
+
+ucs_status_t ucp_counter_wait(ucp_counter_h counter, uint64_t value)
+{
+    while (counter->value < value) {
+        ucp_worker_progress(counter->worker);
+    }
+
+    return (ucs_status_t)counter->status;
+}
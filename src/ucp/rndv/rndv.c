@@ -1754,6 +1754,8 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_rts_handler,
     ucp_worker_h worker         = arg;
     ucp_rndv_rts_hdr_t *rts_hdr = data;
 
+    UCS_PROBE(rndv_rts_recv, worker, rts_hdr->sreq.req_id, rts_hdr->size);
+
     if (ucp_rndv_rts_is_am(rts_hdr)) {
         return ucp_am_rndv_process_rts(arg, data, length, tl_flags);
     } else {
@@ -1770,6 +1772,8 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_ats_handler,
     ucp_reply_hdr_t *rep_hdr = data;
     ucp_request_t *sreq;
 
+    UCS_PROBE(rndv_ats_recv, worker, rep_hdr->req_id, (int)rep_hdr->status);
+
     if (worker->context->config.ext.proto_enable) {
         return ucp_proto_rndv_ats_handler(arg, data, length, flags);
     }
@@ -2272,6 +2276,9 @@ UCS_PROFILE_FUNC(ucs_status_t, ucp_rndv_rtr_handler,
     int is_put_supported;
     uct_rkey_t uct_rkey;
 
+    UCS_PROBE(rndv_rtr_recv, worker, rndv_rtr_hdr->sreq_id,
+              rndv_rtr_hdr->offset, rndv_rtr_hdr->size);
+
     if (context->config.ext.proto_enable) {
         return ucp_proto_rndv_handle_rtr(arg, data, length, flags);
     }
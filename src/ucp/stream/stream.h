@@ -25,6 +25,18 @@ typedef struct {
 } ucp_stream_am_data_t;
 
 
+/**
+ * User-provided receive ring, see @ref ucp_stream_recv_ring_attach.
+ * The offsets grow monotonically and are wrapped by the ring size on access.
+ */
+typedef struct ucp_stream_ring {
+    void                     *buffer;
+    size_t                   size;
+    size_t                   head;   /* Offset of the next received byte */
+    size_t                   tail;   /* Offset of the next byte to consume */
+} ucp_stream_ring_t;
+
+
 void ucp_stream_ep_init(ucp_ep_h ep);
 
 void ucp_stream_ep_cleanup(ucp_ep_h ep, ucs_status_t status);
@@ -91,6 +91,31 @@ ucp_stream_rdesc_get(ucp_ep_ext_t *ep_ext)
     return rdesc;
 }
 
+static UCS_F_ALWAYS_INLINE void
+ucp_stream_ep_set_ready(ucp_ep_ext_t *ep_ext, ucp_worker_h worker)
+{
+    if (!ucp_stream_ep_is_queued(ep_ext) &&
+        (ep_ext->ep->flags & UCP_EP_FLAG_USED)) {
+        ucp_stream_ep_enqueue(ep_ext, worker);
+    }
+}
+
+static UCS_F_ALWAYS_INLINE size_t
+ucp_stream_ring_write(ucp_stream_ring_t *ring, const void *data, size_t length)
+{
+    size_t offset, first;
+
+    length = ucs_min(length, ring->size - (ring->head - ring->tail));
+    offset = ring->head % ring->size;
+    first  = ucs_min(length, ring->size - offset);
+
+    memcpy(UCS_PTR_BYTE_OFFSET(ring->buffer, offset), data, first);
+    memcpy(ring->buffer, UCS_PTR_BYTE_OFFSET(data, first), length - first);
+    ring->head += length;
+
+    return length;
+}
+
 static UCS_F_ALWAYS_INLINE ucs_status_ptr_t
 ucp_stream_recv_data_nb_nolock(ucp_ep_h ep, size_t *length)
 {
@@ -119,7 +144,11 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_stream_recv_data_nb, (ep, length),
                                     return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
 
     UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
-    status_ptr = ucp_stream_recv_data_nb_nolock(ep, length);
+    if (ucs_unlikely(ep->ext->stream.ring != NULL)) {
+        status_ptr = UCS_STATUS_PTR(UCS_ERR_BUSY);
+    } else {
+        status_ptr = ucp_stream_recv_data_nb_nolock(ep, length);
+    }
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
 
     return status_ptr;
@@ -424,6 +453,11 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_stream_recv_nbx,
 
     UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
 
+    if (ucs_unlikely(ep->ext->stream.ring != NULL)) {
+        ret = UCS_STATUS_PTR(UCS_ERR_BUSY);
+        goto out;
+    }
+
     status = ucp_stream_try_recv_inplace(ep, buffer, count, length, param);
     if (status != UCS_ERR_NO_PROGRESS) {
         ret = UCS_STATUS_PTR(status);
@@ -469,14 +503,27 @@ ucp_stream_am_data_process(ucp_worker_t *worker, ucp_ep_ext_t *ep_ext,
     ucp_recv_desc_t *rdesc;
     ucp_request_t   *req;
     ssize_t          unpacked;
+    size_t           written;
 
     rdesc_tmp.length         = length;
     rdesc_tmp.payload_offset = sizeof(*am_data); /* add sizeof(*rdesc) only if
                                                     am_data won't be handled in
                                                     place */
 
-    /* First, process expected requests */
-    if (!ucp_stream_ep_has_data(ep_ext)) {
+    if (ucs_unlikely(ep_ext->stream.ring != NULL)) {
+        /* Write to the user ring, unless older data is waiting for space */
+        if (!ucp_stream_ep_has_data(ep_ext)) {
+            payload = UCS_PTR_BYTE_OFFSET(am_data, rdesc_tmp.payload_offset);
+            written = ucp_stream_ring_write(ep_ext->stream.ring, payload,
+                                            rdesc_tmp.length);
+            if (written == rdesc_tmp.length) {
+                ucp_stream_ep_set_ready(ep_ext, worker);
+                return UCS_OK;
+            }
+            ucp_stream_rdesc_advance(&rdesc_tmp, written, ep_ext);
+        }
+    } else if (!ucp_stream_ep_has_data(ep_ext)) {
+        /* First, process expected requests */
         while (!ucs_queue_is_empty(&ep_ext->stream.match_q)) {
             req      = ucs_queue_head_elem_non_empty(&ep_ext->stream.match_q,
                                                      ucp_request_t, recv.queue);
@@ -537,6 +584,7 @@ void ucp_stream_ep_init(ucp_ep_h ep)
     if (ep->worker->context->config.features & UCP_FEATURE_STREAM) {
         ep_ext->stream.ready_list.prev = NULL;
         ep_ext->stream.ready_list.next = NULL;
+        ep_ext->stream.ring            = NULL;
         ucs_queue_head_init(&ep_ext->stream.match_q);
     }
 }
@@ -562,6 +610,9 @@ void ucp_stream_ep_cleanup(ucp_ep_h ep, ucs_status_t status)
         ucp_stream_ep_dequeue(ep_ext);
     }
 
+    ucs_free(ep_ext->stream.ring);
+    ep_ext->stream.ring = NULL;
+
     /* cancel not completed requests */
     ucs_assert(!ucp_stream_ep_has_data(ep_ext));
     while (!ucs_queue_is_empty(&ep_ext->stream.match_q)) {
@@ -571,6 +622,165 @@ void ucp_stream_ep_cleanup(ucp_ep_h ep, ucs_status_t status)
     }
 }
 
+/* Move the data which did not fit into the ring, in arrival order */
+static void ucp_stream_ring_fill(ucp_ep_ext_t *ep_ext)
+{
+    ucp_stream_ring_t *ring = ep_ext->stream.ring;
+    ucp_recv_desc_t *rdesc;
+    size_t written;
+
+    while (ucp_stream_ep_has_data(ep_ext) &&
+           ((ring->head - ring->tail) < ring->size)) {
+        rdesc   = ucp_stream_rdesc_get(ep_ext);
+        written = ucp_stream_ring_write(ring, ucp_stream_rdesc_payload(rdesc),
+                                        rdesc->length);
+        ucp_stream_rdesc_advance(rdesc, written, ep_ext);
+    }
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_stream_recv_ring_attach,
+                 (ep, buffer, length), ucp_ep_h ep, void *buffer, size_t length)
+{
+    ucp_ep_ext_t *ep_ext = ep->ext;
+    ucp_stream_ring_t *ring;
+    ucs_status_t status;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(ep->worker->context, UCP_FEATURE_STREAM,
+                                    return UCS_ERR_INVALID_PARAM);
+
+    if ((buffer == NULL) || (length == 0)) {
+        ucs_error("ep %p: invalid stream receive ring buffer %p length %zu",
+                  ep, buffer, length);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+
+    if ((ep_ext->stream.ring != NULL) ||
+        (!ucp_stream_ep_has_data(ep_ext) &&
+         !ucs_queue_is_empty(&ep_ext->stream.match_q))) {
+        status = UCS_ERR_BUSY;
+        goto out;
+    }
+
+    ring = ucs_malloc(sizeof(*ring), "ucp_stream_ring");
+    if (ring == NULL) {
+        status = UCS_ERR_NO_MEMORY;
+        goto out;
+    }
+
+    ring->buffer        = buffer;
+    ring->size          = length;
+    ring->head          = 0;
+    ring->tail          = 0;
+    ep_ext->stream.ring = ring;
+
+    ucp_stream_ring_fill(ep_ext);
+    if (ring->head != ring->tail) {
+        ucp_stream_ep_set_ready(ep_ext, ep->worker);
+    }
+
+    ucs_debug("ep %p: attached stream receive ring %p length %zu", ep, buffer,
+              length);
+    status = UCS_OK;
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
+    return status;
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_stream_recv_ring_detach, (ep), ucp_ep_h ep)
+{
+    ucp_ep_ext_t *ep_ext = ep->ext;
+    ucp_stream_ring_t *ring;
+    ucs_status_t status;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(ep->worker->context, UCP_FEATURE_STREAM,
+                                    return UCS_ERR_INVALID_PARAM);
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+
+    ring = ep_ext->stream.ring;
+    if (ring == NULL) {
+        status = UCS_ERR_INVALID_PARAM;
+        goto out;
+    }
+
+    if (ring->head != ring->tail) {
+        status = UCS_ERR_BUSY;
+        goto out;
+    }
+
+    /* Data is held outside of the ring only while the ring is full */
+    ucs_assert(!ucp_stream_ep_has_data(ep_ext));
+    ucs_free(ring);
+    ep_ext->stream.ring = NULL;
+    status              = UCS_OK;
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
+    return status;
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_stream_recv_ring_peek,
+                 (ep, data_p, length_p), ucp_ep_h ep, void **data_p,
+                 size_t *length_p)
+{
+    ucp_stream_ring_t *ring;
+    ucs_status_t status;
+    size_t offset;
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+
+    ring = ep->ext->stream.ring;
+    if (ucs_unlikely(ring == NULL)) {
+        status = UCS_ERR_INVALID_PARAM;
+        goto out;
+    }
+
+    offset    = ring->tail % ring->size;
+    *data_p   = UCS_PTR_BYTE_OFFSET(ring->buffer, offset);
+    *length_p = ucs_min(ring->head - ring->tail, ring->size - offset);
+    status    = UCS_OK;
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
+    return status;
+}
+
+UCS_PROFILE_FUNC(ucs_status_t, ucp_stream_recv_ring_consume, (ep, length),
+                 ucp_ep_h ep, size_t length)
+{
+    ucp_ep_ext_t *ep_ext = ep->ext;
+    ucp_stream_ring_t *ring;
+    ucs_status_t status;
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(ep->worker);
+
+    ring = ep_ext->stream.ring;
+    if (ucs_unlikely((ring == NULL) ||
+                     (length > (ring->head - ring->tail)))) {
+        status = UCS_ERR_INVALID_PARAM;
+        goto out;
+    }
+
+    ring->tail += length;
+    /* Moving the remaining data to the ring may dequeue the endpoint */
+    ucp_stream_ring_fill(ep_ext);
+
+    if (ring->head != ring->tail) {
+        ucp_stream_ep_set_ready(ep_ext, ep->worker);
+    } else if (ucp_stream_ep_is_queued(ep_ext)) {
+        ucp_stream_ep_dequeue(ep_ext);
+    }
+
+    status = UCS_OK;
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(ep->worker);
+    return status;
+}
+
 void ucp_stream_ep_activate(ucp_ep_h ep)
 {
     ucp_ep_ext_t *ep_ext = ep->ext;
@@ -606,10 +816,7 @@ ucp_stream_am_handler(void *am_arg, void *am_data, size_t am_length,
     }
 
     ucs_assert(status == UCS_INPROGRESS);
-
-    if (!ucp_stream_ep_is_queued(ep_ext) && (ep->flags & UCP_EP_FLAG_USED)) {
-        ucp_stream_ep_enqueue(ep_ext, worker);
-    }
+    ucp_stream_ep_set_ready(ep_ext, worker);
 
     return (am_flags & UCT_CB_PARAM_FLAG_DESC) ? UCS_INPROGRESS : UCS_OK;
 }
@@ -292,3 +292,129 @@ out:
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
     return ret;
 }
+
+static void
+ucp_tag_recv_persistent_completed(void *request, ucs_status_t status,
+                                  const ucp_tag_recv_info_t *info,
+                                  void *user_data)
+{
+    ucp_request_t *req             = (ucp_request_t*)request - 1;
+    ucp_request_persistent_t *prst = user_data;
+
+    req->flags |= UCP_REQUEST_FLAG_PERSISTENT;
+    if (req->flags & UCP_REQUEST_FLAG_RELEASED) {
+        ucp_request_persistent_free(prst);
+    } else if (prst->recv.cb != NULL) {
+        prst->recv.cb(request, status, info, prst->user_data);
+    }
+}
+
+static ucs_status_t ucp_tag_recv_persistent_start(ucp_request_t *req)
+{
+    ucp_request_persistent_t *prst = req->user_data;
+    ucp_worker_h worker            = prst->recv.worker;
+    ucp_recv_desc_t *rdesc;
+    ucs_status_ptr_t ret;
+
+    rdesc = ucp_tag_unexp_search(&worker->tm, prst->tag, prst->recv.tag_mask,
+                                 1, "recv_start");
+    ret   = ucp_tag_recv_common(worker, prst->recv.buffer, prst->recv.count,
+                                prst->tag, prst->recv.tag_mask, req, rdesc,
+                                &prst->recv.param, "recv_start");
+    req->flags |= UCP_REQUEST_FLAG_PERSISTENT;
+    if (!UCS_PTR_IS_PTR(ret)) {
+        return UCS_PTR_STATUS(ret);
+    }
+
+    /* The completion callback was already called if the receive completed
+     * immediately, and UCP_OP_ATTR_FLAG_NO_IMM_CMPL was set */
+    ucs_assert(ret == (req + 1));
+    return UCS_INPROGRESS;
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_recv_init_nbx,
+                 (worker, buffer, count, tag, tag_mask, param),
+                 ucp_worker_h worker, void *buffer, size_t count,
+                 ucp_tag_t tag, ucp_tag_t tag_mask,
+                 const ucp_request_param_t *param)
+{
+    ucp_request_persistent_t *prst;
+    ucp_request_param_t *recv_param;
+    ucp_datatype_iter_t dt_iter;
+    ucs_status_ptr_t ret;
+    ucs_status_t status;
+    ucp_request_t *req;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_TAG,
+                                    return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM));
+    UCP_REQUEST_CHECK_PARAM(param);
+
+    status = ucp_request_persistent_check_param(param);
+    if (status != UCS_OK) {
+        return UCS_STATUS_PTR(status);
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    ucs_trace_req("recv_init_nbx buffer %p count %zu tag %" PRIx64 "/%" PRIx64,
+                  buffer, count, tag, tag_mask);
+
+    /* Validate the buffer and detect its memory type once */
+    status = ucp_datatype_iter_init_unpack(worker->context, buffer, count,
+                                           &dt_iter, param);
+    if (status != UCS_OK) {
+        ret = UCS_STATUS_PTR(status);
+        goto out;
+    }
+
+    req = ucp_request_get(worker);
+    if (req == NULL) {
+        ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+        goto out;
+    }
+
+    prst = ucp_request_persistent_init(req, param,
+                                       ucp_tag_recv_persistent_start, tag,
+                                       UCP_REQUEST_FLAG_RECV_TAG);
+    if (prst == NULL) {
+        ucp_request_put(req);
+        ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+        goto out;
+    }
+
+    prst->mem_type      = dt_iter.mem_info.type;
+    prst->recv.worker   = worker;
+    prst->recv.cb       = UCP_REQUEST_PARAM_FIELD(param, CALLBACK, cb.recv,
+                                                  NULL);
+    prst->recv.tag_mask = tag_mask;
+    prst->recv.buffer   = buffer;
+    prst->recv.count    = count;
+    memset(&req->recv.tag.info, 0, sizeof(req->recv.tag.info));
+
+    /* Keep the parameters which describe the receive buffer and the immediate
+     * completion mode, and receive into the persistent request itself, with
+     * a callback which is called for every completion */
+    recv_param                = &prst->recv.param;
+    *recv_param               = *param;
+    recv_param->op_attr_mask &= UCP_OP_ATTR_FIELD_DATATYPE |
+                                UCP_OP_ATTR_FIELD_MEMORY_TYPE |
+                                UCP_OP_ATTR_FIELD_MEMH |
+                                UCP_OP_ATTR_FLAG_NO_IMM_CMPL |
+                                UCP_OP_ATTR_FLAG_FORCE_IMM_CMPL;
+    recv_param->op_attr_mask |= UCP_OP_ATTR_FIELD_REQUEST |
+                                UCP_OP_ATTR_FIELD_CALLBACK |
+                                UCP_OP_ATTR_FIELD_USER_DATA;
+    recv_param->request       = req + 1;
+    recv_param->cb.recv       = ucp_tag_recv_persistent_completed;
+    recv_param->user_data     = prst;
+    if (dt_iter.mem_info.type == UCS_MEMORY_TYPE_HOST) {
+        recv_param->op_attr_mask |= UCP_OP_ATTR_FIELD_MEMORY_TYPE;
+        recv_param->memory_type   = UCS_MEMORY_TYPE_HOST;
+    }
+
+    ret = req + 1;
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return ret;
+}
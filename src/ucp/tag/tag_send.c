@@ -284,7 +284,7 @@ UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_send_nbx,
     }
 
     worker = ep->worker;
-    req    = ucp_request_get_param(worker, param, {
+    req    = ucp_request_get_send_param(worker, param, {
         ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
         goto out;
     });
@@ -358,3 +358,171 @@ out:
     UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
     return ret;
 }
+
+static void ucp_tag_send_persistent_completed(void *request,
+                                              ucs_status_t status,
+                                              void *user_data)
+{
+    ucp_request_t *req             = (ucp_request_t*)request - 1;
+    ucp_request_persistent_t *prst = user_data;
+
+    req->flags |= UCP_REQUEST_FLAG_PERSISTENT;
+    if (req->flags & UCP_REQUEST_FLAG_RELEASED) {
+        ucp_request_persistent_free(prst);
+    } else if (prst->send.cb != NULL) {
+        prst->send.cb(request, status, prst->user_data);
+    }
+}
+
+static ucs_status_t ucp_tag_send_persistent_start(ucp_request_t *req)
+{
+    ucp_request_persistent_t *prst = req->user_data;
+    ucp_ep_h ep                    = prst->send.ep;
+    ucp_context_h context          = ep->worker->context;
+    ucp_datatype_iter_t *dt_iter   = &req->send.state.dt_iter;
+    void *buffer                   = prst->send.dt_iter.type.contig.buffer;
+    size_t msg_length              = prst->send.dt_iter.length;
+    ucp_proto_select_param_t sel_param;
+    ucp_request_param_t param;
+    ucs_status_t status;
+
+    /* Try the short protocol first, which does not use the request, like
+     * ucp_tag_send_nbx() does */
+    if (!(prst->op_attr_mask & UCP_OP_ATTR_FLAG_NO_IMM_CMPL) &&
+        (prst->mem_type == UCS_MEMORY_TYPE_HOST)) {
+        param.op_attr_mask = UCP_OP_ATTR_FIELD_MEMORY_TYPE;
+        param.memory_type  = UCS_MEMORY_TYPE_HOST;
+        status             = UCS_PROFILE_CALL(ucp_tag_send_inline, ep, buffer,
+                                              msg_length, prst->tag, &param);
+        if (ucs_likely(status != UCS_ERR_NO_RESOURCE)) {
+            return status;
+        }
+    }
+
+    if (ucs_unlikely(prst->op_attr_mask & UCP_OP_ATTR_FLAG_FORCE_IMM_CMPL)) {
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    ucp_proto_request_send_init(req, ep, UCP_REQUEST_FLAG_PERSISTENT);
+    req->send.msg_proto.tag = prst->tag;
+    *dt_iter                = prst->send.dt_iter;
+
+    if (ucs_likely((prst->send.proto_config != NULL) &&
+                   (prst->send.proto_config->ep_cfg_index ==
+                    ep->cfg_index))) {
+        ucp_proto_request_set_proto(req, prst->send.proto_config, msg_length);
+        if (prst->memh != NULL) {
+            /* The reference is released when the protocol completes */
+            ucs_rcache_region_hold(context->rcache, &prst->memh->super);
+            dt_iter->type.contig.memh = prst->memh;
+        }
+    } else {
+        /* First start, or the endpoint was reconfigured since the last one,
+         * and the new protocol may register the buffer differently */
+        ucp_request_persistent_memh_put(prst);
+        ucp_proto_select_param_init(&sel_param, UCP_OP_ID_TAG_SEND,
+                                    prst->op_attr_mask, 0, dt_iter->dt_class,
+                                    &dt_iter->mem_info, prst->send.sg_count);
+        status = ucp_proto_request_lookup_proto(ep->worker, ep, req,
+                                                &ucp_ep_config(ep)->proto_select,
+                                                UCP_WORKER_CFG_INDEX_NULL,
+                                                &sel_param, msg_length);
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        prst->send.proto_config = req->send.proto_config;
+    }
+
+    UCS_PROFILE_CALL_VOID(ucp_request_send, req);
+    if (req->flags & UCP_REQUEST_FLAG_COMPLETED) {
+        if (!(prst->op_attr_mask & UCP_OP_ATTR_FLAG_NO_IMM_CMPL)) {
+            return req->status;
+        }
+
+        ucp_tag_send_persistent_completed(req + 1, req->status, prst);
+        return UCS_INPROGRESS;
+    }
+
+    /* Keep the registration done by the protocol for the next starts, so
+     * they do not look up the registration cache again */
+    if ((prst->memh == NULL) && (context->rcache != NULL) &&
+        (dt_iter->type.contig.memh != NULL) &&
+        !ucp_memh_is_user_memh(dt_iter->type.contig.memh) &&
+        !ucp_memh_is_zero_length(dt_iter->type.contig.memh)) {
+        prst->memh = dt_iter->type.contig.memh;
+        ucs_rcache_region_hold(context->rcache, &prst->memh->super);
+    }
+
+    ucp_request_set_callback(req, send.cb, ucp_tag_send_persistent_completed);
+    return UCS_INPROGRESS;
+}
+
+UCS_PROFILE_FUNC(ucs_status_ptr_t, ucp_tag_send_init_nbx,
+                 (ep, buffer, count, tag, param),
+                 ucp_ep_h ep, const void *buffer, size_t count,
+                 ucp_tag_t tag, const ucp_request_param_t *param)
+{
+    ucp_worker_h worker = ep->worker;
+    ucp_request_persistent_t *prst;
+    ucp_datatype_t datatype;
+    ucs_status_ptr_t ret;
+    ucs_status_t status;
+    ucp_request_t *req;
+
+    UCP_CONTEXT_CHECK_FEATURE_FLAGS(worker->context, UCP_FEATURE_TAG,
+                                    return UCS_STATUS_PTR(
+                                            UCS_ERR_INVALID_PARAM));
+    UCP_REQUEST_CHECK_PARAM(param);
+
+    if (!worker->context->config.ext.proto_enable) {
+        return UCS_STATUS_PTR(UCS_ERR_UNSUPPORTED);
+    }
+
+    status = ucp_request_persistent_check_param(param);
+    if (status != UCS_OK) {
+        return UCS_STATUS_PTR(status);
+    }
+
+    UCP_WORKER_THREAD_CS_ENTER_CONDITIONAL(worker);
+
+    ucs_trace_req("send_init_nbx buffer %p count %zu tag %" PRIx64 " to %s",
+                  buffer, count, tag, ucp_ep_peer_name(ep));
+
+    req = ucp_request_get(worker);
+    if (req == NULL) {
+        ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+        goto out;
+    }
+
+    prst = ucp_request_persistent_init(req, param,
+                                       ucp_tag_send_persistent_start, tag, 0);
+    if (prst == NULL) {
+        ucp_request_put(req);
+        ret = UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+        goto out;
+    }
+
+    datatype = ucp_request_param_datatype(param);
+    status   = ucp_datatype_iter_init(worker->context, (void*)buffer, count,
+                                      datatype,
+                                      ucp_contig_dt_length(datatype, count), 1,
+                                      &prst->send.dt_iter,
+                                      &prst->send.sg_count, param);
+    if (status != UCS_OK) {
+        ucs_free(prst);
+        ucp_request_put(req);
+        ret = UCS_STATUS_PTR(status);
+        goto out;
+    }
+
+    prst->mem_type          = prst->send.dt_iter.mem_info.type;
+    prst->send.ep           = ep;
+    prst->send.cb           = ucp_request_param_send_callback(param);
+    prst->send.proto_config = NULL;
+    ret                     = req + 1;
+
+out:
+    UCP_WORKER_THREAD_CS_EXIT_CONDITIONAL(worker);
+    return ret;
+}
@@ -1865,8 +1865,22 @@ ucp_wireup_add_rma_bw_lanes(const ucp_wireup_select_params_t *select_params,
 
         UCP_CONTEXT_MEM_CAP_TLS(context, UCS_MEMORY_TYPE_HOST, access_mem_types,
                                 tl_bitmap);
-        ucp_wireup_add_bw_lanes(select_params, &bw_info, tl_bitmap,
-                                UCP_NULL_LANE, select_ctx, 0);
+        added_lanes = ucp_wireup_add_bw_lanes(select_params, &bw_info,
+                                              tl_bitmap, UCP_NULL_LANE,
+                                              select_ctx, 0);
+
+        /* RMA and atomics may also target memory allocated by a memory
+         * domain which can map it to the peer, e.g. by ucp_mem_map() */
+        if ((added_lanes == 0) &&
+            (ucp_ep_get_context_features(ep) &
+             (UCP_FEATURE_RMA | UCP_FEATURE_AMO))) {
+            bw_info.criteria.local_md_flags = UCT_MD_FLAG_ALLOC |
+                                              UCT_MD_FLAG_RKEY_PTR;
+            ucp_wireup_add_bw_lanes(select_params, &bw_info, tl_bitmap,
+                                    UCP_NULL_LANE, select_ctx, 0);
+        }
+
+        bw_info.criteria.local_md_flags = md_reg_flag;
     }
 
     bw_info.criteria.title            = "high-bw remote memory access";
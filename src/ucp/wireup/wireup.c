@@ -1020,6 +1020,25 @@ static int ucp_wireup_should_activate_wiface(ucp_worker_iface_t *wiface,
            (ep->flags & UCP_EP_FLAG_INTERNAL);
 }
 
+static int
+ucp_wireup_is_lane_releasable(ucp_worker_iface_t *wiface, ucp_ep_h ep,
+                              ucp_lane_index_t lane)
+{
+    ucp_context_h context = wiface->worker->context;
+    uct_device_type_t dev_type;
+
+    if (!context->config.ext.ep_release_idle_lanes ||
+        ucp_wireup_should_activate_wiface(wiface, ep, lane)) {
+        return 0;
+    }
+
+    /* Only shared memory and loopback endpoints keep no state on the remote
+     * side, and can be recreated from the remote interface address */
+    dev_type = context->tl_rscs[wiface->rsc_index].tl_rsc.dev_type;
+    return (dev_type == UCT_DEVICE_TYPE_SHM) ||
+           (dev_type == UCT_DEVICE_TYPE_SELF);
+}
+
 static ucs_status_t
 ucp_wireup_connect_lane_to_iface(ucp_ep_h ep, ucp_lane_index_t lane,
                                  unsigned path_index,
@@ -1091,6 +1110,11 @@ ucp_wireup_connect_lane_to_iface(ucp_ep_h ep, ucp_lane_index_t lane,
         ucp_worker_iface_progress_ep(wiface);
     }
 
+    if (ucp_wireup_is_lane_releasable(wiface, ep, lane)) {
+        ucp_ep_cold_lane_add(ep, lane, path_index, &wiface->attr,
+                             address->dev_addr, address->iface_addr);
+    }
+
     return UCS_OK;
 }
 
@@ -1658,6 +1682,12 @@ ucs_status_t ucp_wireup_init_lanes(ucp_ep_h ep, unsigned ep_init_flags,
 
     ucp_wireup_gather_pending_reqs(ep, &replay_pending_queue);
 
+    /* Lanes may be moved or replaced by the new configuration */
+    status = ucp_ep_cold_lanes_reset(ep);
+    if (status != UCS_OK) {
+        goto out;
+    }
+
     status = ucp_wireup_try_select_lanes(ep, ep_init_flags, &tl_bitmap,
                                          remote_address, addr_indices, &key,
                                          dst_mds_mem);
@@ -1845,6 +1875,16 @@ ucs_status_t ucp_wireup_connect_remote(ucp_ep_h ep, ucp_lane_index_t lane)
 
     ucs_assert(!(ep->flags & UCP_EP_FLAG_REMOTE_CONNECTED));
 
+    if (ucp_ep_is_lane_released(uct_ep)) {
+        /* The wireup ep must wrap a connected transport endpoint */
+        status = ucp_ep_cold_lanes_restore(ep);
+        if (status != UCS_OK) {
+            goto err;
+        }
+
+        uct_ep = ucp_ep_get_lane(ep, lane);
+    }
+
     ucs_trace("ep %p: connect lane %d to remote peer with wireup ep", ep, lane);
 
     status = ucp_wireup_ep_create(ep, &wireup_ep);
@@ -268,6 +268,8 @@ static ucs_config_field_t ucs_global_opts_read_only_table[] = {
   "Destination to send statistics to. If the value is empty, statistics are\n"
   "not reported. Possible values are:\n"
   "  udp:<host>[:<port>]   - send over UDP to the given host:port.\n"
+  "  shm                   - keep the counters in shared memory, where they can be\n"
+  "                          watched live with ucs_stats_top.\n"
   "  stdout                - print to standard output.\n"
   "  stderr                - print to standard error.\n"
   "  file:<filename>[:bin] - save to a file (%h: host, %p: pid, %c: cpu, %t: time, %u: user, %e: exe)",
@@ -310,8 +312,11 @@ static ucs_config_field_t ucs_global_opts_read_only_table[] = {
 
  {"PROFILE_MODE", "",
   "Profile collection modes. If none is specified, profiling is disabled.\n"
-  " - log   - Record all timestamps.\n"
-  " - accum - Accumulate measurements per location.",
+  " - log    - Record all timestamps.\n"
+  " - accum  - Accumulate measurements per location.\n"
+  " - stream - Record all timestamps, and write them to the profiling file\n"
+  "            periodically by a background thread, instead of keeping them in\n"
+  "            memory until the end of the run. Replaces \"log\" mode.",
   ucs_offsetof(ucs_global_opts_t, profile_mode),
   UCS_CONFIG_TYPE_BITMAP(ucs_profile_mode_names)},
 
@@ -321,7 +326,10 @@ static ucs_config_field_t ucs_global_opts_read_only_table[] = {
   ucs_offsetof(ucs_global_opts_t, profile_file), UCS_CONFIG_TYPE_STRING},
 
  {"PROFILE_LOG_SIZE", "4m",
-  "Maximal size of profiling log. New records will replace old records.",
+  "Maximal size of profiling log. New records will replace old records.\n"
+  "In stream mode, this is the size of the per-thread buffer of records which\n"
+  "were not written to the file yet. If the buffer is full, new records are\n"
+  "dropped, and the number of dropped records is written to the file.",
   ucs_offsetof(ucs_global_opts_t, profile_log_size), UCS_CONFIG_TYPE_MEMUNITS},
 
  {"RCACHE_STAT_MIN", "4k",
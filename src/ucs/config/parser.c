@@ -40,12 +40,29 @@ typedef struct ucs_config_parser_prefix_list {
 } ucs_config_parser_prefix_t;
 
 
+/* Parsed configuration, which is cloned by later calls to
+ * ucs_config_parser_fill_opts() with the same table and prefixes, as long as
+ * the environment and the configuration files did not change.
+ */
+typedef struct ucs_config_parser_cache_entry {
+    ucs_list_link_t             list;
+    const ucs_config_field_t    *table;
+    char                        *table_prefix;
+    char                        *env_prefix;
+    int                         ignore_errors;
+    uint64_t                    env_gen;
+    char                        opts[0];
+} ucs_config_parser_cache_entry_t;
+
+
 typedef UCS_CONFIG_ARRAY_FIELD(void, data) ucs_config_array_field_t;
 
 KHASH_SET_INIT_STR(ucs_config_env_vars)
 
 KHASH_MAP_INIT_STR(ucs_config_map, char*)
 
+KHASH_MAP_INIT_STR(ucs_config_env_index, const char*)
+
 
 /* Process environment variables */
 extern char **environ;
@@ -57,6 +74,15 @@ static khash_t(ucs_config_map) ucs_config_file_vars            = {0};
 static pthread_mutex_t ucs_config_parser_env_vars_hash_lock    = PTHREAD_MUTEX_INITIALIZER;
 static char ucs_config_parser_negate                           = '^';
 
+/* Environment variables by name, valid for ucs_config_parser_env_gen */
+static khash_t(ucs_config_env_index) ucs_config_parser_env_index = {0};
+static uint64_t ucs_config_parser_env_gen                        = 0;
+/* Incremented when a configuration file sets a variable */
+static uint64_t ucs_config_file_vars_gen                         = 0;
+static UCS_LIST_HEAD(ucs_config_parser_cache);
+/* Protects the environment index and the parsed configuration cache */
+static pthread_mutex_t ucs_config_parser_cache_lock              = PTHREAD_MUTEX_INITIALIZER;
+
 
 const char *ucs_async_mode_names[] = {
     [UCS_ASYNC_MODE_SIGNAL]          = "signal",
@@ -1623,6 +1649,7 @@ static int ucs_config_parse_config_file_line(void *arg, const char *section,
     }
 
     kh_val(&ucs_config_file_vars, iter) = ucs_strdup(value, "config_value");
+    ++ucs_config_file_vars_gen;
     return 1;
 }
 
@@ -1666,6 +1693,205 @@ out:
     return;
 }
 
+/*
+ * Return a value which changes whenever the environment or the configuration
+ * files change. setenv(), unsetenv() and putenv() replace the entry pointers
+ * in 'environ', so hashing the pointers is enough to detect them without
+ * reading the strings.
+ */
+static uint64_t ucs_config_parser_env_generation()
+{
+    uint64_t gen = ucs_config_file_vars_gen;
+    char **envp;
+
+    for (envp = environ; *envp != NULL; ++envp) {
+        gen = (gen ^ (uintptr_t)*envp) * 0x100000001b3ul;
+    }
+
+    /* Generation 0 means the index was not built yet */
+    return gen | 1;
+}
+
+static void ucs_config_parser_env_index_reset()
+{
+    const char *key;
+
+    kh_foreach_key(&ucs_config_parser_env_index, key, {
+        ucs_free((void*)key);
+    })
+    kh_clear(ucs_config_env_index, &ucs_config_parser_env_index);
+}
+
+/* Index the environment variables by name, to avoid scanning the environment
+ * by getenv() for every configuration field. Called with the cache lock held.
+ */
+static void ucs_config_parser_env_index_update(uint64_t env_gen)
+{
+    const char *eq;
+    char **envp;
+    khiter_t iter;
+    char *key;
+    int ret;
+
+    if (env_gen == ucs_config_parser_env_gen) {
+        return;
+    }
+
+    ucs_config_parser_env_index_reset();
+
+    for (envp = environ; *envp != NULL; ++envp) {
+        eq = strchr(*envp, '=');
+        if (eq == NULL) {
+            continue;
+        }
+
+        key = ucs_strndup(*envp, eq - *envp, "config_env_index_key");
+        if (key == NULL) {
+            goto err;
+        }
+
+        iter = kh_put(ucs_config_env_index, &ucs_config_parser_env_index, key,
+                      &ret);
+        if (ret == UCS_KH_PUT_FAILED) {
+            ucs_free(key);
+            goto err;
+        } else if (ret == UCS_KH_PUT_KEY_PRESENT) {
+            /* Same as getenv(), the first definition wins */
+            ucs_free(key);
+            continue;
+        }
+
+        kh_val(&ucs_config_parser_env_index, iter) = eq + 1;
+    }
+
+    ucs_config_parser_env_gen = env_gen;
+    return;
+
+err:
+    /* Fall back to getenv() */
+    ucs_debug("failed to index environment variables");
+    ucs_config_parser_env_index_reset();
+    ucs_config_parser_env_gen = 0;
+}
+
+static const char *ucs_config_parser_getenv(const char *name)
+{
+    khiter_t iter;
+
+    if (ucs_config_parser_env_gen == 0) {
+        return getenv(name);
+    }
+
+    iter = kh_get(ucs_config_env_index, &ucs_config_parser_env_index, name);
+    if (iter == kh_end(&ucs_config_parser_env_index)) {
+        return NULL;
+    }
+
+    return kh_val(&ucs_config_parser_env_index, iter);
+}
+
+static int ucs_config_parser_strcmp_null(const char *str1, const char *str2)
+{
+    if ((str1 == NULL) || (str2 == NULL)) {
+        return str1 != str2;
+    }
+
+    return strcmp(str1, str2);
+}
+
+static ucs_config_parser_cache_entry_t *
+ucs_config_parser_cache_find(const ucs_config_global_list_entry_t *entry,
+                             const char *env_prefix, int ignore_errors)
+{
+    ucs_config_parser_cache_entry_t *cache_entry;
+
+    ucs_list_for_each(cache_entry, &ucs_config_parser_cache, list) {
+        if ((cache_entry->table == entry->table) &&
+            (cache_entry->ignore_errors == ignore_errors) &&
+            !strcmp(cache_entry->env_prefix, env_prefix) &&
+            !ucs_config_parser_strcmp_null(cache_entry->table_prefix,
+                                           entry->prefix)) {
+            return cache_entry;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+ucs_config_parser_cache_entry_free(ucs_config_parser_cache_entry_t *cache_entry)
+{
+    ucs_list_del(&cache_entry->list);
+    ucs_config_parser_release_opts(cache_entry->opts,
+                                   (ucs_config_field_t*)cache_entry->table);
+    ucs_free(cache_entry->table_prefix);
+    ucs_free(cache_entry->env_prefix);
+    ucs_free(cache_entry);
+}
+
+/* Keep a copy of a parsed configuration. Failure is not fatal, since the
+ * cache is only an optimization. */
+static void
+ucs_config_parser_cache_add(const void *opts,
+                            const ucs_config_global_list_entry_t *entry,
+                            const char *env_prefix, int ignore_errors,
+                            uint64_t env_gen)
+{
+    ucs_config_parser_cache_entry_t *cache_entry;
+    ucs_status_t status;
+
+    cache_entry = ucs_calloc(1, sizeof(*cache_entry) + entry->size,
+                             "config_cache_entry");
+    if (cache_entry == NULL) {
+        return;
+    }
+
+    cache_entry->table         = entry->table;
+    cache_entry->ignore_errors = ignore_errors;
+    cache_entry->env_gen       = env_gen;
+    cache_entry->env_prefix    = ucs_strdup(env_prefix, "config_cache_env");
+    if (cache_entry->env_prefix == NULL) {
+        goto err_free;
+    }
+
+    if (entry->prefix != NULL) {
+        cache_entry->table_prefix = ucs_strdup(entry->prefix,
+                                               "config_cache_table");
+        if (cache_entry->table_prefix == NULL) {
+            goto err_free_env_prefix;
+        }
+    }
+
+    status = ucs_config_parser_clone_opts(opts, cache_entry->opts,
+                                          entry->table);
+    if (status != UCS_OK) {
+        goto err_free_table_prefix;
+    }
+
+    ucs_list_add_head(&ucs_config_parser_cache, &cache_entry->list);
+    return;
+
+err_free_table_prefix:
+    ucs_free(cache_entry->table_prefix);
+err_free_env_prefix:
+    ucs_free(cache_entry->env_prefix);
+err_free:
+    ucs_free(cache_entry);
+}
+
+void ucs_config_parser_cache_purge(const ucs_config_field_t *fields)
+{
+    ucs_config_parser_cache_entry_t *cache_entry, *tmp;
+
+    pthread_mutex_lock(&ucs_config_parser_cache_lock);
+    ucs_list_for_each_safe(cache_entry, tmp, &ucs_config_parser_cache, list) {
+        if (cache_entry->table == fields) {
+            ucs_config_parser_cache_entry_free(cache_entry);
+        }
+    }
+    pthread_mutex_unlock(&ucs_config_parser_cache_lock);
+}
+
 static ucs_status_t
 ucs_config_apply_config_vars(void *opts, ucs_config_field_t *fields,
                              const char *prefix, const char *table_prefix,
@@ -1715,7 +1941,7 @@ ucs_config_apply_config_vars(void *opts, ucs_config_field_t *fields,
             strncpy(buf + prefix_len, field->name, sizeof(buf) - prefix_len - 1);
 
             /* Env variable has precedence over file config */
-            env_value = getenv(buf);
+            env_value = ucs_config_parser_getenv(buf);
             if (env_value == NULL) {
                 env_value = ucs_config_get_value_from_config_file(buf);
             }
@@ -1825,24 +2051,46 @@ ucs_config_parser_fill_opts(void *opts, ucs_config_global_list_entry_t *entry,
 {
     const char   *sub_prefix = NULL;
     static ucs_init_once_t config_file_parse = UCS_INIT_ONCE_INITIALIZER;
+    ucs_config_parser_cache_entry_t *cache_entry;
     ucs_status_t status;
-
-    /* Set default values */
-    status = ucs_config_parser_set_default_values(opts, entry->table);
-    if (status != UCS_OK) {
-        goto err;
-    }
+    uint64_t env_gen;
 
     ucs_assert(env_prefix != NULL);
     status = ucs_config_parser_get_sub_prefix(env_prefix, &sub_prefix);
     if (status != UCS_OK) {
-        goto err;
+        return status;
     }
 
     UCS_INIT_ONCE(&config_file_parse) {
         ucs_config_parse_config_files();
     }
 
+    pthread_mutex_lock(&ucs_config_parser_cache_lock);
+
+    env_gen     = ucs_config_parser_env_generation();
+    cache_entry = ucs_config_parser_cache_find(entry, env_prefix,
+                                               ignore_errors);
+    if (cache_entry != NULL) {
+        if (cache_entry->env_gen == env_gen) {
+            status = ucs_config_parser_clone_opts(cache_entry->opts, opts,
+                                                  entry->table);
+            if (status == UCS_OK) {
+                entry->flags |= UCS_CONFIG_TABLE_FLAG_LOADED;
+            }
+            goto out_unlock;
+        }
+
+        ucs_config_parser_cache_entry_free(cache_entry);
+    }
+
+    ucs_config_parser_env_index_update(env_gen);
+
+    /* Set default values */
+    status = ucs_config_parser_set_default_values(opts, entry->table);
+    if (status != UCS_OK) {
+        goto out_unlock;
+    }
+
     /* Apply environment variables */
     if (sub_prefix != NULL) {
         status = ucs_config_apply_config_vars(opts, entry->table, sub_prefix,
@@ -1859,13 +2107,16 @@ ucs_config_parser_fill_opts(void *opts, ucs_config_global_list_entry_t *entry,
         goto err_free;
     }
 
+    ucs_config_parser_cache_add(opts, entry, env_prefix, ignore_errors,
+                                env_gen);
     entry->flags |= UCS_CONFIG_TABLE_FLAG_LOADED;
-    return UCS_OK;
+    goto out_unlock;
 
 err_free:
     ucs_config_parser_release_opts(opts,
                                    entry->table); /* Release default values */
-err:
+out_unlock:
+    pthread_mutex_unlock(&ucs_config_parser_cache_lock);
     return status;
 }
 
@@ -2433,9 +2684,18 @@ void ucs_config_parser_get_env_vars(ucs_string_buffer_t *env_strb,
 
 void ucs_config_parser_cleanup()
 {
+    ucs_config_parser_cache_entry_t *cache_entry, *tmp;
     const char *key;
     char *value;
 
+    ucs_list_for_each_safe(cache_entry, tmp, &ucs_config_parser_cache, list) {
+        ucs_config_parser_cache_entry_free(cache_entry);
+    }
+
+    ucs_config_parser_env_index_reset();
+    kh_destroy_inplace(ucs_config_env_index, &ucs_config_parser_env_index);
+    ucs_config_parser_env_gen = 0;
+
     kh_foreach_key(&ucs_config_parser_env_vars, key, {
         ucs_free((void*)key);
     })
@@ -147,6 +147,7 @@ typedef struct ucs_config_bw_spec {
     } \
     \
     UCS_STATIC_CLEANUP { \
+        ucs_config_parser_cache_purge((_entry)->table); \
         ucs_list_del(&(_entry)->list); \
     }
 
@@ -171,7 +172,10 @@ typedef struct ucs_config_bw_spec {
     ucs_list_add_tail(_list, &(_table##_config_entry).list)
 
 #define UCS_CONFIG_REMOVE_TABLE(_table) \
-    ucs_list_del(&(_table##_config_entry).list)
+    do { \
+        ucs_config_parser_cache_purge(_table); \
+        ucs_list_del(&(_table##_config_entry).list); \
+    } while (0)
 
 extern ucs_list_link_t ucs_config_global_list;
 
@@ -517,11 +521,24 @@ void ucs_config_parse_config_files();
  *                       env_prefix may consist of multiple sub prefixes
  * @param ignore_errors  Whether to ignore parsing errors and continue parsing
  *                       other fields.
+ *
+ * The parsed values are cached, and later calls with the same table and
+ * prefixes clone the cached values, as long as the environment and the
+ * configuration files did not change.
  */
 ucs_status_t
 ucs_config_parser_fill_opts(void *opts, ucs_config_global_list_entry_t *entry,
                             const char *env_prefix, int ignore_errors);
 
+
+/**
+ * Drop the cached parsed values of a configuration table. Must be called
+ * before the table is unloaded.
+ *
+ * @param fields  Array of fields which define the options.
+ */
+void ucs_config_parser_cache_purge(const ucs_config_field_t *fields);
+
 /**
  * Perform deep copy of the options structure.
  *
@@ -28,6 +28,22 @@ AS_IF([test "x$enable_profiling" = xyes],
 )
 AM_CONDITIONAL([HAVE_PROFILING],[test "x$HAVE_PROFILING" = "xyes"])
 
+#
+# USDT static probes, which a tracer can attach to in a running process.
+# The probes cost a "nop" instruction when unused, so they are on by default.
+#
+AC_ARG_ENABLE([usdt],
+	AS_HELP_STRING([--disable-usdt], [Disable USDT static probes, default: enabled if sys/sdt.h is found]),
+	[],
+	[enable_usdt=guess])
+
+AS_IF([test "x$enable_usdt" != xno],
+	[AC_CHECK_HEADER([sys/sdt.h],
+		[AS_MESSAGE([enabling USDT probes])
+		 AC_DEFINE([HAVE_USDT], [1], [Enable USDT probes])],
+		[AS_IF([test "x$enable_usdt" = xyes],
+			[AC_MSG_ERROR([USDT probes requested but sys/sdt.h was not found])])])])
+
 
 AC_DEFUN([CHECK_BFD_LIB],
 [
@@ -130,6 +130,29 @@ static UCS_F_ALWAYS_INLINE void ucs_lru_push(ucs_lru_h lru, void *key)
 }
 
 
+/**
+ * @brief Remove an element from the cache, if it is present.
+ *
+ * @param [in] lru  Handle to the LRU cache.
+ * @param [in] key  Element's key.
+ */
+static UCS_F_ALWAYS_INLINE void ucs_lru_remove(ucs_lru_h lru, void *key)
+{
+    ucs_lru_element_t *elem;
+    khint_t iter;
+
+    iter = kh_get(ucs_lru_hash, &lru->hash, (uint64_t)key);
+    if (iter == kh_end(&lru->hash)) {
+        return;
+    }
+
+    elem = kh_val(&lru->hash, iter);
+    ucs_list_del(&elem->list);
+    kh_del(ucs_lru_hash, &lru->hash, iter);
+    ucs_free(elem);
+}
+
+
 /**
  * @brief Resets an LRU object.
  *
@@ -70,6 +70,7 @@ void ucs_mpool_params_reset(ucs_mpool_params_t *params)
     params->grow_factor     = 1.0;
     params->ops             = NULL;
     params->name            = "";
+    params->numa_node       = UCS_NUMA_NODE_UNDEFINED;
 }
 
 static size_t ucs_mpool_chunk_size(ucs_mpool_t *mp, unsigned num_elems)
@@ -111,6 +112,7 @@ ucs_status_t ucs_mpool_init(const ucs_mpool_params_t *params, ucs_mpool_t *mp)
     mp->data->align_offset    = sizeof(ucs_mpool_elem_t) + params->align_offset;
     mp->data->elems_per_chunk = params->elems_per_chunk;
     mp->data->malloc_safe     = params->malloc_safe;
+    mp->data->numa_node       = params->numa_node;
     mp->data->quota           = params->max_elems;
     mp->data->tail            = NULL;
     mp->data->chunks          = NULL;
@@ -133,9 +135,9 @@ ucs_status_t ucs_mpool_init(const ucs_mpool_params_t *params, ucs_mpool_t *mp)
 
     VALGRIND_CREATE_MEMPOOL(mp, 0, 0);
 
-    ucs_debug("mpool %s: align %zu, maxelems %u, elemsize %zu",
+    ucs_debug("mpool %s: align %zu, maxelems %u, elemsize %zu, numa node %d",
               ucs_mpool_name(mp), mp->data->alignment, params->max_elems,
-              mp->data->elem_size);
+              mp->data->elem_size, mp->data->numa_node);
     return UCS_OK;
 
 err_free_name:
@@ -251,15 +253,23 @@ void ucs_mpool_grow(ucs_mpool_t *mp, unsigned num_elems)
     size_t chunk_size;
     ucs_mpool_chunk_t *chunk;
     ucs_mpool_elem_t *elem;
+    ucs_numa_mempolicy_t mempolicy;
     ucs_status_t status;
     unsigned i;
     unsigned allocated_num_elems;
+    int mempolicy_set;
     void *ptr;
 
     if (data->quota == 0) {
         return;
     }
 
+    /* Pages of the chunk are allocated on first touch, by chunk_alloc() or by
+     * the objects initialization */
+    mempolicy_set = (data->numa_node != UCS_NUMA_NODE_UNDEFINED) &&
+                    (ucs_numa_mempolicy_set_preferred(data->numa_node,
+                                                      &mempolicy) == UCS_OK);
+
     allocated_num_elems = ucs_min(data->quota, num_elems);
     chunk_size          = ucs_mpool_chunk_size(mp, allocated_num_elems);
     chunk_size          = ucs_min(chunk_size, data->max_chunk_size);
@@ -269,7 +279,7 @@ void ucs_mpool_grow(ucs_mpool_t *mp, unsigned num_elems)
             ucs_error("Failed to allocate memory pool (name=%s) chunk: %s",
                       ucs_mpool_name(mp), ucs_status_string(status));
         }
-        return;
+        goto out;
     }
 
     /* Calculate padding, and update element count according to allocated size */
@@ -302,6 +312,11 @@ void ucs_mpool_grow(ucs_mpool_t *mp, unsigned num_elems)
     }
 
     VALGRIND_MAKE_MEM_NOACCESS(chunk + 1, chunk_size - sizeof(*chunk));
+
+out:
+    if (mempolicy_set) {
+        ucs_numa_mempolicy_restore(&mempolicy);
+    }
 }
 
 void *ucs_mpool_get_grow(ucs_mpool_t *mp)
@@ -11,6 +11,7 @@
 #include <ucs/type/status.h>
 #include <ucs/sys/compiler_def.h>
 #include <ucs/datastruct/string_buffer.h>
+#include <ucs/memory/numa.h>
 
 
 BEGIN_C_DECLS
@@ -82,6 +83,7 @@ struct ucs_mpool_data {
     unsigned               elems_per_chunk; /* Number of elements per chunk */
     unsigned               quota;           /* How many more elements can be allocated */
     int                    malloc_safe;     /* Avoid triggering malloc() during put/get */
+    ucs_numa_node_t        numa_node;       /* Preferred node for chunk memory */
     ucs_mpool_elem_t       *tail;           /* Free list tail */
     ucs_mpool_chunk_t      *chunks;         /* List of allocated chunks */
     const ucs_mpool_ops_t  *ops;            /* Memory pool operations */
@@ -203,6 +205,13 @@ typedef struct ucs_mpool_params {
      * Memory pool name.
      */
     const char            *name;
+
+    /**
+     * NUMA node to allocate the chunks on, if possible. The default is
+     * UCS_NUMA_NODE_UNDEFINED, which means the memory policy of the thread
+     * which grows the pool is used.
+     */
+    ucs_numa_node_t       numa_node;
 } ucs_mpool_params_t;
 
 
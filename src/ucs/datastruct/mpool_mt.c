@@ -0,0 +1,353 @@
+/**
+ * Copyright (c) NVIDIA CORPORATION & AFFILIATES, 2025. ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "mpool_mt.inl"
+
+#include <ucs/arch/atomic.h>
+#include <ucs/debug/log.h>
+#include <ucs/debug/memtrack_int.h>
+
+
+/* Try to park a magazine in a free depot slot */
+static int ucs_mpool_mt_depot_push(ucs_mpool_mt_magazine_t * volatile *slots,
+                                   ucs_mpool_mt_magazine_t *mag)
+{
+    unsigned i;
+
+    for (i = 0; i < UCS_MPOOL_MT_DEPOT_SIZE; ++i) {
+        if ((slots[i] == NULL) &&
+            ucs_atomic_bool_cswap64((volatile uint64_t*)&slots[i], 0,
+                                    (uintptr_t)mag)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Take a magazine out of the depot. If the slot was emptied and refilled with
+ * the same magazine since it was read, taking it is still correct, since the
+ * magazine contents are not modified while it is in the depot.
+ */
+static ucs_mpool_mt_magazine_t *
+ucs_mpool_mt_depot_pop(ucs_mpool_mt_magazine_t * volatile *slots)
+{
+    ucs_mpool_mt_magazine_t *mag;
+    unsigned i;
+
+    for (i = 0; i < UCS_MPOOL_MT_DEPOT_SIZE; ++i) {
+        mag = slots[i];
+        if ((mag != NULL) &&
+            ucs_atomic_bool_cswap64((volatile uint64_t*)&slots[i],
+                                    (uintptr_t)mag, 0)) {
+            return mag;
+        }
+    }
+
+    return NULL;
+}
+
+static ucs_mpool_mt_magazine_t *
+ucs_mpool_mt_magazine_get_empty(ucs_mpool_mt_t *mtp)
+{
+    ucs_mpool_mt_magazine_t *mag;
+
+    mag = ucs_mpool_mt_depot_pop(mtp->empty);
+    if (mag != NULL) {
+        return mag;
+    }
+
+    mag = ucs_malloc(sizeof(*mag), "mpool_mt_magazine");
+    if (mag == NULL) {
+        return NULL;
+    }
+
+    mag->count = 0;
+    return mag;
+}
+
+static void ucs_mpool_mt_magazine_put_empty(ucs_mpool_mt_t *mtp,
+                                            ucs_mpool_mt_magazine_t *mag)
+{
+    ucs_assert(mag->count == 0);
+    if (!ucs_mpool_mt_depot_push(mtp->empty, mag)) {
+        ucs_free(mag);
+    }
+}
+
+/* Return all magazine objects to the underlying memory pool */
+static void ucs_mpool_mt_magazine_drain(ucs_mpool_mt_t *mtp,
+                                        ucs_mpool_mt_magazine_t *mag)
+{
+    ucs_spin_lock(&mtp->lock);
+    while (mag->count > 0) {
+        ucs_mpool_put_inline(mag->objs[--mag->count]);
+    }
+    ucs_spin_unlock(&mtp->lock);
+}
+
+/* Move a magazine to the depot, or drain it if the depot is full */
+static void ucs_mpool_mt_magazine_release(ucs_mpool_mt_t *mtp,
+                                          ucs_mpool_mt_magazine_t *mag)
+{
+    if (mag->count == 0) {
+        ucs_mpool_mt_magazine_put_empty(mtp, mag);
+    } else if (!ucs_mpool_mt_depot_push(mtp->full, mag)) {
+        ucs_mpool_mt_magazine_drain(mtp, mag);
+        ucs_mpool_mt_magazine_put_empty(mtp, mag);
+    }
+}
+
+static void ucs_mpool_mt_tcache_destroy(ucs_mpool_mt_tcache_t *tcache)
+{
+    ucs_mpool_mt_t *mtp = tcache->mtp;
+
+    ucs_spin_lock(&mtp->lock);
+    ucs_list_del(&tcache->list);
+    ucs_spin_unlock(&mtp->lock);
+
+    ucs_mpool_mt_magazine_release(mtp, tcache->loaded);
+    ucs_mpool_mt_magazine_release(mtp, tcache->prev);
+    ucs_free(tcache);
+}
+
+static void ucs_mpool_mt_tcache_key_destr(void *arg)
+{
+    ucs_mpool_mt_tcache_destroy(arg);
+}
+
+static ucs_mpool_mt_tcache_t *ucs_mpool_mt_tcache_get(ucs_mpool_mt_t *mtp)
+{
+    ucs_mpool_mt_tcache_t *tcache;
+
+    tcache = pthread_getspecific(mtp->tcache_key);
+    if (ucs_likely(tcache != NULL)) {
+        return tcache;
+    }
+
+    tcache = ucs_malloc(sizeof(*tcache), "mpool_mt_tcache");
+    if (tcache == NULL) {
+        goto err;
+    }
+
+    tcache->mtp    = mtp;
+    tcache->loaded = ucs_mpool_mt_magazine_get_empty(mtp);
+    if (tcache->loaded == NULL) {
+        goto err_free_tcache;
+    }
+
+    tcache->prev = ucs_mpool_mt_magazine_get_empty(mtp);
+    if (tcache->prev == NULL) {
+        goto err_put_loaded;
+    }
+
+    if (pthread_setspecific(mtp->tcache_key, tcache) != 0) {
+        goto err_put_prev;
+    }
+
+    ucs_spin_lock(&mtp->lock);
+    ucs_list_add_tail(&mtp->tcaches, &tcache->list);
+    ucs_spin_unlock(&mtp->lock);
+    return tcache;
+
+err_put_prev:
+    ucs_mpool_mt_magazine_put_empty(mtp, tcache->prev);
+err_put_loaded:
+    ucs_mpool_mt_magazine_put_empty(mtp, tcache->loaded);
+err_free_tcache:
+    ucs_free(tcache);
+err:
+    ucs_debug("mpool %s: failed to create thread cache", ucs_mpool_name(&mtp->mp));
+    return NULL;
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucs_mpool_mt_tcache_swap(ucs_mpool_mt_tcache_t *tcache)
+{
+    ucs_mpool_mt_magazine_t *mag = tcache->loaded;
+
+    tcache->loaded = tcache->prev;
+    tcache->prev   = mag;
+}
+
+void *ucs_mpool_mt_get_slow(ucs_mpool_mt_t *mtp)
+{
+    ucs_mpool_mt_tcache_t *tcache;
+    ucs_mpool_mt_magazine_t *mag;
+    void *obj;
+
+    tcache = ucs_mpool_mt_tcache_get(mtp);
+    if (ucs_unlikely(tcache == NULL)) {
+        ucs_spin_lock(&mtp->lock);
+        obj = ucs_mpool_get_inline(&mtp->mp);
+        ucs_spin_unlock(&mtp->lock);
+        return obj;
+    }
+
+    if (tcache->loaded->count > 0) {
+        /* The cache was created just now */
+    } else if (tcache->prev->count > 0) {
+        ucs_mpool_mt_tcache_swap(tcache);
+    } else if ((mag = ucs_mpool_mt_depot_pop(mtp->full)) != NULL) {
+        ucs_mpool_mt_magazine_put_empty(mtp, tcache->prev);
+        tcache->prev   = tcache->loaded;
+        tcache->loaded = mag;
+    } else {
+        /* Refill half of the magazine, to leave room for puts */
+        mag = tcache->loaded;
+        ucs_spin_lock(&mtp->lock);
+        while (mag->count < (UCS_MPOOL_MT_MAGAZINE_SIZE / 2)) {
+            obj = ucs_mpool_get_inline(&mtp->mp);
+            if (obj == NULL) {
+                break;
+            }
+
+            mag->objs[mag->count++] = obj;
+        }
+        ucs_spin_unlock(&mtp->lock);
+
+        if (mag->count == 0) {
+            return NULL;
+        }
+    }
+
+    mag = tcache->loaded;
+    return mag->objs[--mag->count];
+}
+
+void ucs_mpool_mt_put_slow(ucs_mpool_mt_t *mtp, void *obj)
+{
+    ucs_mpool_mt_tcache_t *tcache;
+    ucs_mpool_mt_magazine_t *mag;
+
+    tcache = ucs_mpool_mt_tcache_get(mtp);
+    if (ucs_unlikely(tcache == NULL)) {
+        ucs_spin_lock(&mtp->lock);
+        ucs_mpool_put_inline(obj);
+        ucs_spin_unlock(&mtp->lock);
+        return;
+    }
+
+    if (tcache->loaded->count < UCS_MPOOL_MT_MAGAZINE_SIZE) {
+        /* The cache was created just now */
+    } else if (tcache->prev->count == 0) {
+        ucs_mpool_mt_tcache_swap(tcache);
+    } else {
+        /* Both magazines are full: replace the previous one by an empty one */
+        mag = ucs_mpool_mt_magazine_get_empty(mtp);
+        if (mag == NULL) {
+            ucs_mpool_mt_magazine_drain(mtp, tcache->prev);
+        } else {
+            if (!ucs_mpool_mt_depot_push(mtp->full, tcache->prev)) {
+                ucs_mpool_mt_magazine_drain(mtp, tcache->prev);
+                ucs_mpool_mt_magazine_put_empty(mtp, tcache->prev);
+            }
+            tcache->prev = mag;
+        }
+
+        ucs_mpool_mt_tcache_swap(tcache);
+    }
+
+    mag                     = tcache->loaded;
+    mag->objs[mag->count++] = obj;
+}
+
+void *ucs_mpool_mt_get(ucs_mpool_mt_t *mtp)
+{
+    return ucs_mpool_mt_get_inline(mtp);
+}
+
+void ucs_mpool_mt_put(void *obj)
+{
+    ucs_mpool_mt_put_inline(obj);
+}
+
+void ucs_mpool_mt_thread_flush(ucs_mpool_mt_t *mtp)
+{
+    ucs_mpool_mt_tcache_t *tcache = pthread_getspecific(mtp->tcache_key);
+
+    if (tcache != NULL) {
+        pthread_setspecific(mtp->tcache_key, NULL);
+        ucs_mpool_mt_tcache_destroy(tcache);
+    }
+}
+
+ucs_status_t ucs_mpool_mt_init(const ucs_mpool_params_t *params,
+                               ucs_mpool_mt_t *mtp)
+{
+    ucs_status_t status;
+    int ret;
+
+    if (params->malloc_safe) {
+        ucs_error("mpool %s: thread-safe memory pool can't be malloc-safe",
+                  params->name);
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    memset((void*)mtp->full, 0, sizeof(mtp->full));
+    memset((void*)mtp->empty, 0, sizeof(mtp->empty));
+    ucs_list_head_init(&mtp->tcaches);
+
+    status = ucs_spinlock_init(&mtp->lock, 0);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    ret = pthread_key_create(&mtp->tcache_key, ucs_mpool_mt_tcache_key_destr);
+    if (ret != 0) {
+        ucs_error("mpool %s: pthread_key_create() failed: %m", params->name);
+        status = UCS_ERR_NO_RESOURCE;
+        goto err_destroy_lock;
+    }
+
+    status = ucs_mpool_init(params, &mtp->mp);
+    if (status != UCS_OK) {
+        goto err_delete_key;
+    }
+
+    return UCS_OK;
+
+err_delete_key:
+    pthread_key_delete(mtp->tcache_key);
+err_destroy_lock:
+    ucs_spinlock_destroy(&mtp->lock);
+    return status;
+}
+
+void ucs_mpool_mt_cleanup(ucs_mpool_mt_t *mtp, int leak_check)
+{
+    ucs_mpool_mt_tcache_t *tcache, *tmp;
+    ucs_mpool_mt_magazine_t *mag;
+
+    /* Thread caches which remain after the key is deleted are released here,
+     * since their destructors will not be called */
+    pthread_key_delete(mtp->tcache_key);
+
+    ucs_list_for_each_safe(tcache, tmp, &mtp->tcaches, list) {
+        ucs_mpool_mt_magazine_drain(mtp, tcache->loaded);
+        ucs_mpool_mt_magazine_drain(mtp, tcache->prev);
+        ucs_free(tcache->loaded);
+        ucs_free(tcache->prev);
+        ucs_free(tcache);
+    }
+
+    while ((mag = ucs_mpool_mt_depot_pop(mtp->full)) != NULL) {
+        ucs_mpool_mt_magazine_drain(mtp, mag);
+        ucs_free(mag);
+    }
+
+    while ((mag = ucs_mpool_mt_depot_pop(mtp->empty)) != NULL) {
+        ucs_free(mag);
+    }
+
+    ucs_mpool_cleanup(&mtp->mp, leak_check);
+    ucs_spinlock_destroy(&mtp->lock);
+}
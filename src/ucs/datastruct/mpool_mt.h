@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) NVIDIA CORPORATION & AFFILIATES, 2025. ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCS_MPOOL_MT_H_
+#define UCS_MPOOL_MT_H_
+
+#include <ucs/arch/cpu.h>
+#include <ucs/datastruct/list.h>
+#include <ucs/datastruct/mpool.h>
+#include <ucs/sys/compiler_def.h>
+#include <ucs/type/spinlock.h>
+#include <pthread.h>
+
+BEGIN_C_DECLS
+
+
+/* Number of objects in a per-thread magazine */
+#define UCS_MPOOL_MT_MAGAZINE_SIZE 32
+
+/* Number of magazine slots in the global depot */
+#define UCS_MPOOL_MT_DEPOT_SIZE    64
+
+
+/**
+ * Array of cached objects, which is owned by a single thread, or parked in the
+ * global depot.
+ */
+typedef struct ucs_mpool_mt_magazine {
+    unsigned                count;
+    void                    *objs[UCS_MPOOL_MT_MAGAZINE_SIZE];
+} ucs_mpool_mt_magazine_t;
+
+
+/**
+ * Per-thread cache of a memory pool.
+ */
+typedef struct ucs_mpool_mt_tcache {
+    ucs_mpool_mt_magazine_t *loaded;    /* Objects are taken from here first */
+    ucs_mpool_mt_magazine_t *prev;      /* Previously loaded magazine */
+    struct ucs_mpool_mt     *mtp;       /* Owning memory pool */
+    ucs_list_link_t         list;       /* Entry in the memory pool list */
+} ucs_mpool_mt_tcache_t;
+
+
+/**
+ * Thread-safe memory pool.
+ *
+ * Every thread gets and puts objects through its own cache of two magazines,
+ * without synchronization. When both magazines of a thread are empty (or
+ * full), it exchanges a magazine with the global depot, which is a lock-free
+ * array of slots updated by compare-and-swap. Only when the depot can't
+ * satisfy the request, objects are moved from (or to) the underlying memory
+ * pool under a lock.
+ *
+ * Objects cached by one thread are not available to other threads, so a pool
+ * with a limited number of elements may return NULL while some of them are
+ * cached.
+ */
+typedef struct ucs_mpool_mt {
+    /* Full and empty magazines which are not owned by any thread */
+    ucs_mpool_mt_magazine_t * volatile full[UCS_MPOOL_MT_DEPOT_SIZE]
+            UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE);
+    ucs_mpool_mt_magazine_t * volatile empty[UCS_MPOOL_MT_DEPOT_SIZE]
+            UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE);
+
+    pthread_key_t           tcache_key  UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE);
+    ucs_spinlock_t          lock;       /* Protects the fields below */
+    ucs_list_link_t         tcaches;    /* Caches of all threads */
+    ucs_mpool_t             mp;         /* Underlying memory pool */
+} ucs_mpool_mt_t;
+
+
+/**
+ * Initialize a thread-safe memory pool.
+ *
+ * @param params           Memory pool parameters, see @ref ucs_mpool_params_t.
+ *                         Malloc-safe pools are not supported, since the
+ *                         thread caches are allocated with malloc().
+ * @param mtp              Memory pool structure.
+ *
+ * @return UCS status code.
+ */
+ucs_status_t ucs_mpool_mt_init(const ucs_mpool_params_t *params,
+                               ucs_mpool_mt_t *mtp);
+
+
+/**
+ * Cleanup a thread-safe memory pool, including the caches of all threads, and
+ * release all its memory. No other thread may use the pool concurrently.
+ *
+ * @param mtp              Memory pool structure.
+ * @param leak_check       Whether to check for leaks.
+ */
+void ucs_mpool_mt_cleanup(ucs_mpool_mt_t *mtp, int leak_check);
+
+
+/**
+ * Return the objects cached by the calling thread to the memory pool. This is
+ * done automatically when the thread exits.
+ *
+ * @param mtp              Memory pool structure.
+ */
+void ucs_mpool_mt_thread_flush(ucs_mpool_mt_t *mtp);
+
+
+/**
+ * Get an element from the memory pool. Can be called from any thread.
+ *
+ * @param mtp              Memory pool structure.
+ *
+ * @return New allocated object, or NULL if cannot allocate.
+ */
+void *ucs_mpool_mt_get(ucs_mpool_mt_t *mtp);
+
+
+/**
+ * Return an object to the memory pool. Can be called from any thread, not
+ * necessarily the one which allocated the object.
+ *
+ * @param obj              Object to return.
+ */
+void ucs_mpool_mt_put(void *obj);
+
+
+/* Used internally by the inline functions */
+void *ucs_mpool_mt_get_slow(ucs_mpool_mt_t *mtp);
+void ucs_mpool_mt_put_slow(ucs_mpool_mt_t *mtp, void *obj);
+
+END_C_DECLS
+
+#endif
@@ -0,0 +1,47 @@
+/**
+ * Copyright (c) NVIDIA CORPORATION & AFFILIATES, 2025. ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCS_MPOOL_MT_INL_
+#define UCS_MPOOL_MT_INL_
+
+#include "mpool_mt.h"
+#include "mpool.inl"
+
+
+static UCS_F_ALWAYS_INLINE void *ucs_mpool_mt_get_inline(ucs_mpool_mt_t *mtp)
+{
+    ucs_mpool_mt_tcache_t *tcache = pthread_getspecific(mtp->tcache_key);
+    ucs_mpool_mt_magazine_t *mag;
+
+    if (ucs_likely(tcache != NULL)) {
+        mag = tcache->loaded;
+        if (ucs_likely(mag->count > 0)) {
+            return mag->objs[--mag->count];
+        }
+    }
+
+    return ucs_mpool_mt_get_slow(mtp);
+}
+
+static UCS_F_ALWAYS_INLINE void ucs_mpool_mt_put_inline(void *obj)
+{
+    ucs_mpool_mt_t *mtp = ucs_container_of(ucs_mpool_obj_owner(obj),
+                                           ucs_mpool_mt_t, mp);
+    ucs_mpool_mt_tcache_t *tcache = pthread_getspecific(mtp->tcache_key);
+    ucs_mpool_mt_magazine_t *mag;
+
+    if (ucs_likely(tcache != NULL)) {
+        mag = tcache->loaded;
+        if (ucs_likely(mag->count < UCS_MPOOL_MT_MAGAZINE_SIZE)) {
+            mag->objs[mag->count++] = obj;
+            return;
+        }
+    }
+
+    ucs_mpool_mt_put_slow(mtp, obj);
+}
+
+#endif
@@ -137,6 +137,17 @@ err:
     return status;
 }
 
+void ucs_mpool_set_numa_node(ucs_mpool_set_t *mp_set,
+                             ucs_numa_node_t numa_node)
+{
+    ucs_mpool_t *mpools = mp_set->data;
+    int i;
+
+    for (i = 0; i < ucs_popcount(mp_set->bitmap); ++i) {
+        mpools[i].data->numa_node = numa_node;
+    }
+}
+
 void ucs_mpool_set_cleanup(ucs_mpool_set_t *mp_set, int leak_check)
 {
     ucs_mpool_set_cleanup_common(mp_set, ucs_popcount(mp_set->bitmap),
@@ -83,6 +83,19 @@ ucs_mpool_set_init(ucs_mpool_set_t *mp_set, size_t *sizes, unsigned sizes_count,
                    ucs_mpool_ops_t *ops, const char *name);
 
 
+/**
+ * Set the NUMA node to allocate the chunks of all memory pools in the set on.
+ * Affects only the chunks which are allocated after this call.
+ *
+ * @param mp_set            Memory pool set structure.
+ * @param numa_node         NUMA node to allocate the chunks on, or
+ *                          UCS_NUMA_NODE_UNDEFINED to use the memory policy
+ *                          of the calling thread.
+ */
+void ucs_mpool_set_numa_node(ucs_mpool_set_t *mp_set,
+                             ucs_numa_node_t numa_node);
+
+
 /**
  * Cleanup a memory pool set and release all its memory.
  *
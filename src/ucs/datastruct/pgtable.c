@@ -11,6 +11,7 @@
 #include "pgtable.h"
 
 #include <ucs/arch/bitops.h>
+#include <ucs/arch/cpu.h>
 #include <ucs/debug/assert.h>
 #include <ucs/debug/log.h>
 #include <ucs/debug/memtrack_int.h>
@@ -77,6 +78,9 @@ static inline ucs_pgt_dir_t* ucs_pgt_dir_alloc(ucs_pgtable_t *pgtable)
 
     ucs_pgt_check_ptr(pgd);
     memset(pgd, 0, sizeof(*pgd));
+
+    /* Concurrent readers must not see the directory before it's initialized */
+    ucs_memory_cpu_store_fence();
     return pgd;
 }
 
@@ -143,6 +147,94 @@ static void ucs_pgtable_trace(ucs_pgtable_t *pgtable, const char *message)
     ucs_pgtable_log(pgtable, UCS_LOG_LEVEL_TRACE_FUNC, message);
 }
 
+static void ucs_pgtable_flat_reset(ucs_pgtable_t *pgtable)
+{
+    unsigned i;
+
+    /* Unused entries have maximal start address, so they are not counted by
+     * the lookup for any address below it */
+    for (i = 0; i < UCS_PGT_FLAT_MAX_REGIONS; ++i) {
+        pgtable->flat.start[i]  = UCS_PGT_ADDR_MAX;
+        pgtable->flat.region[i] = NULL;
+    }
+    pgtable->flat.valid = 1;
+}
+
+static void ucs_pgtable_flat_insert(ucs_pgtable_t *pgtable,
+                                    ucs_pgt_region_t *region)
+{
+    unsigned num_regions = pgtable->num_regions;
+    unsigned i;
+
+    if (!pgtable->flat.valid) {
+        return;
+    } else if (num_regions >= UCS_PGT_FLAT_MAX_REGIONS) {
+        pgtable->flat.valid = 0;
+        return;
+    }
+
+    /* Shift the regions with higher start address to make room */
+    for (i = num_regions; (i > 0) && (pgtable->flat.start[i - 1] > region->start);
+         --i) {
+        pgtable->flat.start[i]  = pgtable->flat.start[i - 1];
+        pgtable->flat.region[i] = pgtable->flat.region[i - 1];
+    }
+
+    pgtable->flat.start[i]  = region->start;
+    pgtable->flat.region[i] = region;
+}
+
+static void ucs_pgtable_flat_rebuild_callback(const ucs_pgtable_t *pgtable,
+                                              ucs_pgt_region_t *region,
+                                              void *arg)
+{
+    ucs_pgt_region_t ***region_pp = arg;
+
+    /* Regions are found in ascending address order */
+    **region_pp = region;
+    ++(*region_pp);
+}
+
+static void ucs_pgtable_flat_remove(ucs_pgtable_t *pgtable,
+                                    ucs_pgt_region_t *region)
+{
+    unsigned num_regions = pgtable->num_regions;
+    ucs_pgt_region_t **next_region;
+    unsigned i;
+
+    if (!pgtable->flat.valid) {
+        if (num_regions > (UCS_PGT_FLAT_MAX_REGIONS / 2)) {
+            return;
+        }
+
+        ucs_pgtable_flat_reset(pgtable);
+        next_region = pgtable->flat.region;
+        ucs_pgtable_search_range(pgtable, 0, UCS_PGT_ADDR_MAX,
+                                 ucs_pgtable_flat_rebuild_callback,
+                                 &next_region);
+        ucs_assertv(next_region == pgtable->flat.region + num_regions,
+                    "next_region=%p flat_regions=%p num_regions=%u",
+                    next_region, pgtable->flat.region, num_regions);
+
+        for (i = 0; i < num_regions; ++i) {
+            pgtable->flat.start[i] = pgtable->flat.region[i]->start;
+        }
+        return;
+    }
+
+    for (i = 0; pgtable->flat.region[i] != region; ++i) {
+        ucs_assert(i < num_regions);
+    }
+
+    for (; i < num_regions; ++i) {
+        pgtable->flat.start[i]  = pgtable->flat.start[i + 1];
+        pgtable->flat.region[i] = pgtable->flat.region[i + 1];
+    }
+
+    pgtable->flat.start[num_regions]  = UCS_PGT_ADDR_MAX;
+    pgtable->flat.region[num_regions] = NULL;
+}
+
 static void ucs_pgtable_reset(ucs_pgtable_t *pgtable)
 {
     pgtable->base  = 0;
@@ -415,6 +507,10 @@ ucs_status_t ucs_pgtable_insert(ucs_pgtable_t *pgtable, ucs_pgt_region_t *region
     }
 
     ucs_assert(address != end);
+
+    /* Concurrent readers must not see the region before it's initialized */
+    ucs_memory_cpu_store_fence();
+
     while (address < end) {
         order = ucs_pgtable_get_next_page_order(address, end);
         status = ucs_pgtable_insert_page(pgtable, address, order, region);
@@ -424,6 +520,7 @@ ucs_status_t ucs_pgtable_insert(ucs_pgtable_t *pgtable, ucs_pgt_region_t *region
 
         ucs_pgt_address_advance(&address, order);
     }
+    ucs_pgtable_flat_insert(pgtable, region);
     ++pgtable->num_regions;
 
     ucs_pgtable_trace(pgtable, "insert");
@@ -469,44 +566,88 @@ ucs_status_t ucs_pgtable_remove(ucs_pgtable_t *pgtable, ucs_pgt_region_t *region
 
     ucs_assert(pgtable->num_regions > 0);
     --pgtable->num_regions;
+    ucs_pgtable_flat_remove(pgtable, region);
 
     ucs_pgtable_trace(pgtable, "remove");
     return UCS_OK;
 }
 
-ucs_pgt_region_t *ucs_pgtable_lookup(const ucs_pgtable_t *pgtable,
-                                     ucs_pgt_addr_t address)
+ucs_pgt_region_t *ucs_pgtable_lookup_tree(const ucs_pgtable_t *pgtable,
+                                          ucs_pgt_addr_t address)
 {
-    const ucs_pgt_entry_t *pte;
     ucs_pgt_region_t *region;
+    ucs_pgt_entry_t pte;
     ucs_pgt_dir_t *dir;
     unsigned shift;
 
-    ucs_trace_func("pgtable=%p address=0x%lx", pgtable, address);
-
     /* Check if the address is mapped by the page table */
     if ((address & pgtable->mask) != pgtable->base) {
         return NULL;
     }
 
-    /* Descend into the page table */
-    pte   = &pgtable->root;
+    /* Descend into the page table. Every entry is read once, and the result is
+     * checked instead of asserted, since the page table could be modified by
+     * another thread (see ucs_pgtable_lookup).
+     */
+    pte   = pgtable->root;
     shift = pgtable->shift;
     for (;;) {
-        if (ucs_pgt_entry_test(pte, UCS_PGT_ENTRY_FLAG_REGION)) {
-            region = ucs_pgt_entry_get_region(pte);
-            ucs_assert((address >= region->start) && (address < region->end));
+        if (ucs_pgt_entry_test(&pte, UCS_PGT_ENTRY_FLAG_REGION)) {
+            region = ucs_pgt_entry_value(&pte);
+            if (ucs_unlikely((address < region->start) ||
+                             (address >= region->end))) {
+                return NULL;
+            }
             return region;
-        } else if (ucs_pgt_entry_test(pte, UCS_PGT_ENTRY_FLAG_DIR)) {
-            dir = ucs_pgt_entry_get_dir(pte);
+        } else if (ucs_pgt_entry_test(&pte, UCS_PGT_ENTRY_FLAG_DIR) &&
+                   (shift > UCS_PGT_ADDR_SHIFT)) {
+            dir    = ucs_pgt_entry_value(&pte);
             shift -= UCS_PGT_ENTRY_SHIFT;
-            pte = &dir->entries[(address >> shift) & UCS_PGT_ENTRY_MASK];
+            pte    = dir->entries[(address >> shift) & UCS_PGT_ENTRY_MASK];
         } else {
             return NULL;
         }
     }
 }
 
+static UCS_F_ALWAYS_INLINE ucs_pgt_region_t *
+ucs_pgtable_flat_lookup(const ucs_pgtable_t *pgtable, ucs_pgt_addr_t address)
+{
+    ucs_pgt_region_t *region;
+    unsigned i, count;
+
+    /* Count the regions which start at or below the address, without
+     * branches, so the loop could be vectorized */
+    count = 0;
+    for (i = 0; i < UCS_PGT_FLAT_MAX_REGIONS; ++i) {
+        count += (pgtable->flat.start[i] <= address);
+    }
+
+    if (count == 0) {
+        return NULL;
+    }
+
+    /* Unused entries have NULL region */
+    region = pgtable->flat.region[count - 1];
+    if ((region == NULL) || (address >= region->end)) {
+        return NULL;
+    }
+
+    return region;
+}
+
+ucs_pgt_region_t *ucs_pgtable_lookup(const ucs_pgtable_t *pgtable,
+                                     ucs_pgt_addr_t address)
+{
+    ucs_trace_func("pgtable=%p address=0x%lx", pgtable, address);
+
+    if (ucs_likely(pgtable->flat.valid)) {
+        return ucs_pgtable_flat_lookup(pgtable, address);
+    }
+
+    return ucs_pgtable_lookup_tree(pgtable, address);
+}
+
 static void ucs_pgtable_search_recurs(const ucs_pgtable_t *pgtable,
                                       ucs_pgt_addr_t address, unsigned order,
                                       const ucs_pgt_entry_t *pte, unsigned shift,
@@ -670,6 +811,7 @@ ucs_status_t ucs_pgtable_init(ucs_pgtable_t *pgtable,
 
     ucs_pgt_entry_clear(&pgtable->root);
     ucs_pgtable_reset(pgtable);
+    ucs_pgtable_flat_reset(pgtable);
     pgtable->num_regions    = 0;
     pgtable->pgd_alloc_cb   = alloc_cb;
     pgtable->pgd_release_cb = release_cb;
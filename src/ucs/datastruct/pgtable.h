@@ -19,6 +19,11 @@
  * UCS_PGT_PTE_FLAG_REGION bit), or another entry (indicated by UCS_PGT_PTE_FLAG_DIR),
  * or be empty - if none of these bits is set.
  *
+ * In addition, while the page table contains only few regions, they are also
+ * kept in a flat array sorted by start address, which is searched instead of
+ * walking the tree. The array search has a fixed number of iterations without
+ * branches, so it can be vectorized by the compiler.
+ *
  */
 
 
@@ -41,6 +46,9 @@
 #define UCS_PGT_ENTRY_PTR_MASK     (~UCS_PGT_ENTRY_FLAGS_MASK)
 #define UCS_PGT_ENTRY_MIN_ALIGN    (UCS_PGT_ENTRY_FLAGS_MASK + 1)
 
+/* Maximal number of regions in the flat sorted array */
+#define UCS_PGT_FLAT_MAX_REGIONS   16
+
 /* Declare a variable as aligned so it could be placed in page table entry */
 #define UCS_PGT_ENTRY_V_ALIGNED    UCS_V_ALIGNED(UCS_PGT_ENTRY_MIN_ALIGN > sizeof(long) ? \
                                                  UCS_PGT_ENTRY_MIN_ALIGN : sizeof(long))
@@ -142,6 +150,17 @@ struct ucs_pgtable {
     unsigned                       num_regions; /**< total number of regions */
     ucs_pgt_dir_alloc_callback_t   pgd_alloc_cb;
     ucs_pgt_dir_release_callback_t pgd_release_cb;
+
+    /* Flat array of all regions, sorted by start address. It's used for lookup
+     * when it's valid, and becomes invalid when there are too many regions.
+     * It's rebuilt only after the number of regions drops to half of the
+     * maximum, to avoid rebuilding it repeatedly around the limit.
+     */
+    struct {
+        ucs_pgt_addr_t             start[UCS_PGT_FLAT_MAX_REGIONS];
+        ucs_pgt_region_t           *region[UCS_PGT_FLAT_MAX_REGIONS];
+        int                        valid;
+    } flat;
 };
 
 
@@ -200,6 +219,11 @@ ucs_status_t ucs_pgtable_remove(ucs_pgtable_t *pgtable, ucs_pgt_region_t *region
 /*
  * Find a region which contains the given address.
  *
+ * The lookup may run concurrently with insert and remove, if the caller
+ * detects the concurrent modification (for example, by a sequence counter)
+ * and discards the result in this case, and directories and regions which were
+ * removed are not released while such lookups could be using them.
+ *
  * @param [in]  pgtable     Page table to search the address in.
  * @param [in]  address     Address to search.
  *
@@ -209,6 +233,19 @@ ucs_pgt_region_t *ucs_pgtable_lookup(const ucs_pgtable_t *pgtable,
                                      ucs_pgt_addr_t address);
 
 
+/*
+ * Find a region which contains the given address, by walking the radix tree
+ * even if the flat array of regions is valid. Used for testing.
+ *
+ * @param [in]  pgtable     Page table to search the address in.
+ * @param [in]  address     Address to search.
+ *
+ * @return Region which contains 'address', or NULL if not found.
+ */
+ucs_pgt_region_t *ucs_pgtable_lookup_tree(const ucs_pgtable_t *pgtable,
+                                          ucs_pgt_addr_t address);
+
+
 /**
  * Search for all regions overlapping with a given address range.
  *
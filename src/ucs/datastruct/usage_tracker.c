@@ -141,8 +141,8 @@ ucs_status_t ucs_usage_tracker_get_score(ucs_usage_tracker_h usage_tracker,
     return UCS_OK;
 }
 
-ucs_status_t
-ucs_usage_tracker_remove(ucs_usage_tracker_h usage_tracker, void *key)
+static ucs_status_t
+ucs_usage_tracker_hash_remove(ucs_usage_tracker_h usage_tracker, void *key)
 {
     khiter_t iter;
 
@@ -155,6 +155,14 @@ ucs_usage_tracker_remove(ucs_usage_tracker_h usage_tracker, void *key)
     return UCS_OK;
 }
 
+ucs_status_t
+ucs_usage_tracker_remove(ucs_usage_tracker_h usage_tracker, void *key)
+{
+    /* Do not let a recent usage insert the key again on the next progress */
+    ucs_lru_remove(usage_tracker->lru, key);
+    return ucs_usage_tracker_hash_remove(usage_tracker, key);
+}
+
 /* Checks if an entry has high enough score to get promoted. */
 static int ucs_usage_tracker_compare(const void *elem_ptr1,
                                      const void *elem_ptr2, void *arg)
@@ -224,7 +232,7 @@ static void ucs_usage_tracker_promote(ucs_usage_tracker_h usage_tracker)
     for (elem_index = params->promote_capacity; elem_index < elems_count;
          ++elem_index) {
         item = elems_array[elem_index];
-        ucs_usage_tracker_remove(usage_tracker, item->key);
+        ucs_usage_tracker_hash_remove(usage_tracker, item->key);
         if (!item->promoted) {
             continue;
         }
@@ -45,6 +45,12 @@ struct ucs_memtype_cache_region {
     ucs_sys_device_t  sys_dev;  /**< System device index */
  };
 
+/* Page table directory, which can be added to the list of retired elements */
+typedef struct {
+    ucs_pgt_dir_t     super;    /**< Base class - page table directory */
+    ucs_list_link_t   list;     /**< List element */
+} ucs_memtype_cache_pgt_dir_t;
+
 
 static UCS_CLASS_INIT_FUNC(ucs_memtype_cache_t);
 static UCS_CLASS_CLEANUP_FUNC(ucs_memtype_cache_t);
@@ -107,14 +113,117 @@ static ucs_pgt_dir_t *ucs_memtype_cache_pgt_dir_alloc(const ucs_pgtable_t *pgtab
 
     ret = ucs_posix_memalign(&ptr,
                              ucs_max(sizeof(void *), UCS_PGT_ENTRY_MIN_ALIGN),
-                             sizeof(ucs_pgt_dir_t), "memtype_cache_pgdir");
+                             sizeof(ucs_memtype_cache_pgt_dir_t),
+                             "memtype_cache_pgdir");
     return (ret == 0) ? ptr : NULL;
 }
 
+static ucs_memtype_cache_retired_t *
+ucs_memtype_cache_retired_current(ucs_memtype_cache_t *memtype_cache)
+{
+    return &memtype_cache->retired[memtype_cache->epoch & 1];
+}
+
 static void ucs_memtype_cache_pgt_dir_release(const ucs_pgtable_t *pgtable,
                                               ucs_pgt_dir_t *dir)
 {
-    ucs_free(dir);
+    ucs_memtype_cache_t *memtype_cache = ucs_container_of(pgtable,
+                                                          ucs_memtype_cache_t,
+                                                          pgtable);
+    ucs_memtype_cache_pgt_dir_t *mc_dir = ucs_derived_of(dir,
+                                                        ucs_memtype_cache_pgt_dir_t);
+
+    /* Lookups could still be reading the directory */
+    ucs_list_add_tail(&ucs_memtype_cache_retired_current(memtype_cache)->dirs,
+                      &mc_dir->list);
+}
+
+static void ucs_memtype_cache_region_retire(ucs_memtype_cache_t *memtype_cache,
+                                            ucs_memtype_cache_region_t *region)
+{
+    /* Lookups could still be reading the region */
+    ucs_list_add_tail(&ucs_memtype_cache_retired_current(memtype_cache)->regions,
+                      &region->list);
+}
+
+static void ucs_memtype_cache_release_retired(ucs_memtype_cache_retired_t *retired)
+{
+    ucs_memtype_cache_region_t *region, *tmp_region;
+    ucs_memtype_cache_pgt_dir_t *dir, *tmp_dir;
+
+    ucs_list_for_each_safe(region, tmp_region, &retired->regions, list) {
+        ucs_free(region);
+    }
+    ucs_list_head_init(&retired->regions);
+
+    ucs_list_for_each_safe(dir, tmp_dir, &retired->dirs, list) {
+        ucs_free(dir);
+    }
+    ucs_list_head_init(&retired->dirs);
+}
+
+/* Lock must be held */
+static void ucs_memtype_cache_write_begin(ucs_memtype_cache_t *memtype_cache)
+{
+    ucs_assert(!(memtype_cache->seq & 1));
+    ++memtype_cache->seq;
+    ucs_memory_cpu_store_fence();
+}
+
+/* Lock must be held */
+static void ucs_memtype_cache_write_end(ucs_memtype_cache_t *memtype_cache)
+{
+    unsigned prev = (memtype_cache->epoch & 1) ^ 1;
+    unsigned i;
+
+    ucs_memory_cpu_store_fence();
+    ++memtype_cache->seq;
+
+    /* Elements retired in the previous epoch became unreachable before the
+     * epoch was advanced, so only lookups which started in the previous epoch
+     * could be using them. Lookups which start now use the current epoch, so
+     * the counters of the previous epoch drain even under continuous lookups.
+     * Pairs with the fence in ucs_memtype_cache_read_begin().
+     */
+    ucs_memory_cpu_fence();
+    for (i = 0; i < UCS_MEMTYPE_CACHE_READER_SHARDS; ++i) {
+        if (memtype_cache->readers[i].count[prev] != 0) {
+            return; /* Check again on a later update */
+        }
+    }
+
+    ucs_memtype_cache_release_retired(&memtype_cache->retired[prev]);
+
+    /* Elements retired in the current epoch are released after the lookups
+     * which started before this point are completed */
+    ucs_memory_cpu_store_fence();
+    ++memtype_cache->epoch;
+}
+
+static UCS_F_ALWAYS_INLINE volatile uint32_t *
+ucs_memtype_cache_read_begin(ucs_memtype_cache_t *memtype_cache)
+{
+    static uint32_t next_shard                = 0;
+    static __thread int32_t ucs_memtype_shard = -1;
+    volatile uint32_t *count;
+
+    if (ucs_unlikely(ucs_memtype_shard < 0)) {
+        ucs_memtype_shard = ucs_atomic_fadd32(&next_shard, 1) %
+                            UCS_MEMTYPE_CACHE_READER_SHARDS;
+    }
+
+    count = &memtype_cache->readers[ucs_memtype_shard]
+                     .count[memtype_cache->epoch & 1];
+    ucs_atomic_add32(count, 1);
+    ucs_memory_cpu_fence();
+    return count;
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucs_memtype_cache_read_end(volatile uint32_t *count)
+{
+    ucs_memory_cpu_fence();
+    ucs_atomic_sub32(count, 1);
 }
 
 /*
@@ -154,7 +263,8 @@ static void ucs_memtype_cache_insert(ucs_memtype_cache_t *memtype_cache,
         ucs_error("failed to insert " UCS_MEMTYPE_CACHE_REGION_FMT ": %s",
                   UCS_MEMTYPE_CACHE_REGION_ARG(region),
                   ucs_status_string(status));
-        ucs_free(region);
+        /* Could be partially inserted and found by a lookup */
+        ucs_memtype_cache_region_retire(memtype_cache, region);
         return;
     }
 
@@ -201,6 +311,7 @@ UCS_PROFILE_FUNC_VOID(ucs_memtype_cache_update_internal,
     search_end   = end - 1;
 
     ucs_spin_lock(&memtype_cache->lock);
+    ucs_memtype_cache_write_begin(memtype_cache);
 
     /* find and remove all regions which intersect with new one */
     ucs_pgtable_search_range(&memtype_cache->pgtable, search_start, search_end,
@@ -256,10 +367,12 @@ UCS_PROFILE_FUNC_VOID(ucs_memtype_cache_update_internal,
                                      region->mem_type, region->sys_dev);
         }
 
-        ucs_free(region);
+        ucs_list_del(&region->list);
+        ucs_memtype_cache_region_retire(memtype_cache, region);
     }
 
 out_unlock:
+    ucs_memtype_cache_write_end(memtype_cache);
     ucs_spin_unlock(&memtype_cache->lock);
 }
 
@@ -319,6 +432,9 @@ static void ucs_memtype_cache_purge(ucs_memtype_cache_t *memtype_cache)
     ucs_list_for_each_safe(region, tmp, &region_list, list) {
         ucs_free(region);
     }
+
+    ucs_memtype_cache_release_retired(&memtype_cache->retired[0]);
+    ucs_memtype_cache_release_retired(&memtype_cache->retired[1]);
 }
 
 UCS_PROFILE_FUNC(ucs_status_t, ucs_memtype_cache_lookup,
@@ -327,26 +443,50 @@ UCS_PROFILE_FUNC(ucs_status_t, ucs_memtype_cache_lookup,
 {
     ucs_memtype_cache_t *memtype_cache = ucs_memtype_cache_get_global();
     const ucs_pgt_addr_t start         = (uintptr_t)address;
+    volatile uint32_t *readers;
     ucs_memtype_cache_region_t *region;
+    ucs_memtype_cache_region_t region_copy;
     ucs_pgt_region_t *pgt_region;
     ucs_status_t status;
+    int is_changed;
+    uint64_t seq;
 
     if (memtype_cache == NULL) {
         return UCS_ERR_UNSUPPORTED;
     }
 
-    ucs_spin_lock(&memtype_cache->lock);
+    /* Lock-free lookup: copy the region, and retry if the page table was
+     * modified in the meantime. Every attempt enters the current epoch, so
+     * that a lookup which waits for updates does not delay the release of
+     * elements removed by them. */
+    do {
+        while (ucs_unlikely(memtype_cache->seq & 1)) {
+            /* Wait for the update to complete */
+        }
+
+        readers = ucs_memtype_cache_read_begin(memtype_cache);
+        seq     = memtype_cache->seq;
+        ucs_memory_cpu_load_fence();
+
+        pgt_region = UCS_PROFILE_CALL(ucs_pgtable_lookup,
+                                      &memtype_cache->pgtable, start);
+        if (pgt_region != NULL) {
+            region_copy = *ucs_derived_of(pgt_region,
+                                          ucs_memtype_cache_region_t);
+        }
+
+        ucs_memory_cpu_load_fence();
+        is_changed = (seq & 1) || (seq != memtype_cache->seq);
+        ucs_memtype_cache_read_end(readers);
+    } while (ucs_unlikely(is_changed));
 
-    pgt_region = UCS_PROFILE_CALL(ucs_pgtable_lookup, &memtype_cache->pgtable,
-                                  start);
     if (pgt_region == NULL) {
         ucs_trace("address 0x%lx not found", start);
-        status = UCS_ERR_NO_ELEM;
-        goto out_unlock;
+        return UCS_ERR_NO_ELEM;
     }
 
-    region = ucs_derived_of(pgt_region, ucs_memtype_cache_region_t);
-    if (ucs_likely((start + size) <= pgt_region->end)) {
+    region = &region_copy;
+    if (ucs_likely((start + size) <= region->super.end)) {
         mem_info->base_address = (void*)region->super.start;
         mem_info->alloc_length = region->super.end - region->super.start;
         mem_info->type         = region->mem_type;
@@ -365,8 +505,6 @@ UCS_PROFILE_FUNC(ucs_status_t, ucs_memtype_cache_lookup,
     ucs_assertv(mem_info->type != UCS_MEMORY_TYPE_HOST, "%s (%d)",
                 ucs_memory_type_names[mem_info->type], mem_info->type);
 
-out_unlock:
-    ucs_spin_unlock(&memtype_cache->lock);
     return status;
 }
 
@@ -382,6 +520,14 @@ static UCS_CLASS_INIT_FUNC(ucs_memtype_cache_t)
         goto err;
     }
 
+    self->seq   = 0;
+    self->epoch = 0;
+    ucs_list_head_init(&self->retired[0].regions);
+    ucs_list_head_init(&self->retired[0].dirs);
+    ucs_list_head_init(&self->retired[1].regions);
+    ucs_list_head_init(&self->retired[1].dirs);
+    memset(self->readers, 0, sizeof(self->readers));
+
     status = ucs_pgtable_init(&self->pgtable, ucs_memtype_cache_pgt_dir_alloc,
                               ucs_memtype_cache_pgt_dir_release);
     if (status != UCS_OK) {
@@ -402,6 +548,7 @@ static UCS_CLASS_INIT_FUNC(ucs_memtype_cache_t)
     return UCS_OK;
 
 err_cleanup_pgtable:
+    ucs_memtype_cache_purge(self);
     ucs_pgtable_cleanup(&self->pgtable);
 err_destroy_rwlock:
     ucs_spinlock_destroy(&self->lock);
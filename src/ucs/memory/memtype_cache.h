@@ -11,7 +11,9 @@
 
 #include <ucs/datastruct/pgtable.h>
 #include <ucs/datastruct/list.h>
+#include <ucs/arch/cpu.h>
 #include <ucs/stats/stats_fwd.h>
+#include <ucs/sys/compiler.h>
 #include <ucs/sys/compiler_def.h>
 #include <ucs/sys/topo/base/topo.h>
 #include <ucs/type/spinlock.h>
@@ -37,9 +39,37 @@ typedef struct ucs_memory_info {
 } ucs_memory_info_t;
 
 
+/* Number of counters of active lookups, to reduce contention between threads */
+#define UCS_MEMTYPE_CACHE_READER_SHARDS 16
+
+
+/* Counters of active lookups which started in an even or odd epoch, on a
+ * separate cache line */
+typedef struct {
+    volatile uint32_t     count[2];
+    UCS_CACHELINE_PADDING(uint32_t[2]);
+} ucs_memtype_cache_readers_t;
+
+
+/* Elements removed from the page table during an epoch */
+typedef struct {
+    ucs_list_link_t       regions;    /**< Removed regions */
+    ucs_list_link_t       dirs;       /**< Removed page table directories */
+} ucs_memtype_cache_retired_t;
+
+
 struct ucs_memtype_cache {
-    ucs_spinlock_t        lock;       /**< protests the page table */
+    /* Lookups do not take the lock, instead they retry if the sequence number
+     * was odd or changed during the lookup. Page table directories and regions
+     * which are removed during an epoch are released after all lookups which
+     * started in that epoch have completed.
+     */
+    ucs_spinlock_t        lock;       /**< Serializes page table updates */
     ucs_pgtable_t         pgtable;    /**< Page table to hold the regions */
+    volatile uint64_t     seq;        /**< Sequence number, odd during update */
+    volatile uint64_t     epoch;      /**< Reclamation epoch */
+    ucs_memtype_cache_retired_t retired[2]; /**< Removed in even/odd epoch */
+    ucs_memtype_cache_readers_t readers[UCS_MEMTYPE_CACHE_READER_SHARDS];
 };
 
 
@@ -19,6 +19,8 @@
 #include <stdint.h>
 #include <sched.h>
 #include <dirent.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #define UCS_NUMA_MIN_DISTANCE       10
 #define UCS_NUMA_NODE_MAX           INT16_MAX
@@ -26,6 +28,9 @@
 #define UCS_NUMA_NODES_DIR_PATH     UCS_SYS_FS_SYSTEM_PATH "/node"
 #define UCS_NUMA_NODE_DISTANCE_PATH UCS_NUMA_NODES_DIR_PATH "/node%d/distance"
 
+/* Memory policy modes, from linux/mempolicy.h */
+#define UCS_NUMA_MPOL_PREFERRED     1
+
 
 KHASH_MAP_INIT_INT(numa_distance, ucs_numa_distance_t);
 
@@ -151,6 +156,18 @@ ucs_numa_node_t ucs_numa_node_of_cpu(int cpu)
     return cpu_numa_node[cpu] - 1;
 }
 
+ucs_numa_node_t ucs_numa_node_of_current_cpu()
+{
+    int cpu = sched_getcpu();
+
+    if (cpu < 0) {
+        ucs_debug("sched_getcpu() failed: %m");
+        return UCS_NUMA_NODE_UNDEFINED;
+    }
+
+    return ucs_numa_node_of_cpu(cpu);
+}
+
 ucs_numa_node_t ucs_numa_node_of_device(const char *dev_path)
 {
     long parsed_node;
@@ -253,6 +270,47 @@ ucs_numa_distance(ucs_numa_node_t node1, ucs_numa_node_t node2)
     return distance;
 }
 
+ucs_status_t ucs_numa_mempolicy_set_preferred(ucs_numa_node_t node,
+                                              ucs_numa_mempolicy_t *prev)
+{
+#if defined(SYS_get_mempolicy) && defined(SYS_set_mempolicy)
+    static const unsigned long bits_per_long = 8 * sizeof(long);
+    unsigned long nodemask[ucs_static_array_size(prev->nodemask)] = {0};
+
+    if ((node < 0) || (node >= UCS_NUMA_MEMPOLICY_MAX_NODES)) {
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    /* The kernel reads one bit less than the given number of nodes */
+    if (syscall(SYS_get_mempolicy, &prev->mode, prev->nodemask,
+                UCS_NUMA_MEMPOLICY_MAX_NODES + 1, NULL, 0) != 0) {
+        ucs_debug("get_mempolicy() failed: %m");
+        return UCS_ERR_IO_ERROR;
+    }
+
+    nodemask[node / bits_per_long] = UCS_BIT(node % bits_per_long);
+    if (syscall(SYS_set_mempolicy, UCS_NUMA_MPOL_PREFERRED, nodemask,
+                UCS_NUMA_MEMPOLICY_MAX_NODES + 1) != 0) {
+        ucs_debug("set_mempolicy(PREFERRED, node=%d) failed: %m", node);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    return UCS_OK;
+#else
+    return UCS_ERR_UNSUPPORTED;
+#endif
+}
+
+void ucs_numa_mempolicy_restore(const ucs_numa_mempolicy_t *prev)
+{
+#ifdef SYS_set_mempolicy
+    if (syscall(SYS_set_mempolicy, prev->mode, prev->nodemask,
+                UCS_NUMA_MEMPOLICY_MAX_NODES + 1) != 0) {
+        ucs_warn("failed to restore memory policy (mode=%d): %m", prev->mode);
+    }
+#endif
+}
+
 void ucs_numa_init()
 {
     ucs_spinlock_init(&ucs_numa_global_ctx.lock, 0);
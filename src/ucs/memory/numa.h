@@ -8,6 +8,7 @@
 #define UCS_NUMA_H_
 
 #include <ucs/sys/compiler_def.h>
+#include <ucs/type/status.h>
 #include <stdint.h>
 
 BEGIN_C_DECLS
@@ -15,12 +16,24 @@ BEGIN_C_DECLS
 #define UCS_NUMA_NODE_DEFAULT    0
 #define UCS_NUMA_NODE_UNDEFINED -1
 
+/* Maximal number of nodes in a memory policy node mask */
+#define UCS_NUMA_MEMPOLICY_MAX_NODES 1024
+
 typedef int ucs_numa_distance_t;
 
 
 typedef int16_t ucs_numa_node_t;
 
 
+/**
+ * Memory allocation policy of the calling thread, see set_mempolicy(2).
+ */
+typedef struct {
+    int           mode;
+    unsigned long nodemask[UCS_NUMA_MEMPOLICY_MAX_NODES / (8 * sizeof(long))];
+} ucs_numa_mempolicy_t;
+
+
 extern const char *ucs_numa_policy_names[];
 
 
@@ -50,6 +63,12 @@ unsigned ucs_numa_num_configured_nodes();
 ucs_numa_node_t ucs_numa_node_of_cpu(int cpu);
 
 
+/**
+ * @return The node that the calling thread is currently running on.
+ */
+ucs_numa_node_t ucs_numa_node_of_current_cpu();
+
+
 /**
  * @param [in]  dev_path sysfs path of the device.
  *
@@ -69,6 +88,29 @@ ucs_numa_node_t ucs_numa_node_of_device(const char *dev_path);
 ucs_numa_distance_t
 ucs_numa_distance(ucs_numa_node_t node1, ucs_numa_node_t node2);
 
+
+/**
+ * Make the calling thread prefer allocating memory on the given node, until
+ * @ref ucs_numa_mempolicy_restore is called. It affects pages which are
+ * touched for the first time, including pages pinned by memory registration.
+ *
+ * @param [in]  node     NUMA node to allocate memory on.
+ * @param [out] prev     Filled with the previous policy of the thread.
+ *
+ * @return UCS_OK if the policy was set, otherwise an error code.
+ */
+ucs_status_t ucs_numa_mempolicy_set_preferred(ucs_numa_node_t node,
+                                              ucs_numa_mempolicy_t *prev);
+
+
+/**
+ * Restore the memory policy of the calling thread.
+ *
+ * @param [in]  prev     Policy returned from
+ *                       @ref ucs_numa_mempolicy_set_preferred.
+ */
+void ucs_numa_mempolicy_restore(const ucs_numa_mempolicy_t *prev);
+
 END_C_DECLS
 
 #endif
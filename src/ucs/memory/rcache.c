@@ -14,6 +14,7 @@
 #include <ucs/type/class.h>
 #include <ucs/datastruct/queue.h>
 #include <ucs/debug/log.h>
+#include <ucs/profile/probe.h>
 #include <ucs/profile/profile.h>
 #include <ucs/debug/memtrack_int.h>
 #include <ucs/stats/stats.h>
@@ -1082,6 +1083,8 @@ ucs_status_t ucs_rcache_get(ucs_rcache_t *rcache, void *address, size_t length,
     ucs_trace_func("rcache=%s, address=%p, length=%zu", rcache->name, address,
                    length);
 
+    UCS_PROBE(rcache_get, rcache, address, length);
+
     pthread_rwlock_rdlock(&rcache->pgt_lock);
     UCS_STATS_UPDATE_COUNTER(rcache->stats, UCS_RCACHE_GETS, 1);
     if (ucs_queue_is_empty(&rcache->inv_q)) {
@@ -1108,6 +1111,7 @@ ucs_status_t ucs_rcache_get(ucs_rcache_t *rcache, void *address, size_t length,
      * - could not find cached region
      * - found unregistered region
      */
+    UCS_PROBE(rcache_miss, rcache, address, length);
     return UCS_PROFILE_CALL(ucs_rcache_create_region, rcache, address, length,
                             alignment, prot, arg, region_p);
 }
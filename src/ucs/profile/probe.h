@@ -0,0 +1,38 @@
+/**
+* Copyright (c) NVIDIA CORPORATION & AFFILIATES, 2024. ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#ifndef UCS_PROBE_H_
+#define UCS_PROBE_H_
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+/*
+ * USDT (user-level statically defined tracing) probes.
+ *
+ * Unlike profiling, the probes are compiled in by default, and cost a single
+ * "nop" instruction when no tracer is attached. A tool such as bpftrace or
+ * perf can attach to them in a running process, for example:
+ *
+ *   bpftrace -e 'usdt:/path/libucp.so:ucx:request_complete { ... }'
+ *
+ * The provider name of all probes is "ucx". Probe arguments are evaluated
+ * even when no tracer is attached, so they should be cheap expressions
+ * (fields and pointers which are already at hand), and there can be at most 12
+ * of them.
+ *
+ * Probes are disabled if sys/sdt.h was not found, or if UCX was configured with
+ * --disable-usdt.
+ */
+#ifdef HAVE_USDT
+#  include <sys/sdt.h>
+#  define UCS_PROBE(_name, ...) STAP_PROBEV(ucx, _name, ## __VA_ARGS__)
+#else
+#  define UCS_PROBE(_name, ...)
+#endif
+
+#endif
@@ -10,6 +10,7 @@
 
 #include "profile.h"
 
+#include <ucs/arch/bitops.h>
 #include <ucs/datastruct/list.h>
 #include <ucs/debug/debug_int.h>
 #include <ucs/debug/log.h>
@@ -20,6 +21,10 @@
 #include <pthread.h>
 
 
+/* How often the background thread writes streamed records to the file */
+#define UCS_PROFILE_STREAM_INTERVAL_MSEC 10
+
+
 typedef struct ucs_profile_global_location {
     ucs_profile_location_t        super; /*< Location info */
     volatile ucs_profile_loc_id_t *loc_id_p; /*< Back-pointer to location index */
@@ -42,6 +47,16 @@ typedef struct ucs_profile_thread_context {
         int                           wraparound;    /**< Whether log was rotated */
     } log;
 
+    struct {
+        ucs_profile_record_t          *records;      /**< Ring buffer */
+        uint64_t                      mask;          /**< Ring buffer size - 1 */
+        volatile uint64_t             head;          /**< Number of records produced */
+        volatile uint64_t             tail;          /**< Number of records written to the file */
+        volatile uint64_t             num_dropped;   /**< Records dropped since the ring was full */
+        uint64_t                      num_reported;  /**< Dropped records reported to the file */
+        int                           started;       /**< Whether thread start was written */
+    } stream;
+
     struct {
         unsigned                      num_locations; /**< Number of valid locations */
         ucs_profile_thread_location_t *locations;    /**< Statistics per location */
@@ -64,6 +79,14 @@ struct ucs_profile_context  {
     pthread_mutex_t               mutex;            /**< Protects updating the locations array */
     pthread_key_t                 tls_key;          /**< TLS key for per-thread context */
     ucs_list_link_t               thread_list;      /**< List of all thread contexts */
+
+    struct {
+        int                       fd;               /**< Streamed file, or -1 */
+        unsigned                  num_locations;    /**< Locations written to the file */
+        int                       stop;             /**< Stop the writer thread */
+        pthread_cond_t            cond;             /**< Wakes up the writer thread */
+        pthread_t                 thread;           /**< Writer thread */
+    } stream;
 };
 
 
@@ -75,9 +98,10 @@ struct ucs_profile_context  {
 
 
 const char *ucs_profile_mode_names[] = {
-    [UCS_PROFILE_MODE_ACCUM] = "accum",
-    [UCS_PROFILE_MODE_LOG]   = "log",
-    [UCS_PROFILE_MODE_LAST]  = NULL
+    [UCS_PROFILE_MODE_ACCUM]  = "accum",
+    [UCS_PROFILE_MODE_LOG]    = "log",
+    [UCS_PROFILE_MODE_STREAM] = "stream",
+    [UCS_PROFILE_MODE_LAST]   = NULL
 };
 
 /**
@@ -281,11 +305,45 @@ static void ucs_profile_calc_blocks(ucs_profile_header_t *header,
     }
 }
 
-static void ucs_profile_write(ucs_profile_context_t *ctx)
+static void ucs_profile_init_header(ucs_profile_header_t *header,
+                                    ucs_profile_context_t *ctx,
+                                    uint32_t feature_flags)
+{
+    memset(header, 0, sizeof(*header));
+    ucs_strncpy_safe(header->cmdline, ucs_get_process_cmdline(),
+                     sizeof(header->cmdline));
+    ucs_strncpy_safe(header->hostname, ucs_get_host_name(),
+                     sizeof(header->hostname));
+    header->version       = UCS_PROFILE_FILE_VERSION;
+    ucs_strncpy_safe(header->ucs_path, ucs_sys_get_lib_path(),
+                     sizeof(header->ucs_path));
+
+    header->pid           = getpid();
+    header->mode          = ctx->profile_mode;
+    header->one_second    = ucs_time_from_sec(1.0);
+    header->feature_flags = feature_flags;
+}
+
+static int ucs_profile_open_file(ucs_profile_context_t *ctx)
 {
-    ucs_profile_header_t header;
     char fullpath[1024] = {0};
     char filename[1024] = {0};
+    int fd;
+
+    ucs_fill_filename_template(ctx->file_name, filename, sizeof(filename));
+    ucs_expand_path(filename, fullpath, sizeof(fullpath) - 1);
+
+    fd = open(fullpath, O_WRONLY|O_CREAT|O_TRUNC, 0600);
+    if (fd < 0) {
+        ucs_error("failed to write profiling data to '%s': %m", fullpath);
+    }
+
+    return fd;
+}
+
+static void ucs_profile_write(ucs_profile_context_t *ctx)
+{
+    ucs_profile_header_t header;
     ucs_time_t write_time;
     ucs_status_t status;
     int fd;
@@ -304,29 +362,12 @@ static void ucs_profile_write(ucs_profile_context_t *ctx)
 
     write_time = ucs_get_time();
 
-    ucs_fill_filename_template(ctx->file_name, filename, sizeof(filename));
-    ucs_expand_path(filename, fullpath, sizeof(fullpath) - 1);
-
-    fd = open(fullpath, O_WRONLY|O_CREAT|O_TRUNC, 0600);
+    fd = ucs_profile_open_file(ctx);
     if (fd < 0) {
-        ucs_error("failed to write profiling data to '%s': %m", fullpath);
         goto out_unlock;
     }
 
-    memset(&header, 0, sizeof(header));
-    ucs_strncpy_safe(header.cmdline, ucs_get_process_cmdline(),
-                     sizeof(header.cmdline));
-    ucs_strncpy_safe(header.hostname, ucs_get_host_name(),
-                     sizeof(header.hostname));
-    header.version       = UCS_PROFILE_FILE_VERSION;
-    ucs_strncpy_safe(header.ucs_path, ucs_sys_get_lib_path(),
-                     sizeof(header.ucs_path));
-
-    header.pid           = getpid();
-    header.mode          = ctx->profile_mode;
-    header.one_second    = ucs_time_from_sec(1.0);
-    header.feature_flags = 0;
-
+    ucs_profile_init_header(&header, ctx, 0);
     ucs_profile_calc_blocks(&header, ctx, env_variables);
 
     ucs_profile_file_write_data(fd, &header, sizeof(header));
@@ -369,10 +410,11 @@ ucs_profile_thread_init(ucs_profile_context_t *ctx)
         return NULL;
     }
 
-    thread_ctx->tid        = ucs_get_tid();
-    thread_ctx->start_time = ucs_get_time();
-    thread_ctx->end_time   = 0;
-    thread_ctx->pthread_id = pthread_self();
+    thread_ctx->tid          = ucs_get_tid();
+    thread_ctx->start_time   = ucs_get_time();
+    thread_ctx->end_time     = 0;
+    thread_ctx->pthread_id   = pthread_self();
+    thread_ctx->is_completed = 0;
 
     ucs_debug("profiling context %p: start on thread 0x%lx tid %d mode %d",
               thread_ctx, (unsigned long)pthread_self(), ucs_get_tid(),
@@ -393,6 +435,26 @@ ucs_profile_thread_init(ucs_profile_context_t *ctx)
         thread_ctx->log.wraparound = 0;
     }
 
+    /* Initialize stream mode, with a power-of-2 ring buffer */
+    if (ctx->profile_mode & UCS_BIT(UCS_PROFILE_MODE_STREAM)) {
+        num_records = ucs_max(ctx->max_file_size /
+                              sizeof(ucs_profile_record_t), 1);
+        num_records = UCS_BIT(ucs_ilog2(num_records));
+        thread_ctx->stream.records = ucs_calloc(num_records,
+                                                sizeof(ucs_profile_record_t),
+                                                "profile_stream");
+        if (thread_ctx->stream.records == NULL) {
+            ucs_fatal("failed to allocate profiling stream buffer");
+        }
+
+        thread_ctx->stream.mask         = num_records - 1;
+        thread_ctx->stream.head         = 0;
+        thread_ctx->stream.tail         = 0;
+        thread_ctx->stream.num_dropped  = 0;
+        thread_ctx->stream.num_reported = 0;
+        thread_ctx->stream.started      = 0;
+    }
+
     /* Initialize accumulate mode */
     if (ctx->profile_mode & UCS_BIT(UCS_PROFILE_MODE_ACCUM)) {
         thread_ctx->accum.num_locations = 0;
@@ -418,6 +480,10 @@ static void ucs_profile_thread_cleanup(unsigned profile_mode,
         ucs_free(ctx->log.start);
     }
 
+    if (profile_mode & UCS_BIT(UCS_PROFILE_MODE_STREAM)) {
+        ucs_free(ctx->stream.records);
+    }
+
     if (profile_mode & UCS_BIT(UCS_PROFILE_MODE_ACCUM)) {
         ucs_free(ctx->accum.locations);
     }
@@ -431,6 +497,8 @@ static void ucs_profile_thread_finalize(ucs_profile_thread_context_t *ctx)
     ucs_debug("profiling context %p: completed", ctx);
 
     ctx->end_time     = ucs_get_time();
+    /* The stream writer thread may release the context once it's completed */
+    ucs_memory_cpu_store_fence();
     ctx->is_completed = 1;
 }
 
@@ -574,6 +642,7 @@ void ucs_profile_record(ucs_profile_context_t *ctx, ucs_profile_type_t type,
     ucs_profile_loc_id_t loc_id;
     ucs_profile_record_t *rec;
     ucs_time_t current_time;
+    uint64_t head;
 
     /* If the location id is -1 or 0, need to re-read it with lock held */
     loc_id = *loc_id_p;
@@ -631,6 +700,26 @@ void ucs_profile_record(ucs_profile_context_t *ctx, ucs_profile_type_t type,
             thread_ctx->log.wraparound = 1;
         }
     }
+
+    if (ctx->profile_mode & UCS_BIT(UCS_PROFILE_MODE_STREAM)) {
+        head = thread_ctx->stream.head;
+        if (ucs_unlikely((head - thread_ctx->stream.tail) >
+                         thread_ctx->stream.mask)) {
+            /* The writer thread did not keep up, do not block */
+            ++thread_ctx->stream.num_dropped;
+            return;
+        }
+
+        rec            = &thread_ctx->stream.records[head &
+                                                     thread_ctx->stream.mask];
+        rec->timestamp = current_time;
+        rec->param64   = param64;
+        rec->param32   = param32;
+        rec->location  = loc_id - 1;
+        /* Publish the record to the writer thread */
+        ucs_memory_cpu_store_fence();
+        thread_ctx->stream.head = head + 1;
+    }
 }
 
 static void ucs_profile_check_active_threads(ucs_profile_context_t *ctx)
@@ -684,6 +773,386 @@ static void ucs_profile_cleanup_completed_threads(ucs_profile_context_t *ctx)
     pthread_mutex_unlock(&ctx->mutex);
 }
 
+static ucs_status_t
+ucs_profile_stream_write_chunk_header(ucs_profile_context_t *ctx,
+                                      ucs_profile_stream_chunk_type_t type,
+                                      int tid, size_t size)
+{
+    ucs_profile_stream_chunk_t chunk;
+
+    chunk.type = type;
+    chunk.tid  = tid;
+    chunk.size = size;
+    return ucs_profile_file_write_data(ctx->stream.fd, &chunk, sizeof(chunk));
+}
+
+static ucs_status_t
+ucs_profile_stream_write_chunk(ucs_profile_context_t *ctx,
+                               ucs_profile_stream_chunk_type_t type, int tid,
+                               const void *data, size_t size)
+{
+    ucs_status_t status;
+
+    status = ucs_profile_stream_write_chunk_header(ctx, type, tid, size);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    return ucs_profile_file_write_data(ctx->stream.fd, data, size);
+}
+
+/* Write the locations which were added since the last time */
+static ucs_status_t ucs_profile_stream_write_locations(ucs_profile_context_t *ctx)
+{
+    ucs_profile_global_location_t *loc;
+    unsigned num_locations;
+    ucs_status_t status;
+
+    num_locations = ctx->num_locations - ctx->stream.num_locations;
+    if (num_locations == 0) {
+        return UCS_OK;
+    }
+
+    status = ucs_profile_stream_write_chunk_header(
+            ctx, UCS_PROFILE_STREAM_CHUNK_LOCATIONS, 0,
+            num_locations * sizeof(loc->super));
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    for (loc = ctx->locations + ctx->stream.num_locations;
+         loc < ctx->locations + ctx->num_locations; ++loc) {
+        status = ucs_profile_file_write_data(ctx->stream.fd, &loc->super,
+                                             sizeof(loc->super));
+        if (status != UCS_OK) {
+            return status;
+        }
+    }
+
+    ctx->stream.num_locations = ctx->num_locations;
+    return UCS_OK;
+}
+
+static ucs_status_t
+ucs_profile_stream_write_records(ucs_profile_context_t *ctx,
+                                 ucs_profile_thread_context_t *thread_ctx)
+{
+    uint64_t tail = thread_ctx->stream.tail;
+    uint64_t mask = thread_ctx->stream.mask;
+    uint64_t head, num_records, num_dropped, count;
+    ucs_status_t status;
+
+    /* Read the records only after reading the head */
+    head = thread_ctx->stream.head;
+    ucs_memory_cpu_load_fence();
+
+    num_records = head - tail;
+    if (num_records > 0) {
+        status = ucs_profile_stream_write_chunk_header(
+                ctx, UCS_PROFILE_STREAM_CHUNK_RECORDS, thread_ctx->tid,
+                num_records * sizeof(ucs_profile_record_t));
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        /* The records may wrap around the end of the ring buffer */
+        count  = ucs_min(num_records, mask + 1 - (tail & mask));
+        status = ucs_profile_file_write_records(
+                ctx->stream.fd, &thread_ctx->stream.records[tail & mask],
+                &thread_ctx->stream.records[(tail & mask) + count]);
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        status = ucs_profile_file_write_records(
+                ctx->stream.fd, thread_ctx->stream.records,
+                &thread_ctx->stream.records[num_records - count]);
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        /* Release the ring buffer space only after the records were read */
+        ucs_memory_cpu_fence();
+        thread_ctx->stream.tail = head;
+    }
+
+    num_dropped = thread_ctx->stream.num_dropped;
+    if (num_dropped != thread_ctx->stream.num_reported) {
+        count  = num_dropped - thread_ctx->stream.num_reported;
+        status = ucs_profile_stream_write_chunk(ctx,
+                                                UCS_PROFILE_STREAM_CHUNK_DROPPED,
+                                                thread_ctx->tid, &count,
+                                                sizeof(count));
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        thread_ctx->stream.num_reported = num_dropped;
+    }
+
+    return UCS_OK;
+}
+
+static ucs_status_t
+ucs_profile_stream_write_thread_end(ucs_profile_context_t *ctx,
+                                    ucs_profile_thread_context_t *thread_ctx,
+                                    ucs_time_t end_time)
+{
+    ucs_profile_thread_location_t empty_location = { .total_time = 0, .count = 0 };
+    unsigned i, num_locations, num_thread_locations;
+    ucs_profile_thread_header_t thread_hdr;
+    ucs_status_t status;
+
+    if (ctx->profile_mode & UCS_BIT(UCS_PROFILE_MODE_ACCUM)) {
+        num_locations        = ctx->num_locations;
+        num_thread_locations = thread_ctx->accum.num_locations;
+    } else {
+        num_locations        = 0;
+        num_thread_locations = 0;
+    }
+
+    thread_hdr.tid         = thread_ctx->tid;
+    thread_hdr.start_time  = thread_ctx->start_time;
+    thread_hdr.end_time    = end_time;
+    thread_hdr.num_records = thread_ctx->stream.tail;
+
+    status = ucs_profile_stream_write_chunk_header(
+            ctx, UCS_PROFILE_STREAM_CHUNK_THREAD_END, thread_ctx->tid,
+            sizeof(thread_hdr) +
+            (num_locations * sizeof(ucs_profile_thread_location_t)));
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    status = ucs_profile_file_write_data(ctx->stream.fd, &thread_hdr,
+                                         sizeof(thread_hdr));
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    /* Pad with empty entries, same as non-streamed file */
+    ucs_assert_always(num_thread_locations <= num_locations);
+    status = ucs_profile_file_write_data(ctx->stream.fd,
+                                         thread_ctx->accum.locations,
+                                         num_thread_locations *
+                                         sizeof(*thread_ctx->accum.locations));
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    for (i = num_thread_locations; i < num_locations; ++i) {
+        status = ucs_profile_file_write_data(ctx->stream.fd, &empty_location,
+                                             sizeof(empty_location));
+        if (status != UCS_OK) {
+            return status;
+        }
+    }
+
+    return UCS_OK;
+}
+
+static ucs_status_t
+ucs_profile_stream_flush_thread(ucs_profile_context_t *ctx,
+                                ucs_profile_thread_context_t *thread_ctx,
+                                int is_completed, int is_final)
+{
+    ucs_profile_thread_header_t thread_hdr;
+    ucs_status_t status;
+
+    if (ctx->stream.fd < 0) {
+        /* Writing has failed, discard the records */
+        thread_ctx->stream.tail = thread_ctx->stream.head;
+        return UCS_OK;
+    }
+
+    if (!thread_ctx->stream.started) {
+        thread_hdr.tid         = thread_ctx->tid;
+        thread_hdr.start_time  = thread_ctx->start_time;
+        thread_hdr.end_time    = 0;
+        thread_hdr.num_records = 0;
+        status = ucs_profile_stream_write_chunk(
+                ctx, UCS_PROFILE_STREAM_CHUNK_THREAD_START, thread_ctx->tid,
+                &thread_hdr, sizeof(thread_hdr));
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        thread_ctx->stream.started = 1;
+    }
+
+    status = ucs_profile_stream_write_records(ctx, thread_ctx);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    if (is_completed) {
+        return ucs_profile_stream_write_thread_end(ctx, thread_ctx,
+                                                   thread_ctx->end_time);
+    } else if (is_final) {
+        return ucs_profile_stream_write_thread_end(ctx, thread_ctx,
+                                                   ucs_get_time());
+    }
+
+    return UCS_OK;
+}
+
+static void ucs_profile_stream_close(ucs_profile_context_t *ctx)
+{
+    if (ctx->stream.fd >= 0) {
+        close(ctx->stream.fd);
+        ctx->stream.fd = -1;
+    }
+}
+
+/*
+ * Write all pending records and locations to the streamed file, and release
+ * completed threads. If 'is_final' is set, also end all threads and the file.
+ * Global lock must be held.
+ */
+static void ucs_profile_stream_flush(ucs_profile_context_t *ctx, int is_final)
+{
+    ucs_profile_thread_context_t *thread_ctx, *tmp;
+    ucs_status_t status;
+    int is_completed;
+
+    /* Records may refer only to locations which were added before, and adding
+     * a location requires the global lock */
+    if (ctx->stream.fd >= 0) {
+        status = ucs_profile_stream_write_locations(ctx);
+        if (status != UCS_OK) {
+            ucs_profile_stream_close(ctx);
+        }
+    }
+
+    ucs_list_for_each_safe(thread_ctx, tmp, &ctx->thread_list, list) {
+        is_completed = thread_ctx->is_completed;
+        ucs_memory_cpu_load_fence();
+
+        status = ucs_profile_stream_flush_thread(ctx, thread_ctx, is_completed,
+                                                 is_final);
+        if (status != UCS_OK) {
+            ucs_profile_stream_close(ctx);
+        }
+
+        if (is_completed) {
+            ucs_profile_thread_cleanup(ctx->profile_mode, thread_ctx);
+        }
+    }
+
+    if (is_final && (ctx->stream.fd >= 0)) {
+        ucs_profile_stream_write_chunk(ctx, UCS_PROFILE_STREAM_CHUNK_END, 0,
+                                       NULL, 0);
+        ucs_profile_stream_close(ctx);
+    }
+}
+
+static void *ucs_profile_stream_thread_func(void *arg)
+{
+    ucs_profile_context_t *ctx = arg;
+    struct timespec deadline;
+    long nsec;
+
+    pthread_mutex_lock(&ctx->mutex);
+    while (!ctx->stream.stop) {
+        ucs_profile_stream_flush(ctx, 0);
+
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        nsec             = deadline.tv_nsec +
+                           (UCS_PROFILE_STREAM_INTERVAL_MSEC *
+                            (UCS_NSEC_PER_SEC / UCS_MSEC_PER_SEC));
+        deadline.tv_sec += nsec / UCS_NSEC_PER_SEC;
+        deadline.tv_nsec = nsec % UCS_NSEC_PER_SEC;
+        pthread_cond_timedwait(&ctx->stream.cond, &ctx->mutex, &deadline);
+    }
+    pthread_mutex_unlock(&ctx->mutex);
+
+    return NULL;
+}
+
+static void ucs_profile_stream_init(ucs_profile_context_t *ctx)
+{
+    ucs_profile_header_t header;
+    ucs_string_buffer_t env_strb;
+    const char *env_variables;
+    ucs_status_t status;
+
+    ctx->stream.fd            = -1;
+    ctx->stream.num_locations = 0;
+    ctx->stream.stop          = 0;
+
+    if (!(ctx->profile_mode & UCS_BIT(UCS_PROFILE_MODE_STREAM))) {
+        return;
+    }
+
+    /* Streamed records replace the in-memory log */
+    ctx->profile_mode &= ~UCS_BIT(UCS_PROFILE_MODE_LOG);
+
+    if (!strlen(ctx->file_name)) {
+        goto err_disable;
+    }
+
+    ctx->stream.fd = ucs_profile_open_file(ctx);
+    if (ctx->stream.fd < 0) {
+        goto err_disable;
+    }
+
+    ucs_string_buffer_init(&env_strb);
+    ucs_config_parser_get_env_vars(&env_strb, " ");
+    env_variables = ucs_string_buffer_cstr(&env_strb);
+
+    ucs_profile_init_header(&header, ctx, UCS_PROFILE_FEATURE_STREAM);
+    header.env_vars.offset = sizeof(header);
+    header.env_vars.size   = strlen(env_variables);
+
+    status = ucs_profile_file_write_data(ctx->stream.fd, &header,
+                                         sizeof(header));
+    if (status == UCS_OK) {
+        status = ucs_profile_file_write_data(ctx->stream.fd, env_variables,
+                                             header.env_vars.size);
+    }
+    ucs_string_buffer_cleanup(&env_strb);
+    if (status != UCS_OK) {
+        goto err_close;
+    }
+
+    pthread_cond_init(&ctx->stream.cond, NULL);
+    status = ucs_pthread_create(&ctx->stream.thread,
+                                ucs_profile_stream_thread_func, ctx,
+                                "profile");
+    if (status != UCS_OK) {
+        goto err_cond_destroy;
+    }
+
+    return;
+
+err_cond_destroy:
+    pthread_cond_destroy(&ctx->stream.cond);
+err_close:
+    ucs_profile_stream_close(ctx);
+err_disable:
+    ucs_warn("profiling stream mode is disabled");
+    ctx->profile_mode &= ~UCS_BIT(UCS_PROFILE_MODE_STREAM);
+}
+
+static void ucs_profile_stream_cleanup(ucs_profile_context_t *ctx)
+{
+    if (!(ctx->profile_mode & UCS_BIT(UCS_PROFILE_MODE_STREAM))) {
+        return;
+    }
+
+    pthread_mutex_lock(&ctx->mutex);
+    ctx->stream.stop = 1;
+    pthread_cond_signal(&ctx->stream.cond);
+    pthread_mutex_unlock(&ctx->mutex);
+
+    pthread_join(ctx->stream.thread, NULL);
+    pthread_cond_destroy(&ctx->stream.cond);
+
+    pthread_mutex_lock(&ctx->mutex);
+    ucs_profile_stream_flush(ctx, 1);
+    pthread_mutex_unlock(&ctx->mutex);
+}
+
 void ucs_profile_dump(ucs_profile_context_t *ctx)
 {
     ucs_profile_thread_context_t *thread_ctx;
@@ -695,6 +1164,14 @@ void ucs_profile_dump(ucs_profile_context_t *ctx)
         pthread_setspecific(ctx->tls_key, NULL);
     }
 
+    if (ctx->profile_mode & UCS_BIT(UCS_PROFILE_MODE_STREAM)) {
+        /* completed threads are written and released by the flush */
+        pthread_mutex_lock(&ctx->mutex);
+        ucs_profile_stream_flush(ctx, 0);
+        pthread_mutex_unlock(&ctx->mutex);
+        return;
+    }
+
     /* write and cleanup all completed threads (including the current thread) */
     ucs_profile_write(ctx);
     ucs_profile_cleanup_completed_threads(ctx);
@@ -749,6 +1226,8 @@ ucs_status_t ucs_profile_init(unsigned profile_mode, const char *file_name,
         ucs_warn("profiling file not specified");
     }
 
+    ucs_profile_stream_init(ctx);
+
     pthread_key_create(&(ctx->tls_key), ucs_profile_thread_key_destr);
     *ctx_p = ctx;
 
@@ -762,6 +1241,7 @@ free_ctx:
 void ucs_profile_cleanup(ucs_profile_context_t *ctx)
 {
     ucs_profile_dump(ctx);
+    ucs_profile_stream_cleanup(ctx);
     ucs_profile_check_active_threads(ctx);
     ucs_profile_reset_locations(ctx);
     pthread_key_delete(ctx->tls_key);
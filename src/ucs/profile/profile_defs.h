@@ -28,8 +28,10 @@ BEGIN_C_DECLS
  * Profiling modes
  */
 enum {
-    UCS_PROFILE_MODE_ACCUM, /**< Accumulate elapsed time per location */
-    UCS_PROFILE_MODE_LOG,   /**< Record all events */
+    UCS_PROFILE_MODE_ACCUM,  /**< Accumulate elapsed time per location */
+    UCS_PROFILE_MODE_LOG,    /**< Record all events */
+    UCS_PROFILE_MODE_STREAM, /**< Record all events and write them to the
+                                  file continuously */
     UCS_PROFILE_MODE_LAST
 };
 
@@ -60,9 +62,54 @@ typedef enum {
  *
  * ] * ucs_profile_thread_header_t::num_threads
  * <env variables string>
+ *
+ *
+ * Streamed profile file structure (UCS_PROFILE_FEATURE_STREAM is set, and the
+ * locations and threads blocks are empty):
+ *
+ * < ucs_profile_header_t >
+ * <env variables string>
+ * [
+ *    < ucs_profile_stream_chunk_t >
+ *    < payload > * ucs_profile_stream_chunk_t::size bytes
+ * ] * until the end of file
+ *
+ * The last chunk is UCS_PROFILE_STREAM_CHUNK_END, unless the process did not
+ * complete profiling, in which case the last chunk could be partial.
  */
 
 
+/**
+ * Profile file feature flags
+ */
+enum {
+    UCS_PROFILE_FEATURE_STREAM = UCS_BIT(0) /**< Streamed file structure */
+};
+
+
+/**
+ * Streamed profile file chunk types
+ */
+typedef enum {
+    UCS_PROFILE_STREAM_CHUNK_LOCATIONS,    /**< Array of ucs_profile_location_t
+                                                which are appended to the
+                                                locations defined so far */
+    UCS_PROFILE_STREAM_CHUNK_THREAD_START, /**< ucs_profile_thread_header_t of a
+                                                new thread */
+    UCS_PROFILE_STREAM_CHUNK_RECORDS,      /**< Array of ucs_profile_record_t of
+                                                a thread */
+    UCS_PROFILE_STREAM_CHUNK_DROPPED,      /**< uint64_t number of records of a
+                                                thread which were dropped
+                                                because the buffer was full */
+    UCS_PROFILE_STREAM_CHUNK_THREAD_END,   /**< Final ucs_profile_thread_header_t
+                                                of a thread, followed by an
+                                                array of
+                                                ucs_profile_thread_location_t */
+    UCS_PROFILE_STREAM_CHUNK_END,          /**< Profiling completed, no payload */
+    UCS_PROFILE_STREAM_CHUNK_LAST
+} ucs_profile_stream_chunk_type_t;
+
+
 /**
  * Profile output file block/section offset and size
 */
@@ -132,6 +179,15 @@ typedef struct ucs_profile_record {
     uint32_t                 location;      /**< Location identifier */
 } UCS_S_PACKED ucs_profile_record_t;
 
+/**
+ * Streamed profile file chunk header
+ */
+typedef struct ucs_profile_stream_chunk {
+    uint32_t                 type;          /**< From ucs_profile_stream_chunk_type_t */
+    uint32_t                 tid;           /**< System thread id, or 0 */
+    uint64_t                 size;          /**< Payload size in bytes */
+} UCS_S_PACKED ucs_profile_stream_chunk_t;
+
 typedef struct ucs_profile_context ucs_profile_context_t;
 typedef short ucs_profile_loc_id_t;
 
@@ -12,6 +12,7 @@
 #endif
 
 #include "stats.h"
+#include "stats_shm.h"
 
 #include <ucs/debug/log.h>
 #include <ucs/time/time.h>
@@ -46,6 +47,7 @@ enum {
     UCS_STATS_FLAG_STREAM         = UCS_BIT(9),
     UCS_STATS_FLAG_STREAM_CLOSE   = UCS_BIT(10),
     UCS_STATS_FLAG_STREAM_BINARY  = UCS_BIT(11),
+    UCS_STATS_FLAG_SHM            = UCS_BIT(12),
 };
 
 enum {
@@ -79,6 +81,8 @@ typedef struct {
         double                       interval;
     };
 
+    ucs_stats_shm_t                  shm;          /* Shared memory export */
+
     khash_t(ucs_stats_cls)           cls;
 
     pthread_mutex_t                  lock;
@@ -209,6 +213,18 @@ static ucs_stats_class_t *ucs_stats_get_class(ucs_stats_class_t *cls)
     return class_dup;
 }
 
+static void ucs_stats_node_release(ucs_stats_node_t *node)
+{
+    if (!ucs_stats_shm_is_node(&ucs_stats_context.shm, node)) {
+        ucs_free(node);
+        return;
+    }
+
+    pthread_mutex_lock(&ucs_stats_context.lock);
+    ucs_stats_shm_node_put(&ucs_stats_context.shm, node);
+    pthread_mutex_unlock(&ucs_stats_context.lock);
+}
+
 static void ucs_stats_node_remove(ucs_stats_node_t *node, int make_inactive)
 {
     ucs_assert(node != &ucs_stats_context.root_node);
@@ -240,7 +256,7 @@ static void ucs_stats_node_remove(ucs_stats_node_t *node, int make_inactive)
         if (!node->filter_node->type_list_len) {
             ucs_free(node->filter_node);
         }
-        ucs_free(node);
+        ucs_stats_node_release(node);
     }
 }
 
@@ -281,6 +297,19 @@ static ucs_status_t ucs_stats_node_new(ucs_stats_class_t *cls, ucs_stats_node_t
 {
     ucs_stats_node_t *node;
 
+    if (ucs_stats_context.flags & UCS_STATS_FLAG_SHM) {
+        pthread_mutex_lock(&ucs_stats_context.lock);
+        node = ucs_stats_shm_node_get(&ucs_stats_context.shm, cls);
+        pthread_mutex_unlock(&ucs_stats_context.lock);
+        if (node != NULL) {
+            *p_node = node;
+            return UCS_OK;
+        }
+
+        /* The node is counted, but not exported */
+        ucs_debug("no room for stats node of %s in shared memory", cls->name);
+    }
+
     node = ucs_malloc(sizeof(ucs_stats_node_t) +
                       sizeof(ucs_stats_counter_t) *
                       (cls->num_counters > 0 ? cls->num_counters - 1 : 0),
@@ -387,6 +416,8 @@ static ucs_status_t ucs_stats_node_add(ucs_stats_node_t *node,
                                        ucs_stats_node_t *parent,
                                        ucs_stats_filter_node_t *filter_node)
 {
+    ucs_status_t status;
+
     ucs_assert(node != &ucs_stats_context.root_node);
     if (parent == NULL) {
         return UCS_ERR_INVALID_PARAM;
@@ -398,6 +429,14 @@ static ucs_status_t ucs_stats_node_add(ucs_stats_node_t *node,
     node->parent = parent;
     ucs_stats_add_to_filter(node, filter_node);
 
+    if (ucs_stats_shm_is_node(&ucs_stats_context.shm, node)) {
+        status = ucs_stats_shm_node_publish(&ucs_stats_context.shm, node);
+        if (status != UCS_OK) {
+            ucs_debug("failed to export stats node '"UCS_STATS_NODE_FMT"': %s",
+                      UCS_STATS_NODE_ARG(node), ucs_status_string(status));
+        }
+    }
+
     pthread_mutex_unlock(&ucs_stats_context.lock);
 
     return UCS_OK;
@@ -426,13 +465,13 @@ ucs_status_t ucs_stats_node_alloc(ucs_stats_node_t** p_node, ucs_stats_class_t *
     va_end(ap);
 
     if (status != UCS_OK) {
-        ucs_free(node);
+        ucs_stats_node_release(node);
         return status;
     }
 
     status = ucs_stats_filter_node_new(node->cls, &filter_node);
     if (status != UCS_OK) {
-        ucs_free(node);
+        ucs_stats_node_release(node);
         return status;
     }
 
@@ -440,7 +479,7 @@ ucs_status_t ucs_stats_node_alloc(ucs_stats_node_t** p_node, ucs_stats_class_t *
 
     status = ucs_stats_node_add(node, parent, filter_node);
     if (status != UCS_OK) {
-        ucs_free(node);
+        ucs_stats_node_release(node);
         ucs_free(filter_node);
         return status;
     }
@@ -462,7 +501,8 @@ void ucs_stats_node_free(ucs_stats_node_t *node)
     ucs_trace("releasing stats node '"UCS_STATS_NODE_FMT"'", UCS_STATS_NODE_ARG(node));
 
     /* If we would dump stats in exit, keep this data instead of releasing it */
-    if (ucs_stats_context.flags & UCS_STATS_FLAG_ON_EXIT) {
+    if ((ucs_stats_context.flags & UCS_STATS_FLAG_ON_EXIT) &&
+        !(ucs_stats_context.flags & UCS_STATS_FLAG_SHM)) {
         ucs_stats_node_remove(node, 1);
     } else {
         ucs_stats_node_remove(node, 0);
@@ -710,6 +750,14 @@ static void ucs_stats_open_dest()
         }
 
         ucs_stats_context.flags |= UCS_STATS_FLAG_SOCKET;
+    } else if (!strcmp(ucs_global_opts.stats_dest, "shm")) {
+        status = ucs_stats_shm_create(&ucs_stats_context.shm,
+                                      UCS_STATS_SHM_DEFAULT_SLOTS);
+        if (status != UCS_OK) {
+            goto out_free;
+        }
+
+        ucs_stats_context.flags |= UCS_STATS_FLAG_SHM;
     } else if (strcmp(ucs_global_opts.stats_dest, "") != 0) {
         status = ucs_open_output_stream(ucs_global_opts.stats_dest,
                                         UCS_LOG_LEVEL_ERROR,
@@ -737,6 +785,10 @@ out_free:
 
 static void ucs_stats_close_dest()
 {
+    if (ucs_stats_context.flags & UCS_STATS_FLAG_SHM) {
+        ucs_stats_context.flags &= ~UCS_STATS_FLAG_SHM;
+        ucs_stats_shm_detach(&ucs_stats_context.shm);
+    }
     if (ucs_stats_context.flags & UCS_STATS_FLAG_SOCKET) {
         ucs_stats_context.flags &= ~UCS_STATS_FLAG_SOCKET;
         ucs_stats_client_cleanup(ucs_stats_context.client);
@@ -859,11 +911,12 @@ void ucs_stats_init()
     /* Aggregate-sum class id to name database initialize */
     ucs_array_init_dynamic(&ucs_stats_context.aggrgt_counter_names);
 
-    ucs_debug("statistics enabled, flags: %c%c%c%c%c%c%c",
+    ucs_debug("statistics enabled, flags: %c%c%c%c%c%c%c%c",
               (ucs_stats_context.flags & UCS_STATS_FLAG_ON_TIMER)      ? 't' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_ON_EXIT)       ? 'e' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_ON_SIGNAL)     ? 's' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_SOCKET)        ? 'u' : '-',
+              (ucs_stats_context.flags & UCS_STATS_FLAG_SHM)           ? 'm' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_STREAM)        ? 'f' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_STREAM_BINARY) ? 'b' : '-',
               (ucs_stats_context.flags & UCS_STATS_FLAG_STREAM_CLOSE)  ? 'c' : '-');
@@ -904,7 +957,8 @@ void ucs_stats_dump()
 
 int ucs_stats_is_active()
 {
-    return ucs_stats_context.flags & (UCS_STATS_FLAG_SOCKET|UCS_STATS_FLAG_STREAM);
+    return ucs_stats_context.flags & (UCS_STATS_FLAG_SOCKET|UCS_STATS_FLAG_STREAM|
+                                      UCS_STATS_FLAG_SHM);
 }
 
 ucs_stats_node_t * ucs_stats_get_root() {
@@ -0,0 +1,379 @@
+/**
+* Copyright (c) NVIDIA CORPORATION & AFFILIATES, 2024. ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "stats_shm.h"
+
+#include <ucs/debug/log.h>
+#include <ucs/sys/math.h>
+#include <ucs/sys/ptr_arith.h>
+#include <ucs/sys/string.h>
+#include <ucs/sys/sys.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+
+#define UCS_STATS_SHM_SLOT_NONE UINT32_MAX
+
+
+static UCS_F_ALWAYS_INLINE ucs_stats_shm_slot_t *
+ucs_stats_shm_slot(const ucs_stats_shm_t *shm, uint32_t index)
+{
+    return UCS_PTR_BYTE_OFFSET(shm->hdr, shm->hdr->slots_offset +
+                                         (index * shm->hdr->slot_size));
+}
+
+static UCS_F_ALWAYS_INLINE uint32_t
+ucs_stats_shm_slot_index(const ucs_stats_shm_t *shm,
+                         const ucs_stats_shm_slot_t *slot)
+{
+    return UCS_PTR_BYTE_DIFF(ucs_stats_shm_slot(shm, 0), slot) /
+           shm->hdr->slot_size;
+}
+
+static ucs_stats_shm_slot_t *
+ucs_stats_shm_node_slot(const ucs_stats_node_t *node)
+{
+    return ucs_container_of(node, ucs_stats_shm_slot_t, node);
+}
+
+static void ucs_stats_shm_unmap(ucs_stats_shm_t *shm)
+{
+    munmap(shm->hdr, shm->size);
+    shm->hdr = NULL;
+}
+
+ucs_status_t ucs_stats_shm_create(ucs_stats_shm_t *shm, unsigned num_slots)
+{
+    size_t classes_offset, slots_offset, size;
+    ucs_stats_shm_header_t *hdr;
+    int fd, ret;
+
+    classes_offset = ucs_align_up_pow2(sizeof(*hdr), UCS_SYS_CACHE_LINE_SIZE);
+    slots_offset   = ucs_align_up_pow2(classes_offset +
+                                       (UCS_STATS_SHM_MAX_CLASSES *
+                                        sizeof(ucs_stats_shm_class_t)),
+                                       UCS_SYS_CACHE_LINE_SIZE);
+    size           = ucs_align_up(slots_offset +
+                                  (num_slots * sizeof(ucs_stats_shm_slot_t)),
+                                  ucs_get_page_size());
+
+    ucs_snprintf_zero(shm->name, sizeof(shm->name), UCS_STATS_SHM_NAME_FMT,
+                      getpid());
+
+    /* Truncate a stale segment left by a previous process with the same pid */
+    fd = shm_open(shm->name, O_CREAT | O_TRUNC | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        ucs_error("shm_open(%s) failed: %m", shm->name);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    ret = ftruncate(fd, size);
+    if (ret < 0) {
+        ucs_error("ftruncate(%s, %zu) failed: %m", shm->name, size);
+        goto err_unlink;
+    }
+
+    /* Pages of the segment are populated on first use */
+    hdr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (hdr == MAP_FAILED) {
+        ucs_error("mmap(%s, %zu) failed: %m", shm->name, size);
+        goto err_unlink;
+    }
+
+    close(fd);
+
+    hdr->version         = UCS_STATS_SHM_VERSION;
+    hdr->pid             = getpid();
+    hdr->max_classes     = UCS_STATS_SHM_MAX_CLASSES;
+    hdr->num_slots       = num_slots;
+    hdr->slot_size       = sizeof(ucs_stats_shm_slot_t);
+    hdr->counters_offset = ucs_offsetof(ucs_stats_shm_slot_t, node.counters);
+    hdr->classes_offset  = classes_offset;
+    hdr->slots_offset    = slots_offset;
+    hdr->num_classes     = 0;
+    hdr->slots_hwm       = 0;
+    ucs_strncpy_zero(hdr->hostname, ucs_get_host_name(),
+                     sizeof(hdr->hostname));
+    ucs_strncpy_zero(hdr->cmdline, ucs_get_process_cmdline(),
+                     sizeof(hdr->cmdline));
+
+    /* Readers check the magic number last */
+    ucs_memory_cpu_store_fence();
+    hdr->magic = UCS_STATS_SHM_MAGIC;
+
+    shm->hdr       = hdr;
+    shm->size      = size;
+    shm->is_owner  = 1;
+    shm->free_head = UCS_STATS_SHM_SLOT_NONE;
+    shm->num_nodes = 0;
+    shm->detached  = 0;
+
+    ucs_debug("created statistics segment %s, %u slots, %zu bytes", shm->name,
+              num_slots, size);
+    return UCS_OK;
+
+err_unlink:
+    close(fd);
+    shm_unlink(shm->name);
+    return UCS_ERR_IO_ERROR;
+}
+
+static ucs_status_t
+ucs_stats_shm_class_index(ucs_stats_shm_t *shm, const ucs_stats_class_t *cls,
+                          uint32_t *index_p)
+{
+    ucs_stats_shm_header_t *hdr = shm->hdr;
+    ucs_stats_shm_class_t *shm_cls;
+    uint32_t index;
+    unsigned i;
+
+    for (index = 0; index < hdr->num_classes; ++index) {
+        shm_cls = (ucs_stats_shm_class_t*)ucs_stats_shm_class(shm, index);
+        if ((shm_cls->num_counters == cls->num_counters) &&
+            !strcmp(shm_cls->name, cls->name)) {
+            *index_p = index;
+            return UCS_OK;
+        }
+    }
+
+    if (index >= hdr->max_classes) {
+        return UCS_ERR_EXCEEDS_LIMIT;
+    }
+
+    shm_cls = (ucs_stats_shm_class_t*)ucs_stats_shm_class(shm, index);
+    ucs_strncpy_zero(shm_cls->name, cls->name, sizeof(shm_cls->name));
+    shm_cls->num_counters = cls->num_counters;
+    for (i = 0; i < cls->num_counters; ++i) {
+        ucs_strncpy_zero(shm_cls->counter_names[i], cls->counter_names[i],
+                         sizeof(shm_cls->counter_names[i]));
+    }
+
+    ucs_memory_cpu_store_fence();
+    hdr->num_classes = index + 1;
+    *index_p         = index;
+    return UCS_OK;
+}
+
+ucs_stats_node_t *ucs_stats_shm_node_get(ucs_stats_shm_t *shm,
+                                         ucs_stats_class_t *cls)
+{
+    ucs_stats_shm_header_t *hdr = shm->hdr;
+    ucs_stats_shm_slot_t *slot;
+
+    if (cls->num_counters > UCS_STATS_SHM_MAX_COUNTERS) {
+        return NULL;
+    }
+
+    if (shm->free_head != UCS_STATS_SHM_SLOT_NONE) {
+        slot           = ucs_stats_shm_slot(shm, shm->free_head);
+        shm->free_head = slot->next_free;
+    } else if (hdr->slots_hwm < hdr->num_slots) {
+        slot = ucs_stats_shm_slot(shm, hdr->slots_hwm++);
+    } else {
+        return NULL;
+    }
+
+    ucs_assert(slot->state == UCS_STATS_SHM_SLOT_FREE);
+    ++shm->num_nodes;
+    return &slot->node;
+}
+
+ucs_status_t ucs_stats_shm_node_publish(ucs_stats_shm_t *shm,
+                                        ucs_stats_node_t *node)
+{
+    ucs_stats_shm_slot_t *slot = ucs_stats_shm_node_slot(node);
+    ucs_status_t status;
+    uint32_t class_index;
+
+    status = ucs_stats_shm_class_index(shm, node->cls, &class_index);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    slot->class_index = class_index;
+    if (ucs_stats_shm_is_node(shm, node->parent)) {
+        slot->parent = ucs_stats_shm_slot_index(
+                shm, ucs_stats_shm_node_slot(node->parent));
+    } else {
+        slot->parent = UCS_STATS_SHM_PARENT_ROOT;
+    }
+
+    ++slot->generation;
+    ucs_memory_cpu_store_fence();
+    slot->state = UCS_STATS_SHM_SLOT_ACTIVE;
+    return UCS_OK;
+}
+
+void ucs_stats_shm_node_put(ucs_stats_shm_t *shm, ucs_stats_node_t *node)
+{
+    ucs_stats_shm_slot_t *slot = ucs_stats_shm_node_slot(node);
+
+    /* Make sure readers see the slot is free before it is reused */
+    slot->state = UCS_STATS_SHM_SLOT_FREE;
+    ucs_memory_cpu_store_fence();
+
+    slot->next_free = shm->free_head;
+    shm->free_head  = ucs_stats_shm_slot_index(shm, slot);
+
+    ucs_assert(shm->num_nodes > 0);
+    if ((--shm->num_nodes == 0) && shm->detached) {
+        ucs_debug("unmapping statistics segment %s", shm->name);
+        ucs_stats_shm_unmap(shm);
+    }
+}
+
+int ucs_stats_shm_is_node(const ucs_stats_shm_t *shm,
+                          const ucs_stats_node_t *node)
+{
+    return (shm->hdr != NULL) && ((void*)node >= (void*)shm->hdr) &&
+           ((void*)node < UCS_PTR_BYTE_OFFSET(shm->hdr, shm->size));
+}
+
+ucs_status_t ucs_stats_shm_attach(pid_t pid, ucs_stats_shm_t *shm)
+{
+    ucs_stats_shm_header_t *hdr;
+    ucs_status_t status;
+    struct stat st;
+    int fd, ret;
+
+    ucs_snprintf_zero(shm->name, sizeof(shm->name), UCS_STATS_SHM_NAME_FMT,
+                      pid);
+
+    fd = shm_open(shm->name, O_RDONLY, 0);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return UCS_ERR_NO_ELEM;
+        }
+
+        ucs_error("shm_open(%s) failed: %m", shm->name);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    ret = fstat(fd, &st);
+    if (ret < 0) {
+        ucs_error("fstat(%s) failed: %m", shm->name);
+        status = UCS_ERR_IO_ERROR;
+        goto out_close;
+    }
+
+    if (st.st_size < sizeof(*hdr)) {
+        /* The segment is being created */
+        status = UCS_ERR_NO_ELEM;
+        goto out_close;
+    }
+
+    hdr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (hdr == MAP_FAILED) {
+        ucs_error("mmap(%s, %zu) failed: %m", shm->name, (size_t)st.st_size);
+        status = UCS_ERR_IO_ERROR;
+        goto out_close;
+    }
+
+    if (hdr->magic != UCS_STATS_SHM_MAGIC) {
+        status = UCS_ERR_NO_ELEM;
+        goto err_unmap;
+    }
+
+    ucs_memory_cpu_load_fence();
+
+    if ((hdr->version != UCS_STATS_SHM_VERSION) ||
+        (hdr->slot_size != sizeof(ucs_stats_shm_slot_t)) ||
+        ((hdr->slots_offset + (hdr->num_slots * (size_t)hdr->slot_size)) >
+         st.st_size)) {
+        ucs_error("statistics segment %s has incompatible format (version %u)",
+                  shm->name, hdr->version);
+        status = UCS_ERR_UNSUPPORTED;
+        goto err_unmap;
+    }
+
+    shm->hdr       = hdr;
+    shm->size      = st.st_size;
+    shm->is_owner  = 0;
+    shm->free_head = UCS_STATS_SHM_SLOT_NONE;
+    shm->num_nodes = 0;
+    shm->detached  = 0;
+    status         = UCS_OK;
+    goto out_close;
+
+err_unmap:
+    munmap(hdr, st.st_size);
+out_close:
+    close(fd);
+    return status;
+}
+
+void ucs_stats_shm_detach(ucs_stats_shm_t *shm)
+{
+    if (shm->is_owner) {
+        shm_unlink(shm->name);
+
+        /* Nodes which were not returned yet, including nodes which were not
+         * published, still point to the segment */
+        if (shm->num_nodes > 0) {
+            ucs_debug("statistics segment %s has %u nodes in use, unmapping it"
+                      " when they are released", shm->name, shm->num_nodes);
+            shm->detached = 1;
+            return;
+        }
+    }
+
+    ucs_stats_shm_unmap(shm);
+}
+
+const ucs_stats_shm_class_t *
+ucs_stats_shm_class(const ucs_stats_shm_t *shm, uint32_t index)
+{
+    return (const ucs_stats_shm_class_t*)
+                   UCS_PTR_BYTE_OFFSET(shm->hdr, shm->hdr->classes_offset) +
+           index;
+}
+
+ucs_status_t ucs_stats_shm_sample(const ucs_stats_shm_t *shm, uint32_t index,
+                                  ucs_stats_shm_sample_t *sample)
+{
+    const ucs_stats_shm_slot_t *slot = ucs_stats_shm_slot(shm, index);
+    uint32_t num_counters;
+
+    if ((index >= shm->hdr->slots_hwm) ||
+        (slot->state != UCS_STATS_SHM_SLOT_ACTIVE)) {
+        return UCS_ERR_NO_ELEM;
+    }
+
+    ucs_memory_cpu_load_fence();
+
+    sample->generation  = slot->generation;
+    sample->class_index = slot->class_index;
+    sample->parent      = slot->parent;
+    if (sample->class_index >= shm->hdr->num_classes) {
+        return UCS_ERR_BUSY;
+    }
+
+    ucs_memory_cpu_load_fence();
+
+    num_counters = ucs_stats_shm_class(shm, sample->class_index)->num_counters;
+    ucs_strncpy_zero(sample->name, slot->node.name, sizeof(sample->name));
+    memcpy(sample->counters,
+           UCS_PTR_BYTE_OFFSET(slot, shm->hdr->counters_offset),
+           ucs_min(num_counters, UCS_STATS_SHM_MAX_COUNTERS) *
+           sizeof(ucs_stats_counter_t));
+
+    /* The slot could be released and reused while we were copying it */
+    ucs_memory_cpu_load_fence();
+    if ((slot->state != UCS_STATS_SHM_SLOT_ACTIVE) ||
+        (slot->generation != sample->generation)) {
+        return UCS_ERR_BUSY;
+    }
+
+    return UCS_OK;
+}
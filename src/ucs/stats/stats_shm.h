@@ -0,0 +1,200 @@
+/**
+* Copyright (c) NVIDIA CORPORATION & AFFILIATES, 2024. ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#ifndef UCS_STATS_SHM_H_
+#define UCS_STATS_SHM_H_
+
+#include <ucs/stats/libstats.h>
+#include <ucs/sys/compiler_def.h>
+#include <ucs/arch/cpu.h>
+#include <sys/types.h>
+
+BEGIN_C_DECLS
+
+/*
+ * Statistics export over shared memory (UCX_STATS_DEST=shm).
+ *
+ * Every statistics node of the process is allocated inside a slot of a
+ * shared memory segment, so counter updates are plain stores to the mapped
+ * memory, at the same cost as updating a private node. Other processes map the
+ * segment read-only and sample the counters at any time, without signalling or
+ * pausing the exporting process.
+ *
+ *   +--------+-----------------------+--------+--------+-----+
+ *   | header | classes[max_classes]  | slot 0 | slot 1 | ... |
+ *   +--------+-----------------------+--------+--------+-----+
+ *
+ * Slots are cache-line aligned, so counters of nodes which are updated by
+ * different threads (e.g different workers) never share a cache line.
+ *
+ * A slot is published by incrementing its generation and then setting the
+ * state to ACTIVE; a reader validates a sample by checking that the state and
+ * generation did not change while it copied the counters.
+ */
+
+#define UCS_STATS_SHM_MAGIC         0x4d48535354534355ul /* "UCSSTSHM" */
+#define UCS_STATS_SHM_VERSION       1
+#define UCS_STATS_SHM_NAME_FMT      "/ucx_stats.%d"
+#define UCS_STATS_SHM_NAME_MAX      32
+#define UCS_STATS_SHM_DEFAULT_SLOTS 4096
+#define UCS_STATS_SHM_MAX_CLASSES   256
+#define UCS_STATS_SHM_MAX_COUNTERS  64
+#define UCS_STATS_SHM_HOSTNAME_MAX  64
+#define UCS_STATS_SHM_CMDLINE_MAX   128
+#define UCS_STATS_SHM_PARENT_ROOT   (-1)
+
+
+typedef enum {
+    UCS_STATS_SHM_SLOT_FREE,
+    UCS_STATS_SHM_SLOT_ACTIVE
+} ucs_stats_shm_slot_state_t;
+
+
+/* Segment header */
+typedef struct ucs_stats_shm_header {
+    uint64_t                 magic;
+    uint32_t                 version;
+    int32_t                  pid;
+    uint32_t                 max_classes;
+    uint32_t                 num_slots;
+    uint32_t                 slot_size;
+    uint32_t                 counters_offset; /* Offset of counters in a slot */
+    uint64_t                 classes_offset;
+    uint64_t                 slots_offset;
+    volatile uint32_t        num_classes;     /* Registered classes */
+    volatile uint32_t        slots_hwm;       /* Slots which were ever used */
+    char                     hostname[UCS_STATS_SHM_HOSTNAME_MAX];
+    char                     cmdline[UCS_STATS_SHM_CMDLINE_MAX];
+} ucs_stats_shm_header_t;
+
+
+/* Statistics class, as seen by readers */
+typedef struct ucs_stats_shm_class {
+    char                     name[UCS_STAT_NAME_MAX + 1];
+    uint32_t                 num_counters;
+    char                     counter_names[UCS_STATS_SHM_MAX_COUNTERS]
+                                          [UCS_STAT_NAME_MAX + 1];
+} ucs_stats_shm_class_t;
+
+
+/* Slot holding one statistics node */
+typedef struct ucs_stats_shm_slot {
+    volatile uint32_t        state;       /* ucs_stats_shm_slot_state_t */
+    uint32_t                 class_index;
+    volatile uint64_t        generation;  /* Incremented on every reuse */
+    int32_t                  parent;      /* Parent slot, or PARENT_ROOT */
+    uint32_t                 next_free;   /* Used only by the owner */
+    ucs_stats_node_t         node;
+    /* Space for the rest of the counters, which follow node.counters[0] */
+    ucs_stats_counter_t      counters[UCS_STATS_SHM_MAX_COUNTERS - 1];
+} UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE) ucs_stats_shm_slot_t;
+
+
+/* Mapping of a statistics segment */
+typedef struct ucs_stats_shm {
+    ucs_stats_shm_header_t   *hdr;
+    size_t                   size;
+    int                      is_owner;
+    uint32_t                 free_head;   /* Owner only: list of free slots */
+    uint32_t                 num_nodes;   /* Owner only: nodes in use */
+    int                      detached;    /* Owner only: unmap the segment
+                                             when the last node is returned */
+    char                     name[UCS_STATS_SHM_NAME_MAX];
+} ucs_stats_shm_t;
+
+
+/* Consistent copy of a slot, taken by a reader */
+typedef struct ucs_stats_shm_sample {
+    uint64_t                 generation;
+    uint32_t                 class_index;
+    int32_t                  parent;
+    char                     name[UCS_STAT_NAME_MAX + 1];
+    ucs_stats_counter_t      counters[UCS_STATS_SHM_MAX_COUNTERS];
+} ucs_stats_shm_sample_t;
+
+
+/**
+ * Create the statistics segment of the current process.
+ *
+ * @param shm        Segment to initialize.
+ * @param num_slots  Maximal number of statistics nodes in the segment.
+ */
+ucs_status_t ucs_stats_shm_create(ucs_stats_shm_t *shm, unsigned num_slots);
+
+
+/**
+ * Allocate a statistics node from the segment. The node is not visible to
+ * readers until it is published.
+ *
+ * @param shm      Segment created by @ref ucs_stats_shm_create.
+ * @param cls      Node class.
+ *
+ * @return New node, or NULL if the segment is full or the class has too many
+ *         counters.
+ */
+ucs_stats_node_t *ucs_stats_shm_node_get(ucs_stats_shm_t *shm,
+                                         ucs_stats_class_t *cls);
+
+
+/**
+ * Make an initialized node visible to readers. Must be called after the parent
+ * of the node was set.
+ */
+ucs_status_t ucs_stats_shm_node_publish(ucs_stats_shm_t *shm,
+                                        ucs_stats_node_t *node);
+
+
+/**
+ * Return a node allocated by @ref ucs_stats_shm_node_get to the segment.
+ */
+void ucs_stats_shm_node_put(ucs_stats_shm_t *shm, ucs_stats_node_t *node);
+
+
+/**
+ * @return Nonzero if the node was allocated from the segment.
+ */
+int ucs_stats_shm_is_node(const ucs_stats_shm_t *shm,
+                          const ucs_stats_node_t *node);
+
+
+/**
+ * Map the statistics segment of another process, read-only.
+ *
+ * @param pid  Process to attach to.
+ * @param shm  Filled with the segment mapping.
+ *
+ * @return UCS_ERR_NO_ELEM if the process does not export statistics.
+ */
+ucs_status_t ucs_stats_shm_attach(pid_t pid, ucs_stats_shm_t *shm);
+
+
+/**
+ * Unmap a segment, and remove it if it was created by this process. If nodes
+ * of the segment are still in use by this process, they remain valid, and the
+ * segment is unmapped when the last of them is returned.
+ */
+void ucs_stats_shm_detach(ucs_stats_shm_t *shm);
+
+
+/**
+ * @return Class descriptor number @a index of the segment.
+ */
+const ucs_stats_shm_class_t *
+ucs_stats_shm_class(const ucs_stats_shm_t *shm, uint32_t index);
+
+
+/**
+ * Take a consistent copy of slot number @a index.
+ *
+ * @return UCS_OK if the slot holds an active node, UCS_ERR_NO_ELEM if it is
+ *         free, or UCS_ERR_BUSY if it was reused while being read.
+ */
+ucs_status_t ucs_stats_shm_sample(const ucs_stats_shm_t *shm, uint32_t index,
+                                  ucs_stats_shm_sample_t *sample);
+
+END_C_DECLS
+
+#endif
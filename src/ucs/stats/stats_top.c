@@ -0,0 +1,354 @@
+/**
+* Copyright (c) NVIDIA CORPORATION & AFFILIATES, 2024. ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "stats_shm.h"
+
+#include <ucs/sys/math.h>
+#include <ucs/sys/string.h>
+#include <ucs/time/time.h>
+#include <dirent.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+/*
+ * Show live statistics of processes running with UCX_STATS_DEST=shm.
+ * Usage: ucs_stats_top [ -p pid ]... [ -c class ]... [ -i sec ] [ -n count ]
+ *                      [ -a ]
+ *
+ * The statistics segments are mapped read-only, so the monitored processes are
+ * neither signalled nor paused.
+ */
+
+#define STATS_TOP_MAX_PIDS   64
+#define STATS_TOP_MAX_CLASS  16
+#define STATS_TOP_SHM_DIR    "/dev/shm"
+#define STATS_TOP_SHM_PREFIX "ucx_stats."
+
+
+typedef struct {
+    pid_t                  pids[STATS_TOP_MAX_PIDS];
+    unsigned               num_pids;
+    const char             *classes[STATS_TOP_MAX_CLASS];
+    unsigned               num_classes;
+    double                 interval;
+    long                   count;
+    int                    all_counters;
+} stats_top_opts_t;
+
+
+typedef struct {
+    ucs_stats_shm_t        shm;
+    ucs_stats_shm_sample_t *samples[2]; /* Previous and current samples */
+    uint8_t                *valid[2];
+    uint32_t               num_slots;
+    uint32_t               num_used;    /* Slots which were ever used */
+} stats_top_proc_t;
+
+
+static void usage()
+{
+    printf("Usage: ucs_stats_top [options]\n");
+    printf("Show live statistics of UCX processes running with "
+           "UCX_STATS_DEST=shm\n\n");
+    printf("  -p <pid>     Monitor this process (may be given several times), "
+           "default: all\n");
+    printf("  -c <class>   Show only nodes whose class starts with <class>, "
+           "for example\n"
+           "               ucp_worker, ucp_ep, uct_iface or rcache (may be "
+           "given several times)\n");
+    printf("  -i <sec>     Update interval, default: 1\n");
+    printf("  -n <count>   Exit after <count> updates, default: unlimited\n");
+    printf("  -a           Show all counters, not only the ones which changed\n");
+    printf("  -h           Show this help\n");
+}
+
+static int parse_args(int argc, char **argv, stats_top_opts_t *opts)
+{
+    int c;
+
+    memset(opts, 0, sizeof(*opts));
+    opts->interval = 1.0;
+    opts->count    = -1;
+
+    while ((c = getopt(argc, argv, "p:c:i:n:ah")) != -1) {
+        switch (c) {
+        case 'p':
+            if (opts->num_pids >= STATS_TOP_MAX_PIDS) {
+                fprintf(stderr, "too many processes\n");
+                return -1;
+            }
+            opts->pids[opts->num_pids++] = atoi(optarg);
+            break;
+        case 'c':
+            if (opts->num_classes >= STATS_TOP_MAX_CLASS) {
+                fprintf(stderr, "too many classes\n");
+                return -1;
+            }
+            opts->classes[opts->num_classes++] = optarg;
+            break;
+        case 'i':
+            opts->interval = atof(optarg);
+            if (opts->interval <= 0) {
+                fprintf(stderr, "invalid interval '%s'\n", optarg);
+                return -1;
+            }
+            break;
+        case 'n':
+            opts->count = atol(optarg);
+            break;
+        case 'a':
+            opts->all_counters = 1;
+            break;
+        case 'h':
+        default:
+            usage();
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static void find_pids(stats_top_opts_t *opts)
+{
+    struct dirent *entry;
+    DIR *dir;
+    pid_t pid;
+
+    dir = opendir(STATS_TOP_SHM_DIR);
+    if (dir == NULL) {
+        fprintf(stderr, "failed to open %s: %m\n", STATS_TOP_SHM_DIR);
+        return;
+    }
+
+    while (((entry = readdir(dir)) != NULL) &&
+           (opts->num_pids < STATS_TOP_MAX_PIDS)) {
+        if (strncmp(entry->d_name, STATS_TOP_SHM_PREFIX,
+                    strlen(STATS_TOP_SHM_PREFIX))) {
+            continue;
+        }
+
+        /* Skip segments left by processes which were killed */
+        pid = atoi(entry->d_name + strlen(STATS_TOP_SHM_PREFIX));
+        if ((kill(pid, 0) == 0) || (errno != ESRCH)) {
+            opts->pids[opts->num_pids++] = pid;
+        }
+    }
+
+    closedir(dir);
+}
+
+static int proc_attach(stats_top_proc_t *proc, pid_t pid)
+{
+    ucs_status_t status;
+    int i;
+
+    status = ucs_stats_shm_attach(pid, &proc->shm);
+    if (status != UCS_OK) {
+        if (status == UCS_ERR_NO_ELEM) {
+            fprintf(stderr, "process %d does not export statistics\n", pid);
+        }
+        return -1;
+    }
+
+    proc->num_slots = proc->shm.hdr->num_slots;
+    for (i = 0; i < 2; ++i) {
+        proc->samples[i] = calloc(proc->num_slots, sizeof(*proc->samples[i]));
+        proc->valid[i]   = calloc(proc->num_slots, sizeof(*proc->valid[i]));
+        if ((proc->samples[i] == NULL) || (proc->valid[i] == NULL)) {
+            fprintf(stderr, "failed to allocate samples for process %d\n", pid);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static void proc_detach(stats_top_proc_t *proc)
+{
+    int i;
+
+    for (i = 0; i < 2; ++i) {
+        free(proc->samples[i]);
+        free(proc->valid[i]);
+    }
+
+    if (proc->shm.hdr != NULL) {
+        ucs_stats_shm_detach(&proc->shm);
+    }
+}
+
+static void proc_sample(stats_top_proc_t *proc, int cur)
+{
+    ucs_status_t status;
+    uint32_t index;
+    int retry;
+
+    proc->num_used = ucs_min(proc->shm.hdr->slots_hwm, proc->num_slots);
+    for (index = 0; index < proc->num_used; ++index) {
+        retry = 3;
+        do {
+            status = ucs_stats_shm_sample(&proc->shm, index,
+                                          &proc->samples[cur][index]);
+        } while ((status == UCS_ERR_BUSY) && (--retry > 0));
+
+        proc->valid[cur][index] = (status == UCS_OK);
+    }
+
+    memset(&proc->valid[cur][proc->num_used], 0,
+           proc->num_slots - proc->num_used);
+}
+
+static int show_class(const stats_top_opts_t *opts, const char *class_name)
+{
+    unsigned i;
+
+    if (opts->num_classes == 0) {
+        return 1;
+    }
+
+    for (i = 0; i < opts->num_classes; ++i) {
+        if (!strncmp(class_name, opts->classes[i], strlen(opts->classes[i]))) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void show_node(const stats_top_opts_t *opts, stats_top_proc_t *proc,
+                      int cur, uint32_t index, unsigned indent, double elapsed)
+{
+    const ucs_stats_shm_sample_t *sample = &proc->samples[cur][index];
+    const ucs_stats_shm_sample_t *prev   = &proc->samples[!cur][index];
+    const ucs_stats_shm_class_t *cls;
+    int has_prev, show;
+    uint64_t delta;
+    uint32_t child;
+    unsigned i;
+
+    cls      = ucs_stats_shm_class(&proc->shm, sample->class_index);
+    has_prev = proc->valid[!cur][index] &&
+               (prev->generation == sample->generation);
+    show     = show_class(opts, cls->name);
+
+    if (show) {
+        printf("%*s" UCS_STATS_NODE_FMT ":\n", indent * 2, "", cls->name,
+               sample->name);
+        for (i = 0; i < cls->num_counters; ++i) {
+            delta = has_prev ? (sample->counters[i] - prev->counters[i]) : 0;
+            if (!opts->all_counters && (delta == 0)) {
+                continue;
+            }
+
+            printf("%*s%-32s %20" PRIu64 " %14.1f/s\n", (indent + 1) * 2, "",
+                   cls->counter_names[i], sample->counters[i],
+                   delta / elapsed);
+        }
+    }
+
+    for (child = 0; child < proc->num_used; ++child) {
+        if (proc->valid[cur][child] &&
+            (proc->samples[cur][child].parent == (int32_t)index)) {
+            show_node(opts, proc, cur, child, indent + show, elapsed);
+        }
+    }
+}
+
+static void proc_show(const stats_top_opts_t *opts, stats_top_proc_t *proc,
+                      int cur, double elapsed)
+{
+    uint32_t index;
+
+    printf("pid %d on %s: %s\n", proc->shm.hdr->pid, proc->shm.hdr->hostname,
+           proc->shm.hdr->cmdline);
+
+    for (index = 0; index < proc->num_used; ++index) {
+        if (proc->valid[cur][index] &&
+            (proc->samples[cur][index].parent == UCS_STATS_SHM_PARENT_ROOT)) {
+            show_node(opts, proc, cur, index, 1, elapsed);
+        }
+    }
+
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    stats_top_proc_t procs[STATS_TOP_MAX_PIDS] = {};
+    double prev_time, now;
+    stats_top_opts_t opts;
+    unsigned i, num_procs;
+    long iter;
+    int cur;
+
+    if (parse_args(argc, argv, &opts) < 0) {
+        return -1;
+    }
+
+    if (opts.num_pids == 0) {
+        find_pids(&opts);
+    }
+
+    num_procs = 0;
+    for (i = 0; i < opts.num_pids; ++i) {
+        if (proc_attach(&procs[num_procs], opts.pids[i]) == 0) {
+            ++num_procs;
+        } else {
+            proc_detach(&procs[num_procs]);
+            memset(&procs[num_procs], 0, sizeof(procs[num_procs]));
+        }
+    }
+
+    if (num_procs == 0) {
+        fprintf(stderr, "no processes to monitor, make sure they run with "
+                "UCX_STATS_DEST=shm\n");
+        return -1;
+    }
+
+    /* First sample is only a baseline for the rates */
+    cur       = 0;
+    prev_time = ucs_get_accurate_time();
+    for (i = 0; i < num_procs; ++i) {
+        proc_sample(&procs[i], cur);
+    }
+
+    for (iter = 0; (opts.count < 0) || (iter < opts.count); ++iter) {
+        usleep((useconds_t)(opts.interval * UCS_USEC_PER_SEC));
+
+        cur = !cur;
+        now = ucs_get_accurate_time();
+        for (i = 0; i < num_procs; ++i) {
+            proc_sample(&procs[i], cur);
+        }
+
+        if (isatty(STDOUT_FILENO)) {
+            printf("\033[H\033[2J");
+        }
+
+        for (i = 0; i < num_procs; ++i) {
+            proc_show(&opts, &procs[i], cur, now - prev_time);
+        }
+
+        fflush(stdout);
+        prev_time = now;
+    }
+
+    for (i = 0; i < num_procs; ++i) {
+        proc_detach(&procs[i]);
+    }
+
+    return 0;
+}
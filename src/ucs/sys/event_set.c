@@ -15,6 +15,8 @@
 #include <ucs/debug/assert.h>
 #include <ucs/sys/math.h>
 #include <ucs/sys/compiler.h>
+#include <ucs/datastruct/khash.h>
+#include <ucs/datastruct/list.h>
 
 #include <string.h>
 #include <errno.h>
@@ -24,11 +26,28 @@
 
 enum {
     UCS_SYS_EVENT_SET_EXTERNAL_EVENT_FD = UCS_BIT(0),
+    UCS_SYS_EVENT_SET_EDGE_TRIGGERED    = UCS_BIT(1)
 };
 
+/* File descriptor state, used by an edge-triggered event set */
+typedef struct ucs_sys_event_set_fd {
+    ucs_list_link_t       list;          /* Element in ready list */
+    void                  *callback_data; /* User data passed to the handler */
+    int                   fd;            /* The file descriptor */
+    ucs_event_set_types_t events;        /* Events requested by the user */
+    ucs_event_set_types_t ready;         /* Events signaled by the kernel and
+                                            not cleared yet */
+    int                   queued;        /* Whether on the ready list */
+} ucs_sys_event_set_fd_t;
+
+KHASH_MAP_INIT_INT(ucs_sys_event_set_fd, ucs_sys_event_set_fd_t*);
+
 struct ucs_sys_event_set {
-    int      event_fd;
-    unsigned flags;
+    int                            event_fd;
+    unsigned                       flags;
+    khash_t(ucs_sys_event_set_fd)  fds;        /* fd -> fd state */
+    ucs_list_link_t                ready_list; /* FDs with requested events
+                                                  which are ready */
 };
 
 const unsigned ucs_sys_event_set_max_wait_events =
@@ -73,6 +92,59 @@ static inline int ucs_event_set_map_to_events(int raw_events)
     return events;
 }
 
+static inline ucs_event_set_types_t ucs_event_set_map_to_ready(int raw_events)
+{
+    ucs_event_set_types_t ready = 0;
+
+    if (raw_events & (EPOLLIN | EPOLLRDHUP)) {
+        ready |= UCS_EVENT_SET_EVREAD;
+    }
+    if (raw_events & EPOLLOUT) {
+        ready |= UCS_EVENT_SET_EVWRITE;
+    }
+    if (raw_events & (EPOLLERR | EPOLLHUP)) {
+        /* Let the next I/O operation in both directions report the error */
+        ready |= UCS_EVENT_SET_EVREAD | UCS_EVENT_SET_EVWRITE |
+                 UCS_EVENT_SET_EVERR;
+    }
+    return ready;
+}
+
+static inline int
+ucs_event_set_is_edge_triggered(const ucs_sys_event_set_t *event_set)
+{
+    return event_set->flags & UCS_SYS_EVENT_SET_EDGE_TRIGGERED;
+}
+
+static ucs_sys_event_set_fd_t *
+ucs_event_set_fd_find(ucs_sys_event_set_t *event_set, int fd)
+{
+    khiter_t iter;
+
+    iter = kh_get(ucs_sys_event_set_fd, &event_set->fds, fd);
+    if (iter == kh_end(&event_set->fds)) {
+        return NULL;
+    }
+
+    return kh_val(&event_set->fds, iter);
+}
+
+/* Add or remove the file descriptor to/from the ready list according to its
+ * requested and ready events */
+static void ucs_event_set_fd_update(ucs_sys_event_set_t *event_set,
+                                    ucs_sys_event_set_fd_t *fd_state)
+{
+    if (fd_state->ready & fd_state->events) {
+        if (!fd_state->queued) {
+            ucs_list_add_tail(&event_set->ready_list, &fd_state->list);
+            fd_state->queued = 1;
+        }
+    } else if (fd_state->queued) {
+        ucs_list_del(&fd_state->list);
+        fd_state->queued = 0;
+    }
+}
+
 static ucs_sys_event_set_t *ucs_event_set_alloc(int event_fd, unsigned flags)
 {
     ucs_sys_event_set_t *event_set;
@@ -83,8 +155,10 @@ static ucs_sys_event_set_t *ucs_event_set_alloc(int event_fd, unsigned flags)
         return NULL;
     }
 
-    event_set->flags    = flags;
-    event_set->event_fd = event_fd;
+    event_set->flags          = flags;
+    event_set->event_fd       = event_fd;
+    kh_init_inplace(ucs_sys_event_set_fd, &event_set->fds);
+    ucs_list_head_init(&event_set->ready_list);
     return event_set;
 }
 
@@ -101,6 +175,12 @@ ucs_status_t ucs_event_set_create_from_fd(ucs_sys_event_set_t **event_set_p,
 }
 
 ucs_status_t ucs_event_set_create(ucs_sys_event_set_t **event_set_p)
+{
+    return ucs_event_set_create_ext(event_set_p, 0);
+}
+
+ucs_status_t ucs_event_set_create_ext(ucs_sys_event_set_t **event_set_p,
+                                      unsigned flags)
 {
     ucs_status_t status;
     int event_fd;
@@ -112,7 +192,9 @@ ucs_status_t ucs_event_set_create(ucs_sys_event_set_t **event_set_p)
         return UCS_ERR_IO_ERROR;
     }
 
-    *event_set_p = ucs_event_set_alloc(event_fd, 0);
+    *event_set_p = ucs_event_set_alloc(
+            event_fd, (flags & UCS_EVENT_SET_FLAG_EDGE_TRIGGERED) ?
+                              UCS_SYS_EVENT_SET_EDGE_TRIGGERED : 0);
     if (*event_set_p == NULL) {
         status = UCS_ERR_NO_MEMORY;
         goto err_close_event_fd;
@@ -125,6 +207,65 @@ err_close_event_fd:
     return status;
 }
 
+static ucs_status_t
+ucs_event_set_add_edge_triggered(ucs_sys_event_set_t *event_set, int fd,
+                                 ucs_event_set_types_t events,
+                                 void *callback_data)
+{
+    ucs_sys_event_set_fd_t *fd_state;
+    struct epoll_event raw_event;
+    ucs_status_t status;
+    khiter_t iter;
+    int ret;
+
+    fd_state = ucs_malloc(sizeof(*fd_state), "ucs_sys_event_set_fd");
+    if (fd_state == NULL) {
+        ucs_error("failed to allocate event set state for fd=%d", fd);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    fd_state->callback_data = callback_data;
+    fd_state->fd            = fd;
+    fd_state->events        = events & ~UCS_EVENT_SET_EDGE_TRIGGERED;
+    fd_state->ready         = 0;
+    fd_state->queued        = 0;
+
+    iter = kh_put(ucs_sys_event_set_fd, &event_set->fds, fd, &ret);
+    if (ret == UCS_KH_PUT_FAILED) {
+        ucs_error("failed to add fd=%d to event set hash", fd);
+        status = UCS_ERR_NO_MEMORY;
+        goto err_free;
+    } else if (ret == UCS_KH_PUT_KEY_PRESENT) {
+        ucs_error("fd=%d was already added to event set %p", fd, event_set);
+        status = UCS_ERR_ALREADY_EXISTS;
+        goto err_free;
+    }
+
+    kh_val(&event_set->fds, iter) = fd_state;
+
+    /* Subscribe to all events once, so that changing the requested events
+     * later does not require a system call */
+    memset(&raw_event, 0, sizeof(raw_event));
+    raw_event.events   = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    raw_event.data.ptr = fd_state;
+
+    ret = epoll_ctl(event_set->event_fd, EPOLL_CTL_ADD, fd, &raw_event);
+    if (ret < 0) {
+        ucs_error("epoll_ctl(event_fd=%d, ADD, fd=%d) failed: %m",
+                  event_set->event_fd, fd);
+        status = UCS_ERR_IO_ERROR;
+        goto err_hash_del;
+    }
+
+    return UCS_OK;
+
+err_hash_del:
+    kh_del(ucs_sys_event_set_fd, &event_set->fds, iter);
+err_free:
+    ucs_free(fd_state);
+    return status;
+}
+
 ucs_status_t ucs_event_set_add(ucs_sys_event_set_t *event_set, int fd,
                                ucs_event_set_types_t events,
                                void *callback_data)
@@ -132,6 +273,11 @@ ucs_status_t ucs_event_set_add(ucs_sys_event_set_t *event_set, int fd,
     struct epoll_event raw_event;
     int ret;
 
+    if (ucs_event_set_is_edge_triggered(event_set)) {
+        return ucs_event_set_add_edge_triggered(event_set, fd, events,
+                                                callback_data);
+    }
+
     memset(&raw_event, 0, sizeof(raw_event));
     raw_event.events   = ucs_event_set_map_to_raw_events(events);
     raw_event.data.ptr = callback_data;
@@ -150,9 +296,24 @@ ucs_status_t ucs_event_set_mod(ucs_sys_event_set_t *event_set, int fd,
                                ucs_event_set_types_t events,
                                void *callback_data)
 {
+    ucs_sys_event_set_fd_t *fd_state;
     struct epoll_event raw_event;
     int ret;
 
+    if (ucs_event_set_is_edge_triggered(event_set)) {
+        fd_state = ucs_event_set_fd_find(event_set, fd);
+        if (fd_state == NULL) {
+            ucs_error("fd=%d was not added to event set %p", fd, event_set);
+            return UCS_ERR_NO_ELEM;
+        }
+
+        /* The kernel is already subscribed to all events of the fd */
+        fd_state->callback_data = callback_data;
+        fd_state->events        = events & ~UCS_EVENT_SET_EDGE_TRIGGERED;
+        ucs_event_set_fd_update(event_set, fd_state);
+        return UCS_OK;
+    }
+
     memset(&raw_event, 0, sizeof(raw_event));
     raw_event.events   = ucs_event_set_map_to_raw_events(events);
     raw_event.data.ptr = callback_data;
@@ -169,8 +330,24 @@ ucs_status_t ucs_event_set_mod(ucs_sys_event_set_t *event_set, int fd,
 
 ucs_status_t ucs_event_set_del(ucs_sys_event_set_t *event_set, int fd)
 {
+    ucs_sys_event_set_fd_t *fd_state;
+    khiter_t iter;
     int ret;
 
+    if (ucs_event_set_is_edge_triggered(event_set)) {
+        /* Release the fd state even if the kernel fails to remove the fd
+         * (e.g. it was already closed), since the user will not delete it
+         * again */
+        iter = kh_get(ucs_sys_event_set_fd, &event_set->fds, fd);
+        ucs_assertv(iter != kh_end(&event_set->fds), "fd=%d", fd);
+        fd_state = kh_val(&event_set->fds, iter);
+        kh_del(ucs_sys_event_set_fd, &event_set->fds, iter);
+        if (fd_state->queued) {
+            ucs_list_del(&fd_state->list);
+        }
+        ucs_free(fd_state);
+    }
+
     ret = epoll_ctl(event_set->event_fd, EPOLL_CTL_DEL, fd, NULL);
     if (ret < 0) {
         ucs_error("epoll_ctl(event_fd=%d, DEL, fd=%d) failed: %m",
@@ -181,6 +358,93 @@ ucs_status_t ucs_event_set_del(ucs_sys_event_set_t *event_set, int fd)
     return UCS_OK;
 }
 
+int ucs_event_set_has_ready(const ucs_sys_event_set_t *event_set)
+{
+    return ucs_event_set_is_edge_triggered(event_set) &&
+           !ucs_list_is_empty(&event_set->ready_list);
+}
+
+void ucs_event_set_clear_ready(ucs_sys_event_set_t *event_set, int fd,
+                               ucs_event_set_types_t events)
+{
+    ucs_sys_event_set_fd_t *fd_state;
+
+    if (!ucs_event_set_is_edge_triggered(event_set)) {
+        return;
+    }
+
+    fd_state = ucs_event_set_fd_find(event_set, fd);
+    if (fd_state == NULL) {
+        return;
+    }
+
+    fd_state->ready &= ~events;
+    ucs_event_set_fd_update(event_set, fd_state);
+}
+
+static ucs_status_t
+ucs_event_set_wait_edge_triggered(ucs_sys_event_set_t *event_set,
+                                  unsigned *num_events, int timeout_ms,
+                                  ucs_event_set_handler_t event_set_handler,
+                                  void *arg)
+{
+    ucs_list_link_t dispatched_list;
+    ucs_sys_event_set_fd_t *fd_state;
+    struct epoll_event *events;
+    ucs_event_set_types_t io_events;
+    unsigned count;
+    int nready, i;
+
+    events = ucs_alloca(sizeof(*events) * *num_events);
+
+    /* Do not block if there are file descriptors which are still ready */
+    if (!ucs_list_is_empty(&event_set->ready_list)) {
+        timeout_ms = 0;
+    }
+
+    nready = epoll_wait(event_set->event_fd, events, *num_events, timeout_ms);
+    if (ucs_unlikely(nready < 0)) {
+        if (errno != EINTR) {
+            *num_events = 0;
+            ucs_error("epoll_wait() failed: %m");
+            return UCS_ERR_IO_ERROR;
+        }
+        nready = 0;
+    }
+
+    ucs_trace_poll("epoll_wait(event_fd=%d, num_events=%u, timeout=%d) "
+                   "returned %d",
+                   event_set->event_fd, *num_events, timeout_ms, nready);
+
+    /* Accumulate the new edges before calling any handler, since a handler
+     * could delete a file descriptor reported by this epoll_wait() */
+    for (i = 0; i < nready; i++) {
+        fd_state         = events[i].data.ptr;
+        fd_state->ready |= ucs_event_set_map_to_ready(events[i].events);
+        ucs_event_set_fd_update(event_set, fd_state);
+    }
+
+    /* Every dispatched file descriptor is moved to a local list, so it is
+     * dispatched at most once per call. If the handler does not clear its
+     * readiness, it goes to the tail of the ready list for the next call. */
+    ucs_list_head_init(&dispatched_list);
+    for (count = 0; (count < *num_events) &&
+                    !ucs_list_is_empty(&event_set->ready_list);
+         ++count) {
+        fd_state = ucs_list_head(&event_set->ready_list,
+                                 ucs_sys_event_set_fd_t, list);
+        ucs_list_del(&fd_state->list);
+        ucs_list_add_tail(&dispatched_list, &fd_state->list);
+
+        io_events = fd_state->ready & fd_state->events;
+        event_set_handler(fd_state->callback_data, io_events, arg);
+    }
+    ucs_list_splice_tail(&event_set->ready_list, &dispatched_list);
+
+    *num_events = count;
+    return UCS_OK;
+}
+
 ucs_status_t ucs_event_set_wait(ucs_sys_event_set_t *event_set,
                                 unsigned *num_events, int timeout_ms,
                                 ucs_event_set_handler_t event_set_handler,
@@ -193,6 +457,12 @@ ucs_status_t ucs_event_set_wait(ucs_sys_event_set_t *event_set,
     ucs_assert(num_events != NULL);
     ucs_assert(*num_events <= ucs_sys_event_set_max_wait_events);
 
+    if (ucs_event_set_is_edge_triggered(event_set)) {
+        return ucs_event_set_wait_edge_triggered(event_set, num_events,
+                                                 timeout_ms, event_set_handler,
+                                                 arg);
+    }
+
     events = ucs_alloca(sizeof(*events) * *num_events);
 
     nready = epoll_wait(event_set->event_fd, events, *num_events, timeout_ms);
@@ -221,6 +491,13 @@ ucs_status_t ucs_event_set_wait(ucs_sys_event_set_t *event_set,
 
 void ucs_event_set_cleanup(ucs_sys_event_set_t *event_set)
 {
+    ucs_sys_event_set_fd_t *fd_state;
+
+    kh_foreach_value(&event_set->fds, fd_state, {
+        ucs_free(fd_state);
+    });
+    kh_destroy_inplace(ucs_sys_event_set_fd, &event_set->fds);
+
     if (!(event_set->flags & UCS_SYS_EVENT_SET_EXTERNAL_EVENT_FD)) {
         close(event_set->event_fd);
     }
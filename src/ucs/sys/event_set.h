@@ -46,6 +46,18 @@ typedef enum {
     UCS_EVENT_SET_EDGE_TRIGGERED = UCS_BIT(3)
 } ucs_event_set_type_t;
 
+/**
+ * Event set creation flags
+ */
+typedef enum {
+    /* Register every file descriptor once in edge-triggered mode for all event
+     * types, and track the readiness and the requested events of each file
+     * descriptor in user space. Modifying the requested events does not call
+     * the kernel, and an event stays ready until it is cleared by
+     * @ref ucs_event_set_clear_ready. */
+    UCS_EVENT_SET_FLAG_EDGE_TRIGGERED = UCS_BIT(0)
+} ucs_event_set_flags_t;
+
 /* The maximum possible number of events based on system constraints */
 extern const unsigned ucs_sys_event_set_max_wait_events;
 
@@ -70,6 +82,17 @@ ucs_status_t ucs_event_set_create_from_fd(ucs_sys_event_set_t **event_set_p,
  */
 ucs_status_t ucs_event_set_create(ucs_sys_event_set_t **event_set_p);
 
+/**
+ * Allocate ucs_sys_event_set_t structure with extended flags.
+ *
+ * @param [out] event_set_p  Event set pointer to initialize.
+ * @param [in]  flags        Creation flags, see @ref ucs_event_set_flags_t.
+ *
+ * @return UCS_OK on success or an error code on failure.
+ */
+ucs_status_t ucs_event_set_create_ext(ucs_sys_event_set_t **event_set_p,
+                                      unsigned flags);
+
 /**
  * Register the target event.
  *
@@ -108,6 +131,36 @@ ucs_status_t ucs_event_set_mod(ucs_sys_event_set_t *event_set, int fd,
  */
 ucs_status_t ucs_event_set_del(ucs_sys_event_set_t *event_set, int fd);
 
+/**
+ * Clear the readiness of the target events, after the file descriptor was
+ * drained (a read or a write operation returned less than requested). The
+ * events will be reported again only after the kernel signals a new edge.
+ * Has no effect if the event set was not created with
+ * @ref UCS_EVENT_SET_FLAG_EDGE_TRIGGERED.
+ *
+ * @param [in] event_set    Event set created by ucs_event_set_create.
+ * @param [in] fd           The target file descriptor fd.
+ * @param [in] events       Events which are not ready anymore.
+ */
+void ucs_event_set_clear_ready(ucs_sys_event_set_t *event_set, int fd,
+                               ucs_event_set_types_t events);
+
+/**
+ * Check whether an edge-triggered event set has file descriptors which are
+ * ready for one of their requested events. Such file descriptors are reported
+ * by the next @ref ucs_event_set_wait, but since the kernel already delivered
+ * their edges, the event set file descriptor is not signaled for them. So the
+ * caller must not block on the event set file descriptor while this function
+ * returns nonzero.
+ * Always returns 0 if the event set was not created with
+ * @ref UCS_EVENT_SET_FLAG_EDGE_TRIGGERED.
+ *
+ * @param [in] event_set    Event set created by ucs_event_set_create.
+ *
+ * @return Nonzero if there are ready file descriptors, 0 otherwise.
+ */
+int ucs_event_set_has_ready(const ucs_sys_event_set_t *event_set);
+
 /**
  * Wait for an I/O events
  *
@@ -455,7 +455,8 @@ ucs_status_t ucs_socket_set_buffer_size(int fd, size_t sockopt_sndbuf,
 
 ucs_status_t ucs_socket_server_init(const struct sockaddr *saddr, socklen_t socklen,
                                     int backlog, int silent_err_in_use,
-                                    int reuse_addr, int *listen_fd)
+                                    int reuse_addr, int reuse_port,
+                                    int *listen_fd)
 {
     int so_reuse_optval = 1;
     char ip_port_str[UCS_SOCKADDR_STRING_LEN];
@@ -484,6 +485,14 @@ ucs_status_t ucs_socket_server_init(const struct sockaddr *saddr, socklen_t sock
         }
     }
 
+    if (reuse_port) {
+        status = ucs_socket_setopt(fd, SOL_SOCKET, SO_REUSEPORT,
+                                   &so_reuse_optval, sizeof(so_reuse_optval));
+        if (status != UCS_OK) {
+            goto err_close_socket;
+        }
+    }
+
     ret = bind(fd, saddr, socklen);
     if (ret < 0) {
         if ((errno == EADDRINUSE) && silent_err_in_use) {
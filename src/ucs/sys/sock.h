@@ -236,13 +236,17 @@ ucs_status_t ucs_socket_set_buffer_size(int fd, size_t sockopt_sndbuf,
  * @param [in]  reuse_addr        Whether or not to allow the socket to use an
  *                                address that is already in use and was not
  *                                released by another socket yet.
+ * @param [in]  reuse_port        Whether or not to allow other sockets, which
+ *                                also set this option, to listen on the same
+ *                                address. The kernel distributes incoming
+ *                                connections between such sockets.
  * @param [out] listen_fd         The fd that belongs to the server.
  *
  * @return UCS_OK on success or an error code on failure.
  */
 ucs_status_t ucs_socket_server_init(const struct sockaddr *saddr, socklen_t socklen,
                                     int backlog, int silent_bind, int reuse_addr,
-                                    int *listen_fd);
+                                    int reuse_port, int *listen_fd);
 
 
 /**
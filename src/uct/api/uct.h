@@ -683,7 +683,10 @@ enum uct_iface_params_field {
     UCT_IFACE_PARAM_FIELD_AM_ALIGN_OFFSET    = UCS_BIT(17),
 
     /** Enables @ref uct_iface_params_t::features */
-    UCT_IFACE_PARAM_FIELD_FEATURES           = UCS_BIT(18)
+    UCT_IFACE_PARAM_FIELD_FEATURES           = UCS_BIT(18),
+
+    /** Enables @ref uct_iface_params_t::numa_node */
+    UCT_IFACE_PARAM_FIELD_NUMA_NODE          = UCS_BIT(19)
 };
 
 /**
@@ -916,7 +919,25 @@ enum uct_listener_params_field {
     UCT_LISTENER_PARAM_FIELD_CONN_REQUEST_CB = UCS_BIT(1),
 
     /** Enables @ref uct_listener_params::user_data */
-    UCT_LISTENER_PARAM_FIELD_USER_DATA       = UCS_BIT(2)
+    UCT_LISTENER_PARAM_FIELD_USER_DATA       = UCS_BIT(2),
+
+    /** Enables @ref uct_listener_params::flags */
+    UCT_LISTENER_PARAM_FIELD_FLAGS           = UCS_BIT(3)
+};
+
+
+/**
+ * @ingroup UCT_CLIENT_SERVER
+ * @brief UCT listener flags, passed in @ref uct_listener_params::flags.
+ */
+enum uct_listener_flags {
+    /**
+     * Allow several listeners to listen on the same address, if all of them
+     * are created with this flag. The operating system distributes incoming
+     * connection requests between these listeners. A CM which does not
+     * support it returns UCS_ERR_UNSUPPORTED from @ref uct_listener_create.
+     */
+    UCT_LISTENER_FLAG_REUSE_PORT = UCS_BIT(0)
 };
 
 
@@ -1289,6 +1310,13 @@ struct uct_iface_params {
      * initialization.
      */
     uint64_t                                     features;
+
+    /**
+     * NUMA node to allocate the interface memory pools on, if possible. By
+     * default, or if set to UCS_NUMA_NODE_UNDEFINED, the memory is allocated
+     * according to the memory policy of the calling thread.
+     */
+    ucs_numa_node_t                              numa_node;
 };
 
 
@@ -1523,6 +1551,11 @@ struct uct_listener_params {
      * User data associated with the listener.
      */
     void                                    *user_data;
+
+    /**
+     * Listener flags, using bits from @ref uct_listener_flags.
+     */
+    uint64_t                                flags;
 };
 
 
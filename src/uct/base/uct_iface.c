@@ -667,6 +667,9 @@ UCS_CLASS_INIT_FUNC(uct_base_iface_t, uct_iface_ops_t *ops,
     self->err_handler_arg   = UCT_IFACE_PARAM_VALUE(params, err_handler_arg,
                                                     ERR_HANDLER_ARG, NULL);
     self->progress_flags    = 0;
+    self->numa_node         = UCT_IFACE_PARAM_VALUE(params, numa_node,
+                                                    NUMA_NODE,
+                                                    UCS_NUMA_NODE_UNDEFINED);
 
     uct_worker_progress_init(&self->prog);
 
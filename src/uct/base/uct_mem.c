@@ -536,6 +536,7 @@ ucs_status_t uct_iface_mpool_init(uct_base_iface_t *iface, ucs_mpool_t *mp,
     mp_params.alignment       = alignment;
     mp_params.ops             = &uct_iface_mpool_ops;
     mp_params.name            = name;
+    mp_params.numa_node       = iface->numa_node;
     /* Create memory pool of bounce buffers */
     status = ucs_mpool_init(&mp_params, mp);
     if (status != UCS_OK) {
@@ -60,11 +60,12 @@ static UCS_CLASS_INIT_FUNC(uct_priv_worker_t, ucs_async_context_t *async,
     self->async       = async;
     self->thread_mode = thread_mode;
     ucs_list_head_init(&self->tl_data);
-    return UCS_OK;
+    return ucs_recursive_spinlock_init(&self->tl_data_lock, 0);
 }
 
 static UCS_CLASS_CLEANUP_FUNC(uct_priv_worker_t)
 {
+    ucs_recursive_spinlock_destroy(&self->tl_data_lock);
 }
 
 UCS_CLASS_DEFINE(uct_priv_worker_t, uct_worker_t);
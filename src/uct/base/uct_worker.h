@@ -10,6 +10,7 @@
 #include <uct/api/uct.h>
 #include <ucs/datastruct/callbackq.h>
 #include <ucs/datastruct/list.h>
+#include <ucs/type/spinlock.h>
 
 
 /**
@@ -19,6 +20,7 @@ typedef struct uct_worker_tl_data {
     ucs_list_link_t        list;
     uint32_t               refcount;
     uint32_t               key;
+    struct uct_priv_worker *worker;
 } uct_worker_tl_data_t;
 
 
@@ -27,6 +29,8 @@ typedef struct uct_priv_worker {
     ucs_async_context_t    *async;
     ucs_thread_mode_t      thread_mode;
     ucs_list_link_t        tl_data;
+    /* Protects tl_data, since interfaces may be opened by several threads */
+    ucs_recursive_spinlock_t tl_data_lock;
 } uct_priv_worker_t;
 
 
@@ -42,6 +46,7 @@ typedef struct uct_worker_progress {
         _type *result; \
         ucs_status_t _status; \
         \
+        ucs_recursive_spin_lock(&(_worker)->tl_data_lock); \
         ucs_list_for_each(data, &(_worker)->tl_data, list) { \
             if ((data->key == (_key)) && _cmp_fn(ucs_derived_of(data, _type), \
                                                  ## __VA_ARGS__)) \
@@ -59,6 +64,7 @@ typedef struct uct_worker_progress {
                 data = (uct_worker_tl_data_t*)result;\
                 data->key      = (_key); \
                 data->refcount = 1; \
+                data->worker   = (_worker); \
                 _status = _init_fn(ucs_derived_of(data, _type), ## __VA_ARGS__); \
                 if (_status != UCS_OK) { \
                     ucs_free(result); \
@@ -70,6 +76,7 @@ typedef struct uct_worker_progress {
         } else { \
             result = ucs_derived_of(data, _type); \
         } \
+        ucs_recursive_spin_unlock(&(_worker)->tl_data_lock); \
         result; \
     })
 
@@ -77,8 +84,15 @@ typedef struct uct_worker_progress {
 #define uct_worker_tl_data_put(_data, _cleanup_fn, ...) \
     { \
         uct_worker_tl_data_t *data = (uct_worker_tl_data_t*)(_data); \
-        if (--data->refcount == 0) { \
+        int _release; \
+        \
+        ucs_recursive_spin_lock(&data->worker->tl_data_lock); \
+        _release = (--data->refcount == 0); \
+        if (_release) { \
             ucs_list_del(&data->list); \
+        } \
+        ucs_recursive_spin_unlock(&data->worker->tl_data_lock); \
+        if (_release) { \
             _cleanup_fn((_data), ## __VA_ARGS__); \
             ucs_free(data); \
         } \
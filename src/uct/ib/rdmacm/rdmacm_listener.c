@@ -49,6 +49,12 @@ UCS_CLASS_INIT_FUNC(uct_rdmacm_listener_t, uct_cm_h cm,
     self->user_data       = (params->field_mask & UCT_LISTENER_PARAM_FIELD_USER_DATA) ?
                             params->user_data : NULL;
 
+    if ((params->field_mask & UCT_LISTENER_PARAM_FIELD_FLAGS) &&
+        (params->flags & UCT_LISTENER_FLAG_REUSE_PORT)) {
+        ucs_debug("rdmacm listener does not support sharing the address");
+        return UCS_ERR_UNSUPPORTED;
+    }
+
     if (rdma_create_id(rdmacm_cm->ev_ch, &self->id, self, RDMA_PS_TCP)) {
         ucs_error("rdma_create_id() failed: %m");
         status = UCS_ERR_IO_ERROR;
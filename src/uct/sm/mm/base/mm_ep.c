@@ -15,6 +15,7 @@
 
 #include <uct/base/uct_iov.inl>
 #include <ucs/arch/atomic.h>
+#include <ucs/profile/probe.h>
 
 
 /* send modes */
@@ -196,6 +197,16 @@ static UCS_CLASS_INIT_FUNC(uct_mm_ep_t, const uct_ep_params_t *params)
     self->cached_tail = self->fifo_ctl->tail;
     ucs_arbiter_elem_init(&self->arb_elem);
 
+    /* Let a lazy receiver know that it should allocate its receive
+     * descriptors, and wake it up if it is waiting for events. The atomic
+     * operation orders the flag update before reading the head. */
+    if (!self->fifo_ctl->connected &&
+        (ucs_atomic_cswap32(ucs_unaligned_ptr(&self->fifo_ctl->connected), 0,
+                            1) == 0) &&
+        (self->fifo_ctl->head & UCT_MM_IFACE_FIFO_HEAD_EVENT_ARMED)) {
+        uct_mm_ep_signal_remote(self);
+    }
+
     status = uct_ep_keepalive_init(&self->keepalive, self->fifo_ctl->pid);
     if (status != UCS_OK) {
         goto err_free_segs;
@@ -284,6 +295,7 @@ static UCS_F_ALWAYS_INLINE ssize_t uct_mm_ep_am_common_send(
     ucs_status_t status;
     void *base_address;
     uint8_t elem_flags;
+    uint16_t elem_length;
     uint64_t head;
     ucs_iov_iter_t iov_iter;
     void *desc_data;
@@ -325,10 +337,11 @@ retry:
                                UCS_ARCH_MEMCPY_NT_DEST);
 
         elem_flags   = UCT_MM_FIFO_ELEM_FLAG_INLINE;
-        elem->length = length + sizeof(header);
+        elem_length  = length + sizeof(header);
+        elem->length = elem_length;
 
         uct_mm_iface_trace_am(iface, UCT_AM_TRACE_TYPE_SEND, elem_flags, am_id,
-                              elem + 1, elem->length,
+                              elem + 1, elem_length,
                               head & ~UCT_MM_IFACE_FIFO_HEAD_EVENT_ARMED);
         UCT_TL_EP_STAT_OP(&ep->super, AM, SHORT, sizeof(header) + length);
         break;
@@ -344,23 +357,25 @@ retry:
         desc_data    = UCS_PTR_BYTE_OFFSET(base_address, elem->desc.offset);
         length       = pack_cb(desc_data, arg);
         elem_flags   = 0;
-        elem->length = length;
+        elem_length  = length;
+        elem->length = elem_length;
 
         uct_mm_iface_trace_am(iface, UCT_AM_TRACE_TYPE_SEND, elem_flags, am_id,
-                              desc_data, elem->length,
+                              desc_data, elem_length,
                               head & ~UCT_MM_IFACE_FIFO_HEAD_EVENT_ARMED);
         UCT_TL_EP_STAT_OP(&ep->super, AM, BCOPY, length);
         break;
     case UCT_MM_SEND_AM_SHORT_IOV:
         elem_flags   = UCT_MM_FIFO_ELEM_FLAG_INLINE;
         ucs_iov_iter_init(&iov_iter);
-        elem->length = uct_iov_to_buffer(iov, iovcnt, &iov_iter, elem + 1,
+        elem_length  = uct_iov_to_buffer(iov, iovcnt, &iov_iter, elem + 1,
                                          SIZE_MAX);
+        elem->length = elem_length;
 
         uct_mm_iface_trace_am(iface, UCT_AM_TRACE_TYPE_SEND, elem_flags, am_id,
-                              elem + 1, elem->length,
+                              elem + 1, elem_length,
                               head & ~UCT_MM_IFACE_FIFO_HEAD_EVENT_ARMED);
-        UCT_TL_EP_STAT_OP(&ep->super, AM, SHORT, elem->length);
+        UCT_TL_EP_STAT_OP(&ep->super, AM, SHORT, elem_length);
         break;
     }
 
@@ -377,6 +392,9 @@ retry:
     }
     elem->flags = elem_flags;
 
+    UCS_PROBE(mm_fifo_push, ep, head & ~UCT_MM_IFACE_FIFO_HEAD_EVENT_ARMED,
+              am_id, elem_length);
+
     if (ucs_unlikely(head & UCT_MM_IFACE_FIFO_HEAD_EVENT_ARMED)) {
         uct_mm_ep_signal_remote(ep);
     }
@@ -17,7 +17,10 @@
 #include <ucs/arch/atomic.h>
 #include <ucs/arch/bitops.h>
 #include <ucs/async/async.h>
+#include <ucs/profile/probe.h>
 #include <ucs/sys/string.h>
+#include <ucs/vfs/base/vfs_cb.h>
+#include <ucs/vfs/base/vfs_obj.h>
 #include <sys/poll.h>
 
 
@@ -67,6 +70,13 @@ ucs_config_field_t uct_mm_iface_config_table[] = {
     {"ERROR_HANDLING", "n", "Expose error handling support capability",
      ucs_offsetof(uct_mm_iface_config_t, error_handling), UCS_CONFIG_TYPE_BOOL},
 
+    {"LAZY_RX", "n",
+     "Allocate the receive descriptors only when the first peer connects to the\n"
+     "interface. The receive FIFO is still created when the interface is opened,\n"
+     "so the interface address is available right away, but interfaces which\n"
+     "are never used do not consume shared memory for receive buffers.",
+     ucs_offsetof(uct_mm_iface_config_t, lazy_rx), UCS_CONFIG_TYPE_BOOL},
+
     {"SEND_OVERHEAD", UCS_PP_MAKE_STRING(UCT_MM_IFACE_OVERHEAD),
      "Time spent after the message request has been passed to the hardware or\n"
      "system software layers and before operation has been finalized", 0,
@@ -295,6 +305,71 @@ uct_mm_assign_desc_to_fifo_elem(uct_mm_iface_t *iface,
     return UCS_OK;
 }
 
+static void uct_mm_iface_free_rx_descs(uct_mm_iface_t *iface, unsigned num_elems)
+{
+    uct_mm_fifo_element_t *elem;
+    uct_mm_recv_desc_t *desc;
+    unsigned i;
+
+    for (i = 0; i < num_elems; i++) {
+        elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, iface->recv_fifo_elems, i);
+        desc = (uct_mm_recv_desc_t*)UCS_PTR_BYTE_OFFSET(elem->desc_data,
+                                                        -iface->rx_headroom) - 1;
+        ucs_mpool_put(desc);
+    }
+}
+
+static ucs_status_t uct_mm_iface_rx_init(uct_mm_iface_t *iface)
+{
+    uct_mm_fifo_element_t *fifo_elem_p;
+    ucs_status_t status;
+    unsigned i;
+
+    /* set the first receive descriptor */
+    iface->last_recv_desc = ucs_mpool_get(&iface->recv_desc_mp);
+    VALGRIND_MAKE_MEM_DEFINED(iface->last_recv_desc,
+                              sizeof(*(iface->last_recv_desc)));
+    if (iface->last_recv_desc == NULL) {
+        ucs_error("failed to get the first receive descriptor");
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    /* assign a receive descriptor per every FIFO element */
+    for (i = 0; i < iface->config.fifo_size; i++) {
+        fifo_elem_p = UCT_MM_IFACE_GET_FIFO_ELEM(iface, iface->recv_fifo_elems,
+                                                 i);
+        status      = uct_mm_assign_desc_to_fifo_elem(iface, fifo_elem_p, 1);
+        if (status != UCS_OK) {
+            ucs_error("failed to allocate a descriptor for MM");
+            uct_mm_iface_free_rx_descs(iface, i);
+            ucs_mpool_put(iface->last_recv_desc);
+            return status;
+        }
+    }
+
+    return UCS_OK;
+}
+
+static void uct_mm_iface_rx_lazy_progress(uct_mm_iface_t *iface)
+{
+    if (!iface->recv_fifo_ctl->connected) {
+        return;
+    }
+
+    if (uct_mm_iface_rx_init(iface) != UCS_OK) {
+        /* try again on the next progress */
+        return;
+    }
+
+    /* make sure the descriptors are visible before letting senders use the
+     * FIFO elements */
+    ucs_memory_cpu_store_fence();
+    iface->recv_fifo_ctl->tail = iface->read_index;
+    iface->rx_lazy             = 0;
+    ucs_debug("mm iface %p: allocated receive descriptors page size %zu",
+              iface, iface->rx_desc_page_size);
+}
+
 static UCS_F_ALWAYS_INLINE void uct_mm_iface_process_recv(uct_mm_iface_t *iface)
 {
     uct_mm_fifo_element_t *elem = iface->read_index_elem;
@@ -354,6 +429,9 @@ uct_mm_iface_poll_fifo(uct_mm_iface_t *iface)
     ucs_assert(iface->read_index <=
                (iface->recv_fifo_ctl->head & ~UCT_MM_IFACE_FIFO_HEAD_EVENT_ARMED));
 
+    UCS_PROBE(mm_fifo_poll, iface, iface->read_index,
+              iface->read_index_elem->am_id, iface->read_index_elem->length);
+
     uct_mm_iface_process_recv(iface);
 
     /* raise the read_index */
@@ -405,6 +483,10 @@ static unsigned uct_mm_iface_progress(uct_iface_h tl_iface)
 
     ucs_assert(iface->fifo_poll_count >= UCT_MM_IFACE_FIFO_MIN_POLL);
 
+    if (ucs_unlikely(iface->rx_lazy)) {
+        uct_mm_iface_rx_lazy_progress(iface);
+    }
+
     /* progress receive */
     do {
         count = uct_mm_iface_poll_fifo(iface);
@@ -474,6 +556,12 @@ uct_mm_iface_event_fd_arm(uct_iface_h tl_iface, unsigned events)
         }
     }
 
+    if (ucs_unlikely(iface->rx_lazy) && iface->recv_fifo_ctl->connected) {
+        /* a peer is waiting for the receive descriptors to be allocated */
+        ucs_trace("iface %p: cannot arm, peer connected", iface);
+        return UCS_ERR_BUSY;
+    }
+
     /* check for pending events */
     ret = recvfrom(iface->signal_fd, &dummy, sizeof(dummy), 0, NULL, 0);
     if (ret > 0) {
@@ -597,9 +685,24 @@ uct_mm_estimate_perf(uct_iface_h tl_iface, uct_perf_attr_t *perf_attr)
     return UCS_OK;
 }
 
+static void uct_mm_iface_vfs_refresh(uct_iface_h tl_iface)
+{
+    uct_mm_iface_t *iface = ucs_derived_of(tl_iface, uct_mm_iface_t);
+    uct_mm_seg_t *seg     = iface->recv_fifo_mem.memh;
+
+    ucs_vfs_obj_add_ro_file(iface, ucs_vfs_show_memunits, &seg->page_size, 0,
+                            "fifo_page_size");
+
+    if (iface->rx_desc_page_size != 0) {
+        ucs_vfs_obj_add_ro_file(iface, ucs_vfs_show_memunits,
+                                &iface->rx_desc_page_size, 0,
+                                "rx_desc_page_size");
+    }
+}
+
 static uct_iface_internal_ops_t uct_mm_iface_internal_ops = {
     .iface_estimate_perf   = uct_mm_estimate_perf,
-    .iface_vfs_refresh     = (uct_iface_vfs_refresh_func_t)ucs_empty_function,
+    .iface_vfs_refresh     = uct_mm_iface_vfs_refresh,
     .ep_query              = (uct_ep_query_func_t)ucs_empty_function,
     .ep_invalidate         = (uct_ep_invalidate_func_t)ucs_empty_function_return_unsupported,
     .ep_connect_to_ep_v2   = ucs_empty_function_return_unsupported,
@@ -626,25 +729,16 @@ static void uct_mm_iface_recv_desc_init(uct_iface_h tl_iface, void *obj,
     offset = UCS_PTR_BYTE_DIFF(seg->address, desc + 1) + iface->rx_headroom;
     ucs_assert(offset <= UINT_MAX);
 
+    if ((iface->rx_desc_page_size == 0) ||
+        (seg->page_size < iface->rx_desc_page_size)) {
+        iface->rx_desc_page_size = seg->page_size;
+    }
+
     desc->info.seg_id   = seg->seg_id;
     desc->info.seg_size = seg->length;
     desc->info.offset   = offset;
 }
 
-static void uct_mm_iface_free_rx_descs(uct_mm_iface_t *iface, unsigned num_elems)
-{
-    uct_mm_fifo_element_t *elem;
-    uct_mm_recv_desc_t *desc;
-    unsigned i;
-
-    for (i = 0; i < num_elems; i++) {
-        elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, iface->recv_fifo_elems, i);
-        desc = (uct_mm_recv_desc_t*)UCS_PTR_BYTE_OFFSET(elem->desc_data,
-                                                        -iface->rx_headroom) - 1;
-        ucs_mpool_put(desc);
-    }
-}
-
 void uct_mm_iface_set_fifo_ptrs(void *fifo_mem, uct_mm_fifo_ctl_t **fifo_ctl_p,
                                 void **fifo_elems_p)
 {
@@ -728,9 +822,10 @@ static void uct_mm_iface_log_created(uct_mm_iface_t *iface)
     uct_mm_seg_t *seg = iface->recv_fifo_mem.memh;
 
     ucs_debug("created mm iface %p FIFO id 0x%"PRIx64
-              " va %p size %zu (%u x %u elems)",
+              " va %p size %zu (%u x %u elems) page size %zu%s",
               iface, seg->seg_id, seg->address, seg->length,
-              iface->config.fifo_elem_size, iface->config.fifo_size);
+              iface->config.fifo_elem_size, iface->config.fifo_size,
+              seg->page_size, iface->rx_lazy ? " lazy rx" : "");
 }
 
 static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
@@ -813,10 +908,16 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
 
     uct_mm_iface_set_fifo_ptrs(self->recv_fifo_mem.address,
                                &self->recv_fifo_ctl, &self->recv_fifo_elems);
-    self->recv_fifo_ctl->head = 0;
-    self->recv_fifo_ctl->tail = 0;
-    self->recv_fifo_ctl->pid  = getpid();
-    self->read_index          = 0;
+    self->rx_lazy                  = mm_config->lazy_rx;
+    self->rx_desc_page_size        = 0;
+    self->recv_fifo_ctl->head      = 0;
+    /* In lazy mode, senders see a full FIFO until the receive descriptors are
+     * allocated */
+    self->recv_fifo_ctl->tail      = self->rx_lazy ?
+                                     -(uint64_t)self->config.fifo_size : 0;
+    self->recv_fifo_ctl->pid       = getpid();
+    self->recv_fifo_ctl->connected = 0;
+    self->read_index               = 0;
     self->read_index_elem     = UCT_MM_IFACE_GET_FIFO_ELEM(self,
                                                            self->recv_fifo_elems,
                                                            self->read_index);
@@ -846,25 +947,16 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
         goto err_close_signal_fd;
     }
 
-    /* set the first receive descriptor */
-    self->last_recv_desc = ucs_mpool_get(&self->recv_desc_mp);
-    VALGRIND_MAKE_MEM_DEFINED(self->last_recv_desc, sizeof(*(self->last_recv_desc)));
-    if (self->last_recv_desc == NULL) {
-        ucs_error("failed to get the first receive descriptor");
-        status = UCS_ERR_NO_RESOURCE;
-        goto destroy_recv_mpool;
-    }
-
-    /* initiate the owner bit in all the FIFO elements and assign a receive descriptor
-     * per every FIFO element */
+    /* initiate the owner bit in all the FIFO elements */
     for (i = 0; i < mm_config->fifo_size; i++) {
         fifo_elem_p = UCT_MM_IFACE_GET_FIFO_ELEM(self, self->recv_fifo_elems, i);
         fifo_elem_p->flags = UCT_MM_FIFO_ELEM_FLAG_OWNER;
+    }
 
-        status = uct_mm_assign_desc_to_fifo_elem(self, fifo_elem_p, 1);
+    if (!self->rx_lazy) {
+        status = uct_mm_iface_rx_init(self);
         if (status != UCS_OK) {
-            ucs_error("failed to allocate a descriptor for MM");
-            goto destroy_descs;
+            goto destroy_recv_mpool;
         }
     }
 
@@ -873,9 +965,6 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_md_h md, uct_worker_h worker,
 
     return UCS_OK;
 
-destroy_descs:
-    uct_mm_iface_free_rx_descs(self, i);
-    ucs_mpool_put(self->last_recv_desc);
 destroy_recv_mpool:
     ucs_mpool_cleanup(&self->recv_desc_mp, 1);
 err_close_signal_fd:
@@ -891,11 +980,13 @@ static UCS_CLASS_CLEANUP_FUNC(uct_mm_iface_t)
     uct_base_iface_progress_disable(&self->super.super.super,
                                     UCT_PROGRESS_SEND | UCT_PROGRESS_RECV);
 
-    /* return all the descriptors that are now 'assigned' to the FIFO,
-     * to their mpool */
-    uct_mm_iface_free_rx_descs(self, self->config.fifo_size);
+    if (!self->rx_lazy) {
+        /* return all the descriptors that are now 'assigned' to the FIFO,
+         * to their mpool */
+        uct_mm_iface_free_rx_descs(self, self->config.fifo_size);
+        ucs_mpool_put(self->last_recv_desc);
+    }
 
-    ucs_mpool_put(self->last_recv_desc);
     ucs_mpool_cleanup(&self->recv_desc_mp, 1);
     close(self->signal_fd);
     uct_iface_mem_free(&self->recv_fifo_mem);
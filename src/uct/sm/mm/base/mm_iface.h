@@ -115,6 +115,8 @@ typedef struct uct_mm_iface_config {
                                                    * shared memory buffers */
     unsigned                 fifo_elem_size;      /* Size of the FIFO element size */
     int                      error_handling; /* Exposing of error handling cap */
+    int                      lazy_rx;        /* Allocate receive descriptors
+                                              * when the first peer connects */
     uct_iface_mpool_config_t mp;
     uct_mm_iface_overhead_t  overhead;
 } uct_mm_iface_config_t;
@@ -144,6 +146,8 @@ typedef struct uct_mm_fifo_ctl {
     /* 2nd cacheline */
     volatile uint64_t         tail;           /* How much was consumed */
     pid_t                     pid;            /* Process owner pid */
+    volatile uint32_t         connected;      /* Set by the first sender which
+                                                 connects to the FIFO */
 } UCS_S_PACKED UCS_V_ALIGNED(UCS_SYS_CACHE_LINE_SIZE) uct_mm_fifo_ctl_t;
 
 
@@ -221,6 +225,10 @@ typedef struct uct_mm_iface {
 
     ucs_mpool_t             recv_desc_mp;
     uct_mm_recv_desc_t      *last_recv_desc;  /* next receive descriptor to use */
+    int                     rx_lazy;          /* Receive descriptors were not
+                                                 allocated yet */
+    size_t                  rx_desc_page_size; /* Smallest page size of
+                                                  receive descriptor chunks */
 
     int                     signal_fd;        /* Unix socket for receiving remote signal */
 
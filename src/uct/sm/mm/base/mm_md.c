@@ -12,6 +12,7 @@
 #include "mm_md.h"
 
 #include <ucs/debug/log.h>
+#include <ucs/sys/sys.h>
 #include <inttypes.h>
 #include <limits.h>
 
@@ -60,10 +61,11 @@ ucs_status_t uct_mm_seg_new(void *address, size_t length, uct_mm_seg_t **seg_p)
         return UCS_ERR_NO_MEMORY;
     }
 
-    seg->address = address;
-    seg->length  = length;
-    seg->seg_id  = 0;
-    *seg_p       = seg;
+    seg->address   = address;
+    seg->length    = length;
+    seg->page_size = ucs_get_page_size();
+    seg->seg_id    = 0;
+    *seg_p         = seg;
     return UCS_OK;
 }
 
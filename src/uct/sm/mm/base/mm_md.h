@@ -29,6 +29,10 @@ typedef struct uct_mm_seg {
     uct_mm_seg_id_t       seg_id;     /* Shared memory ID */
     void                  *address;   /* Virtual address */
     size_t                length;     /* Size of the memory */
+    size_t                page_size;  /* Size of the pages which are
+                                         guaranteed to back the memory; may
+                                         be the base page size even if
+                                         transparent huge pages are used */
 } uct_mm_seg_t;
 
 
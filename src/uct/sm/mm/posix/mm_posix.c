@@ -19,6 +19,7 @@
 #include <ucs/sys/sys.h>
 #include <sys/mman.h>
 #include <sys/statvfs.h>
+#include <sys/vfs.h>
 #include <uct/api/v2/uct_v2.h>
 
 
@@ -33,7 +34,7 @@
 #define UCT_POSIX_SEG_FLAG_PROCFS       UCS_BIT(63) /* use procfs mode: mmid encodes an
                                                        open fd symlink from procfs */
 #define UCT_POSIX_SEG_FLAG_SHM_OPEN     UCS_BIT(62) /* use shm_open() rather than open() */
-#define UCT_POSIX_SEG_FLAG_HUGETLB      UCS_BIT(61) /* use MAP_HUGETLB */
+#define UCT_POSIX_SEG_FLAG_HUGETLB      UCS_BIT(61) /* backed by hugetlbfs */
 #define UCT_POSIX_SEG_FLAG_PID_NS       UCS_BIT(60) /* use PID NS in address */
 #define UCT_POSIX_SEG_FLAGS_MASK        (UCT_POSIX_SEG_FLAG_PROCFS | \
                                          UCT_POSIX_SEG_FLAG_SHM_OPEN | \
@@ -50,10 +51,14 @@
 #define UCT_POSIX_FILE_FMT              "/ucx_shm_posix_%"PRIx64
 #define UCT_POSIX_PROCFS_FILE_FMT       "/proc/%d/fd/%d" /* file pattern for procfs mode */
 
+/* Filesystem type of hugetlbfs mounts, see statfs(2) */
+#define UCT_POSIX_HUGETLBFS_MAGIC       0x958458f6
+
 
 typedef struct uct_posix_md_config {
     uct_mm_md_config_t super;
     char               *dir;
+    char               *hugetlbfs_dir;
     int                use_proc_link;
     size_t             shm_min_size;
 } uct_posix_md_config_t;
@@ -75,6 +80,14 @@ static ucs_config_field_t uct_posix_md_config_table[] = {
      "shm_open() is used. Otherwise, open() is used.",
      ucs_offsetof(uct_posix_md_config_t, dir), UCS_CONFIG_TYPE_STRING},
 
+    {"HUGETLBFS_DIR", "",
+     "Path to a hugetlbfs mount point used to back shared memory segments with\n"
+     "huge pages, for example a mount with pagesize=2M or pagesize=1G. The page\n"
+     "size of the mount is used. It requires USE_PROC_LINK=y, and is ignored if\n"
+     "MM_HUGETLB_MODE=n. If it's empty, or hugetlbfs allocation fails, transparent\n"
+     "huge pages are requested for the shared memory segment with madvise().",
+     ucs_offsetof(uct_posix_md_config_t, hugetlbfs_dir), UCS_CONFIG_TYPE_STRING},
+
     {"SHM_MIN_SIZE", "16mb",
      "Minimal size of the shared memory file system.\n"
      "If the file system size is less than this value, the transport will be disabled\n"
@@ -341,45 +354,23 @@ out:
 
 static ucs_status_t
 uct_posix_mmap(void **address_p, size_t *length_p, int flags, int fd,
-               const char *alloc_name, ucs_log_level_t err_level)
+               size_t page_size, const char *alloc_name,
+               ucs_log_level_t err_level)
 {
     size_t aligned_length;
     void *result;
 
-    aligned_length = ucs_align_up_pow2(*length_p, ucs_get_page_size());
-
-#ifdef MAP_HUGETLB
-    if (flags & MAP_HUGETLB) {
-        ssize_t huge_page_size = ucs_get_huge_page_size();
-        size_t huge_aligned_length;
-
-        if (huge_page_size <= 0) {
-            ucs_debug("huge pages are not supported on the system");
-            return UCS_ERR_NO_MEMORY; /* Huge pages not supported */
-        }
-
-        huge_aligned_length = ucs_align_up_pow2(aligned_length, huge_page_size);
-        if (huge_aligned_length > (2 * aligned_length)) {
-            return UCS_ERR_EXCEEDS_LIMIT; /* Do not align up by more than 2x */
-        }
-
-        aligned_length = huge_aligned_length;
-    }
-#endif
+    /* hugetlbfs mappings must be aligned to the huge page size */
+    aligned_length = ucs_align_up_pow2(*length_p, page_size);
 
     result = ucs_mmap(*address_p, aligned_length, UCT_POSIX_MMAP_PROT,
                       MAP_SHARED | flags, fd, 0, alloc_name);
     if (result == MAP_FAILED) {
         ucs_log(err_level,
-                "shared memory mmap(addr=%p, length=%zu, flags=%s%s, fd=%d) failed: %m",
+                "shared memory mmap(addr=%p, length=%zu, flags=%s, fd=%d, "
+                "page_size=%zu) failed: %m",
                 *address_p, aligned_length,
-                (flags & MAP_FIXED)   ? " FIXED"   : "",
-#ifdef MAP_HUGETLB
-                (flags & MAP_HUGETLB) ? " HUGETLB" : "",
-#else
-                "",
-#endif
-                fd);
+                (flags & MAP_FIXED) ? " FIXED" : "", fd, page_size);
         return UCS_ERR_SHMEM_SEGMENT;
     }
 
@@ -403,6 +394,27 @@ static ucs_status_t uct_posix_munmap(void *address, size_t length)
     return UCS_OK;
 }
 
+/* Get the size of the pages backing a file: huge pages for hugetlbfs files, and
+ * the regular page size otherwise */
+static ucs_status_t
+uct_posix_fd_page_size(int fd, ucs_log_level_t err_level, size_t *page_size_p)
+{
+    struct statfs fs;
+
+    if (fstatfs(fd, &fs) != 0) {
+        ucs_log(err_level, "fstatfs(fd=%d) failed: %m", fd);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    if (fs.f_type == UCT_POSIX_HUGETLBFS_MAGIC) {
+        *page_size_p = fs.f_bsize;
+    } else {
+        *page_size_p = ucs_get_page_size();
+    }
+
+    return UCS_OK;
+}
+
 static ucs_status_t
 uct_posix_mem_open(uct_mm_seg_id_t seg_id, const char *dir, int *fd_p)
 {
@@ -427,25 +439,33 @@ static ucs_status_t
 uct_posix_mem_attach_common(uct_mm_seg_id_t seg_id, size_t length,
                             const char *dir, uct_mm_remote_seg_t *rseg)
 {
+    size_t page_size;
     ucs_status_t status;
-    int mmap_flags, fd;
+    int fd;
 
     ucs_assert(length > 0);
-    rseg->cookie = (void*)length;
 
     status = uct_posix_mem_open(seg_id, dir, &fd);
     if (status != UCS_OK) {
         return status;
     }
 
-#ifdef MAP_HUGETLB
-    mmap_flags = (seg_id & UCT_POSIX_SEG_FLAG_HUGETLB) ? MAP_HUGETLB : 0;
-#else
-    mmap_flags = 0;
-#endif
+    if (seg_id & UCT_POSIX_SEG_FLAG_HUGETLB) {
+        status = uct_posix_fd_page_size(fd, UCS_LOG_LEVEL_ERROR, &page_size);
+        if (status != UCS_OK) {
+            goto out_close;
+        }
+    } else {
+        page_size = ucs_get_page_size();
+    }
+
     rseg->address = NULL;
-    status = uct_posix_mmap(&rseg->address, &length, mmap_flags, fd,
+    status = uct_posix_mmap(&rseg->address, &length, 0, fd, page_size,
                             "posix_attach", UCS_LOG_LEVEL_ERROR);
+    /* Keep the aligned length for munmap() */
+    rseg->cookie  = (void*)length;
+
+out_close:
     close(fd);
     return status;
 }
@@ -480,11 +500,11 @@ static ucs_status_t uct_posix_mem_detach_common(const uct_mm_remote_seg_t *rseg)
     return uct_posix_munmap(rseg->address, (size_t)rseg->cookie);
 }
 
+/* Create a new backing file in 'dir', or with shm_open() if 'dir' is NULL */
 static ucs_status_t
-uct_posix_segment_open(uct_mm_md_t *md, uct_mm_seg_id_t *seg_id_p, int *fd_p)
+uct_posix_segment_open(uct_mm_md_t *md, const char *dir,
+                       uct_mm_seg_id_t *seg_id_p, int *fd_p)
 {
-    uct_posix_md_config_t *posix_config = ucs_derived_of(md->config,
-                                                         uct_posix_md_config_t);
     uint64_t mmid, flags;
     ucs_status_t status;
     unsigned rand_seed;
@@ -495,13 +515,13 @@ uct_posix_segment_open(uct_mm_md_t *md, uct_mm_seg_id_t *seg_id_p, int *fd_p)
     for (;;) {
         mmid = rand_r(&rand_seed);
         ucs_assert(mmid <= UCT_POSIX_SEG_MMID_MASK);
-        if (uct_posix_use_shm_open(posix_config)) {
+        if (dir == NULL) {
             flags  = UCT_POSIX_SEG_FLAG_SHM_OPEN;
             status = uct_posix_shm_open(mmid, UCT_POSIX_SHM_CREATE_FLAGS, fd_p);
         } else {
             flags  = 0;
-            status = uct_posix_file_open(posix_config->dir, mmid,
-                                         UCT_POSIX_SHM_CREATE_FLAGS, fd_p);
+            status = uct_posix_file_open(dir, mmid, UCT_POSIX_SHM_CREATE_FLAGS,
+                                         fd_p);
         }
         if (status == UCS_OK) {
             *seg_id_p = mmid | flags;
@@ -513,33 +533,116 @@ uct_posix_segment_open(uct_mm_md_t *md, uct_mm_seg_id_t *seg_id_p, int *fd_p)
     }
 }
 
+static uct_mm_seg_id_t uct_posix_procfs_seg_id(uint64_t flags, int fd)
+{
+    return uct_posix_mmid_procfs_pack(fd) | flags | UCT_POSIX_SEG_FLAG_PROCFS |
+           (ucs_sys_ns_is_default(UCS_SYS_NS_TYPE_PID) ? 0 :
+            UCT_POSIX_SEG_FLAG_PID_NS);
+}
+
+/* Allocate a segment backed by a file on a hugetlbfs mount */
 static ucs_status_t
-uct_posix_mem_alloc(uct_md_h tl_md, size_t *length_p, void **address_p,
-                    ucs_memory_type_t mem_type, unsigned flags,
-                    const char *alloc_name, uct_mem_h *memh_p)
+uct_posix_hugetlbfs_alloc(uct_mm_md_t *md, uct_mm_seg_t *seg, int mmap_flags,
+                          const char *alloc_name, ucs_log_level_t err_level,
+                          int *fd_p)
 {
-    uct_mm_md_t                     *md = ucs_derived_of(tl_md, uct_mm_md_t);
     uct_posix_md_config_t *posix_config = ucs_derived_of(md->config,
                                                          uct_posix_md_config_t);
+    char file_path[PATH_MAX];
+    size_t page_size, length;
     ucs_status_t status;
-    uct_mm_seg_t *seg;
-    int force_hugetlb;
-    int mmap_flags;
-    void *address;
     int fd;
 
-    if (mem_type != UCS_MEMORY_TYPE_HOST) {
+    if (!strlen(posix_config->hugetlbfs_dir)) {
+        ucs_log(err_level, "hugetlbfs directory is not set");
         return UCS_ERR_UNSUPPORTED;
     }
 
-    status = uct_mm_seg_new(*address_p, *length_p, &seg);
+    /* Peers open the file by its procfs link, since it's not in the directory
+     * from the iface address */
+    if (!posix_config->use_proc_link) {
+        ucs_log(err_level, "hugetlbfs shared memory requires procfs link mode");
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    status = uct_posix_segment_open(md, posix_config->hugetlbfs_dir,
+                                    &seg->seg_id, &fd);
     if (status != UCS_OK) {
-        goto err;
+        return status;
+    }
+
+    /* The file is accessed only by its procfs link. Build the path without
+     * memory allocation, so the file is always removed */
+    ucs_snprintf_safe(file_path, sizeof(file_path), "%s" UCT_POSIX_FILE_FMT,
+                      posix_config->hugetlbfs_dir, seg->seg_id);
+    if (unlink(file_path) != 0) {
+        ucs_diag("unlink(%s) failed: %m", file_path);
     }
 
-    status = uct_posix_segment_open(md, &seg->seg_id, &fd);
+    status = uct_posix_fd_page_size(fd, err_level, &page_size);
     if (status != UCS_OK) {
-        goto err_free_seg;
+        goto err_close;
+    }
+
+    if (page_size == ucs_get_page_size()) {
+        ucs_log(err_level, "%s is not a hugetlbfs mount",
+                posix_config->hugetlbfs_dir);
+        status = UCS_ERR_UNSUPPORTED;
+        goto err_close;
+    }
+
+    /* Unless huge pages are forced, do not align up by more than 2x */
+    length = ucs_align_up_pow2(seg->length, page_size);
+    if ((length > (2 * seg->length)) &&
+        (posix_config->super.hugetlb_mode != UCS_YES)) {
+        ucs_debug("not using %zu-byte huge pages for %zu bytes of %s",
+                  page_size, seg->length, alloc_name);
+        status = UCS_ERR_EXCEEDS_LIMIT;
+        goto err_close;
+    }
+
+    /* hugetlbfs does not support write(), and huge pages are reserved by
+     * mmap() */
+    if (ftruncate(fd, length) != 0) {
+        ucs_log(err_level, "ftruncate(fd=%d, length=%zu) failed: %m", fd,
+                length);
+        status = UCS_ERR_NO_MEMORY;
+        goto err_close;
+    }
+
+    status = uct_posix_mmap(&seg->address, &length, mmap_flags, fd, page_size,
+                            alloc_name, err_level);
+    if (status != UCS_OK) {
+        goto err_close;
+    }
+
+    seg->seg_id    = uct_posix_procfs_seg_id(UCT_POSIX_SEG_FLAG_HUGETLB, fd);
+    seg->length    = length;
+    seg->page_size = page_size;
+    *fd_p          = fd;
+    return UCS_OK;
+
+err_close:
+    close(fd);
+    return status;
+}
+
+/* Allocate a segment backed by a shared memory or a regular file */
+static ucs_status_t
+uct_posix_shm_alloc(uct_mm_md_t *md, uct_mm_seg_t *seg, int mmap_flags,
+                    const char *alloc_name, int *fd_p)
+{
+    uct_posix_md_config_t *posix_config = ucs_derived_of(md->config,
+                                                         uct_posix_md_config_t);
+    ucs_status_t status;
+    int fd;
+
+    status = uct_posix_segment_open(md,
+                                    uct_posix_use_shm_open(posix_config) ?
+                                    NULL : posix_config->dir,
+                                    &seg->seg_id, &fd);
+    if (status != UCS_OK) {
+        return status;
     }
 
     /* Check if the location of the backing file has enough memory for the
@@ -555,11 +658,65 @@ uct_posix_mem_alloc(uct_md_h tl_md, size_t *length_p, void **address_p,
         uct_posix_unlink(md, seg->seg_id, UCS_LOG_LEVEL_DIAG);
 
         /* Replace mmid by pid+fd. Keep previous SHM_OPEN flag for mkey_pack() */
-        seg->seg_id = uct_posix_mmid_procfs_pack(fd) |
-                      (seg->seg_id & UCT_POSIX_SEG_FLAG_SHM_OPEN) |
-                      UCT_POSIX_SEG_FLAG_PROCFS |
-                      (ucs_sys_ns_is_default(UCS_SYS_NS_TYPE_PID) ? 0 :
-                       UCT_POSIX_SEG_FLAG_PID_NS);
+        seg->seg_id = uct_posix_procfs_seg_id(
+                seg->seg_id & UCT_POSIX_SEG_FLAG_SHM_OPEN, fd);
+    }
+
+    status = uct_posix_mmap(&seg->address, &seg->length, mmap_flags, fd,
+                            ucs_get_page_size(), alloc_name,
+                            UCS_LOG_LEVEL_ERROR);
+    if (status != UCS_OK) {
+        goto err_close;
+    }
+
+#ifdef MADV_HUGEPAGE
+    /* Let the kernel back the segment with transparent huge pages, if shmem
+     * THP is set to "advise". Huge pages are not guaranteed, and are allocated
+     * only on first touch, so the base page size is reported for the segment */
+    if (posix_config->super.hugetlb_mode != UCS_NO) {
+        if (madvise(seg->address, seg->length, MADV_HUGEPAGE) != 0) {
+            ucs_debug("madvise(address=%p, length=%zu, HUGEPAGE) failed: %m",
+                      seg->address, seg->length);
+        } else {
+            ucs_debug("advised transparent huge pages for %s at %p length %zu,"
+                      " base page size %zu", alloc_name, seg->address,
+                      seg->length, seg->page_size);
+        }
+    }
+#endif
+
+    *fd_p = fd;
+    return UCS_OK;
+
+err_close:
+    close(fd);
+    if (!(seg->seg_id & UCT_POSIX_SEG_FLAG_PROCFS)) {
+        uct_posix_unlink(md, seg->seg_id, UCS_LOG_LEVEL_WARN);
+    }
+    return status;
+}
+
+static ucs_status_t
+uct_posix_mem_alloc(uct_md_h tl_md, size_t *length_p, void **address_p,
+                    ucs_memory_type_t mem_type, unsigned flags,
+                    const char *alloc_name, uct_mem_h *memh_p)
+{
+    uct_mm_md_t                     *md = ucs_derived_of(tl_md, uct_mm_md_t);
+    uct_posix_md_config_t *posix_config = ucs_derived_of(md->config,
+                                                         uct_posix_md_config_t);
+    ucs_status_t status;
+    uct_mm_seg_t *seg;
+    int force_hugetlb;
+    int mmap_flags;
+    int fd;
+
+    if (mem_type != UCS_MEMORY_TYPE_HOST) {
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    status = uct_mm_seg_new(*address_p, *length_p, &seg);
+    if (status != UCS_OK) {
+        goto err;
     }
 
     /* mmap the shared memory segment that was created by shm_open */
@@ -570,42 +727,31 @@ uct_posix_mem_alloc(uct_md_h tl_md, size_t *length_p, void **address_p,
         mmap_flags   = 0;
     }
 
-    /* try HUGETLB mmap */
-    address = MAP_FAILED;
+    /* try hugetlbfs, and fallback to regular shared memory */
     if (posix_config->super.hugetlb_mode != UCS_NO) {
         force_hugetlb = (posix_config->super.hugetlb_mode == UCS_YES);
-#ifdef MAP_HUGETLB
-        status = uct_posix_mmap(&seg->address, &seg->length,
-                                mmap_flags | MAP_HUGETLB, fd, alloc_name,
-                                force_hugetlb ? UCS_LOG_LEVEL_ERROR :
-                                                UCS_LOG_LEVEL_DEBUG);
-#else
-        status = UCS_ERR_SHMEM_SEGMENT;
-        if (force_hugetlb) {
-            ucs_error("shared memory allocation failed: "
-                      "MAP_HUGETLB is not supported on the system");
-        }
-#endif
-        if ((status != UCS_OK) && force_hugetlb) {
-            goto err_close;
-        } else if (status == UCS_OK) {
-            seg->seg_id |= UCT_POSIX_SEG_FLAG_HUGETLB;
-       }
-    }
-
-    /* fallback to regular mmap */
-    if (address == MAP_FAILED) {
-        ucs_assert(posix_config->super.hugetlb_mode != UCS_YES);
-        status = uct_posix_mmap(&seg->address, &seg->length, mmap_flags, fd,
-                                alloc_name, UCS_LOG_LEVEL_ERROR);
-        if (status != UCS_OK) {
-            goto err_close;
+        status        = uct_posix_hugetlbfs_alloc(md, seg, mmap_flags,
+                                                  alloc_name,
+                                                  force_hugetlb ?
+                                                  UCS_LOG_LEVEL_ERROR :
+                                                  UCS_LOG_LEVEL_DEBUG,
+                                                  &fd);
+        if (status == UCS_OK) {
+            goto out_ok;
+        } else if (force_hugetlb) {
+            goto err_free_seg;
         }
     }
 
-    /* create new memory segment */
-    ucs_debug("allocated posix shared memory at %p length %zu", seg->address,
-              seg->length);
+    status = uct_posix_shm_alloc(md, seg, mmap_flags, alloc_name, &fd);
+    if (status != UCS_OK) {
+        goto err_free_seg;
+    }
+
+out_ok:
+    ucs_debug("allocated posix shared memory at %p length %zu page size %zu%s",
+              seg->address, seg->length, seg->page_size,
+              (seg->seg_id & UCT_POSIX_SEG_FLAG_HUGETLB) ? " (hugetlbfs)" : "");
 
     if (!posix_config->use_proc_link) {
         /* closing the file here since the peers will open it by file system path */
@@ -614,14 +760,9 @@ uct_posix_mem_alloc(uct_md_h tl_md, size_t *length_p, void **address_p,
 
     *address_p = seg->address;
     *length_p  = seg->length;
-     *memh_p   = seg;
+    *memh_p    = seg;
     return UCS_OK;
 
-err_close:
-    close(fd);
-    if (!(seg->seg_id & UCT_POSIX_SEG_FLAG_PROCFS)) {
-        uct_posix_unlink(md, seg->seg_id, UCS_LOG_LEVEL_WARN);
-    }
 err_free_seg:
     ucs_free(seg);
 err:
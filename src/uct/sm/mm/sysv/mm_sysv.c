@@ -91,6 +91,7 @@ uct_sysv_mem_alloc(uct_md_h tl_md, size_t *length_p, void **address_p,
                                 UCT_MM_SYSV_MSTR | SHM_HUGETLB, alloc_name,
                                 &shmid);
         if (status == UCS_OK) {
+            seg->page_size = ucs_get_huge_page_size();
             goto out_ok;
         }
 
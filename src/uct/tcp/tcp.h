@@ -405,6 +405,9 @@ typedef struct uct_tcp_iface {
         int                       put_enable;        /* Enable PUT Zcopy operation support */
         int                       conn_nb;           /* Use non-blocking connect() */
         unsigned                  max_poll;          /* Number of events to poll per socket*/
+        unsigned                  num_paths;         /* Number of parallel connections
+                                                      * (network paths) per peer */
+        int                       edge_triggered;    /* Use edge-triggered event set */
         uint8_t                   max_conn_retries;  /* How many connection establishment attempts
                                                       * should be done if dropped connection was
                                                       * detected due to lack of system resources */
@@ -445,6 +448,8 @@ typedef struct uct_tcp_iface_config {
     int                            put_enable;
     int                            conn_nb;
     unsigned                       max_poll;
+    unsigned                       num_paths;
+    int                            edge_triggered;
     unsigned                       max_conn_retries;
     int                            sockopt_nodelay;
     uct_tcp_send_recv_buf_config_t sockopt;
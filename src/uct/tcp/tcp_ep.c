@@ -1102,6 +1102,21 @@ static inline ucs_status_t uct_tcp_ep_handle_send_err(uct_tcp_ep_t *ep,
     return status;
 }
 
+/* In edge-triggered mode, a non-blocking socket operation which returned less
+ * than requested means the socket was drained, so the event set should not
+ * report the event again until the kernel signals a new edge */
+static UCS_F_ALWAYS_INLINE void
+uct_tcp_ep_check_drained(uct_tcp_ep_t *ep, ucs_event_set_types_t event,
+                         size_t length, size_t done_length)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+
+    if (iface->config.edge_triggered && (done_length < length)) {
+        ucs_event_set_clear_ready(iface->event_set, ep->fd, event);
+    }
+}
+
 static inline ssize_t uct_tcp_ep_send(uct_tcp_ep_t *ep)
 {
     size_t sent_length;
@@ -1118,6 +1133,8 @@ static inline ssize_t uct_tcp_ep_send(uct_tcp_ep_t *ep)
         return uct_tcp_ep_handle_send_err(ep, status);
     }
 
+    uct_tcp_ep_check_drained(ep, UCS_EVENT_SET_EVWRITE,
+                             ep->tx.length - ep->tx.offset, sent_length);
     uct_tcp_ep_tx_completed(ep, sent_length);
 
     ucs_assert(sent_length <= SSIZE_MAX);
@@ -1138,6 +1155,7 @@ static inline ssize_t uct_tcp_ep_sendv(uct_tcp_ep_t *ep)
     if (ucs_unlikely(status != UCS_OK)) {
         if (status == UCS_ERR_NO_PROGRESS) {
             ucs_assert(sent_length == 0);
+            uct_tcp_ep_check_drained(ep, UCS_EVENT_SET_EVWRITE, 1, 0);
             return 0;
         }
 
@@ -1146,6 +1164,8 @@ static inline ssize_t uct_tcp_ep_sendv(uct_tcp_ep_t *ep)
         return status;
     }
 
+    uct_tcp_ep_check_drained(ep, UCS_EVENT_SET_EVWRITE,
+                             ep->tx.length - ep->tx.offset, sent_length);
     uct_tcp_ep_tx_completed(ep, sent_length);
 
     if (ep->tx.offset != ep->tx.length) {
@@ -1282,6 +1302,7 @@ static inline unsigned uct_tcp_ep_recv(uct_tcp_ep_t *ep, size_t recv_length)
 {
     uct_tcp_iface_t UCS_V_UNUSED *iface = ucs_derived_of(ep->super.super.iface,
                                                          uct_tcp_iface_t);
+    size_t length                       = recv_length;
     ucs_status_t status;
 
     if (ucs_unlikely(recv_length == 0)) {
@@ -1292,10 +1313,16 @@ static inline unsigned uct_tcp_ep_recv(uct_tcp_ep_t *ep, size_t recv_length)
                                                             ep->rx.length),
                                 &recv_length);
     if (ucs_unlikely(status != UCS_OK)) {
+        if (status == UCS_ERR_NO_PROGRESS) {
+            uct_tcp_ep_check_drained(ep, UCS_EVENT_SET_EVREAD, length, 0);
+        }
+
         uct_tcp_ep_handle_recv_err(ep, status);
         return 0;
     }
 
+    uct_tcp_ep_check_drained(ep, UCS_EVENT_SET_EVREAD, length, recv_length);
+
     ucs_assertv(recv_length != 0, "ep=%p", ep);
 
     ep->rx.length += recv_length;
@@ -1587,10 +1614,18 @@ static unsigned uct_tcp_ep_progress_put_rx(uct_tcp_ep_t *ep)
     status      = ucs_socket_recv_nb(ep->fd, (void*)(uintptr_t)put_req->addr,
                                      &recv_length);
     if (ucs_unlikely(status != UCS_OK)) {
+        if (status == UCS_ERR_NO_PROGRESS) {
+            uct_tcp_ep_check_drained(ep, UCS_EVENT_SET_EVREAD,
+                                     put_req->length, 0);
+        }
+
         uct_tcp_ep_handle_recv_err(ep, status);
         return 0;
     }
 
+    uct_tcp_ep_check_drained(ep, UCS_EVENT_SET_EVREAD, put_req->length,
+                             recv_length);
+
     ucs_assertv(recv_length, "ep=%p", ep);
 
     uct_tcp_ep_put_rx_advance(ep, put_req, recv_length);
@@ -1749,6 +1784,8 @@ uct_tcp_ep_am_sendv(uct_tcp_ep_t *ep, int short_sendv, uct_tcp_am_hdr_t *hdr,
         return uct_tcp_ep_handle_send_err(ep, status);
     }
 
+    uct_tcp_ep_check_drained(ep, UCS_EVENT_SET_EVWRITE, ep->tx.length,
+                             sent_length);
     uct_tcp_ep_tx_completed(ep, sent_length);
 
     uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, hdr->am_id,
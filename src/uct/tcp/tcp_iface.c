@@ -58,6 +58,23 @@ static ucs_config_field_t uct_tcp_iface_config_table[] = {
    "time, but can lead to connection resets due to high load on TCP/IP stack",
    ucs_offsetof(uct_tcp_iface_config_t, conn_nb), UCS_CONFIG_TYPE_BOOL},
 
+  {"NUM_PATHS", "1",
+   "Number of parallel TCP connections that should be created between a pair\n"
+   "of communicating endpoints. Each connection is exposed as a separate network\n"
+   "path, so the upper layer can stripe large messages across several kernel TCP\n"
+   "streams to overcome the single-stream bandwidth limit. Only multi-lane\n"
+   "protocols (rendezvous and zero-copy) are striped; short and eager bcopy\n"
+   "messages are always sent on a single active message lane.",
+   ucs_offsetof(uct_tcp_iface_config_t, num_paths), UCS_CONFIG_TYPE_UINT},
+
+  {"EDGE_TRIGGERED", "n",
+   "Register sockets in edge-triggered mode and track their readiness in user\n"
+   "space, so enabling and disabling send/receive events of an endpoint does\n"
+   "not require a system call. Since every socket is registered for all events,\n"
+   "the interface event file descriptor may also be signaled for events which\n"
+   "were not requested, causing extra wakeups with event-driven progress.",
+   ucs_offsetof(uct_tcp_iface_config_t, edge_triggered), UCS_CONFIG_TYPE_BOOL},
+
   {"MAX_POLL", UCS_PP_MAKE_STRING(UCT_TCP_MAX_EVENTS),
    "Number of times to poll on a ready socket. 0 - no polling, -1 - until drained",
    ucs_offsetof(uct_tcp_iface_config_t, max_poll), UCS_CONFIG_TYPE_UINT},
@@ -350,6 +367,7 @@ static ucs_status_t uct_tcp_iface_query(uct_iface_h tl_iface,
     attr->bandwidth.dedicated = 0;
     attr->latency.m           = 0;
     attr->overhead            = 50e-6;  /* 50 usec */
+    attr->dev_num_paths       = iface->config.num_paths;
 
     if (iface->config.prefer_default) {
         status = uct_tcp_netif_is_default(iface->if_name, &is_default);
@@ -375,6 +393,21 @@ static ucs_status_t uct_tcp_iface_event_fd_get(uct_iface_h tl_iface, int *fd_p)
     return ucs_event_set_fd_get(iface->event_set, fd_p);
 }
 
+static ucs_status_t uct_tcp_iface_event_arm(uct_iface_h tl_iface,
+                                            unsigned events)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+
+    /* In edge-triggered mode, sockets which were not drained yet do not signal
+     * the event fd again */
+    if (ucs_event_set_has_ready(iface->event_set)) {
+        ucs_trace("iface %p: sockets are still ready, cannot arm", iface);
+        return UCS_ERR_BUSY;
+    }
+
+    return UCS_OK;
+}
+
 static void uct_tcp_iface_handle_events(void *callback_data,
                                         ucs_event_set_types_t events,
                                         void *arg)
@@ -517,7 +550,7 @@ static uct_iface_ops_t uct_tcp_iface_ops = {
     .iface_progress_disable   = uct_base_iface_progress_disable,
     .iface_progress           = uct_tcp_iface_progress,
     .iface_event_fd_get       = uct_tcp_iface_event_fd_get,
-    .iface_event_arm          = ucs_empty_function_return_success,
+    .iface_event_arm          = uct_tcp_iface_event_arm,
     .iface_close              = UCS_CLASS_DELETE_FUNC_NAME(uct_tcp_iface_t),
     .iface_query              = uct_tcp_iface_query,
     .iface_get_address        = uct_tcp_iface_get_address,
@@ -559,7 +592,7 @@ static ucs_status_t uct_tcp_iface_server_init(uct_tcp_iface_t *iface)
         }
 
         status = ucs_socket_server_init((struct sockaddr*)&bind_addr, addr_len,
-                                        ucs_socket_max_conn(), retry, 0,
+                                        ucs_socket_max_conn(), retry, 0, 0,
                                         &iface->listen_fd);
     } while (retry && (status == UCS_ERR_BUSY));
 
@@ -712,12 +745,20 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
         return UCS_ERR_INVALID_PARAM;
     }
 
+    if ((config->num_paths == 0) || (config->num_paths > UINT8_MAX)) {
+        ucs_error("invalid TCP number of paths %u (expected: 1..%u)",
+                  config->num_paths, UINT8_MAX);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
     self->config.zcopy.max_hdr     = self->config.tx_seg_size -
                                      self->config.zcopy.hdr_offset;
     self->config.prefer_default    = config->prefer_default;
     self->config.put_enable        = config->put_enable;
     self->config.conn_nb           = config->conn_nb;
     self->config.max_poll          = config->max_poll;
+    self->config.num_paths         = config->num_paths;
+    self->config.edge_triggered    = config->edge_triggered;
     self->config.max_conn_retries  = config->max_conn_retries;
     self->config.syn_cnt           = config->syn_cnt;
     self->sockopt.nodelay          = config->sockopt_nodelay;
@@ -802,7 +843,9 @@ static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_md_h md, uct_worker_h worker,
     status = UCS_PTR_MAP_INIT(tcp_ep, &self->ep_ptr_map);
     ucs_assert_always(status == UCS_OK);
 
-    status = ucs_event_set_create(&self->event_set);
+    status = ucs_event_set_create_ext(&self->event_set,
+                                      self->config.edge_triggered ?
+                                      UCS_EVENT_SET_FLAG_EDGE_TRIGGERED : 0);
     if (status != UCS_OK) {
         status = UCS_ERR_IO_ERROR;
         goto err_cleanup_rx_mpool;
@@ -14,11 +14,8 @@
 #include <ucs/async/async.h>
 
 
-static void
-uct_tcp_listener_conn_req_handler(int fd, ucs_event_set_types_t events,
-                                  void *arg)
+static ucs_status_t uct_tcp_listener_accept(uct_tcp_listener_t *listener)
 {
-    uct_tcp_listener_t *listener = (uct_tcp_listener_t *)arg;
     char ip_port_str[UCS_SOCKADDR_STRING_LEN];
     struct sockaddr_storage client_addr;
     ucs_async_context_t *async_ctx;
@@ -28,14 +25,12 @@ uct_tcp_listener_conn_req_handler(int fd, ucs_event_set_types_t events,
     socklen_t addrlen;
     int conn_fd;
 
-    ucs_assert(fd == listener->listen_fd);
-
     addrlen   = sizeof(struct sockaddr_storage);
     status    = ucs_socket_accept(listener->listen_fd,
                                   (struct sockaddr*)&client_addr,
                                   &addrlen, &conn_fd);
     if (status != UCS_OK) {
-        return;
+        return status;
     }
 
     ucs_assert(conn_fd != -1);
@@ -85,12 +80,35 @@ uct_tcp_listener_conn_req_handler(int fd, ucs_event_set_types_t events,
     /* Adding the ep to a list on the cm for cleanup purposes */
     ucs_list_add_tail(&listener->sockcm->ep_list, &ep->list);
 
-    return;
+    /* The client sends its private data right after the connection is
+     * established, so it is usually there already. Try to receive it now
+     * instead of waiting for another event on the new fd. */
+    uct_tcp_sa_data_handler(conn_fd, UCS_EVENT_SET_EVREAD, ep);
+    return UCS_OK;
 
 err_delete_ep:
     UCS_CLASS_DELETE(uct_tcp_sockcm_ep_t, ep);
 err:
     ucs_close_fd(&conn_fd);
+    return status;
+}
+
+static void
+uct_tcp_listener_conn_req_handler(int fd, ucs_event_set_types_t events,
+                                  void *arg)
+{
+    uct_tcp_listener_t *listener = (uct_tcp_listener_t *)arg;
+    unsigned count;
+
+    ucs_assert(fd == listener->listen_fd);
+
+    /* Accept the pending connection requests in a batch, to avoid an event
+     * round trip per connection when many clients connect at once */
+    for (count = 0; count < listener->sockcm->accept_batch; ++count) {
+        if (uct_tcp_listener_accept(listener) != UCS_OK) {
+            break;
+        }
+    }
 }
 
 UCS_CLASS_INIT_FUNC(uct_tcp_listener_t, uct_cm_h cm,
@@ -100,7 +118,7 @@ UCS_CLASS_INIT_FUNC(uct_tcp_listener_t, uct_cm_h cm,
     ucs_async_context_t *async_ctx;
     char ip_port_str[UCS_SOCKADDR_STRING_LEN];
     ucs_status_t status;
-    int backlog;
+    int backlog, reuse_port;
 
     UCS_CLASS_CALL_SUPER_INIT(uct_listener_t, cm);
 
@@ -114,9 +132,11 @@ UCS_CLASS_INIT_FUNC(uct_tcp_listener_t, uct_cm_h cm,
         goto err;
     }
 
-    status = ucs_socket_server_init(saddr, socklen, backlog, 0,
-                                    self->sockcm->super.config.reuse_addr,
-                                    &self->listen_fd);
+    reuse_port = (params->field_mask & UCT_LISTENER_PARAM_FIELD_FLAGS) &&
+                 (params->flags & UCT_LISTENER_FLAG_REUSE_PORT);
+    status     = ucs_socket_server_init(saddr, socklen, backlog, 0,
+                                        self->sockcm->super.config.reuse_addr,
+                                        reuse_port, &self->listen_fd);
     if (status != UCS_OK) {
         goto err;
     }
@@ -26,6 +26,11 @@ ucs_config_field_t uct_tcp_sockcm_config_table[] = {
 
    UCT_TCP_SYN_CNT(ucs_offsetof(uct_tcp_sockcm_config_t, syn_cnt)),
 
+  {"ACCEPT_BATCH", "64",
+   "Maximal number of connection requests which a listener accepts upon a\n"
+   "single event, before letting other events be handled.",
+   ucs_offsetof(uct_tcp_sockcm_config_t, accept_batch), UCS_CONFIG_TYPE_UINT},
+
   {NULL}
 };
 
@@ -219,6 +224,7 @@ UCS_CLASS_INIT_FUNC(uct_tcp_sockcm_t, uct_component_h component,
     self->sockopt_sndbuf = cm_config->sockopt.sndbuf;
     self->sockopt_rcvbuf = cm_config->sockopt.rcvbuf;
     self->syn_cnt        = cm_config->syn_cnt;
+    self->accept_batch   = ucs_max(cm_config->accept_batch, 1);
 
     ucs_list_head_init(&self->ep_list);
 
@@ -0,0 +1,342 @@
+/**
+ * Copyright (c) NVIDIA CORPORATION & AFFILIATES, 2025. ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <ucp/api/ucp.h>
+#include <ucs/sys/math.h>
+#include <ucs/time/time.h>
+
+#include <arpa/inet.h>
+#include <limits.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+/*
+ * Measures the rate of client-server connection establishment over the
+ * loopback, and the time from creating a client endpoint until the server
+ * receives the first Active Message sent on it. The server and the clients
+ * are separate workers progressed by a single thread.
+ */
+
+#define TEST_AM_ID 0
+
+
+typedef struct {
+    ucp_worker_h   worker;
+    ucp_listener_h listener;
+    ucp_ep_h       *eps;
+    unsigned       num_conns;
+    unsigned       num_eps;
+    unsigned       num_received;
+    ucs_time_t     *first_msg_time;
+    ucs_status_t   status;
+} test_server_t;
+
+
+static ucs_status_t test_server_am_cb(void *arg, const void *header,
+                                      size_t header_length, void *data,
+                                      size_t length,
+                                      const ucp_am_recv_param_t *param)
+{
+    test_server_t *server = arg;
+    unsigned index;
+
+    if (header_length != sizeof(index)) {
+        server->status = UCS_ERR_INVALID_PARAM;
+        return UCS_OK;
+    }
+
+    memcpy(&index, header, sizeof(index));
+    if (index >= server->num_conns) {
+        server->status = UCS_ERR_INVALID_PARAM;
+        return UCS_OK;
+    }
+
+    server->first_msg_time[index] = ucs_get_time();
+    ++server->num_received;
+    return UCS_OK;
+}
+
+static void test_server_conn_cb(ucp_conn_request_h conn_request, void *arg)
+{
+    test_server_t *server = arg;
+    ucp_ep_params_t ep_params;
+    ucs_status_t status;
+
+    if (server->num_eps >= server->num_conns) {
+        /* Retried or unexpected connection request, no room to keep it */
+        ucp_listener_reject(server->listener, conn_request);
+        return;
+    }
+
+    ep_params.field_mask   = UCP_EP_PARAM_FIELD_CONN_REQUEST;
+    ep_params.conn_request = conn_request;
+    status                 = ucp_ep_create(server->worker, &ep_params,
+                                           &server->eps[server->num_eps]);
+    if (status != UCS_OK) {
+        server->status = status;
+        return;
+    }
+
+    ++server->num_eps;
+}
+
+static void test_close_eps(ucp_worker_h worker, ucp_worker_h peer_worker,
+                           ucp_ep_h *eps, unsigned count)
+{
+    ucp_request_param_t param;
+    ucs_status_ptr_t req;
+    unsigned i;
+
+    param.op_attr_mask = UCP_OP_ATTR_FIELD_FLAGS;
+    param.flags        = UCP_EP_CLOSE_FLAG_FORCE;
+
+    for (i = 0; i < count; ++i) {
+        req = ucp_ep_close_nbx(eps[i], &param);
+        if (UCS_PTR_IS_PTR(req)) {
+            while (ucp_request_check_status(req) == UCS_INPROGRESS) {
+                ucp_worker_progress(worker);
+                ucp_worker_progress(peer_worker);
+            }
+            ucp_request_free(req);
+        }
+    }
+}
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [options]\n", name);
+    printf("  -n <count>   Number of connections (default: 1000)\n");
+    printf("  -a <addr>    IPv4 address to listen on (default: 127.0.0.1)\n");
+    printf("  -p <port>    Port to listen on (default: any)\n");
+    printf("  -h           Print this help\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *ip           = "127.0.0.1";
+    unsigned num_conns       = 1000;
+    uint16_t port            = 0;
+    test_server_t server     = {0};
+    ucp_ep_h *client_eps     = NULL;
+    ucs_time_t *create_time  = NULL;
+    unsigned *conn_ids       = NULL;
+    int ret                  = -1;
+    ucs_time_t start, end, ttfm, ttfm_max;
+    ucp_worker_params_t worker_params;
+    ucp_am_handler_param_t am_param;
+    ucp_listener_params_t listener_params;
+    ucp_listener_attr_t listener_attr;
+    ucp_request_param_t send_param;
+    ucp_ep_params_t ep_params;
+    ucp_worker_h client_worker;
+    ucp_listener_h listener;
+    struct sockaddr_in addr;
+    ucp_context_h context;
+    ucp_params_t params;
+    ucs_status_ptr_t req;
+    ucs_status_t status;
+    double elapsed;
+    unsigned i;
+    char *endptr;
+    long value;
+    int c;
+
+    while ((c = getopt(argc, argv, "n:a:p:h")) != -1) {
+        switch (c) {
+        case 'n':
+            value = strtol(optarg, &endptr, 0);
+            if ((*endptr != '\0') || (value < 1) || (value > UINT_MAX)) {
+                fprintf(stderr, "invalid number of connections: %s\n",
+                        optarg);
+                usage(argv[0]);
+                return -1;
+            }
+            num_conns = value;
+            break;
+        case 'a':
+            ip = optarg;
+            break;
+        case 'p':
+            port = strtoul(optarg, NULL, 0);
+            break;
+        case 'h':
+        default:
+            usage(argv[0]);
+            return (c == 'h') ? 0 : -1;
+        }
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(port);
+    if (inet_pton(AF_INET, ip, &addr.sin_addr) != 1) {
+        fprintf(stderr, "invalid address: %s\n", ip);
+        return -1;
+    }
+
+    server.num_conns      = num_conns;
+    server.eps            = calloc(num_conns, sizeof(*server.eps));
+    server.first_msg_time = calloc(num_conns, sizeof(*server.first_msg_time));
+    client_eps            = calloc(num_conns, sizeof(*client_eps));
+    create_time           = calloc(num_conns, sizeof(*create_time));
+    conn_ids              = calloc(num_conns, sizeof(*conn_ids));
+    if ((server.eps == NULL) || (server.first_msg_time == NULL) ||
+        (client_eps == NULL) || (create_time == NULL) || (conn_ids == NULL)) {
+        fprintf(stderr, "failed to allocate memory\n");
+        goto out_free;
+    }
+
+    params.field_mask = UCP_PARAM_FIELD_FEATURES;
+    params.features   = UCP_FEATURE_AM;
+    status            = ucp_init(&params, NULL, &context);
+    if (status != UCS_OK) {
+        fprintf(stderr, "ucp_init() failed: %s\n", ucs_status_string(status));
+        goto out_free;
+    }
+
+    worker_params.field_mask  = UCP_WORKER_PARAM_FIELD_THREAD_MODE;
+    worker_params.thread_mode = UCS_THREAD_MODE_SINGLE;
+    status = ucp_worker_create(context, &worker_params, &server.worker);
+    if (status != UCS_OK) {
+        fprintf(stderr, "failed to create server worker: %s\n",
+                ucs_status_string(status));
+        goto out_cleanup;
+    }
+
+    status = ucp_worker_create(context, &worker_params, &client_worker);
+    if (status != UCS_OK) {
+        fprintf(stderr, "failed to create client worker: %s\n",
+                ucs_status_string(status));
+        goto out_destroy_server_worker;
+    }
+
+    am_param.field_mask = UCP_AM_HANDLER_PARAM_FIELD_ID |
+                          UCP_AM_HANDLER_PARAM_FIELD_CB |
+                          UCP_AM_HANDLER_PARAM_FIELD_ARG;
+    am_param.id         = TEST_AM_ID;
+    am_param.cb         = test_server_am_cb;
+    am_param.arg        = &server;
+    status              = ucp_worker_set_am_recv_handler(server.worker,
+                                                         &am_param);
+    if (status != UCS_OK) {
+        goto out_destroy_client_worker;
+    }
+
+    listener_params.field_mask       = UCP_LISTENER_PARAM_FIELD_SOCK_ADDR |
+                                       UCP_LISTENER_PARAM_FIELD_CONN_HANDLER;
+    listener_params.sockaddr.addr    = (const struct sockaddr*)&addr;
+    listener_params.sockaddr.addrlen = sizeof(addr);
+    listener_params.conn_handler.cb  = test_server_conn_cb;
+    listener_params.conn_handler.arg = &server;
+    status = ucp_listener_create(server.worker, &listener_params, &listener);
+    if (status != UCS_OK) {
+        fprintf(stderr, "failed to listen on %s: %s\n", ip,
+                ucs_status_string(status));
+        goto out_destroy_client_worker;
+    }
+
+    server.listener = listener;
+
+    listener_attr.field_mask = UCP_LISTENER_ATTR_FIELD_SOCKADDR;
+    status = ucp_listener_query(listener, &listener_attr);
+    if (status != UCS_OK) {
+        goto out_destroy_listener;
+    }
+
+    memcpy(&addr, &listener_attr.sockaddr, sizeof(addr));
+
+    send_param.op_attr_mask    = 0;
+    ep_params.field_mask       = UCP_EP_PARAM_FIELD_FLAGS |
+                                 UCP_EP_PARAM_FIELD_SOCK_ADDR;
+    ep_params.flags            = UCP_EP_PARAMS_FLAGS_CLIENT_SERVER;
+    ep_params.sockaddr.addr    = (const struct sockaddr*)&addr;
+    ep_params.sockaddr.addrlen = sizeof(addr);
+
+    start = ucs_get_time();
+    for (i = 0; i < num_conns; ++i) {
+        create_time[i] = ucs_get_time();
+        status         = ucp_ep_create(client_worker, &ep_params,
+                                       &client_eps[i]);
+        if (status != UCS_OK) {
+            fprintf(stderr, "failed to create client ep %u: %s\n", i,
+                    ucs_status_string(status));
+            goto out_close_eps;
+        }
+
+        /* The header must stay valid until the endpoint is connected and
+         * the message is sent */
+        conn_ids[i] = i;
+        req         = ucp_am_send_nbx(client_eps[i], TEST_AM_ID, &conn_ids[i],
+                                      sizeof(conn_ids[i]), NULL, 0,
+                                      &send_param);
+        if (UCS_PTR_IS_ERR(req)) {
+            status = UCS_PTR_STATUS(req);
+            ++i;
+            goto out_close_eps;
+        } else if (req != NULL) {
+            ucp_request_free(req);
+        }
+
+        ucp_worker_progress(client_worker);
+        ucp_worker_progress(server.worker);
+    }
+
+    while ((server.num_received < num_conns) && (server.status == UCS_OK)) {
+        ucp_worker_progress(client_worker);
+        ucp_worker_progress(server.worker);
+    }
+
+    end    = ucs_get_time();
+    status = server.status;
+    if (status != UCS_OK) {
+        fprintf(stderr, "server failed: %s\n", ucs_status_string(status));
+        goto out_close_eps;
+    }
+
+    ttfm     = 0;
+    ttfm_max = 0;
+    for (i = 0; i < num_conns; ++i) {
+        ttfm    += server.first_msg_time[i] - create_time[i];
+        ttfm_max = ucs_max(ttfm_max, server.first_msg_time[i] - create_time[i]);
+    }
+
+    elapsed = ucs_time_to_sec(end - start);
+    printf("connections:                %u\n", num_conns);
+    printf("total time:                 %.3f sec\n", elapsed);
+    printf("connection rate:            %.0f conn/sec\n", num_conns / elapsed);
+    printf("time to first message avg:  %.1f usec\n",
+           ucs_time_to_usec(ttfm) / num_conns);
+    printf("time to first message max:  %.1f usec\n",
+           ucs_time_to_usec(ttfm_max));
+    ret = 0;
+
+out_close_eps:
+    test_close_eps(client_worker, server.worker, client_eps, i);
+    test_close_eps(server.worker, client_worker, server.eps, server.num_eps);
+out_destroy_listener:
+    ucp_listener_destroy(listener);
+out_destroy_client_worker:
+    ucp_worker_destroy(client_worker);
+out_destroy_server_worker:
+    ucp_worker_destroy(server.worker);
+out_cleanup:
+    ucp_cleanup(context);
+out_free:
+    free(conn_ids);
+    free(create_time);
+    free(client_eps);
+    free(server.first_msg_time);
+    free(server.eps);
+    return ret;
+}
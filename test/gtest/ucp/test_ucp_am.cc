@@ -1896,6 +1896,124 @@ UCS_TEST_P(test_ucp_am_nbx_rndv, rndv_am_bcopy, "RNDV_SCHEME=am")
 
 UCP_INSTANTIATE_TEST_CASE(test_ucp_am_nbx_rndv);
 
+class test_ucp_am_nbx_recv_pool : public test_ucp_am_nbx {
+public:
+    test_ucp_am_nbx_recv_pool() : m_recv_attr(0), m_rx_data(NULL)
+    {
+        modify_config("RNDV_THRESH", "1024");
+    }
+
+    static ucs_status_t
+    am_recv_pool_cb(void *arg, const void *header, size_t header_length,
+                    void *data, size_t length, const ucp_am_recv_param_t *param)
+    {
+        test_ucp_am_nbx_recv_pool *self =
+                reinterpret_cast<test_ucp_am_nbx_recv_pool*>(arg);
+
+        self->m_recv_attr = param->recv_attr;
+        self->check_header(header, header_length);
+        if (param->recv_attr & UCP_AM_RECV_ATTR_FLAG_DATA) {
+            mem_buffer::pattern_check(data, length, SEED);
+            self->m_rx_data = data;
+            self->m_recv_counter++;
+            return UCS_INPROGRESS;
+        }
+
+        /* Pool is not used, drop the message */
+        self->m_recv_counter++;
+        return UCS_OK;
+    }
+
+    void create_pool(size_t max_size, unsigned max_buffers)
+    {
+        std::vector<size_t> sizes = {max_size, max_size / 4};
+        ucp_am_recv_pool_params_t params;
+
+        params.field_mask  = UCP_AM_RECV_POOL_PARAM_FIELD_SIZES |
+                             UCP_AM_RECV_POOL_PARAM_FIELD_MAX_BUFFERS;
+        params.sizes       = sizes.data();
+        params.num_sizes   = sizes.size();
+        params.max_buffers = max_buffers;
+        ASSERT_UCS_OK(ucp_worker_am_recv_pool_create(receiver().worker(),
+                                                     &params));
+        EXPECT_EQ(UCS_ERR_ALREADY_EXISTS,
+                  ucp_worker_am_recv_pool_create(receiver().worker(),
+                                                 &params));
+
+        set_am_data_handler(receiver(), TEST_AM_NBX_ID, am_recv_pool_cb, this,
+                            UCP_AM_FLAG_RECV_POOL);
+    }
+
+    void send_recv(size_t size)
+    {
+        std::vector<char> sbuf(size);
+        ucs::fill_random(m_hdr);
+        mem_buffer::pattern_fill(sbuf.data(), size, SEED);
+
+        reset_counters();
+        m_rx_data   = NULL;
+        m_recv_attr = 0;
+
+        ucp::data_type_desc_t sdt_desc(m_dt, sbuf.data(), size);
+        ucs_status_ptr_t sptr = send_am(sdt_desc, UCP_AM_SEND_FLAG_RNDV,
+                                        m_hdr.data(), m_hdr.size());
+        wait_receives();
+        EXPECT_EQ(UCS_OK, request_wait(sptr));
+    }
+
+protected:
+    static const size_t POOL_SIZE = 64 * UCS_KBYTE;
+
+    uint64_t m_recv_attr;
+    void     *m_rx_data;
+};
+
+UCS_TEST_P(test_ucp_am_nbx_recv_pool, recv)
+{
+    m_hdr.resize(16);
+    create_pool(POOL_SIZE, 2);
+
+    for (size_t size : {(size_t)1, POOL_SIZE / 8, POOL_SIZE - m_hdr.size()}) {
+        send_recv(size);
+        EXPECT_TRUE(m_recv_attr & UCP_AM_RECV_ATTR_FLAG_DATA);
+        EXPECT_FALSE(m_recv_attr & UCP_AM_RECV_ATTR_FLAG_RNDV);
+        ASSERT_NE((void*)NULL, m_rx_data);
+        ucp_am_data_release(receiver().worker(), m_rx_data);
+    }
+}
+
+UCS_TEST_P(test_ucp_am_nbx_recv_pool, fallback)
+{
+    std::vector<void*> rx_data;
+
+    create_pool(POOL_SIZE, 1);
+
+    /* Larger than the largest size class */
+    send_recv(POOL_SIZE + 1);
+    EXPECT_TRUE(m_recv_attr & UCP_AM_RECV_ATTR_FLAG_RNDV);
+
+    /* Both size classes are used, the pool is exhausted while the user holds
+     * the buffers */
+    for (int i = 0; i < 2; ++i) {
+        send_recv(POOL_SIZE / 8);
+        EXPECT_TRUE(m_recv_attr & UCP_AM_RECV_ATTR_FLAG_DATA);
+        rx_data.push_back(m_rx_data);
+    }
+
+    send_recv(POOL_SIZE / 8);
+    EXPECT_TRUE(m_recv_attr & UCP_AM_RECV_ATTR_FLAG_RNDV);
+
+    for (void *data : rx_data) {
+        ucp_am_data_release(receiver().worker(), data);
+    }
+
+    send_recv(POOL_SIZE / 8);
+    EXPECT_TRUE(m_recv_attr & UCP_AM_RECV_ATTR_FLAG_DATA);
+    ucp_am_data_release(receiver().worker(), m_rx_data);
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_am_nbx_recv_pool);
+
 class test_ucp_am_nbx_rndv_memtype : public test_ucp_am_nbx_rndv {
 public:
     static void get_test_variants(variant_vec_t &variants)
@@ -7,6 +7,8 @@
 
 #include "test_ucp_memheap.h"
 
+#include <algorithm>
+
 extern "C" {
 #include <ucp/core/ucp_types.h> /* for atomic mode */
 #include <ucp/core/ucp_mm.h>
@@ -307,3 +309,74 @@ UCS_TEST_P(test_ucp_atomic64, misaligned_post) {
 #endif
 
 UCP_INSTANTIATE_TEST_CASE_GPU_AWARE(test_ucp_atomic64)
+
+
+class test_ucp_atomic_sw_batch : public ucp_test {
+public:
+    static void get_test_variants(std::vector<ucp_test_variant>& variants)
+    {
+        add_variant_with_value(variants, UCP_FEATURE_AMO64, 1, "nobatch");
+        add_variant_with_value(variants, UCP_FEATURE_AMO64,
+                               UCP_AMO_SW_BATCH_MAX, "batch");
+    }
+
+protected:
+    virtual void init()
+    {
+        /* Transports without device atomics fall back to software emulation */
+        modify_config("ATOMIC_MODE", "device");
+        modify_config("SW_AMO_BATCH", ucs::to_string(get_variant_value()));
+        ucp_test::init();
+        sender().connect(&receiver(), get_ep_params());
+    }
+
+    ucs_status_ptr_t atomic_add(uint64_t *target, ucp_rkey_h rkey,
+                                uint64_t *result)
+    {
+        static uint64_t value     = 1;
+        ucp_request_param_t param = {};
+
+        param.op_attr_mask = UCP_OP_ATTR_FIELD_DATATYPE;
+        param.datatype     = ucp_dt_make_contig(sizeof(value));
+        if (result != NULL) {
+            param.op_attr_mask |= UCP_OP_ATTR_FIELD_REPLY_BUFFER;
+            param.reply_buffer  = result;
+        }
+
+        return ucp_atomic_op_nbx(sender().ep(), UCP_ATOMIC_OP_ADD, &value, 1,
+                                 (uintptr_t)target, rkey, &param);
+    }
+};
+
+UCS_TEST_P(test_ucp_atomic_sw_batch, add_fadd) {
+    const size_t num_ops = 10000 / ucs::test_time_multiplier();
+    mapped_buffer buffer(sizeof(uint64_t), receiver());
+    uint64_t *target = static_cast<uint64_t*>(buffer.ptr());
+    std::vector<uint64_t> results(num_ops);
+    std::vector<void*> reqs;
+
+    *target = 0;
+
+    ucs::handle<ucp_rkey_h> rkey;
+    buffer.rkey(sender(), rkey);
+
+    /* Issue many atomics without waiting, so some of them are sent while the
+     * endpoint is out of resources */
+    for (size_t i = 0; i < num_ops; ++i) {
+        reqs.push_back(atomic_add(target, rkey, &results[i]));
+        reqs.push_back(atomic_add(target, rkey, NULL));
+    }
+
+    ASSERT_UCS_OK(requests_wait(reqs));
+    flush_ep(sender());
+
+    EXPECT_EQ(2 * num_ops, *target);
+
+    /* Every fetch must observe a different value of the counter */
+    std::sort(results.begin(), results.end());
+    EXPECT_EQ(results.end(), std::adjacent_find(results.begin(),
+                                                results.end()));
+    EXPECT_GT(2 * num_ops, results.back());
+}
+
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_atomic_sw_batch, tcp, "tcp")
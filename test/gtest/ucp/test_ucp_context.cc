@@ -56,6 +56,27 @@ UCS_TEST_P(test_ucp_context, minimal_field_mask) {
     }
 }
 
+UCS_TEST_P(test_ucp_context, release_idle_lanes_without_tracker) {
+    ucs::handle<ucp_config_t*> config;
+    UCS_TEST_CREATE_HANDLE(ucp_config_t*, config, ucp_config_release,
+                           ucp_config_read, NULL, NULL);
+
+    /* The usage tracker is disabled by default */
+    ASSERT_UCS_OK(ucp_config_modify(config.get(), "EP_RELEASE_IDLE_LANES",
+                                    "y"));
+
+    ucp_context_h ucph;
+    ucs_status_t status;
+    {
+        scoped_log_handler wrap_err(wrap_errors_logger);
+        status = ucp_init(&get_variant_ctx_params(), config.get(), &ucph);
+    }
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM, status);
+    if (status == UCS_OK) {
+        ucp_cleanup(ucph);
+    }
+}
+
 UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_context, all, "all")
 
 class test_ucp_aliases : public test_ucp_context {
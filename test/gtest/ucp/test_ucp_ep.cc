@@ -5,7 +5,11 @@
  */
 
 #include "ucp_test.h"
+
+extern "C" {
 #include <ucp/core/ucp_context.h>
+#include <ucp/core/ucp_ep.inl>
+}
 
 class test_ucp_ep : public ucp_test {
 public:
@@ -93,3 +97,105 @@ UCS_TEST_P(test_ucp_ep, ucp_query_transport)
 }
 
 UCP_INSTANTIATE_TEST_CASE(test_ucp_ep);
+
+
+class test_ucp_ep_release_idle_lanes : public test_ucp_ep {
+public:
+    test_ucp_ep_release_idle_lanes()
+    {
+        modify_config("EP_RELEASE_IDLE_LANES", "y");
+        modify_config("DYNAMIC_TL_SWITCH_INTERVAL", "1us");
+        modify_config("DYNAMIC_TL_PROGRESS_FACTOR", "1");
+    }
+
+    virtual void init()
+    {
+        test_ucp_ep::init();
+        /* Second endpoint to the same peer, which stays idle */
+        sender().connect(&receiver(), get_ep_params(), 1);
+    }
+
+protected:
+    unsigned num_released_lanes(ucp_ep_h ep)
+    {
+        unsigned count = 0;
+
+        for (ucp_lane_index_t lane = 0; lane < ucp_ep_num_lanes(ep); ++lane) {
+            if (ucp_ep_is_lane_released(ucp_ep_get_lane(ep, lane))) {
+                ++count;
+            }
+        }
+
+        return count;
+    }
+
+    void send_recv(ucp_ep_h ep, size_t size)
+    {
+        std::string send_buf(size, 'x');
+        std::string recv_buf(size, 0);
+        ucp_request_param_t param;
+
+        param.op_attr_mask = 0;
+        void *rreq = ucp_tag_recv_nbx(receiver().worker(), &recv_buf[0], size,
+                                      TAG, TAG_MASK, &param);
+        void *sreq = ucp_tag_send_nbx(ep, &send_buf[0], size, TAG, &param);
+        ASSERT_UCS_OK(requests_wait({sreq, rreq}));
+        EXPECT_EQ(send_buf, recv_buf);
+    }
+
+    /* Keep the first endpoint busy, so the usage tracker runs rounds, until
+     * it releases the lanes of the idle endpoint */
+    void wait_for_release(ucp_ep_h idle_ep)
+    {
+        ucs_time_t deadline = ucs_get_time() + ucs_time_from_sec(10.0);
+
+        while ((num_released_lanes(idle_ep) == 0) &&
+               (ucs_get_time() < deadline)) {
+            send_recv(sender().ep(), BUSY_SIZE);
+            progress();
+        }
+
+        ASSERT_GT(num_released_lanes(idle_ep), 0u);
+        EXPECT_EQ(0u, num_released_lanes(sender().ep()));
+    }
+
+    static const ucp_tag_t TAG       = 0x1337;
+    static const ucp_tag_t TAG_MASK  = (ucp_tag_t)-1;
+    /* Large enough to be sent by a protocol which is tracked */
+    static const size_t    BUSY_SIZE = 4 * UCS_KBYTE;
+};
+
+UCS_TEST_P(test_ucp_ep_release_idle_lanes, never_used)
+{
+    ucp_ep_h idle_ep = sender().ep(0, 1);
+
+    wait_for_release(idle_ep);
+
+    /* The next operation restores the released lanes */
+    send_recv(idle_ep, 1);
+    EXPECT_EQ(0u, num_released_lanes(idle_ep));
+}
+
+UCS_TEST_P(test_ucp_ep_release_idle_lanes, used_then_idle)
+{
+    static const size_t sizes[] = {8, 4 * UCS_KBYTE, 256 * UCS_KBYTE};
+    ucp_ep_h idle_ep            = sender().ep(0, 1);
+
+    for (size_t i = 0; i < ucs_static_array_size(sizes); ++i) {
+        for (int j = 0; j < 100; ++j) {
+            send_recv(idle_ep, BUSY_SIZE);
+        }
+
+        wait_for_release(idle_ep);
+        send_recv(idle_ep, sizes[i]);
+        EXPECT_EQ(0u, num_released_lanes(idle_ep));
+    }
+}
+
+UCS_TEST_P(test_ucp_ep_release_idle_lanes, destroy_released)
+{
+    wait_for_release(sender().ep(0, 1));
+    /* The endpoint is destroyed with released lanes during cleanup */
+}
+
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_ep_release_idle_lanes, shm, "shm")
@@ -441,3 +441,50 @@ UCS_TEST_P(test_ucp_wait_mem, envelope) {
 }
 
 UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_wait_mem, shm, "shm")
+
+
+class test_ucp_sw_amo_batch : public test_ucp_perf {
+public:
+    static void get_test_variants(std::vector<ucp_test_variant> &variants)
+    {
+        add_variant(variants, 0);
+    }
+
+protected:
+    double run_amo_add(unsigned batch)
+    {
+        const test_spec test = { "software atomic add", "Mpps",
+                                 UCX_PERF_API_UCP, UCX_PERF_CMD_ADD,
+                                 UCX_PERF_TEST_TYPE_STREAM_UNI,
+                                 UCX_PERF_WAIT_MODE_POLL,
+                                 UCP_PERF_DATATYPE_CONTIG,
+                                 0, 1, { 8 }, 1, 100000lu,
+                                 ucs_offsetof(ucx_perf_result_t,
+                                              msgrate.total_average),
+                                 1e-6, 0, 0, 0,
+                                 UCS_MEMORY_TYPE_HOST,
+                                 UCS_MEMORY_TYPE_HOST };
+        /* coverity[tainted_string_argument] */
+        ucs::scoped_setenv sw_amo_batch("UCX_SW_AMO_BATCH",
+                                        ucs::to_string(batch).c_str());
+
+        return run_test(test, 0, false, "", "");
+    }
+};
+
+UCS_TEST_P(test_ucp_sw_amo_batch, envelope) {
+    std::stringstream ss;
+    ss << GetParam().transports;
+    /* coverity[tainted_string_argument] */
+    ucs::scoped_setenv tls("UCX_TLS", ss.str().c_str());
+    /* Transports without device atomics fall back to software emulation */
+    ucs::scoped_setenv atomic_mode("UCX_ATOMIC_MODE", "device");
+
+    double single  = run_amo_add(1);
+    double batched = run_amo_add(16);
+
+    UCS_TEST_MESSAGE << "software atomic add: " << single << " Mpps, batched: "
+                     << batched << " Mpps";
+}
+
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_sw_amo_batch, tcp, "tcp")
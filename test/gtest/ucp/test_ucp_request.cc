@@ -102,6 +102,49 @@ UCS_TEST_P(test_ucp_request, test_request_query)
     }
 }
 
+UCS_TEST_P(test_ucp_request, send_imm_cmpl_reuse)
+{
+    static const size_t size = 1024;
+    ucp_request_t *prev_req  = NULL;
+    unsigned num_reused      = 0;
+    ucp_request_param_t param;
+
+    if (m_mem_type != UCS_MEMORY_TYPE_HOST) {
+        UCS_TEST_SKIP_R("not host memory");
+    }
+
+    std::string sbuf(size, 'x'), rbuf(size, 0);
+    param.op_attr_mask = 0;
+
+    for (int i = 0; i < 10; ++i) {
+        void *rreq = ucp_tag_recv_nbx(receiver().worker(), &rbuf[0], size, 0,
+                                      0, &param);
+        void *sreq = ucp_tag_send_nbx(sender().ep(), sbuf.c_str(), size, 0,
+                                      &param);
+        if (UCS_PTR_IS_PTR(sreq)) {
+            /* The request escaped to the user, the slot starts over */
+            prev_req = NULL;
+        } else {
+            ASSERT_UCS_OK(UCS_PTR_STATUS(sreq));
+            /* A send which completed immediately reuses the request kept in
+             * the worker slot by the previous one */
+            ucp_request_t *req = sender().worker()->req_slot;
+            if ((prev_req != NULL) && (req != NULL)) {
+                EXPECT_EQ(prev_req, req);
+                ++num_reused;
+            }
+            prev_req = req;
+        }
+
+        request_wait(sreq);
+        request_wait(rreq);
+        EXPECT_EQ(sbuf, rbuf);
+        rbuf.assign(size, 0);
+    }
+
+    UCS_TEST_MESSAGE << "reused the slot request " << num_reused << " times";
+}
+
 UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_request, all, "all")
 
 class test_proto_reset : public ucp_test {
@@ -11,6 +11,7 @@ extern "C" {
 #include <ucp/core/ucp_context.h>
 #include <ucp/core/ucp_mm.h> /* for UCP_MEM_IS_ACCESSIBLE_FROM_CPU */
 #include <ucp/core/ucp_ep.inl>
+#include <ucp/proto/proto_select.inl>
 #include <ucs/sys/sys.h>
 }
 
@@ -484,3 +485,371 @@ UCS_TEST_P(test_ucp_rma_order, put_ordering) {
 // TODO: Strong fence hangs with SW RMA emulation, because it requires progress
 // on both peers. Add other tls, when fence implementation revised
 UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_rma_order, shm_rc_dc, "self,shm,rc,dc")
+
+
+class test_ucp_rma_batch : public test_ucp_rma {
+public:
+    static void get_test_variants(std::vector<ucp_test_variant>& variants) {
+        add_variant(variants, UCP_FEATURE_RMA);
+    }
+
+    virtual void init() {
+        test_ucp_memheap::init();
+    }
+
+protected:
+    static void send_callback(void *request, ucs_status_t status,
+                              void *user_data) {
+        ++(*static_cast<unsigned*>(user_data));
+    }
+
+    void test_batch(size_t elem_size, size_t count) {
+        mem_buffer sbuf(elem_size * count, UCS_MEMORY_TYPE_HOST);
+        mapped_buffer rbuf(elem_size * count, receiver());
+        std::vector<ucp_put_batch_elem_t> elems(count);
+        ucp_request_param_t param;
+        unsigned completed = 0;
+
+        sbuf.pattern_fill(ucs::rand());
+        rbuf.memset(0);
+
+        ucs::handle<ucp_rkey_h> rkey;
+        rbuf.rkey(sender(), rkey);
+
+        /* Post the elements in reverse order to different offsets */
+        for (size_t i = 0; i < count; ++i) {
+            size_t offset         = (count - i - 1) * elem_size;
+            elems[i].ep           = sender().ep();
+            elems[i].buffer       = UCS_PTR_BYTE_OFFSET(sbuf.ptr(), offset);
+            elems[i].length       = elem_size;
+            elems[i].remote_addr  = (uintptr_t)rbuf.ptr() + offset;
+            elems[i].rkey         = rkey;
+        }
+
+        param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                             UCP_OP_ATTR_FIELD_USER_DATA;
+        param.cb.send      = send_callback;
+        param.user_data    = &completed;
+
+        ucs_status_ptr_t sptr = ucp_put_batch_nbx(sender().worker(),
+                                                  &elems[0], count, &param);
+        bool in_progress      = UCS_PTR_IS_PTR(sptr);
+        ASSERT_UCS_OK(request_wait(sptr));
+        /* The callback is called once, only if the batch did not complete
+         * immediately */
+        EXPECT_EQ(in_progress ? 1u : 0u, completed);
+
+        flush_worker(sender());
+        EXPECT_EQ(0, memcmp(sbuf.ptr(), rbuf.ptr(), elem_size * count));
+    }
+};
+
+UCS_TEST_P(test_ucp_rma_batch, put_short) {
+    test_batch(8, 256);
+}
+
+UCS_TEST_P(test_ucp_rma_batch, put_bcopy) {
+    test_batch(4 * UCS_KBYTE, 32);
+}
+
+UCS_TEST_P(test_ucp_rma_batch, put_zcopy, "ZCOPY_THRESH=0") {
+    test_batch(64 * UCS_KBYTE, 8);
+}
+
+UCS_TEST_P(test_ucp_rma_batch, empty) {
+    ucp_request_param_t param;
+
+    param.op_attr_mask = 0;
+    EXPECT_EQ(UCS_OK, UCS_PTR_STATUS(ucp_put_batch_nbx(sender().worker(), NULL,
+                                                       0, &param)));
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_rma_batch)
+
+class test_ucp_rma_counter : public test_ucp_rma {
+public:
+    static void get_test_variants(std::vector<ucp_test_variant>& variants) {
+        /* Other operations are enabled to check they reject the counter */
+        add_variant(variants, UCP_FEATURE_RMA | UCP_FEATURE_AMO64 |
+                              UCP_FEATURE_TAG | UCP_FEATURE_AM |
+                              UCP_FEATURE_STREAM);
+    }
+
+    virtual void init() {
+        test_ucp_memheap::init();
+        ASSERT_UCS_OK(ucp_counter_create(sender().worker(), &m_counter));
+    }
+
+    virtual void cleanup() {
+        ucp_counter_destroy(m_counter);
+        test_ucp_memheap::cleanup();
+    }
+
+protected:
+    /* Software RMA emulation requires progress on the target as well, so
+     * progress both sides before calling the blocking wait */
+    ucs_status_t wait_counter(uint64_t value) {
+        ucs_time_t deadline = ucs_get_time() + ucs_time_from_sec(10.0);
+        while ((ucp_counter_read(m_counter, NULL) < value) &&
+               (ucs_get_time() < deadline)) {
+            progress();
+        }
+
+        return ucp_counter_wait(m_counter, value);
+    }
+
+    void test_put_get(size_t size, unsigned count) {
+        mem_buffer sbuf(size * count, UCS_MEMORY_TYPE_HOST);
+        mem_buffer gbuf(size * count, UCS_MEMORY_TYPE_HOST);
+        mapped_buffer rbuf(size * count, receiver());
+        ucp_request_param_t param;
+
+        sbuf.pattern_fill(ucs::rand());
+        gbuf.memset(0);
+        rbuf.memset(0);
+
+        ucs::handle<ucp_rkey_h> rkey;
+        rbuf.rkey(sender(), rkey);
+
+        param.op_attr_mask = UCP_OP_ATTR_FIELD_COUNTER;
+        param.counter      = m_counter;
+
+        uint64_t start = ucp_counter_read(m_counter, NULL);
+        for (unsigned i = 0; i < count; ++i) {
+            size_t offset    = i * size;
+            ucs_status_ptr_t sptr;
+
+            sptr = ucp_put_nbx(sender().ep(),
+                               UCS_PTR_BYTE_OFFSET(sbuf.ptr(), offset), size,
+                               (uintptr_t)rbuf.ptr() + offset, rkey, &param);
+            /* A request handle is never returned */
+            ASSERT_EQ(NULL, sptr);
+        }
+
+        ASSERT_UCS_OK(wait_counter(start + count));
+        flush_worker(sender());
+        EXPECT_EQ(0, memcmp(sbuf.ptr(), rbuf.ptr(), size * count));
+
+        for (unsigned i = 0; i < count; ++i) {
+            size_t offset = i * size;
+
+            ASSERT_EQ(NULL, ucp_get_nbx(sender().ep(),
+                                        UCS_PTR_BYTE_OFFSET(gbuf.ptr(), offset),
+                                        size, (uintptr_t)rbuf.ptr() + offset,
+                                        rkey, &param));
+        }
+
+        ASSERT_UCS_OK(wait_counter(start + (2 * count)));
+        EXPECT_EQ(0, memcmp(sbuf.ptr(), gbuf.ptr(), size * count));
+        EXPECT_EQ(start + (2 * count), ucp_counter_read(m_counter, NULL));
+    }
+
+    ucp_counter_h m_counter;
+};
+
+UCS_TEST_P(test_ucp_rma_counter, short_msg) {
+    test_put_get(8, 100);
+}
+
+UCS_TEST_P(test_ucp_rma_counter, bcopy) {
+    test_put_get(4 * UCS_KBYTE, 32);
+}
+
+UCS_TEST_P(test_ucp_rma_counter, zcopy, "ZCOPY_THRESH=0") {
+    test_put_get(64 * UCS_KBYTE, 8);
+}
+
+UCS_TEST_P(test_ucp_rma_counter, zero_length) {
+    ucp_request_param_t param;
+    ucs_status_t status;
+
+    param.op_attr_mask = UCP_OP_ATTR_FIELD_COUNTER;
+    param.counter      = m_counter;
+    EXPECT_EQ(NULL, ucp_put_nbx(sender().ep(), NULL, 0, 0, NULL, &param));
+    EXPECT_EQ(1u, ucp_counter_read(m_counter, &status));
+    EXPECT_UCS_OK(status);
+}
+
+UCS_TEST_P(test_ucp_rma_counter, invalid_param) {
+    ucp_request_param_t param;
+    uint64_t data;
+
+    param.op_attr_mask = UCP_OP_ATTR_FIELD_COUNTER |
+                         UCP_OP_ATTR_FLAG_NO_IMM_CMPL;
+    param.counter      = m_counter;
+
+    scoped_log_handler wrap_err(wrap_errors_logger);
+    ucs_status_ptr_t sptr = ucp_put_nbx(sender().ep(), &data, sizeof(data),
+                                        0, NULL, &param);
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM, UCS_PTR_STATUS(sptr));
+    EXPECT_EQ(0u, ucp_counter_read(m_counter, NULL));
+}
+
+UCS_TEST_P(test_ucp_rma_counter, non_rma_op) {
+    uint64_t data = 0, result;
+    ucp_request_param_t param;
+    size_t length;
+
+    mapped_buffer rbuf(sizeof(data), receiver());
+    ucs::handle<ucp_rkey_h> rkey;
+    rbuf.rkey(sender(), rkey);
+
+    param.op_attr_mask = UCP_OP_ATTR_FIELD_COUNTER;
+    param.counter      = m_counter;
+
+    scoped_log_handler wrap_err(wrap_errors_logger);
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM,
+              UCS_PTR_STATUS(ucp_tag_send_nbx(sender().ep(), &data,
+                                              sizeof(data), 0, &param)));
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM,
+              UCS_PTR_STATUS(ucp_tag_recv_nbx(sender().worker(), &data,
+                                              sizeof(data), 0, 0, &param)));
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM,
+              UCS_PTR_STATUS(ucp_am_send_nbx(sender().ep(), 0, NULL, 0, &data,
+                                             sizeof(data), &param)));
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM,
+              UCS_PTR_STATUS(ucp_stream_send_nbx(sender().ep(), &data,
+                                                 sizeof(data), &param)));
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM,
+              UCS_PTR_STATUS(ucp_stream_recv_nbx(sender().ep(), &data,
+                                                 sizeof(data), &length,
+                                                 &param)));
+
+    param.op_attr_mask |= UCP_OP_ATTR_FIELD_DATATYPE |
+                          UCP_OP_ATTR_FIELD_REPLY_BUFFER;
+    param.datatype      = ucp_dt_make_contig(sizeof(data));
+    param.reply_buffer  = &result;
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM,
+              UCS_PTR_STATUS(ucp_atomic_op_nbx(sender().ep(),
+                                               UCP_ATOMIC_OP_ADD, &data, 1,
+                                               (uintptr_t)rbuf.ptr(), rkey,
+                                               &param)));
+
+    EXPECT_EQ(0u, ucp_counter_read(m_counter, NULL));
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_rma_counter)
+
+class test_ucp_rma_rkey_ptr : public test_ucp_memheap {
+public:
+    static void get_test_variants(std::vector<ucp_test_variant>& variants) {
+        add_variant(variants, UCP_FEATURE_RMA | UCP_FEATURE_AMO64);
+    }
+
+    virtual void init() {
+        /* Do not select shared memory transports for atomic offload, so
+         * atomics are performed on the mapped target memory */
+        modify_config("ATOMIC_MODE", "device");
+        test_ucp_memheap::init();
+        if (!is_proto_enabled()) {
+            UCS_TEST_SKIP_R("rkey_ptr RMA protocols require PROTO_ENABLE");
+        }
+    }
+
+protected:
+    /* Allocate the target buffer from a memory domain which is able to map
+     * it to the peer process */
+    void *mem_alloc(size_t size, ucp_mem_h *memh_p) {
+        ucp_mem_map_params_t params;
+        ucp_mem_attr_t attr;
+
+        params.field_mask = UCP_MEM_MAP_PARAM_FIELD_LENGTH |
+                            UCP_MEM_MAP_PARAM_FIELD_FLAGS;
+        params.length     = size;
+        params.flags      = UCP_MEM_MAP_ALLOCATE;
+        ASSERT_UCS_OK(ucp_mem_map(receiver().ucph(), &params, memh_p));
+
+        attr.field_mask = UCP_MEM_ATTR_FIELD_ADDRESS;
+        ASSERT_UCS_OK(ucp_mem_query(*memh_p, &attr));
+        return attr.address;
+    }
+
+    void check_proto(ucp_rkey_h rkey, ucp_operation_id_t op_id,
+                     size_t length) {
+        ucp_worker_h worker = sender().worker();
+        ucp_proto_select_t *proto_select =
+                &worker->rkey_config[rkey->cfg_index].proto_select;
+        const ucp_proto_config_t *proto_config;
+        ucp_proto_select_elem_t value;
+        ucp_proto_select_key_t key;
+        size_t count = 0;
+
+        kh_foreach(proto_select->hash, key.u64, value, {
+            if (ucp_proto_select_op_id(&key.param) != op_id) {
+                continue;
+            }
+
+            unsigned idx = 0;
+            while (length > value.thresholds[idx].max_msg_length) {
+                ++idx;
+            }
+
+            proto_config = &value.thresholds[idx].proto_config;
+            EXPECT_NE(nullptr, strstr(proto_config->proto->name, "rkey_ptr"))
+                    << proto_config->proto->name;
+            ++count;
+        });
+
+        EXPECT_GT(count, 0u);
+    }
+};
+
+UCS_TEST_P(test_ucp_rma_rkey_ptr, put_get_atomic) {
+    static const size_t size = 100000;
+    ucp_request_param_t param;
+    ucs_status_ptr_t sptr;
+    ucp_mem_h memh;
+    void *rkey_buffer;
+    size_t rkey_size;
+    ucp_rkey_h rkey;
+    uint64_t value, result;
+
+    uint8_t *target = static_cast<uint8_t*>(mem_alloc(size, &memh));
+    ASSERT_UCS_OK(ucp_rkey_pack(receiver().ucph(), memh, &rkey_buffer,
+                                &rkey_size));
+    ASSERT_UCS_OK(ucp_ep_rkey_unpack(sender().ep(), rkey_buffer, &rkey));
+    ucp_rkey_buffer_release(rkey_buffer);
+
+    if (ucp_ep_config(sender().ep())->key.rkey_ptr_lane == UCP_NULL_LANE) {
+        ucp_rkey_destroy(rkey);
+        ucp_mem_unmap(receiver().ucph(), memh);
+        UCS_TEST_SKIP_R("no rkey_ptr lane");
+    }
+
+    std::vector<uint8_t> sbuf(size), rbuf(size);
+    ucs::fill_random(sbuf);
+
+    /* The operations complete immediately, without progress on the target */
+    param.op_attr_mask = 0;
+    sptr = ucp_put_nbx(sender().ep(), sbuf.data(), size, (uintptr_t)target,
+                       rkey, &param);
+    EXPECT_EQ(UCS_OK, UCS_PTR_STATUS(sptr));
+    EXPECT_EQ(0, memcmp(sbuf.data(), target, size));
+    check_proto(rkey, UCP_OP_ID_PUT, size);
+
+    memset(target, 0x5a, size);
+    sptr = ucp_get_nbx(sender().ep(), rbuf.data(), size, (uintptr_t)target,
+                       rkey, &param);
+    ASSERT_UCS_OK(request_wait(sptr));
+    EXPECT_EQ(std::vector<uint8_t>(size, 0x5a), rbuf);
+    check_proto(rkey, UCP_OP_ID_GET, size);
+
+    *reinterpret_cast<uint64_t*>(target) = 5;
+    value               = 3;
+    param.op_attr_mask  = UCP_OP_ATTR_FIELD_DATATYPE |
+                          UCP_OP_ATTR_FIELD_REPLY_BUFFER;
+    param.datatype      = ucp_dt_make_contig(sizeof(value));
+    param.reply_buffer  = &result;
+    sptr = ucp_atomic_op_nbx(sender().ep(), UCP_ATOMIC_OP_ADD, &value, 1,
+                             (uintptr_t)target, rkey, &param);
+    ASSERT_UCS_OK(request_wait(sptr));
+    EXPECT_EQ(5u, result);
+    EXPECT_EQ(8u, *reinterpret_cast<uint64_t*>(target));
+    check_proto(rkey, UCP_OP_ID_AMO_FETCH, sizeof(value));
+
+    flush_worker(sender());
+    ucp_rkey_destroy(rkey);
+    ASSERT_UCS_OK(ucp_mem_unmap(receiver().ucph(), memh));
+}
+
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_rma_rkey_ptr, shm, "shm")
@@ -1303,6 +1303,54 @@ UCS_TEST_SKIP_COND_P(test_ucp_sockaddr, listener_invalid_params,
     ucp_listener_destroy(listener);
 }
 
+UCS_TEST_SKIP_COND_P(test_ucp_sockaddr, listener_reuse_port,
+                     nonparameterized_test())
+{
+    ucp_listener_h listeners[2];
+    ucp_listener_params_t params;
+    ucp_listener_attr_t attr;
+    ucp_listener_h listener;
+    ucs_status_t status;
+    uint16_t port;
+
+    m_test_addr.set_port(0);
+    params.field_mask       = UCP_LISTENER_PARAM_FIELD_SOCK_ADDR |
+                              UCP_LISTENER_PARAM_FIELD_CONN_HANDLER |
+                              UCP_LISTENER_PARAM_FIELD_FLAGS;
+    params.sockaddr.addr    = m_test_addr.get_sock_addr_ptr();
+    params.sockaddr.addrlen = m_test_addr.get_addr_size();
+    params.conn_handler.cb  = (ucp_listener_conn_callback_t)ucs_empty_function;
+    params.conn_handler.arg = NULL;
+    params.flags            = UCP_LISTENER_FLAG_REUSE_PORT;
+
+    status = create_listener_wrap_err(params, listeners[0]);
+    if (status == UCS_ERR_UNSUPPORTED) {
+        UCS_TEST_SKIP_R("no CM supports sharing the listening address");
+    }
+    ASSERT_UCS_OK(status);
+
+    attr.field_mask = UCP_LISTENER_ATTR_FIELD_SOCKADDR;
+    ASSERT_UCS_OK(ucp_listener_query(listeners[0], &attr));
+    ASSERT_UCS_OK(ucs_sockaddr_get_port((const struct sockaddr*)&attr.sockaddr,
+                                        &port));
+    m_test_addr.set_port(port);
+
+    /* another listener sharing the address */
+    status = create_listener_wrap_err(params, listeners[1]);
+    ASSERT_UCS_OK(status);
+
+    /* a listener which does not set the flag cannot use the address */
+    params.flags = 0;
+    status       = create_listener_wrap_err(params, listener);
+    EXPECT_EQ(UCS_ERR_BUSY, status);
+    if (status == UCS_OK) {
+        ucp_listener_destroy(listener);
+    }
+
+    ucp_listener_destroy(listeners[1]);
+    ucp_listener_destroy(listeners[0]);
+}
+
 UCP_INSTANTIATE_ALL_TEST_CASE(test_ucp_sockaddr)
 
 class test_ucp_sockaddr_conn_request : public test_ucp_sockaddr {
@@ -659,6 +659,172 @@ UCS_TEST_P(test_ucp_stream, send_zero_ending_iov_recv_data) {
 
 UCP_INSTANTIATE_TEST_CASE(test_ucp_stream)
 
+class test_ucp_stream_ring : public test_ucp_stream {
+protected:
+    void send_data(std::vector<uint8_t> &pattern, std::vector<void*> &sreqs,
+                   size_t min_size, size_t max_size)
+    {
+        for (size_t size = min_size; size <= max_size; size *= 4) {
+            std::vector<uint8_t> sbuf(size);
+            ucs::fill_random(sbuf);
+            /* Send buffers must not move while the sends are in progress */
+            ASSERT_LE(pattern.size() + size, pattern.capacity());
+            pattern.insert(pattern.end(), sbuf.begin(), sbuf.end());
+
+            ucp::data_type_desc_t dt_desc(DATATYPE, &pattern[pattern.size() -
+                                                              size], size);
+            void *sreq = stream_send_nb(dt_desc);
+            ASSERT_FALSE(UCS_PTR_IS_ERR(sreq));
+            sreqs.push_back(sreq);
+        }
+    }
+
+    /* Consume the ring until the given amount of data is received */
+    std::vector<uint8_t> consume(size_t total)
+    {
+        ucs_time_t deadline = ucs::get_deadline();
+        std::vector<uint8_t> rbuf;
+        size_t length;
+        void *data;
+
+        while ((rbuf.size() < total) && (ucs_get_time() < deadline)) {
+            progress();
+            ASSERT_UCS_OK(ucp_stream_recv_ring_peek(receiver().ep(), &data,
+                                                    &length),
+                          << "rbuf.size()=" << rbuf.size());
+            rbuf.insert(rbuf.end(), static_cast<uint8_t*>(data),
+                        static_cast<uint8_t*>(data) + length);
+            ASSERT_UCS_OK(ucp_stream_recv_ring_consume(receiver().ep(),
+                                                       length));
+        }
+
+        return rbuf;
+    }
+};
+
+UCS_TEST_P(test_ucp_stream_ring, recv) {
+    const size_t ring_size = 64 * UCS_KBYTE;
+    std::vector<uint8_t> ring(ring_size), pattern, rbuf(1);
+    std::vector<void*> sreqs;
+    size_t length;
+
+    pattern.reserve(4 * UCS_MBYTE);
+    ASSERT_UCS_OK(ucp_stream_recv_ring_attach(receiver().ep(), ring.data(),
+                                              ring.size()));
+    EXPECT_EQ(UCS_ERR_BUSY,
+              ucp_stream_recv_ring_attach(receiver().ep(), ring.data(),
+                                          ring.size()));
+
+    /* Send more data than the ring can hold, in bcopy and zcopy sizes */
+    send_data(pattern, sreqs, 1, UCS_MBYTE);
+
+    ucp_request_param_t param;
+    param.op_attr_mask = 0;
+    void *rreq = ucp_stream_recv_nbx(receiver().ep(), rbuf.data(),
+                                     rbuf.size(), &length, &param);
+    EXPECT_EQ(UCS_ERR_BUSY, UCS_PTR_STATUS(rreq));
+    EXPECT_EQ(UCS_ERR_BUSY,
+              UCS_PTR_STATUS(ucp_stream_recv_data_nb(receiver().ep(),
+                                                     &length)));
+
+    EXPECT_EQ(pattern, consume(pattern.size()));
+    requests_wait(sreqs);
+
+    ASSERT_UCS_OK(ucp_stream_recv_ring_detach(receiver().ep()));
+
+    /* Regular receive works again after the ring is detached */
+    std::vector<uint8_t> sbuf(1, 0x5a);
+    ucp::data_type_desc_t dt_desc(DATATYPE, sbuf.data(), sbuf.size());
+    request_wait(stream_send_nb(dt_desc));
+    rreq = ucp_stream_recv_nbx(receiver().ep(), rbuf.data(), rbuf.size(),
+                               &length, &param);
+    ASSERT_UCS_PTR_OK(rreq);
+    if (rreq != NULL) {
+        wait_stream_recv(rreq);
+    }
+    EXPECT_EQ(sbuf, rbuf);
+}
+
+UCS_TEST_P(test_ucp_stream_ring, attach_with_unexpected_data) {
+    std::vector<uint8_t> ring(UCS_KBYTE), pattern;
+    std::vector<void*> sreqs;
+    ucp_stream_poll_ep_t poll_ep;
+    ssize_t count;
+
+    pattern.reserve(64 * UCS_KBYTE);
+    send_data(pattern, sreqs, 1, 16 * UCS_KBYTE);
+    requests_wait(sreqs);
+
+    /* Wait for the data to arrive before the ring is attached */
+    ucs_time_t deadline = ucs::get_deadline();
+    do {
+        progress();
+        count = ucp_stream_worker_poll(receiver().worker(), &poll_ep, 1, 0);
+    } while ((count == 0) && (ucs_get_time() < deadline));
+    ASSERT_EQ(1l, count);
+
+    ASSERT_UCS_OK(ucp_stream_recv_ring_attach(receiver().ep(), ring.data(),
+                                              ring.size()));
+    EXPECT_EQ(UCS_ERR_BUSY, ucp_stream_recv_ring_detach(receiver().ep()));
+    EXPECT_EQ(pattern, consume(pattern.size()));
+    ASSERT_UCS_OK(ucp_stream_recv_ring_detach(receiver().ep()));
+}
+
+UCS_TEST_P(test_ucp_stream_ring, poll_after_partial_consume) {
+    std::vector<uint8_t> ring(UCS_KBYTE), pattern, rbuf;
+    std::vector<void*> sreqs;
+    ucp_stream_poll_ep_t poll_ep;
+    size_t length;
+    void *data;
+
+    ASSERT_UCS_OK(ucp_stream_recv_ring_attach(receiver().ep(), ring.data(),
+                                              ring.size()));
+
+    /* Send more data than the ring can hold */
+    pattern.reserve(2 * ring.size());
+    send_data(pattern, sreqs, ring.size() + (ring.size() / 2),
+              ring.size() + (ring.size() / 2));
+    requests_wait(sreqs);
+
+    /* Wait until the ring is full and the rest is held by the endpoint */
+    ucs_time_t deadline = ucs::get_deadline();
+    while (!(receiver().ep()->flags & UCP_EP_FLAG_STREAM_HAS_DATA) &&
+           (ucs_get_time() < deadline)) {
+        progress();
+    }
+    ASSERT_TRUE(receiver().ep()->flags & UCP_EP_FLAG_STREAM_HAS_DATA);
+
+    /* Consume a part of the ring, so the remaining data is moved to it */
+    ASSERT_UCS_OK(ucp_stream_recv_ring_peek(receiver().ep(), &data, &length));
+    ASSERT_EQ(ring.size(), length);
+    rbuf.insert(rbuf.end(), static_cast<uint8_t*>(data),
+                static_cast<uint8_t*>(data) + (length / 2));
+    ASSERT_UCS_OK(ucp_stream_recv_ring_consume(receiver().ep(), length / 2));
+    EXPECT_FALSE(receiver().ep()->flags & UCP_EP_FLAG_STREAM_HAS_DATA);
+
+    /* The endpoint is still ready while the ring holds unread data */
+    ASSERT_EQ(1l, ucp_stream_worker_poll(receiver().worker(), &poll_ep, 1, 0));
+    EXPECT_EQ(receiver().ep(), poll_ep.ep);
+
+    ASSERT_UCS_OK(ucp_stream_recv_ring_peek(receiver().ep(), &data, &length));
+    rbuf.insert(rbuf.end(), static_cast<uint8_t*>(data),
+                static_cast<uint8_t*>(data) + length);
+    ASSERT_UCS_OK(ucp_stream_recv_ring_consume(receiver().ep(), length));
+
+    /* The unread data may wrap around the end of the ring */
+    ASSERT_UCS_OK(ucp_stream_recv_ring_peek(receiver().ep(), &data, &length));
+    rbuf.insert(rbuf.end(), static_cast<uint8_t*>(data),
+                static_cast<uint8_t*>(data) + length);
+    ASSERT_UCS_OK(ucp_stream_recv_ring_consume(receiver().ep(), length));
+    EXPECT_EQ(pattern, rbuf);
+
+    /* Not ready after all the data is consumed */
+    EXPECT_EQ(0l, ucp_stream_worker_poll(receiver().worker(), &poll_ep, 1, 0));
+    ASSERT_UCS_OK(ucp_stream_recv_ring_detach(receiver().ep()));
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_stream_ring)
+
 class test_ucp_stream_many2one : public test_ucp_stream_base {
 protected:
     struct request_wrapper_t {
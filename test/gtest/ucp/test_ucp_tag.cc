@@ -931,3 +931,239 @@ UCS_TEST_P(test_ucp_tag_nbx, external_request_free)
 }
 
 UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_nbx)
+
+
+class test_ucp_tag_persistent : public test_ucp_tag {
+public:
+    void init()
+    {
+        test_ucp_tag::init();
+        if (!is_proto_enabled()) {
+            UCS_TEST_SKIP_R("persistent send requires protocols v2");
+        }
+    }
+
+protected:
+    static const unsigned NUM_ITERS = 10;
+
+    static void send_callback(void *req, ucs_status_t status, void *user_data)
+    {
+        ucs_atomic_add32((volatile uint32_t*)user_data, 1);
+    }
+
+    ucs_status_t wait_persistent(void *req)
+    {
+        return request_progress(req, {&sender(), &receiver()});
+    }
+
+    ucs_status_t start_wait(void *req)
+    {
+        ucs_status_t status = ucp_request_start(req);
+        if (status != UCS_INPROGRESS) {
+            return status;
+        }
+
+        EXPECT_EQ(UCS_ERR_BUSY, ucp_request_start(req));
+        return wait_persistent(req);
+    }
+
+    void *send_init(const void *buffer, size_t size, ucp_tag_t tag,
+                    uint32_t *completed)
+    {
+        ucp_request_param_t param;
+
+        param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                             UCP_OP_ATTR_FIELD_USER_DATA;
+        param.cb.send      = send_callback;
+        param.user_data    = completed;
+
+        void *req = ucp_tag_send_init_nbx(sender().ep(), buffer, size, tag,
+                                          &param);
+        EXPECT_FALSE(UCS_PTR_IS_ERR(req));
+        return req;
+    }
+
+    void *recv_init(void *buffer, size_t size, ucp_tag_t tag)
+    {
+        ucp_request_param_t param;
+
+        param.op_attr_mask = 0;
+
+        void *req = ucp_tag_recv_init_nbx(receiver().worker(), buffer, size,
+                                          tag, UCP_TAG_MASK_FULL, &param);
+        EXPECT_FALSE(UCS_PTR_IS_ERR(req));
+        return req;
+    }
+
+    void test_xfer(size_t size, bool recv_first)
+    {
+        std::vector<char> send_buffer(size);
+        std::vector<char> recv_buffer(size);
+        uint32_t completed = 0;
+        uint32_t started   = 0;
+        ucp_tag_recv_info_t info;
+
+        void *sreq = send_init(&send_buffer[0], size, 0x11, &completed);
+        void *rreq = recv_init(&recv_buffer[0], size, 0x11);
+        ASSERT_UCS_OK(ucp_request_check_status(sreq));
+
+        for (unsigned i = 0; i < NUM_ITERS; ++i) {
+            ucs::fill_random(send_buffer);
+            if (recv_first) {
+                ASSERT_UCS_OK_OR_INPROGRESS(ucp_request_start(rreq));
+            }
+
+            ucs_status_t status = ucp_request_start(sreq);
+            ASSERT_UCS_OK_OR_INPROGRESS(status);
+            started += (status == UCS_INPROGRESS);
+
+            if (!recv_first) {
+                ASSERT_UCS_OK_OR_INPROGRESS(ucp_request_start(rreq));
+            }
+
+            ASSERT_UCS_OK(wait_persistent(rreq));
+            ASSERT_UCS_OK(wait_persistent(sreq));
+            ASSERT_UCS_OK(ucp_tag_recv_request_test(rreq, &info));
+            EXPECT_EQ(0x11u, info.sender_tag);
+            EXPECT_EQ(size, info.length);
+            EXPECT_EQ(send_buffer, recv_buffer);
+        }
+
+        /* The callback is called only for starts which were in progress */
+        EXPECT_EQ(started, completed);
+
+        ucp_request_free(sreq);
+        ucp_request_free(rreq);
+    }
+};
+
+UCS_TEST_P(test_ucp_tag_persistent, eager_short)
+{
+    test_xfer(8, true);
+    test_xfer(8, false);
+}
+
+UCS_TEST_P(test_ucp_tag_persistent, eager_bcopy)
+{
+    test_xfer(4 * UCS_KBYTE, true);
+    test_xfer(4 * UCS_KBYTE, false);
+}
+
+UCS_TEST_P(test_ucp_tag_persistent, rndv)
+{
+    test_xfer(256 * UCS_KBYTE, true);
+    test_xfer(256 * UCS_KBYTE, false);
+}
+
+UCS_TEST_P(test_ucp_tag_persistent, cancel)
+{
+    uint64_t recv_data = 0;
+
+    void *rreq = recv_init(&recv_data, sizeof(recv_data), 0x22);
+    ASSERT_EQ(UCS_INPROGRESS, ucp_request_start(rreq));
+
+    ucp_request_cancel(receiver().worker(), rreq);
+    EXPECT_EQ(UCS_ERR_CANCELED, wait_persistent(rreq));
+
+    /* The request can be started again after it was canceled */
+    uint64_t send_data = 0xdeadbeef;
+    uint32_t completed = 0;
+    void *sreq         = send_init(&send_data, sizeof(send_data), 0x22,
+                                   &completed);
+    ASSERT_UCS_OK_OR_INPROGRESS(ucp_request_start(rreq));
+    EXPECT_UCS_OK(start_wait(sreq));
+    EXPECT_UCS_OK(wait_persistent(rreq));
+    EXPECT_EQ(send_data, recv_data);
+
+    ucp_request_free(sreq);
+    ucp_request_free(rreq);
+}
+
+UCS_TEST_P(test_ucp_tag_persistent, free_in_progress)
+{
+    uint64_t recv_data = 0;
+
+    void *rreq = recv_init(&recv_data, sizeof(recv_data), 0x33);
+    ASSERT_EQ(UCS_INPROGRESS, ucp_request_start(rreq));
+    ucp_request_cancel(receiver().worker(), rreq);
+    ucp_request_free(rreq);
+    progress();
+}
+
+UCS_TEST_P(test_ucp_tag_persistent, no_imm_cmpl)
+{
+    uint64_t send_data = 0xdeadbeef;
+    uint64_t recv_data = 0;
+    uint32_t completed = 0;
+    ucp_request_param_t param;
+
+    param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                         UCP_OP_ATTR_FIELD_USER_DATA |
+                         UCP_OP_ATTR_FLAG_NO_IMM_CMPL;
+    param.cb.send      = send_callback;
+    param.user_data    = &completed;
+
+    void *sreq = ucp_tag_send_init_nbx(sender().ep(), &send_data,
+                                       sizeof(send_data), 0x44, &param);
+    ASSERT_FALSE(UCS_PTR_IS_ERR(sreq));
+    void *rreq = recv_init(&recv_data, sizeof(recv_data), 0x44);
+
+    /* The callback is called for every start, even if the send completed
+     * immediately */
+    for (unsigned i = 0; i < NUM_ITERS; ++i) {
+        ASSERT_UCS_OK_OR_INPROGRESS(ucp_request_start(rreq));
+        EXPECT_EQ(UCS_INPROGRESS, ucp_request_start(sreq));
+        ASSERT_UCS_OK(wait_persistent(sreq));
+        ASSERT_UCS_OK(wait_persistent(rreq));
+        EXPECT_EQ(send_data, recv_data);
+    }
+
+    EXPECT_EQ(static_cast<uint32_t>(NUM_ITERS), completed);
+
+    ucp_request_free(sreq);
+    ucp_request_free(rreq);
+}
+
+UCS_TEST_P(test_ucp_tag_persistent, force_imm_cmpl)
+{
+    std::vector<char> large_buffer(256 * UCS_KBYTE);
+    uint64_t send_data = 0xdeadbeef;
+    uint64_t recv_data = 0;
+    uint32_t completed = 0;
+    ucp_request_param_t param;
+    ucs_status_t status;
+
+    param.op_attr_mask = UCP_OP_ATTR_FLAG_FORCE_IMM_CMPL;
+
+    /* A rendezvous send can't be completed immediately */
+    void *sreq = ucp_tag_send_init_nbx(sender().ep(), &large_buffer[0],
+                                       large_buffer.size(), 0x55, &param);
+    ASSERT_FALSE(UCS_PTR_IS_ERR(sreq));
+    EXPECT_EQ(UCS_ERR_NO_RESOURCE, ucp_request_start(sreq));
+    EXPECT_EQ(UCS_ERR_NO_RESOURCE, ucp_request_check_status(sreq));
+    ucp_request_free(sreq);
+
+    /* A receive completes immediately only if the message already arrived */
+    void *rreq = ucp_tag_recv_init_nbx(receiver().worker(), &recv_data,
+                                       sizeof(recv_data), 0x55,
+                                       UCP_TAG_MASK_FULL, &param);
+    ASSERT_FALSE(UCS_PTR_IS_ERR(rreq));
+    EXPECT_EQ(UCS_ERR_NO_RESOURCE, ucp_request_start(rreq));
+
+    sreq = send_init(&send_data, sizeof(send_data), 0x55, &completed);
+    EXPECT_UCS_OK(start_wait(sreq));
+
+    ucs_time_t deadline = ucs::get_deadline();
+    do {
+        progress();
+        status = ucp_request_start(rreq);
+    } while ((status == UCS_ERR_NO_RESOURCE) && (ucs_get_time() < deadline));
+
+    EXPECT_UCS_OK(status);
+    EXPECT_EQ(send_data, recv_data);
+
+    ucp_request_free(sreq);
+    ucp_request_free(rreq);
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_persistent)
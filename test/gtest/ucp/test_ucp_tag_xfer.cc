@@ -1264,4 +1264,41 @@ UCS_TEST_P(multi_rail_max, max_lanes, "IB_NUM_PATHS?=64", "TM_SW_RNDV=y",
 
 UCP_INSTANTIATE_TEST_CASE_TLS(multi_rail_max, rc, "rc")
 
+class multi_rail_tcp : public multi_rail_max {
+public:
+    unsigned num_lanes() override
+    {
+        return 4;
+    }
+};
+
+UCS_TEST_P(multi_rail_tcp, stripe, "TCP_NUM_PATHS?=4", "RNDV_THRESH=1",
+           "MIN_RNDV_CHUNK_SIZE=1", "MULTI_PATH_RATIO=0.0001")
+{
+    if (get_variant_value() == VARIANT_RNDV_GET_ZCOPY) {
+        UCS_TEST_SKIP_R("tcp does not support get_zcopy");
+    }
+
+    receiver().connect(&sender(), get_ep_params());
+    test_run_xfer(true, true, true, true, false);
+
+    /* Every path is a separate TCP connection and must carry some data */
+    ASSERT_GE(ucp_ep_num_lanes(sender().ep()), num_lanes());
+
+    size_t bytes_sent = 0;
+    for (ucp_lane_index_t lane = 0; lane < num_lanes(); ++lane) {
+        size_t sender_tx   = get_bytes_sent(sender().ep(), lane);
+        size_t receiver_tx = get_bytes_sent(receiver().ep(), lane);
+        UCS_TEST_MESSAGE << "lane[" << static_cast<int>(lane) << "] : "
+                         << "sender " << sender_tx << " receiver " << receiver_tx;
+
+        EXPECT_GT(sender_tx + receiver_tx, 0);
+        bytes_sent += sender_tx + receiver_tx;
+    }
+
+    EXPECT_GE(bytes_sent, get_msg_size());
+}
+
+UCP_INSTANTIATE_TEST_CASE_TLS(multi_rail_tcp, tcp, "tcp")
+
 #endif
@@ -987,3 +987,121 @@ UCS_TEST_P(test_worker_cpu_mask, all_cpus)
 }
 
 UCP_INSTANTIATE_TEST_CASE_TLS(test_worker_cpu_mask, all, "all")
+
+class test_ucp_worker_iface_open : public ucp_test {
+public:
+    static void get_test_variants(std::vector<ucp_test_variant> &variants)
+    {
+        add_variant(variants, UCP_FEATURE_TAG);
+    }
+};
+
+UCS_TEST_P(test_ucp_worker_iface_open, parallel, "IFACE_OPEN_THREADS=4")
+{
+    ucp_worker_h parallel_worker = sender().worker();
+
+    /* Ifaces opened serially must be the same as the ones opened in parallel */
+    modify_config("IFACE_OPEN_THREADS", "1");
+    ucp_worker_h serial_worker = create_entity()->worker();
+
+    ASSERT_EQ(serial_worker->num_ifaces, parallel_worker->num_ifaces);
+    for (unsigned i = 0; i < serial_worker->num_ifaces; ++i) {
+        EXPECT_EQ(serial_worker->ifaces[i]->rsc_index,
+                  parallel_worker->ifaces[i]->rsc_index);
+    }
+
+    char *buf   = NULL;
+    size_t size = 0;
+    FILE *f     = open_memstream(&buf, &size);
+    ASSERT_TRUE(f != NULL);
+    ucp_worker_print_info(parallel_worker, f);
+    fclose(f);
+
+    std::string info(buf, size);
+    free(buf);
+    EXPECT_NE(std::string::npos, info.find("iface open time")) << info;
+}
+
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_worker_iface_open, all, "all")
+
+class test_ucp_worker_numa : public ucp_test {
+public:
+    test_ucp_worker_numa()
+    {
+        modify_config("NUMA_POLICY", ucp_numa_policy_names[numa_policy()]);
+    }
+
+    static void get_test_variants(std::vector<ucp_test_variant> &variants)
+    {
+        for (int policy = 0; policy < UCP_NUMA_POLICY_LAST; ++policy) {
+            add_variant_with_value(variants, UCP_FEATURE_TAG, policy,
+                                   ucp_numa_policy_names[policy]);
+        }
+    }
+
+protected:
+    ucp_numa_policy_t numa_policy() const
+    {
+        return static_cast<ucp_numa_policy_t>(get_variant_value(0));
+    }
+};
+
+UCS_TEST_P(test_ucp_worker_numa, placement)
+{
+    ucp_worker_h worker = sender().worker();
+
+    if (numa_policy() == UCP_NUMA_POLICY_NONE) {
+        EXPECT_EQ(UCS_NUMA_NODE_UNDEFINED, worker->numa_node);
+    } else {
+        EXPECT_GE(worker->numa_node, 0);
+        EXPECT_LT(worker->numa_node, (int)ucs_numa_num_configured_nodes());
+    }
+
+    for (unsigned i = 0; i < worker->num_ifaces; ++i) {
+        uct_base_iface_t *iface = ucs_derived_of(worker->ifaces[i]->iface,
+                                                 uct_base_iface_t);
+        EXPECT_EQ(worker->numa_node, iface->numa_node);
+    }
+
+    EXPECT_EQ(worker->numa_node, worker->req_mp.data->numa_node);
+    EXPECT_EQ(worker->numa_node, worker->reg_mp.data->numa_node);
+    if (worker->flags & UCP_WORKER_FLAG_AM_MPOOL_INITIALIZED) {
+        for (unsigned i = 0; i < ucs_popcount(worker->am_mps.bitmap); ++i) {
+            EXPECT_EQ(worker->numa_node,
+                      static_cast<ucs_mpool_t*>(worker->am_mps.data)[i]
+                              .data->numa_node);
+        }
+    }
+
+    char *buf   = NULL;
+    size_t size = 0;
+    FILE *f     = open_memstream(&buf, &size);
+    ASSERT_TRUE(f != NULL);
+    ucp_worker_print_info(worker, f);
+    fclose(f);
+
+    std::string info(buf, size);
+    free(buf);
+    EXPECT_NE(std::string::npos,
+              info.find(std::string("numa policy: ") +
+                        ucp_numa_policy_names[numa_policy()]))
+            << info;
+
+    /* Memory pools must still be usable with the policy applied */
+    sender().connect(&receiver(), get_ep_params());
+    receiver().connect(&sender(), get_ep_params());
+
+    uint64_t send_data = 0xdeadbeef, recv_data = 0;
+    ucp_request_param_t param;
+    param.op_attr_mask = 0;
+    void *sreq         = ucp_tag_send_nbx(sender().ep(), &send_data,
+                                          sizeof(send_data), 1, &param);
+    void *rreq         = ucp_tag_recv_nbx(receiver().worker(), &recv_data,
+                                          sizeof(recv_data), 1, (ucp_tag_t)-1,
+                                          &param);
+    request_wait(sreq);
+    request_wait(rreq);
+    EXPECT_EQ(send_data, recv_data);
+}
+
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_worker_numa, all, "all")
@@ -977,3 +977,61 @@ UCS_TEST_F(test_config, test_config_file_parse_files) {
     EXPECT_EQ(100, opts.price);
     ucs_config_parser_release_opts(&opts, car_opts_table);
 }
+
+UCS_TEST_F(test_config, parse_cache) {
+    /* Add stuff to env to make a full parse slower */
+    ucs::ptr_vector<ucs::scoped_setenv> env;
+    for (unsigned i = 0; i < 300; ++i) {
+        env.push_back(new ucs::scoped_setenv(
+                        (std::string("MTEST") + ucs::to_string(i)).c_str(),
+                        ""));
+    }
+
+    ucs_config_global_list_entry_t entry;
+    entry.table  = car_opts_table;
+    entry.name   = "cars";
+    entry.prefix = NULL;
+    entry.size   = sizeof(car_opts_t);
+    entry.flags  = 0;
+
+    const unsigned count = 1000;
+    car_opts_t opts;
+    ucs_status_t status;
+
+    /* Repeated parsing with the same environment is served from the cache */
+    ucs_time_t start_time = ucs_get_time();
+    for (unsigned i = 0; i < count; ++i) {
+        status = ucs_config_parser_fill_opts(&opts, &entry,
+                                             UCS_DEFAULT_ENV_PREFIX, 0);
+        ASSERT_UCS_OK(status);
+        EXPECT_EQ(COLOR_RED, opts.color);
+        ucs_config_parser_release_opts(&opts, car_opts_table);
+    }
+    UCS_TEST_MESSAGE << ucs_time_to_usec(ucs_get_time() - start_time) / count
+                     << " usec per parse";
+
+    /* Changing the environment invalidates the cached values */
+    {
+        ucs::scoped_setenv env1("UCX_COLOR", "white");
+        status = ucs_config_parser_fill_opts(&opts, &entry,
+                                             UCS_DEFAULT_ENV_PREFIX, 0);
+        ASSERT_UCS_OK(status);
+        EXPECT_EQ(COLOR_WHITE, opts.color);
+        ucs_config_parser_release_opts(&opts, car_opts_table);
+
+        /* Different prefixes have separate entries */
+        ucs::scoped_setenv env2(TEST_ENV_PREFIX "UCX_COLOR", "black");
+        status = ucs_config_parser_fill_opts(&opts, &entry,
+                                             TEST_ENV_PREFIX
+                                             UCS_DEFAULT_ENV_PREFIX, 0);
+        ASSERT_UCS_OK(status);
+        EXPECT_EQ(COLOR_BLACK, opts.color);
+        ucs_config_parser_release_opts(&opts, car_opts_table);
+    }
+
+    status = ucs_config_parser_fill_opts(&opts, &entry, UCS_DEFAULT_ENV_PREFIX,
+                                         0);
+    ASSERT_UCS_OK(status);
+    EXPECT_EQ(COLOR_RED, opts.color);
+    ucs_config_parser_release_opts(&opts, car_opts_table);
+}
@@ -9,6 +9,7 @@ extern "C" {
 #include <ucs/sys/event_set.h>
 #include <pthread.h>
 #include <sys/epoll.h>
+#include <poll.h>
 }
 
 #define MAX_BUF_LEN        255
@@ -18,7 +19,8 @@ static const char *UCS_EVENT_SET_EXTRA_STRING = "ucs_event_set extra string";
 static const int   UCS_EVENT_SET_EXTRA_NUM    = 0xFF;
 
 enum {
-    UCS_EVENT_SET_EXTERNAL_FD = UCS_BIT(0),
+    UCS_EVENT_SET_EXTERNAL_FD  = UCS_BIT(0),
+    UCS_EVENT_SET_EDGE_TRACKED = UCS_BIT(1)
 };
 
 class test_event_set : public ucs::test_base,
@@ -96,6 +98,9 @@ protected:
 
         if (GetParam() & UCS_EVENT_SET_EXTERNAL_FD) {
             status = ucs_event_set_create_from_fd(&m_event_set, m_ext_fd);
+        } else if (GetParam() & UCS_EVENT_SET_EDGE_TRACKED) {
+            status = ucs_event_set_create_ext(&m_event_set,
+                                              UCS_EVENT_SET_FLAG_EDGE_TRIGGERED);
         } else {
             status = ucs_event_set_create(&m_event_set);
         }
@@ -247,6 +252,10 @@ UCS_TEST_P(test_event_set, ucs_event_set_trig_modes) {
     void *arg[] = { (void*)UCS_EVENT_SET_EXTRA_STRING,
                     (void*)&UCS_EVENT_SET_EXTRA_NUM };
 
+    if (GetParam() & UCS_EVENT_SET_EDGE_TRACKED) {
+        UCS_TEST_SKIP_R("readiness is tracked by the event set");
+    }
+
     event_set_init(event_set_read_func);
     event_set_ctl(EVENT_SET_OP_ADD, m_pipefd[0],
                   UCS_EVENT_SET_EVREAD);
@@ -279,7 +288,136 @@ UCS_TEST_P(test_event_set, ucs_event_set_trig_modes) {
     event_set_cleanup();
 }
 
+UCS_TEST_P(test_event_set, ucs_event_set_edge_tracked_ready) {
+    void *arg[] = { (void*)UCS_EVENT_SET_EXTRA_STRING,
+                    (void*)&UCS_EVENT_SET_EXTRA_NUM };
+
+    if (!(GetParam() & UCS_EVENT_SET_EDGE_TRACKED)) {
+        UCS_TEST_SKIP_R("readiness is not tracked by the event set");
+    }
+
+    event_set_init(event_set_read_func);
+    event_set_ctl(EVENT_SET_OP_ADD, m_pipefd[0], UCS_EVENT_SET_EVREAD);
+
+    thread_barrier();
+
+    /* The event is reported until the readiness is cleared */
+    for (int i = 0; i < 10; i++) {
+        event_set_wait(1u, 0, event_set_func4, NULL);
+    }
+
+    /* Not interested in the event - not reported, but still ready */
+    event_set_ctl(EVENT_SET_OP_MOD, m_pipefd[0], 0);
+    event_set_wait(0u, 0, event_set_func3, NULL);
+    event_set_ctl(EVENT_SET_OP_MOD, m_pipefd[0], UCS_EVENT_SET_EVREAD);
+
+    /* Drain the pipe and clear the readiness */
+    event_set_wait(1u, 0, event_set_func1, arg);
+    ucs_event_set_clear_ready(m_event_set, m_pipefd[0], UCS_EVENT_SET_EVREAD);
+    for (int i = 0; i < 10; i++) {
+        event_set_wait(0u, 0, event_set_func3, NULL);
+    }
+
+    /* A new edge makes the fd ready again */
+    ASSERT_EQ((ssize_t)strlen(evfd_data),
+              write(m_pipefd[1], evfd_data, strlen(evfd_data)));
+    event_set_wait(1u, 0, event_set_func1, arg);
+
+    event_set_ctl(EVENT_SET_OP_DEL, m_pipefd[0], 0);
+    event_set_cleanup();
+}
+
+UCS_TEST_P(test_event_set, ucs_event_set_edge_tracked_mod) {
+    if (!(GetParam() & UCS_EVENT_SET_EDGE_TRACKED)) {
+        UCS_TEST_SKIP_R("readiness is not tracked by the event set");
+    }
+
+    event_set_init(event_set_tmo_func);
+
+    /* The write end is writable, but the event is not requested yet */
+    event_set_ctl(EVENT_SET_OP_ADD, m_pipefd[1], UCS_EVENT_SET_EVREAD);
+
+    thread_barrier();
+
+    event_set_wait(0u, 0, event_set_func3, NULL);
+
+    /* The readiness was recorded when the fd was added */
+    event_set_ctl(EVENT_SET_OP_MOD, m_pipefd[1], UCS_EVENT_SET_EVWRITE);
+    event_set_wait(1u, 0, event_set_func2, NULL);
+
+    event_set_ctl(EVENT_SET_OP_DEL, m_pipefd[1], 0);
+    event_set_cleanup();
+}
+
+UCS_TEST_P(test_event_set, ucs_event_set_edge_tracked_has_ready) {
+    void *arg[] = { (void*)UCS_EVENT_SET_EXTRA_STRING,
+                    (void*)&UCS_EVENT_SET_EXTRA_NUM };
+    int event_fd;
+
+    if (!(GetParam() & UCS_EVENT_SET_EDGE_TRACKED)) {
+        UCS_TEST_SKIP_R("readiness is not tracked by the event set");
+    }
+
+    event_set_init(event_set_read_func);
+    event_set_ctl(EVENT_SET_OP_ADD, m_pipefd[0], UCS_EVENT_SET_EVREAD);
+    ASSERT_UCS_OK(ucs_event_set_fd_get(m_event_set, &event_fd));
+
+    thread_barrier();
+    EXPECT_FALSE(ucs_event_set_has_ready(m_event_set));
+
+    /* The edge is consumed from the kernel, but the fd is not drained */
+    event_set_wait(1u, 0, event_set_func4, NULL);
+    EXPECT_TRUE(ucs_event_set_has_ready(m_event_set));
+
+    /* The event set fd is not signaled anymore, so a user which blocks on it
+     * must check the ready list first */
+    struct pollfd pfd = { event_fd, POLLIN, 0 };
+    EXPECT_EQ(0, poll(&pfd, 1, 0));
+
+    event_set_wait(1u, 0, event_set_func1, arg);
+    ucs_event_set_clear_ready(m_event_set, m_pipefd[0], UCS_EVENT_SET_EVREAD);
+    EXPECT_FALSE(ucs_event_set_has_ready(m_event_set));
+
+    /* A new edge signals the event set fd again */
+    ASSERT_EQ((ssize_t)strlen(evfd_data),
+              write(m_pipefd[1], evfd_data, strlen(evfd_data)));
+    EXPECT_EQ(1, poll(&pfd, 1, 1000));
+    event_set_wait(1u, 0, event_set_func1, arg);
+    ucs_event_set_clear_ready(m_event_set, m_pipefd[0], UCS_EVENT_SET_EVREAD);
+
+    event_set_ctl(EVENT_SET_OP_DEL, m_pipefd[0], 0);
+    event_set_cleanup();
+}
+
+static void event_set_func_del(void *callback_data,
+                               ucs_event_set_types_t events, void *arg)
+{
+    ucs_sys_event_set_t *event_set = (ucs_sys_event_set_t*)arg;
+
+    EXPECT_UCS_OK(ucs_event_set_del(event_set,
+                                    (int)(uintptr_t)callback_data));
+}
+
+UCS_TEST_P(test_event_set, ucs_event_set_edge_tracked_del_in_handler) {
+    if (!(GetParam() & UCS_EVENT_SET_EDGE_TRACKED)) {
+        UCS_TEST_SKIP_R("readiness is not tracked by the event set");
+    }
+
+    event_set_init(event_set_tmo_func);
+    event_set_ctl(EVENT_SET_OP_ADD, m_pipefd[1], UCS_EVENT_SET_EVWRITE);
+
+    thread_barrier();
+
+    event_set_wait(1u, 0, event_set_func_del, m_event_set);
+    event_set_wait(0u, 0, event_set_func3, NULL);
+
+    event_set_cleanup();
+}
+
 INSTANTIATE_TEST_SUITE_P(ext_fd, test_event_set,
                         ::testing::Values(static_cast<int>(
                                               UCS_EVENT_SET_EXTERNAL_FD)));
 INSTANTIATE_TEST_SUITE_P(int_fd, test_event_set, ::testing::Values(0));
+INSTANTIATE_TEST_SUITE_P(edge_tracked, test_event_set,
+                        ::testing::Values(static_cast<int>(
+                                              UCS_EVENT_SET_EDGE_TRACKED)));
@@ -107,3 +107,27 @@ UCS_TEST_F(test_lru, pop_oldest) {
     expected.insert(expected.end(), elements2.begin(), elements2.end());
     run(elements2, expected);
 }
+
+UCS_TEST_F(test_lru, remove) {
+    std::vector<uint64_t> elements;
+    init_vector(elements, m_capacity, 0);
+    run(elements, elements);
+
+    uint64_t removed = elements[m_capacity / 2];
+    ucs_lru_remove(m_lru, (void*)removed);
+    EXPECT_FALSE(ucs_lru_is_present(m_lru, (void*)removed));
+
+    /* Removing a missing key is a no-op */
+    ucs_lru_remove(m_lru, (void*)removed);
+
+    void **item;
+    size_t count = 0;
+    ucs_lru_for_each(item, m_lru) {
+        EXPECT_NE(removed, (uint64_t)*item);
+        ++count;
+    }
+    EXPECT_EQ(m_capacity - 1, count);
+
+    ucs_lru_push(m_lru, (void*)removed);
+    EXPECT_TRUE(ucs_lru_is_present(m_lru, (void*)removed));
+}
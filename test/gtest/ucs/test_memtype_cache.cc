@@ -7,9 +7,12 @@
 #include <common/test.h>
 #include <common/mem_buffer.h>
 
+#include <ucs/arch/atomic.h>
 #include <ucs/sys/sys.h>
 #include <ucs/memory/memtype_cache.h>
+#include <ucs/time/time.h>
 #include <ucm/api/ucm.h>
+#include <sys/mman.h>
 
 extern "C" {
 #include <ucm/event/event.h>
@@ -502,3 +505,194 @@ UCS_MT_TEST_P(test_memtype_cache_deferred_create, mt_cache_init, 8) {
 
 INSTANTIATE_TEST_SUITE_P(mem_type, test_memtype_cache_deferred_create,
                         ::testing::ValuesIn(mem_buffer::supported_mem_types()));
+
+class test_memtype_cache_mt : public ucs::test {
+protected:
+    static const size_t   REGION_SIZE    = 64 * UCS_KBYTE;
+    static const unsigned NUM_STABLE     = 8;
+    static const unsigned NUM_CHANGING   = 8;
+    static const double   TEST_TIME_SEC;
+
+    virtual void init() {
+        m_base = MAP_FAILED;
+        ucs::test::init();
+
+        ucs_memory_info_t mem_info;
+        if (ucs_memtype_cache_lookup(NULL, 1, &mem_info) ==
+            UCS_ERR_UNSUPPORTED) {
+            UCS_TEST_SKIP_R("memtype cache is disabled");
+        }
+
+        /* Reserve address space for fake regions, with gaps between regions
+         * so they would not be merged */
+        m_length = 2 * (NUM_STABLE + NUM_CHANGING) * REGION_SIZE;
+        m_base   = mmap(NULL, m_length, PROT_NONE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        ASSERT_NE(MAP_FAILED, m_base);
+
+        for (unsigned i = 0; i < NUM_STABLE; ++i) {
+            ucs_memtype_cache_update(stable_region(i), REGION_SIZE,
+                                     UCS_MEMORY_TYPE_CUDA,
+                                     UCS_SYS_DEVICE_ID_UNKNOWN);
+        }
+
+        m_stop         = false;
+        m_num_lookups  = 0;
+        m_num_readers  = 0;
+    }
+
+    virtual void cleanup() {
+        if (m_base != MAP_FAILED) {
+            ucs_memtype_cache_remove(m_base, m_length);
+            munmap(m_base, m_length);
+        }
+        ucs::test::cleanup();
+    }
+
+    void *stable_region(unsigned index) const {
+        return UCS_PTR_BYTE_OFFSET(m_base, 2 * index * REGION_SIZE);
+    }
+
+    void *changing_region(unsigned index) const {
+        return stable_region(NUM_STABLE + index);
+    }
+
+    /* Replace the changing regions by regions of other types, sliced
+     * regions, and remove them */
+    void update_regions() {
+        for (unsigned i = 0; i < NUM_CHANGING; ++i) {
+            ucs_memtype_cache_update(changing_region(i), REGION_SIZE,
+                                     UCS_MEMORY_TYPE_ROCM,
+                                     UCS_SYS_DEVICE_ID_UNKNOWN);
+        }
+
+        for (unsigned i = 0; i < NUM_CHANGING; ++i) {
+            ucs_memtype_cache_update(changing_region(i), REGION_SIZE / 2,
+                                     UCS_MEMORY_TYPE_CUDA_MANAGED,
+                                     UCS_SYS_DEVICE_ID_UNKNOWN);
+        }
+
+        for (unsigned i = 0; i < NUM_CHANGING; ++i) {
+            ucs_memtype_cache_remove(changing_region(i), REGION_SIZE);
+        }
+    }
+
+    /* Returns the number of lookups */
+    uint64_t lookup_regions() {
+        ucs_memory_info_t mem_info;
+        ucs_status_t status;
+        uint64_t count = 0;
+
+        for (unsigned i = 0; i < NUM_STABLE; ++i, ++count) {
+            /* Stable regions are always found */
+            status = ucs_memtype_cache_lookup(stable_region(i), REGION_SIZE,
+                                              &mem_info);
+            EXPECT_UCS_OK(status);
+            EXPECT_EQ(UCS_MEMORY_TYPE_CUDA, mem_info.type);
+            EXPECT_EQ(stable_region(i), mem_info.base_address);
+            EXPECT_EQ(REGION_SIZE, mem_info.alloc_length);
+        }
+
+        for (unsigned i = 0; i < NUM_CHANGING; ++i, ++count) {
+            /* Changing regions are either not found, or found with one of
+             * their types and within their bounds */
+            status = ucs_memtype_cache_lookup(changing_region(i), 1,
+                                              &mem_info);
+            if (status == UCS_ERR_NO_ELEM) {
+                continue;
+            }
+
+            EXPECT_UCS_OK(status);
+            EXPECT_TRUE((mem_info.type == UCS_MEMORY_TYPE_ROCM) ||
+                        (mem_info.type == UCS_MEMORY_TYPE_CUDA_MANAGED))
+                    << ucs_memory_type_names[mem_info.type];
+            EXPECT_EQ(changing_region(i), mem_info.base_address);
+            EXPECT_LE(mem_info.alloc_length, REGION_SIZE);
+        }
+
+        return count;
+    }
+
+    /* Returns the number of removed elements which were not released yet */
+    static size_t num_retired() {
+        ucs_memtype_cache_t *memtype_cache = ucs_memtype_cache_global_instance;
+        size_t count                       = 0;
+
+        for (unsigned i = 0; i < 2; ++i) {
+            count += ucs_list_length(&memtype_cache->retired[i].regions) +
+                     ucs_list_length(&memtype_cache->retired[i].dirs);
+        }
+        return count;
+    }
+
+    void                  *m_base;
+    size_t                m_length;
+    volatile bool         m_stop;
+    volatile uint64_t     m_num_lookups;
+    volatile uint32_t     m_num_readers;
+};
+
+const size_t test_memtype_cache_mt::REGION_SIZE;
+const double test_memtype_cache_mt::TEST_TIME_SEC = 0.5;
+
+/* One thread updates the regions while other threads look them up */
+UCS_MT_TEST_F(test_memtype_cache_mt, lookup_during_update, 4) {
+    if (barrier()) {
+        ucs_time_t deadline = ucs_get_time() +
+                              ucs_time_from_sec(TEST_TIME_SEC *
+                                                ucs::test_time_multiplier());
+        unsigned num_updates = 0;
+
+        while ((ucs_get_time() < deadline) && !HasFailure()) {
+            update_regions();
+            ++num_updates;
+        }
+
+        m_stop = true;
+        barrier();
+
+        UCS_TEST_MESSAGE << num_updates << " updates, "
+                         << (m_num_lookups / TEST_TIME_SEC /
+                             ucs::test_time_multiplier() / 1e6)
+                         << " million lookups/sec by " << m_num_readers
+                         << " threads";
+    } else {
+        uint64_t num_lookups = 0;
+
+        while (!m_stop && !HasFailure()) {
+            num_lookups += lookup_regions();
+        }
+
+        ucs_atomic_add64(&m_num_lookups, num_lookups);
+        ucs_atomic_add32(&m_num_readers, 1);
+        barrier();
+    }
+}
+
+/* Removed elements must be released even if there is always an active lookup,
+ * as long as every lookup eventually completes */
+UCS_TEST_F(test_memtype_cache_mt, release_with_overlapping_lookups) {
+    ucs_memtype_cache_t *memtype_cache = ucs_memtype_cache_global_instance;
+    volatile uint32_t *prev_reader     = NULL;
+    volatile uint32_t *reader;
+    size_t max_retired                 = 0;
+
+    for (unsigned i = 0; i < 1000; ++i) {
+        /* Emulate a lookup which starts before the previous one completes */
+        reader = &memtype_cache->readers[i % UCS_MEMTYPE_CACHE_READER_SHARDS]
+                          .count[memtype_cache->epoch & 1];
+        ucs_atomic_add32(reader, 1);
+        if (prev_reader != NULL) {
+            ucs_atomic_sub32(prev_reader, 1);
+        }
+        prev_reader = reader;
+
+        update_regions();
+        max_retired = ucs_max(max_retired, num_retired());
+    }
+
+    ucs_atomic_sub32(prev_reader, 1);
+
+    UCS_TEST_MESSAGE << "up to " << max_retired << " retired elements";
+    EXPECT_LT(max_retired, 64 * NUM_CHANGING);
+}
@@ -6,7 +6,11 @@
 
 #include <common/test.h>
 extern "C" {
+#include <ucs/arch/atomic.h>
 #include <ucs/datastruct/mpool.h>
+#include <ucs/datastruct/mpool_mt.h>
+#include <ucs/time/time.h>
+#include <ucs/type/spinlock.h>
 }
 
 #include <limits.h>
@@ -78,8 +82,8 @@ protected:
     static const size_t align = 128;
     static size_t leak_count;
 
-    ucs_status_t setup_mpool(ucs_mpool_t *mp, size_t elem_size,
-                             unsigned elems_per_chunk, unsigned max_elems = 0)
+    void setup_mpool_params(ucs_mpool_params_t *mp_params, size_t elem_size,
+                            unsigned elems_per_chunk, unsigned max_elems)
     {
         static ucs_mpool_ops_t mpool_ops = {ucs_mpool_chunk_malloc,
                                             ucs_mpool_chunk_free, NULL, NULL,
@@ -88,17 +92,23 @@ protected:
             max_elems = elems_per_chunk;
         }
 
+        ucs_mpool_params_reset(mp_params);
+        mp_params->elem_size       = header_size + elem_size;
+        mp_params->align_offset    = header_size;
+        mp_params->alignment       = align;
+        mp_params->max_chunk_size  = 4 * UCS_GBYTE;
+        mp_params->elems_per_chunk = elems_per_chunk;
+        mp_params->max_elems       = max_elems;
+        mp_params->ops             = &mpool_ops;
+        mp_params->name            = "tests";
+    }
+
+    ucs_status_t setup_mpool(ucs_mpool_t *mp, size_t elem_size,
+                             unsigned elems_per_chunk, unsigned max_elems = 0)
+    {
         ucs_mpool_params_t mp_params;
 
-        ucs_mpool_params_reset(&mp_params);
-        mp_params.elem_size       = header_size + elem_size;
-        mp_params.align_offset    = header_size;
-        mp_params.alignment       = align;
-        mp_params.max_chunk_size  = 4 * UCS_GBYTE;
-        mp_params.elems_per_chunk = elems_per_chunk;
-        mp_params.max_elems       = max_elems;
-        mp_params.ops             = &mpool_ops;
-        mp_params.name            = "tests";
+        setup_mpool_params(&mp_params, elem_size, elems_per_chunk, max_elems);
         return ucs_mpool_init(&mp_params, mp);
     }
 };
@@ -495,3 +505,177 @@ UCS_TEST_SKIP_COND_F(test_mpool_fifo, alloc_release, !ENABLE_DEBUG_DATA)
 
     ucs_mpool_cleanup(&mp, 0); // skip individual put as obj could be corrupted
 }
+
+class test_mpool_mt : public test_mpool {
+protected:
+    virtual void init()
+    {
+        ucs_mpool_params_t mp_params;
+
+        test_mpool::init();
+
+        /* The pool is cache-line aligned, so it can't be a class member */
+        ASSERT_EQ(0, posix_memalign((void**)&m_mtp, UCS_SYS_CACHE_LINE_SIZE,
+                                    sizeof(*m_mtp)));
+
+        setup_mpool_params(&mp_params, data_size, elems_per_chunk, UINT_MAX);
+        ASSERT_UCS_OK(ucs_mpool_mt_init(&mp_params, m_mtp));
+
+        /* Reference pool, protected by a lock */
+        ASSERT_UCS_OK(ucs_mpool_init(&mp_params, &m_mp));
+        ASSERT_UCS_OK(ucs_spinlock_init(&m_lock, 0));
+
+        m_thread_id = 0;
+        m_total_ns  = 0;
+    }
+
+    virtual void cleanup()
+    {
+        ucs_spinlock_destroy(&m_lock);
+        ucs_mpool_cleanup(&m_mp, 1);
+        ucs_mpool_mt_cleanup(m_mtp, 1);
+        free(m_mtp);
+        test_mpool::cleanup();
+    }
+
+    unsigned thread_id()
+    {
+        return ucs_atomic_fadd32(&m_thread_id, 1);
+    }
+
+    void *locked_get()
+    {
+        ucs_spin_lock(&m_lock);
+        void *obj = ucs_mpool_get(&m_mp);
+        ucs_spin_unlock(&m_lock);
+        return obj;
+    }
+
+    void locked_put(void *obj)
+    {
+        ucs_spin_lock(&m_lock);
+        ucs_mpool_put(obj);
+        ucs_spin_unlock(&m_lock);
+    }
+
+    template<typename GetFunc, typename PutFunc>
+    double measure(GetFunc get, PutFunc put)
+    {
+        static const unsigned count = 100000 / ucs::test_time_multiplier();
+        void *objs[burst];
+
+        barrier();
+        ucs_time_t start_time = ucs_get_time();
+        for (unsigned i = 0; i < count; ++i) {
+            for (unsigned j = 0; j < burst; ++j) {
+                objs[j] = get();
+            }
+            for (unsigned j = 0; j < burst; ++j) {
+                put(objs[j]);
+            }
+        }
+        ucs_atomic_add64(&m_total_ns,
+                         ucs_time_to_nsec(ucs_get_time() - start_time));
+        barrier();
+
+        double ns_per_op = (double)m_total_ns / (count * burst * num_threads());
+        barrier();
+        m_total_ns = 0;
+        return ns_per_op;
+    }
+
+    static const unsigned elems_per_chunk = 64;
+    static const unsigned burst           = 8;
+
+    ucs_mpool_mt_t   *m_mtp;
+    ucs_mpool_t      m_mp;
+    ucs_spinlock_t   m_lock;
+    volatile uint32_t m_thread_id;
+    volatile uint64_t m_total_ns;
+};
+
+UCS_TEST_F(test_mpool_mt, basic) {
+    std::vector<void*> objs;
+
+    for (unsigned i = 0; i < 3 * UCS_MPOOL_MT_MAGAZINE_SIZE; ++i) {
+        void *obj = ucs_mpool_mt_get(m_mtp);
+        ASSERT_TRUE(obj != NULL);
+        EXPECT_EQ(0ul, ((uintptr_t)obj + header_size) % align);
+        memset(obj, 0xBB, header_size + data_size);
+        objs.push_back(obj);
+    }
+
+    /* Objects are returned in LIFO order from the thread cache */
+    for (unsigned i = 0; i < 4; ++i) {
+        void *obj = objs.back();
+        ucs_mpool_mt_put(obj);
+        EXPECT_EQ(obj, ucs_mpool_mt_get(m_mtp));
+    }
+
+    while (!objs.empty()) {
+        ucs_mpool_mt_put(objs.back());
+        objs.pop_back();
+    }
+
+    ucs_mpool_mt_thread_flush(m_mtp);
+}
+
+UCS_TEST_F(test_mpool_mt, malloc_safe) {
+    ucs_mpool_params_t mp_params;
+    ucs_mpool_mt_t mtp;
+
+    setup_mpool_params(&mp_params, data_size, elems_per_chunk, 0);
+    mp_params.malloc_safe = 1;
+
+    scoped_log_handler wrap_err(wrap_errors_logger);
+    EXPECT_EQ(UCS_ERR_UNSUPPORTED, ucs_mpool_mt_init(&mp_params, &mtp));
+}
+
+UCS_MT_TEST_F(test_mpool_mt, cross_thread, 8) {
+    static const unsigned count = 1000;
+    static std::vector<void*> objs;
+    unsigned id = thread_id();
+
+    if (barrier()) {
+        objs.assign(num_threads() * count, NULL);
+    }
+    barrier();
+
+    for (unsigned iter = 0; iter < 10; ++iter) {
+        /* Allocate a set of objects and mark them with the thread id */
+        for (unsigned i = 0; i < count; ++i) {
+            void *obj = ucs_mpool_mt_get(m_mtp);
+            ASSERT_TRUE(obj != NULL);
+            *(unsigned*)UCS_PTR_BYTE_OFFSET(obj, header_size) = id;
+            objs[id * count + i] = obj;
+        }
+        barrier();
+
+        /* Release the objects allocated by the next thread */
+        unsigned peer = (id + 1) % num_threads();
+        for (unsigned i = 0; i < count; ++i) {
+            void *obj = objs[peer * count + i];
+            EXPECT_EQ(peer, *(unsigned*)UCS_PTR_BYTE_OFFSET(obj, header_size));
+            ucs_mpool_mt_put(obj);
+        }
+        barrier();
+    }
+}
+
+UCS_MT_TEST_F(test_mpool_mt, scalability, 8) {
+    double mt_ns = measure([this]() { return ucs_mpool_mt_get(m_mtp); },
+                           ucs_mpool_mt_put);
+    double locked_ns = measure([this]() { return locked_get(); },
+                               [this](void *obj) { locked_put(obj); });
+
+    if (barrier()) {
+        UCS_TEST_MESSAGE << num_threads() << " threads: " << mt_ns
+                         << " nsec per op with thread caches, " << locked_ns
+                         << " nsec per op with a lock";
+        if (ucs::perf_retry_count) {
+            EXPECT_LT(mt_ns, locked_ns * ucs::test_time_multiplier());
+        } else {
+            UCS_TEST_MESSAGE << "not validating performance";
+        }
+    }
+}
@@ -58,6 +58,32 @@ protected:
         return ucs_pgtable_lookup(&m_pgtable, address);
     }
 
+    ucs_pgt_region_t *lookup_tree(ucs_pgt_addr_t address) {
+        return ucs_pgtable_lookup_tree(&m_pgtable, address);
+    }
+
+    /* Check that the flat array and the tree find the same regions */
+    void check_lookup(const std::vector<ucs_pgt_region_t> &regions,
+                      const std::vector<bool> &inserted)
+    {
+        for (size_t i = 0; i < regions.size(); ++i) {
+            const ucs_pgt_region_t *region = &regions[i];
+            const ucs_pgt_region_t *exp    = inserted[i] ? region : NULL;
+            ucs_pgt_addr_t addresses[]     = {region->start,
+                                              region->start + 1,
+                                              region->end - 1};
+
+            for (ucs_pgt_addr_t address : addresses) {
+                EXPECT_EQ(exp, lookup(address)) << std::hex << address;
+                EXPECT_EQ(exp, lookup_tree(address)) << std::hex << address;
+            }
+
+            /* Gaps between the regions */
+            EXPECT_EQ(NULL, lookup(region->end));
+            EXPECT_EQ(NULL, lookup(region->start - UCS_PGT_ADDR_ALIGN));
+        }
+    }
+
     unsigned num_regions() {
         return ucs_pgtable_num_regions(&m_pgtable);
     }
@@ -406,6 +432,38 @@ UCS_TEST_F(test_pgtable, search_adjacent_regions) {
     remove(&region3);
 }
 
+UCS_TEST_F(test_pgtable, flat_and_tree) {
+    const unsigned count = UCS_PGT_FLAT_MAX_REGIONS * 3;
+    std::vector<ucs_pgt_region_t> regions(count);
+    std::vector<bool> inserted(count, false);
+    std::vector<unsigned> order;
+
+    for (unsigned i = 0; i < count; ++i) {
+        regions[i].start = UCS_MBYTE * (i + 1);
+        regions[i].end   = regions[i].start + (UCS_KBYTE * (i + 1));
+        order.push_back(i);
+    }
+
+    /* Grow beyond the flat array limit and shrink back, twice */
+    for (int iter = 0; iter < 2; ++iter) {
+        std::random_shuffle(order.begin(), order.end(), ucs::rand_range);
+        for (unsigned i : order) {
+            insert(&regions[i]);
+            inserted[i] = true;
+            check_lookup(regions, inserted);
+        }
+
+        std::random_shuffle(order.begin(), order.end(), ucs::rand_range);
+        for (unsigned i : order) {
+            remove(&regions[i]);
+            inserted[i] = false;
+            check_lookup(regions, inserted);
+        }
+    }
+
+    EXPECT_EQ(0u, num_regions());
+}
+
 class test_pgtable_perf : public test_pgtable {
 protected:
 
@@ -439,6 +497,10 @@ protected:
         return test_pgtable::lookup(address);
     }
 
+    ucs_pgt_region_t* lookup_in_pgt_tree(ucs_pgt_addr_t address) {
+        return test_pgtable::lookup_tree(address);
+    }
+
     void measure_workload(ucs_pgt_addr_t max_addr,
                           size_t block_size,   /* Basic block size */
                           unsigned blocks_per_superblock, /* Number of consecutive basic blocks per big block */
@@ -504,19 +566,26 @@ protected:
         invalidate_cache();
 
         std::pair<ucs_time_t, unsigned> result_stl =
-                        measure(lookups, true);
+                        measure(lookups, LOOKUP_STL);
+
+        invalidate_cache();
+
+        std::pair<ucs_time_t, unsigned> result_tree =
+                        measure(lookups, LOOKUP_PGT_TREE);
 
         invalidate_cache();
 
         std::pair<ucs_time_t, unsigned> result_pgt =
-                        measure(lookups, false);
+                        measure(lookups, LOOKUP_PGT);
 
         EXPECT_EQ(result_stl.second, result_pgt.second);
+        EXPECT_EQ(result_stl.second, result_tree.second);
 
         UCS_TEST_MESSAGE << std::dec << num_superblocks << " areas of " <<
                         blocks_per_superblock << "x" << block_size << " bytes, " <<
                         (random_access ? "random" : "ordered") << ": " <<
                         "stl: " << (ucs_time_to_nsec(result_stl.first) / num_lookups) << " ns, "
+                        "tree: " << (ucs_time_to_nsec(result_tree.first) / num_lookups) << " ns, "
                         "ucs: " << (ucs_time_to_nsec(result_pgt.first) / num_lookups) << " ns " <<
                         (result_pgt.second * 100) / lookups.size() << "% hit"
                         ;
@@ -524,6 +593,12 @@ protected:
     }
 
 private:
+    typedef enum {
+        LOOKUP_STL,
+        LOOKUP_PGT_TREE,
+        LOOKUP_PGT
+    } lookup_method_t;
+
     struct region_comparator {
         bool
         operator()(ucs_pgt_region_t *region1, ucs_pgt_region_t *region2) const
@@ -535,7 +610,8 @@ private:
     typedef std::set<ucs_pgt_region_t*, region_comparator> stl_pgtable_t;
 
     std::pair<ucs_time_t, unsigned>
-    inline measure(const std::vector<ucs_pgt_addr_t>& lookups, bool use_stl)
+    inline measure(const std::vector<ucs_pgt_addr_t>& lookups,
+                   lookup_method_t method)
     {
         unsigned hit_count = 0;
 
@@ -544,8 +620,18 @@ private:
         for (std::vector<ucs_pgt_addr_t>::const_iterator iter = lookups.begin();
                        iter != lookups.end(); ++iter)
         {
-            ucs_pgt_region_t *region =
-                            use_stl ? lookup_in_stl(*iter) : lookup_in_pgt(*iter);
+            ucs_pgt_region_t *region;
+            switch (method) {
+            case LOOKUP_STL:
+                region = lookup_in_stl(*iter);
+                break;
+            case LOOKUP_PGT_TREE:
+                region = lookup_in_pgt_tree(*iter);
+                break;
+            default:
+                region = lookup_in_pgt(*iter);
+                break;
+            }
             if (region != NULL) {
                ++hit_count;
             }
@@ -615,3 +701,33 @@ UCS_TEST_SKIP_COND_F(test_pgtable_perf, workloads,
                      false,
                      0.8);
 }
+
+/*
+ * Small number of regions, which are looked up in the flat array, compared
+ * with walking the tree
+ */
+UCS_TEST_SKIP_COND_F(test_pgtable_perf, small_workloads,
+                     (ucs::test_time_multiplier() != 1)) {
+
+    measure_workload(UCS_MASK(40),
+                     1024 * 256,
+                     1,
+                     4,
+                     10000000,
+                     true,
+                     0.8);
+    measure_workload(UCS_MASK(40),
+                     1024 * 256,
+                     1,
+                     UCS_PGT_FLAT_MAX_REGIONS,
+                     10000000,
+                     true,
+                     0.8);
+    measure_workload(UCS_MASK(40),
+                     1024 * 256,
+                     1,
+                     UCS_PGT_FLAT_MAX_REGIONS,
+                     10000000,
+                     false,
+                     0.8);
+}
@@ -15,6 +15,7 @@ extern "C" {
 
 #include <pthread.h>
 #include <fstream>
+#include <map>
 
 class scoped_profile {
 public:
@@ -110,6 +111,8 @@ protected:
     void test_env(const void **ptr, const ucs_profile_block_header_t &env_vars);
 
     void do_test(unsigned int_mode, const std::string &str_mode);
+
+    void do_test_stream(unsigned int_mode, const std::string &str_mode);
 };
 
 static int sum(int a, int b)
@@ -407,6 +410,102 @@ void test_profile::do_test(unsigned int_mode, const std::string& str_mode)
     EXPECT_EQ(&data[data.size()], ptr) << data.size();
 }
 
+void test_profile::do_test_stream(unsigned int_mode,
+                                  const std::string &str_mode)
+{
+    const int ITER           = 5;
+    uint64_t exp_count       = (int_mode & UCS_BIT(UCS_PROFILE_MODE_ACCUM)) ?
+                               ITER : 0;
+    uint64_t exp_num_records = NUM_LOCAITONS * ITER;
+
+    scoped_profile p(*this, PROFILE_FILENAME, str_mode.c_str());
+    run_profiled_code(ITER);
+
+    std::string data     = p.read();
+    const void *ptr      = &data[0];
+    const void *data_end = &data[data.size()];
+
+    /* coverity[tainted_data_downcast] */
+    const ucs_profile_header_t *hdr =
+                    reinterpret_cast<const ucs_profile_header_t*>(ptr);
+    EXPECT_EQ(UCS_PROFILE_FEATURE_STREAM, hdr->feature_flags);
+    EXPECT_EQ(0, hdr->locations.size);
+    EXPECT_EQ(0, hdr->threads.size);
+    test_header(hdr, int_mode, &ptr, NUM_LOCAITONS);
+    test_env(&ptr, hdr->env_vars);
+
+    std::vector<ucs_profile_location_t> locations;
+    std::map<uint32_t, uint64_t> num_records;
+    int num_thread_start = 0;
+    int num_thread_end   = 0;
+
+    /* Read and test the chunks, written so far by the profiling thread and
+     * the dump */
+    while (ptr < data_end) {
+        /* coverity[tainted_data_downcast] */
+        const ucs_profile_stream_chunk_t *chunk =
+                reinterpret_cast<const ucs_profile_stream_chunk_t*>(ptr);
+        ptr = chunk + 1;
+        ASSERT_LE(UCS_PTR_BYTE_OFFSET(ptr, chunk->size), data_end);
+
+        switch (chunk->type) {
+        case UCS_PROFILE_STREAM_CHUNK_LOCATIONS:
+            locations.insert(
+                    locations.end(),
+                    reinterpret_cast<const ucs_profile_location_t*>(ptr),
+                    reinterpret_cast<const ucs_profile_location_t*>(
+                            UCS_PTR_BYTE_OFFSET(ptr, chunk->size)));
+            break;
+        case UCS_PROFILE_STREAM_CHUNK_THREAD_START:
+            EXPECT_NE(m_tids.end(), m_tids.find(chunk->tid));
+            ++num_thread_start;
+            break;
+        case UCS_PROFILE_STREAM_CHUNK_RECORDS:
+            for (const ucs_profile_record_t *rec =
+                         reinterpret_cast<const ucs_profile_record_t*>(ptr);
+                 rec < UCS_PTR_BYTE_OFFSET(ptr, chunk->size); ++rec) {
+                /* Records refer only to locations which were written before */
+                EXPECT_LT(rec->location, locations.size());
+            }
+            num_records[chunk->tid] += chunk->size /
+                                       sizeof(ucs_profile_record_t);
+            break;
+        case UCS_PROFILE_STREAM_CHUNK_THREAD_END:
+        {
+            /* coverity[tainted_data_downcast] */
+            const ucs_profile_thread_header_t *thread_hdr =
+                    reinterpret_cast<const ucs_profile_thread_header_t*>(ptr);
+            const void *thread_ptr;
+            unsigned num_thread_locations =
+                    (chunk->size - sizeof(*thread_hdr)) /
+                    sizeof(ucs_profile_thread_location_t);
+
+            if (exp_count == 0) {
+                EXPECT_EQ(0, num_thread_locations);
+            }
+            test_thread_locations(thread_hdr, num_thread_locations, exp_count,
+                                  exp_num_records, &thread_ptr);
+            EXPECT_EQ(UCS_PTR_BYTE_OFFSET(ptr, chunk->size), thread_ptr);
+            EXPECT_EQ(exp_num_records, num_records[thread_hdr->tid]);
+            ++num_thread_end;
+            break;
+        }
+        default:
+            ADD_FAILURE() << "unexpected chunk type " << chunk->type;
+            break;
+        }
+
+        ptr = UCS_PTR_BYTE_OFFSET(ptr, chunk->size);
+    }
+
+    EXPECT_EQ(data_end, ptr);
+    EXPECT_EQ(NUM_LOCAITONS, locations.size());
+    test_locations(locations.data(), locations.size(), &ptr);
+    EXPECT_EQ(&locations.back() + 1, ptr);
+    EXPECT_EQ(num_threads(), num_thread_start);
+    EXPECT_EQ(num_threads(), num_thread_end);
+}
+
 UCS_TEST_P(test_profile, accum) {
     do_test(UCS_BIT(UCS_PROFILE_MODE_ACCUM), "accum");
 }
@@ -420,6 +519,15 @@ UCS_TEST_P(test_profile, log_accum) {
             "log,accum");
 }
 
+UCS_TEST_P(test_profile, stream) {
+    do_test_stream(UCS_BIT(UCS_PROFILE_MODE_STREAM), "stream");
+}
+
+UCS_TEST_P(test_profile, stream_accum) {
+    do_test_stream(UCS_BIT(UCS_PROFILE_MODE_STREAM) |
+                   UCS_BIT(UCS_PROFILE_MODE_ACCUM), "stream,accum");
+}
+
 INSTANTIATE_TEST_SUITE_P(st, test_profile, ::testing::Values(1));
 INSTANTIATE_TEST_SUITE_P(mt, test_profile, ::testing::Values(2, 4, 8));
 
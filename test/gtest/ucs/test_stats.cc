@@ -8,10 +8,12 @@
 #include <common/test.h>
 extern "C" {
 #include <ucs/stats/stats.h>
+#include <ucs/stats/stats_shm.h>
 }
 
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <map>
 
 #ifdef ENABLE_STATS
 #define NUM_DATA_NODES 20
@@ -289,6 +291,31 @@ public:
     }
 };
 
+class stats_shm_test : public stats_test {
+public:
+    virtual std::string stats_dest_config() {
+        return "shm";
+    }
+
+    virtual std::string stats_trigger_config() {
+        return "";
+    }
+
+    /* Return the samples of all active slots, by slot index */
+    std::map<uint32_t, ucs_stats_shm_sample_t>
+    sample_all(const ucs_stats_shm_t *shm) {
+        std::map<uint32_t, ucs_stats_shm_sample_t> samples;
+        ucs_stats_shm_sample_t sample;
+
+        for (uint32_t index = 0; index < shm->hdr->slots_hwm; ++index) {
+            if (ucs_stats_shm_sample(shm, index, &sample) == UCS_OK) {
+                samples[index] = sample;
+            }
+        }
+        return samples;
+    }
+};
+
 UCS_TEST_F(stats_on_demand_test, null_root) {
     ucs_stats_node_t       *cat_node;
 
@@ -352,6 +379,110 @@ UCS_TEST_F(stats_on_signal_test, report) {
     free_nodes(cat_node, data_nodes);
 }
 
+UCS_TEST_F(stats_shm_test, report) {
+    typedef std::map<uint32_t, ucs_stats_shm_sample_t> samples_t;
+    ucs_stats_node_t *cat_node;
+    ucs_stats_node_t *data_nodes[NUM_DATA_NODES] = {NULL};
+    ucs_stats_shm_t shm;
+
+    prepare_nodes(&cat_node, data_nodes);
+
+    ucs_status_t status = ucs_stats_shm_attach(getpid(), &shm);
+    ASSERT_UCS_OK(status);
+
+    samples_t samples = sample_all(&shm);
+    EXPECT_EQ(size_t(NUM_DATA_NODES + 1), samples.size());
+
+    int32_t cat_index = -1;
+    for (samples_t::iterator it = samples.begin(); it != samples.end(); ++it) {
+        const ucs_stats_shm_class_t *cls =
+                ucs_stats_shm_class(&shm, it->second.class_index);
+        if (std::string(cls->name) == "category") {
+            EXPECT_EQ(UCS_STATS_SHM_PARENT_ROOT, it->second.parent);
+            cat_index = it->first;
+        }
+    }
+    ASSERT_NE(-1, cat_index);
+
+    unsigned num_data_nodes = 0;
+    for (samples_t::iterator it = samples.begin(); it != samples.end(); ++it) {
+        const ucs_stats_shm_class_t *cls =
+                ucs_stats_shm_class(&shm, it->second.class_index);
+        if (std::string(cls->name) != "data") {
+            continue;
+        }
+
+        EXPECT_EQ(cat_index, it->second.parent);
+        ASSERT_EQ(unsigned(NUM_COUNTERS), cls->num_counters);
+        EXPECT_EQ(std::string("counter0"),
+                  std::string(cls->counter_names[0]));
+        for (unsigned i = 0; i < NUM_COUNTERS; ++i) {
+            EXPECT_EQ((i + 1) * 10, it->second.counters[i]);
+        }
+        ++num_data_nodes;
+    }
+    EXPECT_EQ(unsigned(NUM_DATA_NODES), num_data_nodes);
+
+    /* Counter updates are visible without dumping the statistics */
+    UCS_STATS_UPDATE_COUNTER(data_nodes[0], 0, 5);
+    samples = sample_all(&shm);
+    bool found = false;
+    for (samples_t::iterator it = samples.begin(); it != samples.end(); ++it) {
+        if (std::string(it->second.name) == data_nodes[0]->name) {
+            EXPECT_EQ(15u, it->second.counters[0]);
+            found = true;
+        }
+    }
+    EXPECT_TRUE(found);
+
+    free_nodes(cat_node, data_nodes);
+    EXPECT_TRUE(sample_all(&shm).empty());
+
+    ucs_stats_shm_detach(&shm);
+}
+
+/* Use a private segment, while the global statistics go to a file */
+class stats_shm_segment_test : public stats_file_test {
+};
+
+UCS_TEST_F(stats_shm_segment_test, detach_with_nodes) {
+    ucs_stats_node_t *nodes[NUM_DATA_NODES];
+    ucs_stats_shm_t shm, reader;
+    ucs_status_t status;
+
+    status = ucs_stats_shm_create(&shm, NUM_DATA_NODES);
+    ASSERT_UCS_OK(status);
+
+    /* Publish only half of the nodes, the rest are in use but not visible */
+    for (unsigned i = 0; i < NUM_DATA_NODES; ++i) {
+        nodes[i] = ucs_stats_shm_node_get(&shm, m_data_stats_class);
+        ASSERT_TRUE(nodes[i] != NULL);
+        nodes[i]->cls    = m_data_stats_class;
+        nodes[i]->parent = NULL;
+        if ((i % 2) == 0) {
+            ASSERT_UCS_OK(ucs_stats_shm_node_publish(&shm, nodes[i]));
+        }
+    }
+
+    /* The segment is removed, but the nodes must remain valid */
+    ucs_stats_shm_detach(&shm);
+    EXPECT_EQ(UCS_ERR_NO_ELEM, ucs_stats_shm_attach(getpid(), &reader));
+    ASSERT_TRUE(shm.hdr != NULL);
+
+    for (unsigned i = 0; i < NUM_DATA_NODES; ++i) {
+        nodes[i]->counters[0] = i;
+    }
+
+    for (unsigned i = 0; i < NUM_DATA_NODES; ++i) {
+        EXPECT_TRUE(shm.hdr != NULL);
+        EXPECT_EQ(i, nodes[i]->counters[0]);
+        ucs_stats_shm_node_put(&shm, nodes[i]);
+    }
+
+    /* Unmapped when the last node was returned */
+    EXPECT_TRUE(shm.hdr == NULL);
+}
+
 UCS_TEST_F(stats_on_exit_test, dump) {
     ucs_stats_node_t       *cat_node;
     ucs_stats_node_t       *data_nodes[NUM_DATA_NODES] = {NULL};
@@ -211,4 +211,71 @@ UCS_TEST_SKIP_COND_P(test_uct_event, sig_am,
     test_recv_am(UCT_EVENT_RECV_SIG, UCT_SEND_FLAG_SIGNALED);
 }
 
+UCS_TEST_SKIP_COND_P(test_uct_event, am_edge_triggered,
+                     !has_transport("tcp"), "TCP_EDGE_TRIGGERED=y")
+{
+    static const unsigned count = 10000 / ucs::test_time_multiplier();
+    recv_desc_t *recv_buffer;
+
+    recv_buffer = (recv_desc_t*)malloc(sizeof(*recv_buffer) +
+                                       sizeof(m_send_data));
+    uct_iface_set_am_handler(m_e2->iface(), 0, am_handler, recv_buffer, 0);
+
+    /* Edge-triggered sockets may signal the event fd for events which were
+     * not requested, but a successful arm must never miss a wakeup */
+    for (unsigned i = 0; i < count; ++i) {
+        arm(m_e2, UCT_EVENT_RECV);
+        send_am_data(0, false);
+        ASSERT_TRUE(m_async_event_ctx.wait_for_event(*m_e2, 60));
+        while (m_am_recv_count < m_am_send_count) {
+            progress();
+        }
+    }
+
+    m_e1->flush();
+    free(recv_buffer);
+}
+
+UCS_TEST_SKIP_COND_P(test_uct_event, arm_edge_triggered_not_drained,
+                     !has_transport("tcp"), "TCP_EDGE_TRIGGERED=y",
+                     "TCP_RX_SEG_SIZE=8kb")
+{
+    /* Enough messages to exceed a single receive segment */
+    static const unsigned count = 4096;
+    recv_desc_t *recv_buffer;
+    ucs_status_t status;
+
+    recv_buffer = (recv_desc_t*)malloc(sizeof(*recv_buffer) +
+                                       sizeof(m_send_data));
+    uct_iface_set_am_handler(m_e2->iface(), 0, am_handler, recv_buffer, 0);
+
+    arm(m_e2, UCT_EVENT_RECV);
+    for (unsigned i = 0; i < count; ++i) {
+        send_am_data(0, false);
+    }
+    m_e1->flush();
+    ASSERT_TRUE(m_async_event_ctx.wait_for_event(*m_e2, 60));
+    /* Let all data arrive, so no new edges are signaled after progress */
+    ucs::safe_sleep(0.1);
+
+    /* A single progress call does not drain the socket, and its edge was
+     * already consumed, so arming must not succeed until it is drained */
+    m_e2->progress();
+    ASSERT_LT(m_am_recv_count, m_am_send_count);
+    status = uct_iface_event_arm(m_e2->iface(), UCT_EVENT_RECV);
+    if (status == UCS_OK) {
+        EXPECT_TRUE(m_async_event_ctx.wait_for_event(*m_e2, 1))
+                << "armed with pending data, but no wakeup";
+    } else {
+        EXPECT_EQ(UCS_ERR_BUSY, status);
+    }
+
+    while (m_am_recv_count < m_am_send_count) {
+        progress();
+    }
+    arm(m_e2, UCT_EVENT_RECV);
+
+    free(recv_buffer);
+}
+
 UCT_INSTANTIATE_NO_SELF_TEST_CASE(test_uct_event);
@@ -7,12 +7,17 @@
 extern "C" {
 #include <uct/api/uct.h>
 #include <uct/sm/mm/base/mm_md.h>
+#include <uct/sm/mm/base/mm_iface.h>
 #include <ucs/time/time.h>
 }
 #include "uct_p2p_test.h"
 #include <common/test.h>
 #include "uct_test.h"
 
+#include <fstream>
+#include <sstream>
+#include <sys/vfs.h>
+
 
 class test_uct_mm : public uct_test {
 public:
@@ -76,6 +81,83 @@ public:
         variants.push_back(mm_resource(res, "/dev/shm"));
     }
 
+    static std::string hugetlbfs_mount() {
+        std::ifstream mounts("/proc/mounts");
+        std::string line, device, dir, type;
+
+        while (std::getline(mounts, line)) {
+            std::istringstream iss(line);
+            if ((iss >> device >> dir >> type) && (type == "hugetlbfs") &&
+                (access(dir.c_str(), W_OK) == 0)) {
+                return dir;
+            }
+        }
+
+        return "";
+    }
+
+    static unsigned long free_huge_pages(size_t page_size) {
+        std::ifstream file("/sys/kernel/mm/hugepages/hugepages-" +
+                           ucs::to_string(page_size / UCS_KBYTE) +
+                           "kB/free_hugepages");
+        unsigned long count = 0;
+
+        file >> count;
+        return count;
+    }
+
+    void send_am_short(entity &sender, unsigned ep_index, entity &receiver) {
+        uint64_t send_data = 0xdeadbeef;
+        recv_desc_t *recv_buffer;
+        ucs_status_t status;
+
+        recv_buffer = (recv_desc_t*)malloc(sizeof(*recv_buffer) +
+                                           sizeof(uint64_t));
+        recv_buffer->length = 0;
+        uct_iface_set_am_handler(receiver.iface(), 0, mm_am_handler,
+                                 recv_buffer, 0);
+
+        do {
+            status = uct_ep_am_short(sender.ep(ep_index), 0, 0xbeef,
+                                     &send_data, sizeof(send_data));
+            progress();
+        } while (status == UCS_ERR_NO_RESOURCE);
+        ASSERT_UCS_OK(status);
+
+        wait_for_flag(&recv_buffer->length);
+        EXPECT_EQ(sizeof(send_data), recv_buffer->length);
+        EXPECT_EQ(send_data, *(uint64_t*)(recv_buffer + 1));
+
+        uct_iface_set_am_handler(receiver.iface(), 0, NULL, NULL, 0);
+        free(recv_buffer);
+    }
+
+    void check_alloc_page_size(entity &e, size_t length,
+                               size_t expected_page_size) {
+        uct_alloc_method_t method = UCT_ALLOC_METHOD_MD;
+        uct_md_h md               = e.md();
+        uct_mem_alloc_params_t params;
+        uct_allocated_memory_t mem;
+
+        params.field_mask = UCT_MEM_ALLOC_PARAM_FIELD_FLAGS    |
+                            UCT_MEM_ALLOC_PARAM_FIELD_MEM_TYPE |
+                            UCT_MEM_ALLOC_PARAM_FIELD_MDS      |
+                            UCT_MEM_ALLOC_PARAM_FIELD_NAME;
+        params.flags      = UCT_MD_MEM_ACCESS_ALL;
+        params.mem_type   = UCS_MEMORY_TYPE_HOST;
+        params.mds.mds    = &md;
+        params.mds.count  = 1;
+        params.name       = "test_hugetlbfs";
+
+        ASSERT_UCS_OK(uct_mem_alloc(length, &method, 1, &params, &mem));
+
+        uct_mm_seg_t *seg = (uct_mm_seg_t*)mem.memh;
+        EXPECT_EQ(expected_page_size, seg->page_size) << "length " << length;
+        EXPECT_EQ(0u, mem.length % seg->page_size);
+        EXPECT_EQ(0u, (uintptr_t)mem.address % seg->page_size);
+        uct_mem_free(&mem);
+    }
+
     void set_posix_config() {
         set_config("POSIX_DIR=" + GetParam()->shm_dir);
     }
@@ -110,7 +192,15 @@ public:
         return UCS_OK;
     }
 
-    bool check_md_caps(uint64_t flags) {
+    static size_t mm_am_pack(void *dest, void *arg) {
+        uint64_t *buffer = (uint64_t*)dest;
+
+        buffer[0] = 0xbeef;
+        buffer[1] = *(uint64_t*)arg;
+        return 2 * sizeof(uint64_t);
+    }
+
+        bool check_md_caps(uint64_t flags) {
         FOR_EACH_ENTITY(iter) {
             if (!(ucs_test_all_flags((*iter)->md_attr().flags, flags))) {
                 return false;
@@ -269,4 +359,111 @@ UCS_TEST_SKIP_COND_P(test_uct_mm, reg,
     ASSERT_UCS_OK(status);
 }
 
+UCS_TEST_SKIP_COND_P(test_uct_mm, lazy_rx,
+                     !check_caps(UCT_IFACE_FLAG_AM_BCOPY | UCT_IFACE_FLAG_CB_SYNC),
+                     "MM_LAZY_RX=y")
+{
+    uct_mm_iface_t *iface = ucs_derived_of(m_e2->iface(), uct_mm_iface_t);
+    uint64_t send_data    = 0xdeadbeef;
+    recv_desc_t *recv_buffer;
+    ssize_t res;
+
+    /* An interface which no peer connected to does not allocate receive
+     * descriptors */
+    entity *e3 = uct_test::create_entity(0);
+    m_entities.push_back(e3);
+    e3->progress();
+
+    uct_mm_iface_t *idle_iface = ucs_derived_of(e3->iface(), uct_mm_iface_t);
+    EXPECT_TRUE(idle_iface->rx_lazy);
+    EXPECT_TRUE(idle_iface->recv_desc_mp.data->chunks == NULL);
+
+    recv_buffer = (recv_desc_t*)malloc(sizeof(*recv_buffer) +
+                                       sizeof(uint64_t));
+    recv_buffer->length = 0;
+    uct_iface_set_am_handler(m_e2->iface(), 0, mm_am_handler, recv_buffer, 0);
+
+    /* The first send may wait until the receiver allocates its descriptors */
+    do {
+        res = uct_ep_am_bcopy(m_e1->ep(0), 0, mm_am_pack, &send_data, 0);
+        progress();
+    } while (res == UCS_ERR_NO_RESOURCE);
+    ASSERT_EQ((ssize_t)(2 * sizeof(uint64_t)), res);
+
+    wait_for_flag(&recv_buffer->length);
+    EXPECT_EQ(sizeof(send_data), recv_buffer->length);
+    EXPECT_EQ(send_data, *(uint64_t*)(recv_buffer + 1));
+    EXPECT_FALSE(iface->rx_lazy);
+
+    uct_iface_set_am_handler(m_e2->iface(), 0, NULL, NULL, 0);
+    free(recv_buffer);
+}
+
+UCS_TEST_P(test_uct_mm, page_size)
+{
+    uct_mm_iface_t *iface = ucs_derived_of(m_e1->iface(), uct_mm_iface_t);
+    uct_mm_seg_t *seg     = (uct_mm_seg_t*)iface->recv_fifo_mem.memh;
+
+    EXPECT_TRUE(ucs_is_pow2(seg->page_size));
+    EXPECT_GE(seg->page_size, ucs_get_page_size());
+    if (!iface->rx_lazy) {
+        EXPECT_GE(iface->rx_desc_page_size, ucs_get_page_size());
+    }
+}
+
+UCS_TEST_SKIP_COND_P(test_uct_mm, hugetlbfs_fallback,
+                     GetParam()->tl_name != "posix")
+{
+    /* The directory is not a hugetlbfs mount, so regular pages are used */
+    modify_config("POSIX_HUGETLBFS_DIR", "/dev/shm");
+
+    entity *e3 = uct_test::create_entity(0);
+    m_entities.push_back(e3);
+
+    uct_mm_iface_t *iface = ucs_derived_of(e3->iface(), uct_mm_iface_t);
+    uct_mm_seg_t *seg     = (uct_mm_seg_t*)iface->recv_fifo_mem.memh;
+    EXPECT_EQ(ucs_get_page_size(), seg->page_size);
+
+    e3->connect(0, *m_e1, 1);
+    m_e1->connect(1, *e3, 0);
+    send_am_short(*e3, 0, *m_e1);
+}
+
+UCS_TEST_SKIP_COND_P(test_uct_mm, hugetlbfs,
+                     (GetParam()->tl_name != "posix") ||
+                     hugetlbfs_mount().empty())
+{
+    const std::string mount = hugetlbfs_mount();
+    struct statfs fs;
+
+    ASSERT_EQ(0, statfs(mount.c_str(), &fs)) << mount;
+    size_t huge_page_size = fs.f_bsize;
+    if (free_huge_pages(huge_page_size) < 32) {
+        UCS_TEST_SKIP_R("not enough free huge pages of size " +
+                        ucs::to_string(huge_page_size));
+    }
+
+    modify_config("POSIX_HUGETLBFS_DIR", mount);
+
+    /* Huge pages are not used if the length is aligned up by more than 2x */
+    entity *e3 = uct_test::create_entity(0);
+    m_entities.push_back(e3);
+    check_alloc_page_size(*e3, huge_page_size / 4, ucs_get_page_size());
+    check_alloc_page_size(*e3, (huge_page_size * 3) / 4, huge_page_size);
+
+    /* Peers attach the FIFO aligned to the page size of the hugetlbfs file */
+    modify_config("POSIX_HUGETLB_MODE", "y");
+    entity *e4 = uct_test::create_entity(0);
+    m_entities.push_back(e4);
+
+    uct_mm_iface_t *iface = ucs_derived_of(e4->iface(), uct_mm_iface_t);
+    uct_mm_seg_t *seg     = (uct_mm_seg_t*)iface->recv_fifo_mem.memh;
+    EXPECT_EQ(huge_page_size, seg->page_size);
+
+    e4->connect(0, *m_e1, 1);
+    m_e1->connect(1, *e4, 0);
+    send_am_short(*e4, 0, *m_e1);
+    send_am_short(*m_e1, 1, *e4);
+}
+
 UCT_INSTANTIATE_MM_TEST_CASE(test_uct_mm)